@@ -4,11 +4,25 @@
 
 #include "flutter/assets/asset_manager.h"
 
+#include <vector>
+
 #include "flutter/assets/directory_asset_bundle.h"
 #include "flutter/fml/trace_event.h"
 
 namespace flutter {
 
+namespace {
+
+std::unique_ptr<fml::Mapping> ShareMapping(
+    std::shared_ptr<fml::Mapping> mapping) {
+  const uint8_t* data = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+  return std::make_unique<fml::NonOwnedMapping>(
+      data, size, [mapping = std::move(mapping)](const uint8_t*, size_t) {});
+}
+
+}  // namespace
+
 AssetManager::AssetManager() = default;
 
 AssetManager::~AssetManager() = default;
@@ -18,7 +32,9 @@ void AssetManager::PushFront(std::unique_ptr<AssetResolver> resolver) {
     return;
   }
 
+  std::scoped_lock lock(mutex_);
   resolvers_.push_front(std::move(resolver));
+  InvalidateLookups();
 }
 
 void AssetManager::PushBack(std::unique_ptr<AssetResolver> resolver) {
@@ -26,7 +42,37 @@ void AssetManager::PushBack(std::unique_ptr<AssetResolver> resolver) {
     return;
   }
 
+  std::scoped_lock lock(mutex_);
   resolvers_.push_back(std::move(resolver));
+  InvalidateLookups();
+}
+
+void AssetManager::InvalidateLookups() {
+  lookups_.clear();
+  misses_.clear();
+  miss_positions_.clear();
+  generation_++;
+}
+
+bool AssetManager::TouchMissUnlocked(const std::string& asset_name) const {
+  auto found = miss_positions_.find(asset_name);
+  if (found == miss_positions_.end()) {
+    return false;
+  }
+  misses_.splice(misses_.begin(), misses_, found->second);
+  return true;
+}
+
+void AssetManager::RememberMissUnlocked(const std::string& asset_name) const {
+  if (TouchMissUnlocked(asset_name)) {
+    return;
+  }
+  if (misses_.size() >= kMaxRememberedMisses) {
+    miss_positions_.erase(misses_.back());
+    misses_.pop_back();
+  }
+  misses_.push_front(asset_name);
+  miss_positions_[asset_name] = misses_.begin();
 }
 
 // |AssetResolver|
@@ -37,18 +83,72 @@ std::unique_ptr<fml::Mapping> AssetManager::GetAsMapping(
   }
   TRACE_EVENT1("flutter", "AssetManager::GetAsMapping", "name",
                asset_name.c_str());
-  for (const auto& resolver : resolvers_) {
-    auto mapping = resolver->GetAsMapping(asset_name);
+
+  // Resolvers are only ever added, so they can be used without holding the
+  // lock. This keeps lookups of different assets from waiting on each other.
+  std::vector<const AssetResolver*> resolvers;
+  uint64_t generation = 0;
+  {
+    std::scoped_lock lock(mutex_);
+    if (TouchMissUnlocked(asset_name)) {
+      return nullptr;
+    }
+    const AssetResolver* holder = nullptr;
+    auto found = lookups_.find(asset_name);
+    if (found != lookups_.end()) {
+      if (auto mapping = found->second.mapping.lock()) {
+        return ShareMapping(std::move(mapping));
+      }
+      holder = found->second.resolver;
+      // Try the resolver that held the asset before all the others.
+      resolvers.push_back(holder);
+    }
+    for (const auto& resolver : resolvers_) {
+      if (resolver.get() != holder) {
+        resolvers.push_back(resolver.get());
+      }
+    }
+    generation = generation_;
+  }
+
+  const AssetResolver* holder = nullptr;
+  std::shared_ptr<fml::Mapping> mapping;
+  for (const auto* resolver : resolvers) {
+    mapping = resolver->GetAsMapping(asset_name);
     if (mapping != nullptr) {
-      return mapping;
+      holder = resolver;
+      break;
     }
   }
-  FML_DLOG(WARNING) << "Could not find asset: " << asset_name;
-  return nullptr;
+
+  {
+    std::scoped_lock lock(mutex_);
+    if (generation == generation_) {
+      if (mapping == nullptr) {
+        RememberMissUnlocked(asset_name);
+      } else {
+        auto& lookup = lookups_[asset_name];
+        // Another request for the asset may have resolved it in the meantime.
+        // Share its mapping instead of keeping two of them alive.
+        if (auto existing = lookup.mapping.lock()) {
+          return ShareMapping(std::move(existing));
+        }
+        lookup.resolver = holder;
+        lookup.mapping = mapping;
+      }
+    }
+  }
+
+  if (mapping == nullptr) {
+    FML_DLOG(WARNING) << "Could not find asset: " << asset_name;
+    return nullptr;
+  }
+  return ShareMapping(std::move(mapping));
 }
 
 // |AssetResolver|
 bool AssetManager::IsValid() const {
+  std::scoped_lock lock(mutex_);
   return resolvers_.size() > 0;
 }
 
@@ -5,9 +5,13 @@
 #ifndef FLUTTER_ASSETS_ASSET_MANAGER_H_
 #define FLUTTER_ASSETS_ASSET_MANAGER_H_
 
+#include <cstdint>
 #include <deque>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "flutter/assets/asset_resolver.h"
 #include "flutter/fml/macros.h"
@@ -15,8 +19,21 @@
 
 namespace flutter {
 
+// Resolves assets from a stack of resolvers, trying each in order. The
+// manager remembers which resolver holds each asset it found, so that repeated
+// lookups do not probe every resolver again. It also remembers the most
+// recently missed names, up to |kMaxRememberedMisses| of them, so that lookups
+// of arbitrary names cannot grow the manager without bound. While a mapping
+// it returned is alive, further requests for the same asset share it.
+// Pushing a resolver forgets everything that was remembered.
+//
+// This class is thread safe.
 class AssetManager final : public AssetResolver {
  public:
+  // The number of missing asset names that are remembered, least recently
+  // missed first out.
+  static constexpr size_t kMaxRememberedMisses = 128;
+
   AssetManager();
 
   ~AssetManager() override;
@@ -33,7 +50,31 @@ class AssetManager final : public AssetResolver {
       const std::string& asset_name) const override;
 
  private:
+  struct Lookup {
+    // The resolver that holds the asset.
+    const AssetResolver* resolver = nullptr;
+    // The mapping of the asset, for as long as it is in use.
+    std::weak_ptr<fml::Mapping> mapping;
+  };
+
+  mutable std::mutex mutex_;
   std::deque<std::unique_ptr<AssetResolver>> resolvers_;
+  mutable std::unordered_map<std::string, Lookup> lookups_;
+  // The names that no resolver holds, most recently missed first.
+  mutable std::list<std::string> misses_;
+  mutable std::unordered_map<std::string, std::list<std::string>::iterator>
+      miss_positions_;
+  // Incremented whenever the resolvers change, so that lookups racing with
+  // the change are not remembered.
+  uint64_t generation_ = 0;
+
+  void InvalidateLookups();
+
+  // Returns whether |asset_name| is a remembered miss, and if so makes it the
+  // most recent one.
+  bool TouchMissUnlocked(const std::string& asset_name) const;
+
+  void RememberMissUnlocked(const std::string& asset_name) const;
 
   FML_DISALLOW_COPY_AND_ASSIGN(AssetManager);
 };
@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/asset_manager.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+class CountingAssetResolver : public AssetResolver {
+ public:
+  explicit CountingAssetResolver(std::map<std::string, std::string> assets)
+      : assets_(std::move(assets)) {}
+
+  size_t GetLookupCount() const { return lookup_count_; }
+
+  // |AssetResolver|
+  bool IsValid() const override { return true; }
+
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetAsMapping(
+      const std::string& asset_name) const override {
+    lookup_count_++;
+    auto found = assets_.find(asset_name);
+    if (found == assets_.end()) {
+      return nullptr;
+    }
+    return std::make_unique<fml::DataMapping>(found->second);
+  }
+
+ private:
+  const std::map<std::string, std::string> assets_;
+  mutable std::atomic<size_t> lookup_count_ = 0;
+};
+
+std::string StringFromMapping(const fml::Mapping& mapping) {
+  return std::string(reinterpret_cast<const char*>(mapping.GetMapping()),
+                     mapping.GetSize());
+}
+
+}  // namespace
+
+TEST(AssetManagerTest, RemembersWhichResolverHoldsAnAsset) {
+  AssetManager manager;
+  auto overlay = std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{{"a", "overlay"}});
+  auto bundle = std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{{"a", "bundle"}, {"b", "bundle"}});
+  auto* overlay_ptr = overlay.get();
+  auto* bundle_ptr = bundle.get();
+  manager.PushBack(std::move(overlay));
+  manager.PushBack(std::move(bundle));
+
+  for (int i = 0; i < 3; i++) {
+    auto mapping = manager.GetAsMapping("b");
+    ASSERT_TRUE(mapping);
+    ASSERT_EQ(StringFromMapping(*mapping), "bundle");
+  }
+  // Only the first lookup probed the overlay.
+  ASSERT_EQ(overlay_ptr->GetLookupCount(), 1u);
+  ASSERT_EQ(bundle_ptr->GetLookupCount(), 3u);
+
+  auto mapping = manager.GetAsMapping("a");
+  ASSERT_TRUE(mapping);
+  ASSERT_EQ(StringFromMapping(*mapping), "overlay");
+}
+
+TEST(AssetManagerTest, RemembersMissingAssets) {
+  AssetManager manager;
+  auto resolver = std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{{"a", "contents"}});
+  auto* resolver_ptr = resolver.get();
+  manager.PushBack(std::move(resolver));
+
+  ASSERT_FALSE(manager.GetAsMapping("missing"));
+  ASSERT_FALSE(manager.GetAsMapping("missing"));
+  ASSERT_EQ(resolver_ptr->GetLookupCount(), 1u);
+
+  // A missing asset does not get in the way of the assets that are found.
+  auto mapping = manager.GetAsMapping("a");
+  ASSERT_TRUE(mapping);
+  ASSERT_EQ(StringFromMapping(*mapping), "contents");
+}
+
+TEST(AssetManagerTest, ForgetsLeastRecentlyMissedAssets) {
+  AssetManager manager;
+  auto resolver = std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{});
+  auto* resolver_ptr = resolver.get();
+  manager.PushBack(std::move(resolver));
+
+  ASSERT_FALSE(manager.GetAsMapping("first"));
+  ASSERT_FALSE(manager.GetAsMapping("second"));
+  for (size_t i = 0; i < AssetManager::kMaxRememberedMisses - 1; i++) {
+    ASSERT_FALSE(manager.GetAsMapping("other" + std::to_string(i)));
+    // Keep the second miss the most recent one.
+    ASSERT_FALSE(manager.GetAsMapping("second"));
+  }
+  const size_t lookup_count = resolver_ptr->GetLookupCount();
+  ASSERT_EQ(lookup_count, AssetManager::kMaxRememberedMisses + 1);
+
+  ASSERT_FALSE(manager.GetAsMapping("second"));
+  ASSERT_EQ(resolver_ptr->GetLookupCount(), lookup_count);
+  ASSERT_FALSE(manager.GetAsMapping("first"));
+  ASSERT_EQ(resolver_ptr->GetLookupCount(), lookup_count + 1);
+}
+
+TEST(AssetManagerTest, SharesMappingsInUse) {
+  AssetManager manager;
+  auto resolver = std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{{"a", "contents"}});
+  auto* resolver_ptr = resolver.get();
+  manager.PushBack(std::move(resolver));
+
+  auto first = manager.GetAsMapping("a");
+  auto second = manager.GetAsMapping("a");
+  ASSERT_TRUE(first && second);
+  ASSERT_EQ(first->GetMapping(), second->GetMapping());
+  ASSERT_EQ(resolver_ptr->GetLookupCount(), 1u);
+
+  // Once every user is gone, the asset is mapped again.
+  first.reset();
+  second.reset();
+  auto third = manager.GetAsMapping("a");
+  ASSERT_TRUE(third);
+  ASSERT_EQ(StringFromMapping(*third), "contents");
+  ASSERT_EQ(resolver_ptr->GetLookupCount(), 2u);
+}
+
+TEST(AssetManagerTest, PushingResolversForgetsLookups) {
+  AssetManager manager;
+  manager.PushBack(std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{{"a", "bundle"}}));
+  ASSERT_FALSE(manager.GetAsMapping("b"));
+  auto bundle_a = manager.GetAsMapping("a");
+  ASSERT_TRUE(bundle_a);
+
+  auto overlay = std::make_unique<CountingAssetResolver>(
+      std::map<std::string, std::string>{{"a", "overlay"}, {"b", "overlay"}});
+  auto* overlay_ptr = overlay.get();
+  manager.PushFront(std::move(overlay));
+  // The miss is forgotten, so the new resolver is probed for it.
+  auto b = manager.GetAsMapping("b");
+  ASSERT_TRUE(b);
+  ASSERT_EQ(StringFromMapping(*b), "overlay");
+  ASSERT_EQ(overlay_ptr->GetLookupCount(), 1u);
+  // The mapping from the bundle is still alive, but must not be shared.
+  auto overlay_a = manager.GetAsMapping("a");
+  ASSERT_TRUE(overlay_a);
+  ASSERT_EQ(StringFromMapping(*overlay_a), "overlay");
+  ASSERT_EQ(StringFromMapping(*bundle_a), "bundle");
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,159 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/packed_asset_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/compression.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+constexpr char PackedAssetBundle::kFileName[];
+
+std::unique_ptr<PackedAssetBundle> PackedAssetBundle::Open(
+    const fml::UniqueFD& directory) {
+  if (!directory.is_valid()) {
+    return nullptr;
+  }
+  auto file = fml::OpenFileReadOnly(directory, kFileName);
+  if (!file.is_valid()) {
+    return nullptr;
+  }
+  auto archive = std::make_shared<fml::FileMapping>(file);
+  if (archive->GetMapping() == nullptr) {
+    return nullptr;
+  }
+  auto bundle = std::make_unique<PackedAssetBundle>(std::move(archive));
+  if (!bundle->IsValid()) {
+    FML_LOG(ERROR) << "The packed asset archive was malformed.";
+    return nullptr;
+  }
+  return bundle;
+}
+
+PackedAssetBundle::PackedAssetBundle(
+    std::shared_ptr<const fml::Mapping> archive)
+    : archive_(std::move(archive)) {
+  is_valid_ = ValidateArchive();
+}
+
+PackedAssetBundle::~PackedAssetBundle() = default;
+
+bool PackedAssetBundle::ValidateArchive() {
+  if (!archive_ || archive_->GetMapping() == nullptr) {
+    return false;
+  }
+  const uint8_t* base = archive_->GetMapping();
+  const size_t size = archive_->GetSize();
+  if (size < sizeof(packed_assets::Header) ||
+      reinterpret_cast<uintptr_t>(base) % alignof(packed_assets::Entry) != 0) {
+    return false;
+  }
+
+  packed_assets::Header header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, packed_assets::kMagic,
+                  sizeof(header.magic)) != 0 ||
+      header.version != packed_assets::kVersion) {
+    return false;
+  }
+
+  // The entries immediately follow the header.
+  const size_t entries_size =
+      static_cast<size_t>(header.entry_count) * sizeof(packed_assets::Entry);
+  if (entries_size > size - sizeof(header) ||
+      header.names_offset > size || header.names_size > size ||
+      header.names_offset + header.names_size > size) {
+    return false;
+  }
+  entries_ = reinterpret_cast<const packed_assets::Entry*>(base +
+                                                           sizeof(header));
+  entry_count_ = header.entry_count;
+  names_ = reinterpret_cast<const char*>(base + header.names_offset);
+
+  for (size_t i = 0; i < entry_count_; i++) {
+    const auto& entry = entries_[i];
+    if (entry.name_offset > header.names_size ||
+        entry.name_size > header.names_size - entry.name_offset ||
+        entry.payload_offset > size ||
+        entry.payload_size > size - entry.payload_offset) {
+      return false;
+    }
+    switch (entry.compression) {
+      case packed_assets::Compression::kNone:
+        if (entry.payload_size != entry.size) {
+          return false;
+        }
+        break;
+      case packed_assets::Compression::kLZ4:
+        // No LZ4 block expands by more than a factor of 255, which bounds the
+        // allocation a malformed entry can cause.
+        if (entry.size / 255 > entry.payload_size) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+    // Lookups rely on the names being sorted and unique.
+    if (i > 0 && GetEntryName(entries_[i - 1]) >= GetEntryName(entry)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view PackedAssetBundle::GetEntryName(
+    const packed_assets::Entry& entry) const {
+  return std::string_view(names_ + entry.name_offset, entry.name_size);
+}
+
+// |AssetResolver|
+bool PackedAssetBundle::IsValid() const {
+  return is_valid_;
+}
+
+// |AssetResolver|
+std::unique_ptr<fml::Mapping> PackedAssetBundle::GetAsMapping(
+    const std::string& asset_name) const {
+  if (!is_valid_) {
+    FML_DLOG(WARNING) << "Asset bundle was not valid.";
+    return nullptr;
+  }
+
+  const auto* end = entries_ + entry_count_;
+  const auto* entry = std::lower_bound(
+      entries_, end, asset_name,
+      [this](const packed_assets::Entry& entry, const std::string& name) {
+        return GetEntryName(entry) < name;
+      });
+  if (entry == end || GetEntryName(*entry) != asset_name) {
+    return nullptr;
+  }
+
+  const uint8_t* payload = archive_->GetMapping() + entry->payload_offset;
+  if (entry->compression == packed_assets::Compression::kLZ4) {
+    std::vector<uint8_t> decompressed(entry->size);
+    if (!fml::DecompressLZ4(payload, entry->payload_size, decompressed.data(),
+                            decompressed.size())) {
+      FML_LOG(ERROR) << "Could not decompress asset " << asset_name;
+      return nullptr;
+    }
+    return std::make_unique<fml::DataMapping>(std::move(decompressed));
+  }
+
+  // The slice keeps the archive mapped for as long as it is alive, even if
+  // this bundle is collected first.
+  return std::make_unique<fml::NonOwnedMapping>(
+      payload, entry->size,
+      [archive = archive_](const uint8_t*, size_t) {});
+}
+
+}  // namespace flutter
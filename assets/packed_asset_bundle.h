@@ -0,0 +1,61 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
+#define FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "flutter/assets/asset_resolver.h"
+#include "flutter/assets/packed_asset_format.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+
+namespace flutter {
+
+// Resolves assets from a single packed archive, as produced by the
+// |asset_packer| tool. The archive is mapped once and every lookup is a
+// binary search of its index. Uncompressed assets are returned as slices of
+// the archive's mapping without any copies or system calls.
+class PackedAssetBundle : public AssetResolver {
+ public:
+  // The name of the archive in an asset directory.
+  static constexpr char kFileName[] = "assets.pack";
+
+  // Returns the bundle for the archive in |directory|, or nullptr if there is
+  // no valid archive there.
+  static std::unique_ptr<PackedAssetBundle> Open(
+      const fml::UniqueFD& directory);
+
+  explicit PackedAssetBundle(std::shared_ptr<const fml::Mapping> archive);
+
+  ~PackedAssetBundle() override;
+
+ private:
+  const std::shared_ptr<const fml::Mapping> archive_;
+  const packed_assets::Entry* entries_ = nullptr;
+  size_t entry_count_ = 0;
+  const char* names_ = nullptr;
+  bool is_valid_ = false;
+
+  bool ValidateArchive();
+
+  std::string_view GetEntryName(const packed_assets::Entry& entry) const;
+
+  // |AssetResolver|
+  bool IsValid() const override;
+
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetAsMapping(
+      const std::string& asset_name) const override;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedAssetBundle);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
@@ -0,0 +1,131 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/packed_asset_bundle.h"
+
+#include <cstddef>
+#include <string>
+
+#include "flutter/assets/packed_asset_bundle_writer.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+std::unique_ptr<fml::Mapping> MappingFromString(const std::string& string) {
+  return std::make_unique<fml::DataMapping>(string);
+}
+
+std::string StringFromMapping(const fml::Mapping& mapping) {
+  return std::string(reinterpret_cast<const char*>(mapping.GetMapping()),
+                     mapping.GetSize());
+}
+
+std::shared_ptr<const fml::Mapping> BuildArchive(
+    const PackedAssetBundleWriter& writer) {
+  return writer.Build();
+}
+
+}  // namespace
+
+TEST(PackedAssetBundleTest, ResolvesAssets) {
+  PackedAssetBundleWriter writer;
+  ASSERT_TRUE(writer.AddAsset("b.txt", MappingFromString("bravo"), false));
+  ASSERT_TRUE(writer.AddAsset("a/c.txt", MappingFromString("charlie"), false));
+  ASSERT_TRUE(writer.AddAsset("empty", MappingFromString(""), false));
+  ASSERT_FALSE(writer.AddAsset("b.txt", MappingFromString("other"), false));
+
+  PackedAssetBundle bundle(BuildArchive(writer));
+  AssetResolver& resolver = bundle;
+  ASSERT_TRUE(resolver.IsValid());
+
+  auto bravo = resolver.GetAsMapping("b.txt");
+  ASSERT_TRUE(bravo);
+  ASSERT_EQ(StringFromMapping(*bravo), "bravo");
+  auto charlie = resolver.GetAsMapping("a/c.txt");
+  ASSERT_TRUE(charlie);
+  ASSERT_EQ(StringFromMapping(*charlie), "charlie");
+  auto empty = resolver.GetAsMapping("empty");
+  ASSERT_TRUE(empty);
+  ASSERT_EQ(empty->GetSize(), 0u);
+
+  ASSERT_FALSE(resolver.GetAsMapping("a"));
+  ASSERT_FALSE(resolver.GetAsMapping("c.txt"));
+  ASSERT_FALSE(resolver.GetAsMapping("z"));
+}
+
+TEST(PackedAssetBundleTest, ReturnsSlicesOfTheArchive) {
+  PackedAssetBundleWriter writer;
+  const std::string large(3 * packed_assets::kPageSize, 'l');
+  ASSERT_TRUE(writer.AddAsset("large", MappingFromString(large), false));
+  ASSERT_TRUE(writer.AddAsset("small", MappingFromString("s"), false));
+
+  auto archive = BuildArchive(writer);
+  std::unique_ptr<fml::Mapping> mapping;
+  {
+    PackedAssetBundle bundle(archive);
+    AssetResolver& resolver = bundle;
+    mapping = resolver.GetAsMapping("large");
+  }
+  ASSERT_TRUE(mapping);
+  const size_t offset = mapping->GetMapping() - archive->GetMapping();
+  ASSERT_LT(offset, archive->GetSize());
+  ASSERT_EQ(offset % packed_assets::kPageSize, 0u);
+  // The slice outlives the bundle it came from.
+  ASSERT_EQ(StringFromMapping(*mapping), large);
+}
+
+TEST(PackedAssetBundleTest, DecompressesAssets) {
+  PackedAssetBundleWriter writer;
+  std::string text;
+  for (size_t i = 0; i < 1000; i++) {
+    text += "{\"key\": \"value\"},";
+  }
+  ASSERT_TRUE(writer.AddAsset("data.json", MappingFromString(text), true));
+  auto archive = BuildArchive(writer);
+  ASSERT_LT(archive->GetSize(), text.size() / 4);
+
+  PackedAssetBundle bundle(archive);
+  AssetResolver& resolver = bundle;
+  auto mapping = resolver.GetAsMapping("data.json");
+  ASSERT_TRUE(mapping);
+  ASSERT_EQ(StringFromMapping(*mapping), text);
+}
+
+TEST(PackedAssetBundleTest, RejectsMalformedArchives) {
+  {
+    PackedAssetBundle bundle(nullptr);
+    ASSERT_FALSE(static_cast<AssetResolver&>(bundle).IsValid());
+  }
+  {
+    PackedAssetBundle bundle(MappingFromString("not an archive"));
+    ASSERT_FALSE(static_cast<AssetResolver&>(bundle).IsValid());
+  }
+
+  PackedAssetBundleWriter writer;
+  ASSERT_TRUE(writer.AddAsset("asset", MappingFromString("contents"), false));
+  auto archive = BuildArchive(writer);
+  std::vector<uint8_t> bytes(archive->GetMapping(),
+                             archive->GetMapping() + archive->GetSize());
+  {
+    // Truncated payload.
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+    PackedAssetBundle bundle(
+        std::make_shared<fml::DataMapping>(std::move(truncated)));
+    ASSERT_FALSE(static_cast<AssetResolver&>(bundle).IsValid());
+  }
+  {
+    // Unknown version.
+    auto corrupt = bytes;
+    corrupt[offsetof(packed_assets::Header, version)]++;
+    PackedAssetBundle bundle(
+        std::make_shared<fml::DataMapping>(std::move(corrupt)));
+    ASSERT_FALSE(static_cast<AssetResolver&>(bundle).IsValid());
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,106 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/packed_asset_bundle_writer.h"
+
+#include <cstring>
+#include <utility>
+
+#include "flutter/fml/compression.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+namespace {
+
+size_t AlignTo(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+PackedAssetBundleWriter::PackedAssetBundleWriter() = default;
+
+PackedAssetBundleWriter::~PackedAssetBundleWriter() = default;
+
+bool PackedAssetBundleWriter::AddAsset(const std::string& name,
+                                       std::unique_ptr<fml::Mapping> contents,
+                                       bool compress) {
+  FML_DCHECK(contents);
+  if (assets_.count(name) != 0) {
+    return false;
+  }
+  Asset asset;
+  asset.compression = packed_assets::Compression::kNone;
+  if (compress && contents->GetSize() > 0) {
+    auto compressed =
+        fml::CompressLZ4(contents->GetMapping(), contents->GetSize());
+    // Only keep the compressed payload if it saves at least an eighth of the
+    // asset, as already compressed formats like PNG never do.
+    if (compressed.size() <= contents->GetSize() - contents->GetSize() / 8) {
+      asset.compression = packed_assets::Compression::kLZ4;
+      asset.compressed = std::move(compressed);
+    }
+  }
+  asset.contents = std::move(contents);
+  assets_.emplace(name, std::move(asset));
+  return true;
+}
+
+std::unique_ptr<fml::Mapping> PackedAssetBundleWriter::Build() const {
+  packed_assets::Header header = {};
+  std::memcpy(header.magic, packed_assets::kMagic, sizeof(header.magic));
+  header.version = packed_assets::kVersion;
+  header.entry_count = assets_.size();
+  header.names_offset =
+      sizeof(header) + assets_.size() * sizeof(packed_assets::Entry);
+
+  // Lay out the names, then the payloads.
+  std::vector<packed_assets::Entry> entries;
+  entries.reserve(assets_.size());
+  for (const auto& [name, asset] : assets_) {
+    packed_assets::Entry entry = {};
+    entry.name_offset = header.names_size;
+    entry.name_size = name.size();
+    entry.compression = asset.compression;
+    entry.size = asset.contents->GetSize();
+    entry.payload_size = asset.compression == packed_assets::Compression::kNone
+                             ? entry.size
+                             : asset.compressed.size();
+    header.names_size += name.size();
+    entries.push_back(entry);
+  }
+  size_t offset = header.names_offset + header.names_size;
+  for (auto& entry : entries) {
+    const bool page_aligned =
+        entry.compression == packed_assets::Compression::kNone &&
+        entry.size >= packed_assets::kPageSize;
+    offset = AlignTo(offset, page_aligned ? packed_assets::kPageSize
+                                          : packed_assets::kPayloadAlignment);
+    entry.payload_offset = offset;
+    offset += entry.payload_size;
+  }
+
+  std::vector<uint8_t> archive(offset, 0);
+  std::memcpy(archive.data(), &header, sizeof(header));
+  std::memcpy(archive.data() + sizeof(header), entries.data(),
+              entries.size() * sizeof(packed_assets::Entry));
+  auto entry = entries.begin();
+  for (const auto& [name, asset] : assets_) {
+    std::memcpy(archive.data() + header.names_offset + entry->name_offset,
+                name.data(), name.size());
+    const uint8_t* payload =
+        asset.compression == packed_assets::Compression::kNone
+            ? asset.contents->GetMapping()
+            : asset.compressed.data();
+    if (entry->payload_size > 0) {
+      std::memcpy(archive.data() + entry->payload_offset, payload,
+                  entry->payload_size);
+    }
+    ++entry;
+  }
+  return std::make_unique<fml::DataMapping>(std::move(archive));
+}
+
+}  // namespace flutter
@@ -0,0 +1,53 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_WRITER_H_
+#define FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_WRITER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/assets/packed_asset_format.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+
+namespace flutter {
+
+// Builds the packed archives read by |PackedAssetBundle|.
+class PackedAssetBundleWriter {
+ public:
+  PackedAssetBundleWriter();
+
+  ~PackedAssetBundleWriter();
+
+  // Adds the asset named |name| to the archive. If |compress| is true, the
+  // asset is stored compressed unless that does not save enough space to be
+  // worth decompressing it on every lookup. Returns false if an asset with
+  // the same name was already added.
+  bool AddAsset(const std::string& name,
+                std::unique_ptr<fml::Mapping> contents,
+                bool compress);
+
+  size_t GetAssetCount() const { return assets_.size(); }
+
+  // Returns the archive containing every asset added so far.
+  std::unique_ptr<fml::Mapping> Build() const;
+
+ private:
+  struct Asset {
+    packed_assets::Compression compression;
+    std::unique_ptr<fml::Mapping> contents;
+    std::vector<uint8_t> compressed;
+  };
+
+  std::map<std::string, Asset> assets_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedAssetBundleWriter);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_WRITER_H_
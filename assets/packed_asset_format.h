@@ -0,0 +1,66 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_PACKED_ASSET_FORMAT_H_
+#define FLUTTER_ASSETS_PACKED_ASSET_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter {
+namespace packed_assets {
+
+// A packed asset archive stores every asset of a bundle in a single file that
+// is memory mapped once. It is laid out as follows, with all integers in
+// little endian byte order:
+//
+//   Header
+//   Entry[header.entry_count], sorted by name
+//   The names of the entries, not terminated
+//   The payloads of the entries
+//
+// Uncompressed payloads of at least |kPageSize| bytes start on a page
+// boundary. Other payloads are aligned to |kPayloadAlignment| so that small
+// assets do not waste most of a page each.
+
+constexpr uint8_t kMagic[8] = {'F', 'L', 'T', 'P', 'A', 'C', 'K', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kPageSize = 4096;
+constexpr size_t kPayloadAlignment = 16;
+
+enum class Compression : uint32_t {
+  kNone = 0,
+  // See |fml::CompressLZ4|.
+  kLZ4 = 1,
+};
+
+struct Header {
+  uint8_t magic[8];
+  uint32_t version;
+  uint32_t entry_count;
+  // The offset and size of the names of the entries, in bytes.
+  uint64_t names_offset;
+  uint64_t names_size;
+};
+
+struct Entry {
+  // The offset of the name of the entry in the names of the archive.
+  uint64_t name_offset;
+  uint32_t name_size;
+  Compression compression;
+  // The offset of the payload from the start of the archive.
+  uint64_t payload_offset;
+  // The size of the payload as stored in the archive.
+  uint64_t payload_size;
+  // The size of the asset once decompressed.
+  uint64_t size;
+};
+
+static_assert(sizeof(Header) == 32, "The header must not have padding.");
+static_assert(sizeof(Entry) == 40, "Entries must not have padding.");
+
+}  // namespace packed_assets
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_PACKED_ASSET_FORMAT_H_
@@ -25,6 +25,8 @@ std::string Settings::ToString() const {
          << std::endl;
   stream << "isolate_snapshot_instr_path: " << isolate_snapshot_instr_path
          << std::endl;
+  stream << "populate_snapshots: " << populate_snapshots << std::endl;
+  stream << "prefetch_snapshots: " << prefetch_snapshots << std::endl;
   stream << "application_library_path:" << std::endl;
   for (const auto& path : application_library_path) {
     stream << "    " << path << std::endl;
@@ -38,6 +40,7 @@ std::string Settings::ToString() const {
   stream << "trace_skia: " << trace_skia << std::endl;
   stream << "trace_startup: " << trace_startup << std::endl;
   stream << "trace_systrace: " << trace_systrace << std::endl;
+  stream << "trace_recorder: " << trace_recorder << std::endl;
   stream << "dump_skp_on_shader_compilation: " << dump_skp_on_shader_compilation
          << std::endl;
   stream << "cache_sksl: " << cache_sksl << std::endl;
@@ -69,6 +69,15 @@ struct Settings {
   std::string isolate_snapshot_instr_path;  // deprecated
   MappingCallback isolate_snapshot_instr;
 
+  // Reduces the page faults taken while the snapshots are first accessed.
+  // Snapshots mapped from the paths above are read in full when they are
+  // mapped if |populate_snapshots| is set. If |prefetch_snapshots| is set, the
+  // kernel is asked to read them ahead, and the snapshots of known size are
+  // also read on the concurrent workers of the VM once it starts. Both request
+  // huge pages for the mappings.
+  bool populate_snapshots = false;
+  bool prefetch_snapshots = false;
+
   // Returns the Mapping to a kernel buffer which contains sources for dart:*
   // libraries.
   MappingCallback dart_library_sources_kernel;
@@ -93,6 +102,8 @@ struct Settings {
   bool trace_skia = false;
   bool trace_startup = false;
   bool trace_systrace = false;
+  // Record trace events with the |fml::tracing::TraceRecorder|.
+  bool trace_recorder = false;
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
   bool endless_trace_buffer = false;
@@ -167,6 +178,28 @@ struct Settings {
   UnhandledExceptionCallback unhandled_exception_callback;
   bool enable_software_rendering = false;
   bool skia_deterministic_rendering_on_cpu = false;
+  // Rasterize pictures into the raster cache on the concurrent workers of the
+  // VM instead of the raster thread.
+  bool enable_async_raster_cache_population = false;
+  // Split the frames rendered into CPU backed surfaces into tiles and
+  // rasterize them on the concurrent workers of the VM as well as the raster
+  // thread.
+  bool enable_tiled_software_rasterization = false;
+  // Preroll the children of wide containers in layer trees on the concurrent
+  // workers of the VM as well as the raster thread.
+  bool enable_parallel_preroll = false;
+  // Let the layer tree pipeline get deeper when frames take too long to build
+  // and rasterize one after the other, and shallower again when they do not
+  // or while the user is interacting with the app.
+  bool enable_adaptive_pipeline_depth = false;
+  // Flush the canvas of each frame before submitting it, so that the frame
+  // statistics tell the time spent issuing its draws apart from the time
+  // spent presenting it. This costs a flush per frame. Otherwise, both are
+  // recorded as the present phase.
+  bool profile_frame_flushes = false;
+  // The bytes of frames that animated images may decode ahead of the frames
+  // requested so far, shared by all of them. Zero disables decoding ahead.
+  size_t animated_image_decode_ahead_bytes = 0;
   bool verbose_logging = false;
   std::string log_tag = "flutter";
 
@@ -187,6 +220,11 @@ struct Settings {
   // soon as a frame is rasterized.
   FrameRasterizedCallback frame_rasterized_callback;
 
+  // Called when a frame that began ends without anything to present, because
+  // no scene was rendered for it or its layer tree could not be drawn. This
+  // is called on the UI or the GPU thread, whichever dropped the frame.
+  fml::closure frame_dropped_callback;
+
   // This data will be available to the isolate immediately on launch via the
   // Window.getPersistentIsolateData callback. This is meant for information
   // that the isolate cannot request asynchronously (platform messages can be
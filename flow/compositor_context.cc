@@ -5,6 +5,7 @@
 #include "flutter/flow/compositor_context.h"
 
 #include "flutter/flow/layers/layer_tree.h"
+#include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 
 namespace flutter {
@@ -70,7 +71,9 @@ CompositorContext::ScopedFrame::~ScopedFrame() {
 RasterStatus CompositorContext::ScopedFrame::Raster(
     flutter::LayerTree& layer_tree,
     bool ignore_raster_cache) {
+  const fml::TimePoint preroll_start = fml::TimePoint::Now();
   bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
+  preroll_time_ = fml::TimePoint::Now() - preroll_start;
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
   PostPrerollResult post_preroll_result = PostPrerollResult::kSuccess;
   if (view_embedder_ && gpu_thread_merger_) {
@@ -80,12 +83,28 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kResubmitFrame) {
     return RasterStatus::kResubmit;
   }
+
+  damage_ = context_.ComputeDamage(layer_tree, root_surface_transformation_,
+                                   ignore_raster_cache,
+                                   partial_repaint_enabled_);
+  // Even if the damage is empty, the layers are still painted (with every draw
+  // rejected by the clip) so that the raster cache sees its entries in use.
+  const bool clip_to_damage =
+      partial_repaint_enabled_ &&
+      !damage_.contains(SkIRect::MakeSize(layer_tree.frame_size()));
+
+  const fml::TimePoint paint_start = fml::TimePoint::Now();
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
   if (canvas()) {
+    if (clip_to_damage) {
+      // Everything outside of the damage still holds the last frame.
+      canvas()->save();
+      canvas()->clipRegion(damage_);
+    }
     if (needs_save_layer) {
       FML_LOG(INFO) << "Using SaveLayer to protect non-readback surface";
-      SkRect bounds = SkRect::Make(layer_tree.frame_size());
+      SkRect bounds = SkRect::Make(damage_.getBounds());
       SkPaint paint;
       paint.setBlendMode(SkBlendMode::kSrc);
       canvas()->saveLayer(&bounds, &paint);
@@ -93,12 +112,53 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
     canvas()->clear(SK_ColorTRANSPARENT);
   }
   layer_tree.Paint(*this, ignore_raster_cache);
-  if (canvas() && needs_save_layer) {
-    canvas()->restore();
+  if (canvas()) {
+    if (needs_save_layer) {
+      canvas()->restore();
+    }
+    if (clip_to_damage) {
+      canvas()->restore();
+    }
   }
+  paint_time_ = fml::TimePoint::Now() - paint_start;
   return RasterStatus::kSuccess;
 }
 
+SkRegion CompositorContext::ComputeDamage(
+    const LayerTree& layer_tree,
+    const SkMatrix& root_surface_transformation,
+    bool ignore_raster_cache,
+    bool partial_repaint_enabled) {
+  const SkIRect frame_rect = SkIRect::MakeSize(layer_tree.frame_size());
+  const SkRegion full_damage(frame_rect);
+  if (!partial_repaint_enabled) {
+    last_paint_regions_.reset();
+    return full_damage;
+  }
+
+  TRACE_EVENT0("flutter", "CompositorContext::ComputeDamage");
+  DiffContext diff_context(root_surface_transformation, frame_rect,
+                           ignore_raster_cache ? nullptr : &raster_cache_);
+  layer_tree.Diff(&diff_context);
+
+  std::optional<PaintRegions> previous_paint_regions =
+      std::move(last_paint_regions_);
+  const bool same_frame_size =
+      last_paint_regions_frame_size_ == layer_tree.frame_size();
+  last_paint_regions_ = diff_context.TakePaintRegions();
+  last_paint_regions_frame_size_ = layer_tree.frame_size();
+
+  if (!previous_paint_regions || !same_frame_size ||
+      diff_context.has_full_damage()) {
+    return full_damage;
+  }
+
+  SkRegion damage = DiffContext::ComputeDamage(*previous_paint_regions,
+                                               *last_paint_regions_);
+  damage.op(frame_rect, SkRegion::kIntersect_Op);
+  return damage;
+}
+
 void CompositorContext::OnGrContextCreated() {
   texture_registry_.OnGrContextCreated();
   raster_cache_.Clear();
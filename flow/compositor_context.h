@@ -6,16 +6,20 @@
 #define FLUTTER_FLOW_COMPOSITOR_CONTEXT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
 #include "flutter/flow/texture.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/gpu_thread_merger.h"
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRegion.h"
 
 namespace flutter {
 
@@ -67,6 +71,22 @@ class CompositorContext {
     virtual RasterStatus Raster(LayerTree& layer_tree,
                                 bool ignore_raster_cache);
 
+    // Allows |Raster| to only repaint the parts of the frame that differ from
+    // the last frame rastered by the context. Only valid if the canvas still
+    // holds the pixels of that frame.
+    void set_partial_repaint_enabled(bool enabled) {
+      partial_repaint_enabled_ = enabled;
+    }
+
+    // The region of the canvas (in physical pixels) painted by the last call
+    // to |Raster|.
+    const SkRegion& damage() const { return damage_; }
+
+    // The time the last call to |Raster| spent prerolling and painting the
+    // layer tree.
+    fml::TimeDelta preroll_time() const { return preroll_time_; }
+    fml::TimeDelta paint_time() const { return paint_time_; }
+
    private:
     CompositorContext& context_;
     GrContext* gr_context_;
@@ -76,6 +96,10 @@ class CompositorContext {
     const bool instrumentation_enabled_;
     const bool surface_supports_readback_;
     fml::RefPtr<fml::GpuThreadMerger> gpu_thread_merger_;
+    bool partial_repaint_enabled_ = false;
+    SkRegion damage_;
+    fml::TimeDelta preroll_time_;
+    fml::TimeDelta paint_time_;
 
     FML_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
   };
@@ -107,17 +131,48 @@ class CompositorContext {
 
   Stopwatch& ui_time() { return ui_time_; }
 
+  // Prerolls the children of wide containers on the raster thread and up to
+  // |helper_count| tasks posted to |task_runner| (see
+  // |LayerDisplayList::SetPrerollTaskRunner|). Passing null goes back to
+  // prerolling serially.
+  void SetPrerollTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+      size_t helper_count) {
+    preroll_task_runner_ = std::move(task_runner);
+    preroll_helper_count_ = helper_count;
+  }
+
+  const std::shared_ptr<fml::ConcurrentTaskRunner>& preroll_task_runner()
+      const {
+    return preroll_task_runner_;
+  }
+
+  size_t preroll_helper_count() const { return preroll_helper_count_; }
+
  private:
   RasterCache raster_cache_;
   TextureRegistry texture_registry_;
   Counter frame_count_;
   Stopwatch raster_time_;
   Stopwatch ui_time_;
+  // The regions painted by the last frame rastered with partial repaint
+  // enabled, if the frame right after it may be rastered incrementally.
+  std::optional<PaintRegions> last_paint_regions_;
+  SkISize last_paint_regions_frame_size_ = SkISize::MakeEmpty();
+  std::shared_ptr<fml::ConcurrentTaskRunner> preroll_task_runner_;
+  size_t preroll_helper_count_ = 0;
 
   void BeginFrame(ScopedFrame& frame, bool enable_instrumentation);
 
   void EndFrame(ScopedFrame& frame, bool enable_instrumentation);
 
+  // Returns the region of the frame that must be painted given the frame
+  // rastered before it.
+  SkRegion ComputeDamage(const LayerTree& layer_tree,
+                         const SkMatrix& root_surface_transformation,
+                         bool ignore_raster_cache,
+                         bool partial_repaint_enabled);
+
   FML_DISALLOW_COPY_AND_ASSIGN(CompositorContext);
 };
 
@@ -0,0 +1,205 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+DiffContext::DiffContext(const SkMatrix& root_matrix,
+                         const SkIRect& frame_rect,
+                         const RasterCache* raster_cache)
+    : matrix_(root_matrix),
+      clip_(frame_rect),
+      state_hash_(fml::HashCombine()),
+      raster_cache_(raster_cache) {}
+
+DiffContext::~DiffContext() = default;
+
+DiffContext::AutoSubtreeRestore::AutoSubtreeRestore(DiffContext* context)
+    : context_(context),
+      matrix_(context->matrix_),
+      clip_(context->clip_),
+      state_hash_(context->state_hash_) {}
+
+DiffContext::AutoSubtreeRestore::~AutoSubtreeRestore() {
+  context_->matrix_ = matrix_;
+  context_->clip_ = clip_;
+  context_->state_hash_ = state_hash_;
+}
+
+void DiffContext::Concat(const SkMatrix& matrix) {
+  matrix_.preConcat(matrix);
+}
+
+void DiffContext::Translate(SkScalar dx, SkScalar dy) {
+  matrix_.preTranslate(dx, dy);
+}
+
+void DiffContext::SetMatrix(const SkMatrix& matrix) {
+  matrix_ = matrix;
+}
+
+void DiffContext::ClipRect(const SkRect& local_bounds) {
+  clip_ = DeviceBounds(local_bounds);
+}
+
+void DiffContext::ClearClip() {
+  // Large enough for any frame and still representable after rounding out.
+  constexpr int32_t kUnbounded = 1 << 29;
+  clip_ = SkIRect::MakeLTRB(-kUnbounded, -kUnbounded, kUnbounded, kUnbounded);
+}
+
+void DiffContext::FoldState(uint64_t hash) {
+  state_hash_ = fml::HashCombine(state_hash_, HashMatrix(matrix_), hash);
+}
+
+void DiffContext::AddPaintRegion(const SkRect& local_bounds,
+                                 uint64_t content_hash) {
+  SkIRect bounds = DeviceBounds(local_bounds);
+  if (bounds.isEmpty()) {
+    return;
+  }
+  uint64_t hash =
+      fml::HashCombine(state_hash_, HashMatrix(matrix_), content_hash);
+  regions_.push_back({bounds, hash, false});
+}
+
+void DiffContext::AddVolatilePaintRegion(const SkRect& local_bounds) {
+  SkIRect bounds = DeviceBounds(local_bounds);
+  if (bounds.isEmpty()) {
+    return;
+  }
+  regions_.push_back({bounds, 0, true});
+}
+
+void DiffContext::CollapsePaintRegions(size_t mark,
+                                       const SkRect& local_bounds,
+                                       uint64_t content_hash) {
+  FML_DCHECK(mark <= regions_.size());
+  uint64_t hash = content_hash;
+  bool is_volatile = false;
+  for (size_t i = mark; i < regions_.size(); i++) {
+    const PaintRegion& region = regions_[i];
+    hash = fml::HashCombine(hash, region.hash, region.bounds.fLeft,
+                            region.bounds.fTop, region.bounds.fRight,
+                            region.bounds.fBottom);
+    is_volatile = is_volatile || region.is_volatile;
+  }
+  regions_.resize(mark);
+  if (is_volatile) {
+    AddVolatilePaintRegion(local_bounds);
+  } else {
+    AddPaintRegion(local_bounds, hash);
+  }
+}
+
+PaintRegions DiffContext::TakePaintRegions() {
+  return std::move(regions_);
+}
+
+SkIRect DiffContext::DeviceBounds(const SkRect& local_bounds) const {
+  if (matrix_.hasPerspective()) {
+    // Mapping points behind the viewer does not produce conservative bounds.
+    return clip_;
+  }
+  SkRect device_bounds;
+  matrix_.mapRect(&device_bounds, local_bounds);
+  // Anti-aliased edges may touch the pixels just outside of the bounds.
+  device_bounds.outset(1.0f, 1.0f);
+  if (!device_bounds.intersect(SkRect::Make(clip_))) {
+    return SkIRect::MakeEmpty();
+  }
+  return device_bounds.roundOut();
+}
+
+SkRegion DiffContext::ComputeDamage(const PaintRegions& previous,
+                                    const PaintRegions& current) {
+  // The indices of the previous regions with each hash, in paint order.
+  std::unordered_map<uint64_t, std::vector<size_t>> previous_indices;
+  for (size_t i = 0; i < previous.size(); i++) {
+    if (!previous[i].is_volatile) {
+      previous_indices[previous[i].hash].push_back(i);
+    }
+  }
+
+  SkRegion damage;
+  std::vector<bool> matched(previous.size(), false);
+  // Matched regions must be painted in the same relative order in both frames
+  // or overlapping regions could swap without being damaged.
+  size_t next_index = 0;
+  for (const PaintRegion& region : current) {
+    bool found = false;
+    auto indices = region.is_volatile ? previous_indices.end()
+                                      : previous_indices.find(region.hash);
+    if (indices != previous_indices.end()) {
+      auto candidate = std::lower_bound(indices->second.begin(),
+                                        indices->second.end(), next_index);
+      for (; candidate != indices->second.end(); ++candidate) {
+        if (previous[*candidate].bounds == region.bounds) {
+          matched[*candidate] = true;
+          next_index = *candidate + 1;
+          found = true;
+          break;
+        }
+      }
+    }
+    if (!found) {
+      damage.op(region.bounds, SkRegion::kUnion_Op);
+    }
+  }
+
+  for (size_t i = 0; i < previous.size(); i++) {
+    if (!matched[i]) {
+      damage.op(previous[i].bounds, SkRegion::kUnion_Op);
+    }
+  }
+
+  return damage;
+}
+
+uint64_t DiffContext::HashBytes(const void* data, size_t length) {
+  // 64-bit FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+uint64_t DiffContext::HashMatrix(const SkMatrix& matrix) {
+  SkScalar values[9];
+  matrix.get9(values);
+  return HashBytes(values, sizeof(values));
+}
+
+uint64_t DiffContext::HashPath(const SkPath& path) {
+  std::vector<uint8_t> buffer(path.writeToMemory(nullptr));
+  path.writeToMemory(buffer.data());
+  return HashBytes(buffer.data(), buffer.size());
+}
+
+uint64_t DiffContext::HashFlattenable(const SkFlattenable* flattenable) {
+  if (flattenable == nullptr) {
+    return 0;
+  }
+  sk_sp<SkData> data = flattenable->serialize();
+  if (data == nullptr) {
+    // Make sure that the region never matches one of another frame.
+    static std::atomic<uint64_t> unserializable_count;
+    return fml::HashCombine(flattenable, ++unserializable_count);
+  }
+  return HashBytes(data->data(), data->size());
+}
+
+}  // namespace flutter
@@ -0,0 +1,151 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DIFF_CONTEXT_H_
+#define FLUTTER_FLOW_DIFF_CONTEXT_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkFlattenable.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkRegion.h"
+
+namespace flutter {
+
+class RasterCache;
+
+// A device-space rectangle painted by one leaf layer (or by one layer that
+// composites its whole subtree as a unit), along with a hash of everything
+// that determines its pixels.
+struct PaintRegion {
+  SkIRect bounds;
+  uint64_t hash;
+  // Volatile regions may change without their layer changing (textures, the
+  // performance overlay, ...) and never match a region of another frame.
+  bool is_volatile;
+};
+
+using PaintRegions = std::vector<PaintRegion>;
+
+// Collects the |PaintRegion|s of a prerolled layer tree via |Layer::Diff| so
+// that they can be compared with those of the previous frame.
+//
+// Layers are rebuilt by the framework on every frame, so the comparison does
+// not rely on layer identity. Instead, each region is keyed on the content it
+// paints (e.g. the picture's unique ID), the total matrix, and the clips and
+// per-pixel effects of all of its ancestors. Two frames paint the same pixels
+// wherever their regions match, in the same order, with the same keys and
+// bounds.
+class DiffContext {
+ public:
+  DiffContext(const SkMatrix& root_matrix,
+              const SkIRect& frame_rect,
+              const RasterCache* raster_cache);
+
+  ~DiffContext();
+
+  // Saves the matrix, clip and ancestor state of the context and restores
+  // them upon destruction. Layers that modify any of these for their children
+  // must create one of these first.
+  class AutoSubtreeRestore {
+   public:
+    explicit AutoSubtreeRestore(DiffContext* context);
+    ~AutoSubtreeRestore();
+
+   private:
+    DiffContext* context_;
+    const SkMatrix matrix_;
+    const SkIRect clip_;
+    const uint64_t state_hash_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoSubtreeRestore);
+  };
+
+  const SkMatrix& matrix() const { return matrix_; }
+
+  // May be null if the raster cache is not used for this frame.
+  const RasterCache* raster_cache() const { return raster_cache_; }
+
+  void Concat(const SkMatrix& matrix);
+
+  void Translate(SkScalar dx, SkScalar dy);
+
+  // For layers that snap the matrix to integral translations when painting.
+  void SetMatrix(const SkMatrix& matrix);
+
+  // Intersects the clip with the device bounds of |local_bounds|. The shape
+  // and anti-aliasing of the clip must be folded into the state separately.
+  void ClipRect(const SkRect& local_bounds);
+
+  // Removes the clip. Used by layers whose output depends on content outside
+  // of the clip, such as image filters that blur their children.
+  void ClearClip();
+
+  // Folds |hash| into the state inherited by all regions added until the
+  // enclosing |AutoSubtreeRestore| goes away. Used by ancestors that affect
+  // each pixel of their subtree independently (clips, opacity, ...). The
+  // current matrix is folded in along with |hash|.
+  void FoldState(uint64_t hash);
+
+  // Adds a region that paints |local_bounds| with content identified by
+  // |content_hash|.
+  void AddPaintRegion(const SkRect& local_bounds, uint64_t content_hash);
+
+  void AddVolatilePaintRegion(const SkRect& local_bounds);
+
+  // The layer affects pixels outside of its own paint bounds (e.g. backdrop
+  // filters, platform views), so the whole frame must be repainted.
+  void MarkFullDamage() { has_full_damage_ = true; }
+
+  bool has_full_damage() const { return has_full_damage_; }
+
+  // For layers whose output at any pixel may depend on the rest of their
+  // subtree (e.g. image filters). Take a mark before diffing the children
+  // and then collapse all the regions they added into a single region that
+  // covers |local_bounds|.
+  size_t paint_region_mark() const { return regions_.size(); }
+  void CollapsePaintRegions(size_t mark,
+                            const SkRect& local_bounds,
+                            uint64_t content_hash);
+
+  const PaintRegions& paint_regions() const { return regions_; }
+
+  PaintRegions TakePaintRegions();
+
+  // Returns the device-space region in which the frames that produced
+  // |previous| and |current| may differ.
+  static SkRegion ComputeDamage(const PaintRegions& previous,
+                                const PaintRegions& current);
+
+  static uint64_t HashBytes(const void* data, size_t length);
+
+  static uint64_t HashMatrix(const SkMatrix& matrix);
+
+  static uint64_t HashPath(const SkPath& path);
+
+  // Hashes the serialized form of |flattenable|, since filters and shaders
+  // are recreated by the framework on every frame.
+  static uint64_t HashFlattenable(const SkFlattenable* flattenable);
+
+ private:
+  SkMatrix matrix_;
+  SkIRect clip_;
+  uint64_t state_hash_;
+  const RasterCache* raster_cache_;
+  bool has_full_damage_ = false;
+  PaintRegions regions_;
+
+  SkIRect DeviceBounds(const SkRect& local_bounds) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DiffContext);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DIFF_CONTEXT_H_
@@ -0,0 +1,159 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/flow/diff_context.h"
+
+#include "flutter/flow/layers/backdrop_filter_layer.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/testing/mock_layer.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
+#include "third_party/skia/include/core/SkPicture.h"
+
+namespace flutter {
+namespace testing {
+
+static const SkIRect kFrameRect = SkIRect::MakeWH(100, 100);
+
+class DiffContextTest : public SkiaGPUObjectLayerTest {
+ public:
+  std::shared_ptr<PictureLayer> MakePictureLayer(sk_sp<SkPicture> picture) {
+    return std::make_shared<PictureLayer>(
+        SkPoint::Make(0.0f, 0.0f), SkiaGPUObject(picture, unref_queue()),
+        false, false);
+  }
+
+  // Prerolls |root| and collects the regions it paints into |context|.
+  void Diff(const std::shared_ptr<Layer>& root, DiffContext* context) {
+    root->Preroll(preroll_context(), SkMatrix());
+    root->Diff(context);
+  }
+
+  PaintRegions Diff(const std::shared_ptr<Layer>& root) {
+    DiffContext context(SkMatrix(), kFrameRect, nullptr);
+    Diff(root, &context);
+    return context.TakePaintRegions();
+  }
+
+  SkRegion ComputeDamage(const std::shared_ptr<Layer>& previous_root,
+                         const std::shared_ptr<Layer>& current_root) {
+    return DiffContext::ComputeDamage(Diff(previous_root), Diff(current_root));
+  }
+};
+
+TEST_F(DiffContextTest, UnchangedTreeHasNoDamage) {
+  auto picture1 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto picture2 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(50, 50, 70, 70));
+  // The framework rebuilds the layers on every frame, but retains pictures
+  // that did not change.
+  auto make_tree = [&]() {
+    auto root = std::make_shared<TransformLayer>(SkMatrix::MakeScale(0.5f));
+    root->Add(MakePictureLayer(picture1));
+    root->Add(MakePictureLayer(picture2));
+    return root;
+  };
+
+  EXPECT_TRUE(ComputeDamage(make_tree(), make_tree()).isEmpty());
+}
+
+TEST_F(DiffContextTest, ChangedPictureOnlyDamagesItsBounds) {
+  auto picture1 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto picture2 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(50, 50, 70, 70));
+  auto picture3 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(50, 50, 70, 70));
+  auto previous_root = std::make_shared<ContainerLayer>();
+  previous_root->Add(MakePictureLayer(picture1));
+  previous_root->Add(MakePictureLayer(picture2));
+  auto current_root = std::make_shared<ContainerLayer>();
+  current_root->Add(MakePictureLayer(picture1));
+  current_root->Add(MakePictureLayer(picture3));
+
+  // The bounds are outset by a pixel for anti-aliasing.
+  EXPECT_EQ(ComputeDamage(previous_root, current_root),
+            SkRegion(SkIRect::MakeLTRB(49, 49, 71, 71)));
+}
+
+TEST_F(DiffContextTest, MovedLayerDamagesOldAndNewBounds) {
+  auto picture = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto previous_root = std::make_shared<TransformLayer>(SkMatrix());
+  previous_root->Add(MakePictureLayer(picture));
+  auto current_root =
+      std::make_shared<TransformLayer>(SkMatrix::MakeTrans(40, 0));
+  current_root->Add(MakePictureLayer(picture));
+
+  SkRegion expected_damage;
+  expected_damage.op(SkIRect::MakeLTRB(9, 9, 31, 31), SkRegion::kUnion_Op);
+  expected_damage.op(SkIRect::MakeLTRB(49, 9, 71, 31), SkRegion::kUnion_Op);
+  EXPECT_EQ(ComputeDamage(previous_root, current_root), expected_damage);
+}
+
+TEST_F(DiffContextTest, ReorderedLayersAreDamaged) {
+  auto picture1 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto picture2 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(20, 20, 40, 40));
+  auto previous_root = std::make_shared<ContainerLayer>();
+  previous_root->Add(MakePictureLayer(picture1));
+  previous_root->Add(MakePictureLayer(picture2));
+  auto current_root = std::make_shared<ContainerLayer>();
+  current_root->Add(MakePictureLayer(picture2));
+  current_root->Add(MakePictureLayer(picture1));
+
+  SkRegion damage = ComputeDamage(previous_root, current_root);
+  EXPECT_TRUE(damage.contains(SkIRect::MakeLTRB(20, 20, 30, 30)));
+}
+
+TEST_F(DiffContextTest, ClipLimitsDamage) {
+  auto picture1 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto picture2 = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto previous_root = std::make_shared<ClipRectLayer>(
+      SkRect::MakeLTRB(0, 0, 20, 20), Clip::hardEdge);
+  previous_root->Add(MakePictureLayer(picture1));
+  auto current_root = std::make_shared<ClipRectLayer>(
+      SkRect::MakeLTRB(0, 0, 20, 20), Clip::hardEdge);
+  current_root->Add(MakePictureLayer(picture2));
+
+  EXPECT_EQ(ComputeDamage(previous_root, current_root),
+            SkRegion(SkIRect::MakeLTRB(9, 9, 21, 21)));
+}
+
+TEST_F(DiffContextTest, ChangedOpacityDamagesChildren) {
+  auto picture = SkPicture::MakePlaceholder(SkRect::MakeLTRB(10, 10, 30, 30));
+  auto previous_root =
+      std::make_shared<OpacityLayer>(128, SkPoint::Make(0.0f, 0.0f));
+  previous_root->Add(MakePictureLayer(picture));
+  auto current_root =
+      std::make_shared<OpacityLayer>(64, SkPoint::Make(0.0f, 0.0f));
+  current_root->Add(MakePictureLayer(picture));
+
+  EXPECT_EQ(ComputeDamage(previous_root, current_root),
+            SkRegion(SkIRect::MakeLTRB(9, 9, 31, 31)));
+}
+
+TEST_F(DiffContextTest, VolatileLayersAreAlwaysDamaged) {
+  auto make_tree = []() {
+    auto root = std::make_shared<ContainerLayer>();
+    root->Add(std::make_shared<MockLayer>(
+        SkPath().addRect(SkRect::MakeLTRB(10, 10, 30, 30))));
+    return root;
+  };
+
+  EXPECT_EQ(ComputeDamage(make_tree(), make_tree()),
+            SkRegion(SkIRect::MakeLTRB(9, 9, 31, 31)));
+}
+
+TEST_F(DiffContextTest, BackdropFilterCausesFullDamage) {
+  auto root = std::make_shared<BackdropFilterLayer>(nullptr);
+  root->Add(std::make_shared<MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(10, 10, 30, 30))));
+
+  DiffContext context(SkMatrix(), kFrameRect, nullptr);
+  Diff(root, &context);
+  EXPECT_TRUE(context.has_full_damage());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,186 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/frame_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+namespace {
+
+// Values are split into buckets covering [0, 256), [256, 512), [512, 1024) and
+// so on. Each bucket after the first is divided into 128 sub-buckets of equal
+// width, which bounds the relative error of any value to 1/128.
+constexpr size_t kSubBucketCount = 256;
+constexpr size_t kSubBucketHalfCount = kSubBucketCount / 2;
+
+// Any phase taking longer than this is recorded as taking this long.
+constexpr int64_t kHighestTrackableMicros = 60 * 1000 * 1000;
+
+size_t GetBucketIndex(int64_t value) {
+  size_t bucket = 0;
+  while ((static_cast<uint64_t>(value) >> bucket) >= kSubBucketCount) {
+    bucket++;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+Histogram::Histogram(int64_t highest_trackable_value)
+    : highest_trackable_value_(std::max<int64_t>(highest_trackable_value, 1)),
+      counts_(GetCountsIndex(highest_trackable_value_) + 1, 0) {}
+
+Histogram::~Histogram() = default;
+
+size_t Histogram::GetCountsIndex(int64_t value) {
+  const size_t bucket = GetBucketIndex(value);
+  const size_t sub_bucket = static_cast<uint64_t>(value) >> bucket;
+  // The sub-buckets in the lower half of every bucket but the first are
+  // covered by the previous bucket, so they are not stored.
+  return bucket * kSubBucketHalfCount + sub_bucket;
+}
+
+int64_t Histogram::GetHighestEquivalentValue(size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const size_t bucket = index / kSubBucketHalfCount - 1;
+  const size_t sub_bucket = index - bucket * kSubBucketHalfCount;
+  return static_cast<int64_t>(((sub_bucket + 1) << bucket) - 1);
+}
+
+void Histogram::Record(int64_t value) {
+  value = std::clamp<int64_t>(value, 0, highest_trackable_value_);
+  counts_[GetCountsIndex(value)]++;
+  min_ = count_ == 0 ? value : std::min(min_, value);
+  max_ = std::max(max_, value);
+  sum_ += value;
+  count_++;
+}
+
+void Histogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  sum_ = 0;
+}
+
+double Histogram::GetMean() const {
+  return count_ == 0 ? 0 : sum_ / count_;
+}
+
+int64_t Histogram::GetValueAtPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+  const uint64_t target = std::max<uint64_t>(
+      static_cast<uint64_t>(std::ceil(fraction * count_)), 1);
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < counts_.size(); i++) {
+    cumulative += counts_[i];
+    if (cumulative >= target) {
+      return std::clamp(GetHighestEquivalentValue(i), min_, max_);
+    }
+  }
+  return max_;
+}
+
+FrameStatistics::FrameStatistics()
+    : phases_(kPhaseCount, Histogram(kHighestTrackableMicros)) {}
+
+FrameStatistics::~FrameStatistics() = default;
+
+const char* FrameStatistics::GetPhaseName(Phase phase) {
+  switch (phase) {
+    case kBuild:
+      return "build";
+    case kRaster:
+      return "raster";
+    case kPreroll:
+      return "preroll";
+    case kPaint:
+      return "paint";
+    case kFlush:
+      return "flush";
+    case kPresent:
+      return "present";
+    case kPhaseCount:
+      break;
+  }
+  FML_DCHECK(false);
+  return "";
+}
+
+void FrameStatistics::RecordBuiltFrame(fml::TimeDelta build_time,
+                                       fml::TimeDelta frame_interval) {
+  std::scoped_lock lock(mutex_);
+  phases_[kBuild].Record(build_time.ToMicroseconds());
+  built_frames_++;
+  if (build_time > frame_interval) {
+    missed_build_frames_++;
+  }
+  frame_interval_ = frame_interval;
+}
+
+void FrameStatistics::RecordRasterizedFrame(fml::TimeDelta raster_time) {
+  std::scoped_lock lock(mutex_);
+  phases_[kRaster].Record(raster_time.ToMicroseconds());
+  rasterized_frames_++;
+  // Frames rasterized before any was built by the animator, such as the
+  // frames redrawn from the last layer tree, have no deadline.
+  if (frame_interval_ > fml::TimeDelta::Zero() &&
+      raster_time > frame_interval_) {
+    missed_raster_frames_++;
+  }
+}
+
+void FrameStatistics::RecordPhase(Phase phase, fml::TimeDelta time) {
+  FML_DCHECK(phase != kBuild && phase != kRaster && phase < kPhaseCount);
+  std::scoped_lock lock(mutex_);
+  phases_[phase].Record(time.ToMicroseconds());
+}
+
+FrameStatistics::Summary FrameStatistics::GetSummary() const {
+  Summary summary;
+  std::scoped_lock lock(mutex_);
+  summary.built_frames = built_frames_;
+  summary.rasterized_frames = rasterized_frames_;
+  summary.missed_build_frames = missed_build_frames_;
+  summary.missed_raster_frames = missed_raster_frames_;
+  for (size_t i = 0; i < kPhaseCount; i++) {
+    const auto& histogram = phases_[i];
+    auto& phase = summary.phases[i];
+    phase.count = histogram.GetCount();
+    phase.mean = fml::TimeDelta::FromMicroseconds(
+        static_cast<int64_t>(std::round(histogram.GetMean())));
+    phase.p50 =
+        fml::TimeDelta::FromMicroseconds(histogram.GetValueAtPercentile(50));
+    phase.p90 =
+        fml::TimeDelta::FromMicroseconds(histogram.GetValueAtPercentile(90));
+    phase.p99 =
+        fml::TimeDelta::FromMicroseconds(histogram.GetValueAtPercentile(99));
+    phase.max = fml::TimeDelta::FromMicroseconds(histogram.GetMax());
+  }
+  return summary;
+}
+
+void FrameStatistics::Reset() {
+  std::scoped_lock lock(mutex_);
+  for (auto& histogram : phases_) {
+    histogram.Reset();
+  }
+  built_frames_ = 0;
+  rasterized_frames_ = 0;
+  missed_build_frames_ = 0;
+  missed_raster_frames_ = 0;
+}
+
+}  // namespace flutter
@@ -0,0 +1,139 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_FRAME_STATISTICS_H_
+#define FLUTTER_FLOW_FRAME_STATISTICS_H_
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+
+namespace flutter {
+
+// A histogram of non-negative integer values in the style of HdrHistogram.
+// Values are counted in buckets whose width is proportional to their
+// magnitude, so that every recorded value is represented with a relative
+// error of at most 1% while the memory used stays constant no matter how many
+// values are recorded. Values above |highest_trackable_value| are counted as
+// that value. The minimum and maximum recorded values are kept exactly.
+//
+// This class is not thread safe.
+class Histogram {
+ public:
+  explicit Histogram(int64_t highest_trackable_value);
+
+  ~Histogram();
+
+  void Record(int64_t value);
+
+  void Reset();
+
+  int64_t GetCount() const { return count_; }
+
+  int64_t GetMin() const { return count_ == 0 ? 0 : min_; }
+
+  int64_t GetMax() const { return max_; }
+
+  double GetMean() const;
+
+  // Returns the smallest recorded value that |percentile| percent of the
+  // recorded values are less than or equal to, up to the precision of the
+  // histogram. Returns 0 if nothing was recorded.
+  int64_t GetValueAtPercentile(double percentile) const;
+
+ private:
+  const int64_t highest_trackable_value_;
+  std::vector<uint64_t> counts_;
+  int64_t count_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+  double sum_ = 0;
+
+  static size_t GetCountsIndex(int64_t value);
+
+  static int64_t GetHighestEquivalentValue(size_t index);
+};
+
+// Aggregates the time spent in each phase of the frames produced by a shell
+// over arbitrarily long windows, without keeping the individual frames. Unlike
+// the |Stopwatch| used by the performance overlay, this can be read from any
+// thread and reports percentiles instead of the last few laps.
+//
+// This class is thread safe.
+class FrameStatistics {
+ public:
+  enum Phase {
+    // The time the UI thread spent building a frame.
+    kBuild,
+    // The time the raster thread spent rasterizing a frame.
+    kRaster,
+    // The parts of |kRaster| spent prerolling and painting the layer tree,
+    // flushing the frame's canvas and presenting the frame. Flushes are only
+    // timed apart from presenting with |Settings::profile_frame_flushes|.
+    kPreroll,
+    kPaint,
+    kFlush,
+    kPresent,
+    kPhaseCount,
+  };
+
+  struct PhaseSummary {
+    int64_t count = 0;
+    fml::TimeDelta mean;
+    fml::TimeDelta p50;
+    fml::TimeDelta p90;
+    fml::TimeDelta p99;
+    fml::TimeDelta max;
+  };
+
+  struct Summary {
+    int64_t built_frames = 0;
+    int64_t rasterized_frames = 0;
+    // The frames whose build or raster phase alone took longer than the
+    // frame interval.
+    int64_t missed_build_frames = 0;
+    int64_t missed_raster_frames = 0;
+    PhaseSummary phases[kPhaseCount];
+  };
+
+  FrameStatistics();
+
+  ~FrameStatistics();
+
+  static const char* GetPhaseName(Phase phase);
+
+  // Records a frame built by the UI thread in |build_time|, that had to be
+  // ready within |frame_interval|. The interval is also used to tell whether
+  // the frames rasterized after this one missed their deadline.
+  void RecordBuiltFrame(fml::TimeDelta build_time,
+                        fml::TimeDelta frame_interval);
+
+  // Records a frame rasterized in |raster_time|.
+  void RecordRasterizedFrame(fml::TimeDelta raster_time);
+
+  // Records the time spent in a phase other than |kBuild| and |kRaster|.
+  void RecordPhase(Phase phase, fml::TimeDelta time);
+
+  Summary GetSummary() const;
+
+  void Reset();
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<Histogram> phases_;
+  int64_t built_frames_ = 0;
+  int64_t rasterized_frames_ = 0;
+  int64_t missed_build_frames_ = 0;
+  int64_t missed_raster_frames_ = 0;
+  fml::TimeDelta frame_interval_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FrameStatistics);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_FRAME_STATISTICS_H_
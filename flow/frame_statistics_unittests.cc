@@ -0,0 +1,136 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/frame_statistics.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(HistogramTest, IsEmptyWhenCreated) {
+  Histogram histogram(1000);
+  ASSERT_EQ(histogram.GetCount(), 0);
+  ASSERT_EQ(histogram.GetMin(), 0);
+  ASSERT_EQ(histogram.GetMax(), 0);
+  ASSERT_EQ(histogram.GetMean(), 0);
+  ASSERT_EQ(histogram.GetValueAtPercentile(50), 0);
+}
+
+TEST(HistogramTest, SmallValuesAreExact) {
+  Histogram histogram(1000);
+  for (int64_t value = 1; value <= 100; value++) {
+    histogram.Record(value);
+  }
+  ASSERT_EQ(histogram.GetCount(), 100);
+  ASSERT_EQ(histogram.GetMin(), 1);
+  ASSERT_EQ(histogram.GetMax(), 100);
+  ASSERT_DOUBLE_EQ(histogram.GetMean(), 50.5);
+  ASSERT_EQ(histogram.GetValueAtPercentile(0), 1);
+  ASSERT_EQ(histogram.GetValueAtPercentile(50), 50);
+  ASSERT_EQ(histogram.GetValueAtPercentile(90), 90);
+  ASSERT_EQ(histogram.GetValueAtPercentile(99), 99);
+  ASSERT_EQ(histogram.GetValueAtPercentile(100), 100);
+}
+
+TEST(HistogramTest, LargeValuesAreWithinOnePercent) {
+  Histogram histogram(60 * 1000 * 1000);
+  for (int64_t value = 1000; value <= 10 * 1000 * 1000; value *= 3) {
+    histogram.Reset();
+    histogram.Record(value - 1);
+    histogram.Record(value);
+    histogram.Record(value + 1);
+    const int64_t median = histogram.GetValueAtPercentile(50);
+    ASSERT_LE(std::abs(median - value), value / 100) << value;
+    ASSERT_EQ(histogram.GetMax(), value + 1);
+  }
+}
+
+TEST(HistogramTest, ClampsValuesOutOfRange) {
+  Histogram histogram(1000);
+  histogram.Record(-5);
+  histogram.Record(1000000);
+  ASSERT_EQ(histogram.GetMin(), 0);
+  ASSERT_EQ(histogram.GetMax(), 1000);
+  ASSERT_EQ(histogram.GetValueAtPercentile(100), 1000);
+}
+
+TEST(HistogramTest, ResetForgetsValues) {
+  Histogram histogram(1000);
+  histogram.Record(10);
+  histogram.Reset();
+  histogram.Record(20);
+  ASSERT_EQ(histogram.GetCount(), 1);
+  ASSERT_EQ(histogram.GetMin(), 20);
+  ASSERT_EQ(histogram.GetValueAtPercentile(1), 20);
+}
+
+TEST(FrameStatisticsTest, CountsMissedFrames) {
+  FrameStatistics statistics;
+  const auto interval = fml::TimeDelta::FromMilliseconds(16);
+  // Raster times are only compared to an interval once a frame is built.
+  statistics.RecordRasterizedFrame(fml::TimeDelta::FromMilliseconds(20));
+  statistics.RecordBuiltFrame(fml::TimeDelta::FromMilliseconds(4), interval);
+  statistics.RecordBuiltFrame(fml::TimeDelta::FromMilliseconds(30), interval);
+  statistics.RecordRasterizedFrame(fml::TimeDelta::FromMilliseconds(8));
+  statistics.RecordRasterizedFrame(fml::TimeDelta::FromMilliseconds(20));
+
+  const auto summary = statistics.GetSummary();
+  ASSERT_EQ(summary.built_frames, 2);
+  ASSERT_EQ(summary.missed_build_frames, 1);
+  ASSERT_EQ(summary.rasterized_frames, 3);
+  ASSERT_EQ(summary.missed_raster_frames, 1);
+}
+
+TEST(FrameStatisticsTest, SummarizesEachPhase) {
+  FrameStatistics statistics;
+  for (int64_t i = 1; i <= 100; i++) {
+    statistics.RecordPhase(FrameStatistics::kPaint,
+                           fml::TimeDelta::FromMicroseconds(i));
+  }
+  statistics.RecordPhase(FrameStatistics::kFlush,
+                         fml::TimeDelta::FromMilliseconds(2));
+
+  const auto summary = statistics.GetSummary();
+  const auto& paint = summary.phases[FrameStatistics::kPaint];
+  ASSERT_EQ(paint.count, 100);
+  ASSERT_EQ(paint.p50.ToMicroseconds(), 50);
+  ASSERT_EQ(paint.p90.ToMicroseconds(), 90);
+  ASSERT_EQ(paint.p99.ToMicroseconds(), 99);
+  ASSERT_EQ(paint.max.ToMicroseconds(), 100);
+  ASSERT_EQ(paint.mean.ToMicroseconds(), 51);
+  const auto& flush = summary.phases[FrameStatistics::kFlush];
+  ASSERT_EQ(flush.count, 1);
+  ASSERT_EQ(flush.max.ToMilliseconds(), 2);
+  ASSERT_EQ(summary.phases[FrameStatistics::kPreroll].count, 0);
+}
+
+TEST(FrameStatisticsTest, ResetClearsEverything) {
+  FrameStatistics statistics;
+  statistics.RecordBuiltFrame(fml::TimeDelta::FromMilliseconds(30),
+                              fml::TimeDelta::FromMilliseconds(16));
+  statistics.RecordPhase(FrameStatistics::kPresent,
+                         fml::TimeDelta::FromMilliseconds(1));
+  statistics.Reset();
+
+  const auto summary = statistics.GetSummary();
+  ASSERT_EQ(summary.built_frames, 0);
+  ASSERT_EQ(summary.missed_build_frames, 0);
+  for (const auto& phase : summary.phases) {
+    ASSERT_EQ(phase.count, 0);
+    ASSERT_EQ(phase.max.ToMicroseconds(), 0);
+  }
+}
+
+TEST(FrameStatisticsTest, NamesEveryPhase) {
+  ASSERT_STREQ(FrameStatistics::GetPhaseName(FrameStatistics::kBuild),
+               "build");
+  ASSERT_STREQ(FrameStatistics::GetPhaseName(FrameStatistics::kPresent),
+               "present");
+}
+
+}  // namespace testing
+}  // namespace flutter
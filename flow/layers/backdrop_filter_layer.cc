@@ -4,6 +4,9 @@
 
 #include "flutter/flow/layers/backdrop_filter_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+
 namespace flutter {
 
 BackdropFilterLayer::BackdropFilterLayer(sk_sp<SkImageFilter> filter)
@@ -26,4 +29,15 @@ void BackdropFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void BackdropFilterLayer::Diff(DiffContext* context) const {
+  // The filter reads back everything painted below it within the clip.
+  context->MarkFullDamage();
+  context->AddVolatilePaintRegion(kGiantRect);
+  DiffChildren(context);
+}
+
+void BackdropFilterLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 }  // namespace flutter
@@ -19,6 +19,10 @@ class BackdropFilterLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
+  void AddToDisplayList(LayerDisplayList* display_list) override;
+
  private:
   sk_sp<SkImageFilter> filter_;
 
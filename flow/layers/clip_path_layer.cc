@@ -4,6 +4,10 @@
 
 #include "flutter/flow/layers/clip_path_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
+
 #if defined(OS_FUCHSIA)
 
 #include "lib/ui/scenic/cpp/commands.h"
@@ -75,4 +79,23 @@ void ClipPathLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipPathLayer::Diff(DiffContext* context) const {
+  if (!children_inside_clip_) {
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_path_.getBounds());
+  context->FoldState(fml::HashCombine(DiffContext::HashPath(clip_path_),
+                                      static_cast<int>(clip_behavior_)));
+  DiffChildren(context);
+}
+
+void ClipPathLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->PushClipPath(this, clip_path_, clip_behavior_,
+                             &children_inside_clip_);
+  AddChildrenToDisplayList(display_list);
+  display_list->Pop();
+}
+
 }  // namespace flutter
@@ -4,6 +4,10 @@
 
 #include "flutter/flow/layers/clip_rect_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ClipRectLayer::ClipRectLayer(const SkRect& clip_rect, Clip clip_behavior)
@@ -68,4 +72,24 @@ void ClipRectLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipRectLayer::Diff(DiffContext* context) const {
+  if (!children_inside_clip_) {
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_rect_);
+  context->FoldState(
+      fml::HashCombine(DiffContext::HashBytes(&clip_rect_, sizeof(clip_rect_)),
+                       static_cast<int>(clip_behavior_)));
+  DiffChildren(context);
+}
+
+void ClipRectLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->PushClipRect(this, clip_rect_, clip_behavior_,
+                             &children_inside_clip_);
+  AddChildrenToDisplayList(display_list);
+  display_list->Pop();
+}
+
 }  // namespace flutter
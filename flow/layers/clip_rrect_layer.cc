@@ -4,6 +4,10 @@
 
 #include "flutter/flow/layers/clip_rrect_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ClipRRectLayer::ClipRRectLayer(const SkRRect& clip_rrect, Clip clip_behavior)
@@ -69,4 +73,27 @@ void ClipRRectLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipRRectLayer::Diff(DiffContext* context) const {
+  if (!children_inside_clip_) {
+    return;
+  }
+
+  char rrect_data[SkRRect::kSizeInMemory];
+  clip_rrect_.writeToMemory(rrect_data);
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_rrect_.getBounds());
+  context->FoldState(
+      fml::HashCombine(DiffContext::HashBytes(rrect_data, sizeof(rrect_data)),
+                       static_cast<int>(clip_behavior_)));
+  DiffChildren(context);
+}
+
+void ClipRRectLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->PushClipRRect(this, clip_rrect_, clip_behavior_,
+                              &children_inside_clip_);
+  AddChildrenToDisplayList(display_list);
+  display_list->Pop();
+}
+
 }  // namespace flutter
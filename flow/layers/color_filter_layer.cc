@@ -4,6 +4,10 @@
 
 #include "flutter/flow/layers/color_filter_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ColorFilterLayer::ColorFilterLayer(sk_sp<SkColorFilter> filter)
@@ -28,4 +32,19 @@ void ColorFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ColorFilterLayer::Diff(DiffContext* context) const {
+  // The filter applies to each pixel of the save layer independently, but it
+  // may also paint the parts of the layer that the children do not cover.
+  const uint64_t filter_hash = DiffContext::HashFlattenable(filter_.get());
+  context->AddPaintRegion(paint_bounds(), filter_hash);
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->FoldState(filter_hash);
+  DiffChildren(context);
+}
+
+void ColorFilterLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 }  // namespace flutter
@@ -4,6 +4,9 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+
 namespace flutter {
 
 ContainerLayer::ContainerLayer() {}
@@ -26,6 +29,10 @@ void ContainerLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ContainerLayer::Diff(DiffContext* context) const {
+  DiffChildren(context);
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
@@ -65,6 +72,30 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   }
 }
 
+void ContainerLayer::DiffChildren(DiffContext* context) const {
+  // Mirrors |PaintChildren|.
+  for (auto& layer : layers_) {
+    if (layer->needs_painting()) {
+      layer->Diff(context);
+    }
+  }
+}
+
+void ContainerLayer::AddChildrenToDisplayList(
+    LayerDisplayList* display_list) {
+  for (auto& layer : layers_) {
+    layer->AddToDisplayList(display_list);
+  }
+}
+
+GroupLayer::GroupLayer() = default;
+
+void GroupLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->PushContainer(this);
+  AddChildrenToDisplayList(display_list);
+  display_list->Pop();
+}
+
 #if defined(OS_FUCHSIA)
 
 void ContainerLayer::UpdateScene(SceneUpdateContext& context) {
@@ -18,6 +18,8 @@ class ContainerLayer : public Layer {
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+
 #if defined(OS_FUCHSIA)
   void UpdateScene(SceneUpdateContext& context) override;
 #endif  // defined(OS_FUCHSIA)
@@ -29,6 +31,8 @@ class ContainerLayer : public Layer {
                        const SkMatrix& child_matrix,
                        SkRect* child_paint_bounds);
   void PaintChildren(PaintContext& context) const;
+  void DiffChildren(DiffContext* context) const;
+  void AddChildrenToDisplayList(LayerDisplayList* display_list);
 
 #if defined(OS_FUCHSIA)
   void UpdateSceneChildren(SceneUpdateContext& context);
@@ -43,6 +47,24 @@ class ContainerLayer : public Layer {
   FML_DISALLOW_COPY_AND_ASSIGN(ContainerLayer);
 };
 
+// A container that only groups its children, with no effect of its own.
+//
+// Containers are recorded into a |LayerDisplayList| as a single operation
+// unless their type records what it does, since the display list would
+// otherwise skip the effects of subclasses it does not know about. This class
+// is final so that its children are only recorded as separate operations
+// when nothing else is done with them.
+class GroupLayer final : public ContainerLayer {
+ public:
+  GroupLayer();
+
+  // |Layer|
+  void AddToDisplayList(LayerDisplayList* display_list) override;
+
+ private:
+  FML_DISALLOW_COPY_AND_ASSIGN(GroupLayer);
+};
+
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
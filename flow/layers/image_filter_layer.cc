@@ -4,6 +4,10 @@
 
 #include "flutter/flow/layers/image_filter_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ImageFilterLayer::ImageFilterLayer(sk_sp<SkImageFilter> filter)
@@ -53,4 +57,33 @@ void ImageFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ImageFilterLayer::Diff(DiffContext* context) const {
+  // Each output pixel of the filter may depend on any pixel of its input, so
+  // the whole subtree is collapsed into a single region.
+  const size_t mark = context->paint_region_mark();
+  bool is_cached = false;
+  {
+    DiffContext::AutoSubtreeRestore subtree(context);
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+    context->SetMatrix(RasterCache::GetIntegralTransCTM(context->matrix()));
+#endif
+    is_cached = context->raster_cache() &&
+                context->raster_cache()->HasValidEntry((Layer*)this,
+                                                       context->matrix());
+    context->ClearClip();
+    DiffChildren(context);
+  }
+
+  const SkRect filter_bounds =
+      filter_ ? filter_->computeFastBounds(paint_bounds()) : paint_bounds();
+  context->CollapsePaintRegions(
+      mark, filter_bounds,
+      fml::HashCombine(DiffContext::HashFlattenable(filter_.get()),
+                       is_cached));
+}
+
+void ImageFilterLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 }  // namespace flutter
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
 #include "flutter/flow/paint_utils.h"
 #include "third_party/skia/include/core/SkColorFilter.h"
 
@@ -27,6 +29,14 @@ uint64_t Layer::NextUniqueID() {
 
 void Layer::Preroll(PrerollContext* context, const SkMatrix& matrix) {}
 
+void Layer::Diff(DiffContext* context) const {
+  context->AddVolatilePaintRegion(paint_bounds());
+}
+
+void Layer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 Layer::AutoPrerollSaveLayerState::AutoPrerollSaveLayerState(
     PrerollContext* preroll_context,
     bool save_layer_is_active,
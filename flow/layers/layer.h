@@ -37,6 +37,9 @@
 
 namespace flutter {
 
+class DiffContext;
+class LayerDisplayList;
+
 static constexpr SkRect kGiantRect = SkRect::MakeLTRB(-1E9F, -1E9F, 1E9F, 1E9F);
 
 // This should be an exact copy of the Clip enum in painting.dart.
@@ -66,6 +69,11 @@ struct PrerollContext {
   float total_elevation = 0.0f;
   bool has_platform_view = false;
   bool is_opaque = true;
+
+  // Set while a subtree is prerolled off the raster thread. The calls to
+  // |RasterCache::Prepare| are then queued here instead of touching the
+  // cache.
+  RasterCachePrepareQueue* deferred_raster_cache_prepares = nullptr;
 };
 
 // Represents a single composited layer. Created on the UI thread but then
@@ -158,6 +166,17 @@ class Layer {
 
   virtual void Paint(PaintContext& context) const = 0;
 
+  // Records the regions of the frame painted by this layer into |context| so
+  // that they can be compared with those of the previous frame. Only called
+  // after Preroll and only if the layer needs painting. By default, the whole
+  // paint bounds are assumed to change on every frame.
+  virtual void Diff(DiffContext* context) const;
+
+  // Records this layer into |display_list|, which the |LayerTree| prerolls and
+  // paints instead of recursing through the layers. By default, the layer is
+  // recorded as a single operation that calls its |Preroll| and |Paint|.
+  virtual void AddToDisplayList(LayerDisplayList* display_list);
+
 #if defined(OS_FUCHSIA)
   // Updates the system composited scene.
   virtual void UpdateScene(SceneUpdateContext& context);
@@ -0,0 +1,497 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layers/layer_display_list.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+LayerDisplayList::LayerDisplayList(Layer* root_layer) {
+  TRACE_EVENT0("flutter", "LayerDisplayList::Compile");
+  root_layer->AddToDisplayList(this);
+  FML_DCHECK(open_ops_.empty());
+  preroll_stack_.reserve(max_depth_);
+}
+
+LayerDisplayList::~LayerDisplayList() = default;
+
+void LayerDisplayList::AddOp(OpType type, uint32_t data, Layer* layer) {
+  const uint32_t index = ops_.size();
+  ops_.push_back({type, data, index + 1, 0, layer, SkRect::MakeEmpty()});
+}
+
+void LayerDisplayList::PushOp(OpType type, uint32_t data, Layer* layer) {
+  open_ops_.push_back(ops_.size());
+  max_depth_ = std::max(max_depth_, open_ops_.size());
+  AddOp(type, data, layer);
+}
+
+void LayerDisplayList::AddLayer(Layer* layer) {
+  AddOp(OpType::kLayer, 0, layer);
+}
+
+void LayerDisplayList::AddPicture(Layer* layer,
+                                  SkPicture* picture,
+                                  const SkPoint& offset,
+                                  bool is_complex,
+                                  bool will_change) {
+  AddOp(OpType::kPicture, pictures_.size(), layer);
+  pictures_.push_back({picture, offset, is_complex, will_change});
+}
+
+void LayerDisplayList::PushContainer(Layer* layer) {
+  PushOp(OpType::kContainer, 0, layer);
+}
+
+void LayerDisplayList::PushTransform(Layer* layer, const SkMatrix& transform) {
+  PushOp(OpType::kTransform, transforms_.size(), layer);
+  transforms_.push_back(transform);
+}
+
+void LayerDisplayList::PushClip(OpType type,
+                                Layer* layer,
+                                const ClipData& clip) {
+  FML_DCHECK(clip.behavior != Clip::none);
+  PushOp(type, clips_.size(), layer);
+  clips_.push_back(clip);
+}
+
+void LayerDisplayList::PushClipRect(Layer* layer,
+                                    const SkRect& clip_rect,
+                                    Clip clip_behavior,
+                                    bool* children_inside_clip) {
+  PushClip(OpType::kClipRect, layer,
+           {clip_rect, SkRRect::MakeRect(clip_rect), nullptr, clip_behavior,
+            children_inside_clip});
+}
+
+void LayerDisplayList::PushClipRRect(Layer* layer,
+                                     const SkRRect& clip_rrect,
+                                     Clip clip_behavior,
+                                     bool* children_inside_clip) {
+  PushClip(OpType::kClipRRect, layer,
+           {clip_rrect.getBounds(), clip_rrect, nullptr, clip_behavior,
+            children_inside_clip});
+}
+
+void LayerDisplayList::PushClipPath(Layer* layer,
+                                    const SkPath& clip_path,
+                                    Clip clip_behavior,
+                                    bool* children_inside_clip) {
+  PushClip(OpType::kClipPath, layer,
+           {clip_path.getBounds(), SkRRect::MakeEmpty(), &clip_path,
+            clip_behavior, children_inside_clip});
+}
+
+void LayerDisplayList::Pop() {
+  FML_DCHECK(!open_ops_.empty());
+  const uint32_t op_index = open_ops_.back();
+  open_ops_.pop_back();
+  Op& op = ops_[op_index];
+  op.end = ops_.size();
+  for (uint32_t child = op_index + 1; child < op.end;
+       child = ops_[child].end) {
+    op.child_count++;
+  }
+}
+
+void LayerDisplayList::SetPrerollTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t helper_count) {
+  preroll_task_runner_ = std::move(task_runner);
+  preroll_helper_count_ = helper_count;
+}
+
+// Shared by the calling thread and the helper tasks. Helpers that only start
+// once every child has been taken return without touching the layers or the
+// context, so the calling thread only waits for the children and not for the
+// helpers.
+class LayerDisplayList::ParallelPreroll {
+ public:
+  ParallelPreroll(LayerDisplayList* display_list,
+                  const PrerollContext* context,
+                  const SkMatrix& child_matrix,
+                  std::vector<uint32_t> children)
+      : display_list_(display_list),
+        context_(context),
+        child_matrix_(child_matrix),
+        children_(std::move(children)),
+        results_(children_.size()),
+        remaining_children_(children_.size()) {}
+
+  // Prerolls children until none are left to take.
+  void PrerollChildren() {
+    size_t index = next_child_.fetch_add(1);
+    if (index >= children_.size()) {
+      return;
+    }
+
+    // The mutators and cull rect are restored after each child, so every
+    // thread only needs a copy of them for all the children it takes.
+    MutatorsStack mutators_stack = context_->mutators_stack;
+    PrerollContext context = {
+        context_->raster_cache,
+        context_->gr_context,
+        context_->view_embedder,
+        mutators_stack,
+        context_->dst_color_space,
+        context_->cull_rect,
+        false, /* surface_needs_readback */
+        context_->raster_time,
+        context_->ui_time,
+        context_->texture_registry,
+        context_->checkerboard_offscreen_layers,
+        context_->frame_physical_depth,
+        context_->frame_device_pixel_ratio,
+        context_->total_elevation,
+        false, /* has_platform_view */
+        context_->is_opaque,
+    };
+    PrerollStack stack;
+    stack.reserve(display_list_->max_depth_);
+
+    for (; index < children_.size(); index = next_child_.fetch_add(1)) {
+      TRACE_EVENT0("flutter", "LayerDisplayList::PrerollChild");
+      Result& result = results_[index];
+      context.surface_needs_readback = false;
+      context.has_platform_view = false;
+      context.deferred_raster_cache_prepares = &result.raster_cache_prepares;
+      const uint32_t child = children_[index];
+      display_list_->PrerollOps(&context, child_matrix_, child,
+                                display_list_->ops_[child].end, &stack,
+                                false);
+      result.surface_needs_readback = context.surface_needs_readback;
+      result.has_platform_view = context.has_platform_view;
+      remaining_children_.CountDown();
+    }
+  }
+
+  void WaitForChildren() { remaining_children_.Wait(); }
+
+  // Folds the results of the children into |context| and the frame at the
+  // top of |stack|, in the order of the children. Must be called after
+  // |WaitForChildren| on the thread that owns |context|.
+  void Merge(PrerollContext* context, PrerollStack* stack) {
+    for (size_t i = 0; i < children_.size(); i++) {
+      Result& result = results_[i];
+      // Layers only ask to be cached while there is no platform view below
+      // them.
+      context->has_platform_view = false;
+      result.raster_cache_prepares.Flush(context);
+      context->surface_needs_readback =
+          context->surface_needs_readback || result.surface_needs_readback;
+      context->has_platform_view = result.has_platform_view;
+      display_list_->FinishPrerollOp(context, stack,
+                                     display_list_->ops_[children_[i]]);
+    }
+  }
+
+  size_t child_count() const { return children_.size(); }
+
+ private:
+  struct Result {
+    RasterCachePrepareQueue raster_cache_prepares;
+    bool surface_needs_readback = false;
+    bool has_platform_view = false;
+  };
+
+  LayerDisplayList* const display_list_;
+  const PrerollContext* const context_;
+  const SkMatrix child_matrix_;
+  const std::vector<uint32_t> children_;
+  std::vector<Result> results_;
+  std::atomic_size_t next_child_ = {0};
+  fml::CountDownLatch remaining_children_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ParallelPreroll);
+};
+
+void LayerDisplayList::Preroll(PrerollContext* context,
+                               const SkMatrix& matrix) {
+  TRACE_EVENT0("flutter", "LayerDisplayList::Preroll");
+
+  preroll_stack_.clear();
+  PrerollOps(context, matrix, 0, ops_.size(), &preroll_stack_,
+             preroll_task_runner_ != nullptr);
+}
+
+void LayerDisplayList::PrerollOps(PrerollContext* context,
+                                  const SkMatrix& matrix,
+                                  uint32_t begin,
+                                  uint32_t end,
+                                  PrerollStack* stack,
+                                  bool allow_parallel) {
+  const size_t base_depth = stack->size();
+  uint32_t index = begin;
+  while (index < end) {
+    Op& op = ops_[index];
+    const uint32_t op_index = index;
+    // Skip the children of the operation unless it descends into them below.
+    index = op.end;
+
+    const SkMatrix& parent_matrix =
+        stack->size() == base_depth ? matrix : stack->back().child_matrix;
+    if (!stack->empty()) {
+      // Reset context->has_platform_view to false so that layers aren't
+      // treated as if they have a platform view based on one being previously
+      // found in a sibling tree.
+      context->has_platform_view = false;
+    }
+
+    switch (op.type) {
+      case OpType::kLayer:
+        op.layer->Preroll(context, parent_matrix);
+        FinishPrerollOp(context, stack, op);
+        break;
+      case OpType::kPicture: {
+        const PictureData& picture = pictures_[op.data];
+        op.layer->set_paint_bounds(PictureLayer::PrerollPicture(
+            context, parent_matrix, picture.picture, picture.offset,
+            picture.is_complex, picture.will_change));
+        FinishPrerollOp(context, stack, op);
+        break;
+      }
+      case OpType::kContainer:
+        PushPrerollFrame(context, stack, op_index, parent_matrix,
+                         context->cull_rect);
+        index = PrerollChildren(context, op_index, stack, allow_parallel);
+        break;
+      case OpType::kTransform: {
+        const SkMatrix& transform = transforms_[op.data];
+        SkMatrix child_matrix;
+        child_matrix.setConcat(parent_matrix, transform);
+        PushPrerollFrame(context, stack, op_index, child_matrix,
+                         context->cull_rect);
+        context->mutators_stack.PushTransform(transform);
+        SkMatrix inverse_transform;
+        // Perspective projections don't produce rectangles that are useful
+        // for culling.
+        if (!transform.hasPerspective() &&
+            transform.invert(&inverse_transform)) {
+          inverse_transform.mapRect(&context->cull_rect);
+        } else {
+          context->cull_rect = kGiantRect;
+        }
+        index = PrerollChildren(context, op_index, stack, allow_parallel);
+        break;
+      }
+      case OpType::kClipRect:
+      case OpType::kClipRRect:
+      case OpType::kClipPath: {
+        const ClipData& clip = clips_[op.data];
+        const SkRect previous_cull_rect = context->cull_rect;
+        *clip.children_inside_clip =
+            context->cull_rect.intersect(clip.bounds);
+        if (!*clip.children_inside_clip) {
+          context->cull_rect = previous_cull_rect;
+          FinishPrerollOp(context, stack, op);
+          break;
+        }
+        PushPrerollFrame(context, stack, op_index, parent_matrix,
+                         previous_cull_rect);
+        if (clip.UsesSaveLayer()) {
+          context->surface_needs_readback = false;
+        }
+        if (op.type == OpType::kClipRect) {
+          context->mutators_stack.PushClipRect(clip.bounds);
+        } else if (op.type == OpType::kClipRRect) {
+          context->mutators_stack.PushClipRRect(clip.rrect);
+        } else {
+          context->mutators_stack.PushClipPath(*clip.path);
+        }
+        index = PrerollChildren(context, op_index, stack, allow_parallel);
+        break;
+      }
+    }
+
+    // Finish the containers whose last child was just prerolled.
+    while (stack->size() > base_depth && ops_[stack->back().op].end == index) {
+      FinishPrerollFrame(context, stack);
+    }
+  }
+}
+
+void LayerDisplayList::PushPrerollFrame(PrerollContext* context,
+                                        PrerollStack* stack,
+                                        uint32_t op,
+                                        const SkMatrix& child_matrix,
+                                        const SkRect& previous_cull_rect) {
+  stack->push_back({op, child_matrix, previous_cull_rect, SkRect::MakeEmpty(),
+                    false, context->surface_needs_readback});
+}
+
+bool LayerDisplayList::ShouldPrerollInParallel(const PrerollContext* context,
+                                               uint32_t op) const {
+  return preroll_task_runner_ && context->view_embedder == nullptr &&
+         context->deferred_raster_cache_prepares == nullptr &&
+         ops_[op].child_count >= kMinParallelPrerollChildren &&
+         ops_[op].end - op - 1 >= kMinParallelPrerollOps;
+}
+
+uint32_t LayerDisplayList::PrerollChildren(PrerollContext* context,
+                                           uint32_t op,
+                                           PrerollStack* stack,
+                                           bool allow_parallel) {
+  if (!allow_parallel || !ShouldPrerollInParallel(context, op)) {
+    return op + 1;
+  }
+
+  TRACE_EVENT0("flutter", "LayerDisplayList::PrerollChildrenInParallel");
+  std::vector<uint32_t> children;
+  children.reserve(ops_[op].child_count);
+  for (uint32_t child = op + 1; child < ops_[op].end;
+       child = ops_[child].end) {
+    children.push_back(child);
+  }
+  auto preroll = std::make_shared<ParallelPreroll>(
+      this, context, stack->back().child_matrix, std::move(children));
+  // The calling thread takes one of the children itself.
+  const size_t task_count =
+      std::min(preroll_helper_count_, preroll->child_count() - 1);
+  for (size_t i = 0; i < task_count; i++) {
+    preroll_task_runner_->PostTask(
+        [preroll]() { preroll->PrerollChildren(); });
+  }
+  preroll->PrerollChildren();
+  preroll->WaitForChildren();
+  preroll->Merge(context, stack);
+  return ops_[op].end;
+}
+
+void LayerDisplayList::FinishPrerollOp(PrerollContext* context,
+                                       PrerollStack* stack,
+                                       Op& op) {
+  op.paint_bounds = op.layer->paint_bounds();
+  if (stack->empty()) {
+    return;
+  }
+  PrerollFrame& parent = stack->back();
+  if (op.layer->needs_system_composite()) {
+    ops_[parent.op].layer->set_needs_system_composite(true);
+  }
+  parent.child_paint_bounds.join(op.paint_bounds);
+  parent.child_has_platform_view =
+      parent.child_has_platform_view || context->has_platform_view;
+}
+
+void LayerDisplayList::FinishPrerollFrame(PrerollContext* context,
+                                          PrerollStack* stack) {
+  const PrerollFrame frame = stack->back();
+  stack->pop_back();
+
+  Op& op = ops_[frame.op];
+  context->has_platform_view = frame.child_has_platform_view;
+  SkRect child_paint_bounds = frame.child_paint_bounds;
+  switch (op.type) {
+    case OpType::kContainer:
+      op.layer->set_paint_bounds(child_paint_bounds);
+      break;
+    case OpType::kTransform:
+      transforms_[op.data].mapRect(&child_paint_bounds);
+      op.layer->set_paint_bounds(child_paint_bounds);
+      context->cull_rect = frame.previous_cull_rect;
+      context->mutators_stack.Pop();
+      break;
+    case OpType::kClipRect:
+    case OpType::kClipRRect:
+    case OpType::kClipPath: {
+      const ClipData& clip = clips_[op.data];
+      if (child_paint_bounds.intersect(clip.bounds)) {
+        op.layer->set_paint_bounds(child_paint_bounds);
+      }
+      context->mutators_stack.Pop();
+      if (clip.UsesSaveLayer()) {
+        context->surface_needs_readback = frame.prev_surface_needs_readback;
+      }
+      context->cull_rect = frame.previous_cull_rect;
+      break;
+    }
+    case OpType::kLayer:
+    case OpType::kPicture:
+      FML_DCHECK(false);
+      break;
+  }
+  FinishPrerollOp(context, stack, op);
+}
+
+void LayerDisplayList::Paint(Layer::PaintContext& context) const {
+  TRACE_EVENT0("flutter", "LayerDisplayList::Paint");
+
+  SkCanvas* canvas = context.internal_nodes_canvas;
+  std::vector<PaintFrame> stack;
+  stack.reserve(max_depth_);
+  uint32_t index = 0;
+  while (index < ops_.size()) {
+    const Op& op = ops_[index];
+    const uint32_t op_index = index;
+    index = op.end;
+
+    // Like |ContainerLayer::PaintChildren|, skip the layers that paint
+    // nothing.
+    if (!op.paint_bounds.isEmpty()) {
+      switch (op.type) {
+        case OpType::kLayer:
+          op.layer->Paint(context);
+          break;
+        case OpType::kPicture: {
+          const PictureData& picture = pictures_[op.data];
+          PictureLayer::PaintPicture(context, picture.picture, picture.offset);
+          break;
+        }
+        case OpType::kContainer:
+          index = op_index + 1;
+          stack.push_back({op.end, 0});
+          break;
+        case OpType::kTransform:
+          canvas->save();
+          canvas->concat(transforms_[op.data]);
+          index = op_index + 1;
+          stack.push_back({op.end, 1});
+          break;
+        case OpType::kClipRect:
+        case OpType::kClipRRect:
+        case OpType::kClipPath: {
+          const ClipData& clip = clips_[op.data];
+          if (!*clip.children_inside_clip) {
+            break;
+          }
+          const bool do_anti_alias = clip.behavior != Clip::hardEdge;
+          canvas->save();
+          if (op.type == OpType::kClipRect) {
+            canvas->clipRect(clip.bounds, do_anti_alias);
+          } else if (op.type == OpType::kClipRRect) {
+            canvas->clipRRect(clip.rrect, do_anti_alias);
+          } else {
+            canvas->clipPath(*clip.path, do_anti_alias);
+          }
+          int restore_count = 1;
+          if (clip.UsesSaveLayer()) {
+            canvas->saveLayer(
+                op.type == OpType::kClipRect ? clip.bounds : op.paint_bounds,
+                nullptr);
+            restore_count++;
+          }
+          index = op_index + 1;
+          stack.push_back({op.end, restore_count});
+          break;
+        }
+      }
+    }
+
+    while (!stack.empty() && stack.back().end == index) {
+      for (int i = 0; i < stack.back().restore_count; i++) {
+        canvas->restore();
+      }
+      stack.pop_back();
+    }
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,231 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_LAYERS_LAYER_DISPLAY_LIST_H_
+#define FLUTTER_FLOW_LAYERS_LAYER_DISPLAY_LIST_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "flutter/flow/layers/layer.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRect.h"
+
+namespace flutter {
+
+// A layer tree compiled into a flat list of operations, so that it can be
+// prerolled and painted in linear passes instead of by recursing through the
+// virtual |Layer::Preroll| and |Layer::Paint| of every layer.
+//
+// Groups, transforms, clips and pictures are recorded as operations that
+// hold their transform, clip or picture inline, in the order of a depth-first
+// walk of the tree. Every other layer is recorded as a single operation that
+// calls the virtual methods of the layer, which then handles its own subtree.
+//
+// The layers remain the source of truth: the passes write the paint bounds and
+// the other results of |Preroll| back into the layers, so that |Diff|,
+// |UpdateScene| and the raster cache see the same state as after a recursive
+// preroll. The layers must outlive the list and must not change after it was
+// compiled.
+//
+// Wide containers can have their children prerolled concurrently (see
+// |SetPrerollTaskRunner|). Each child subtree is then prerolled with a
+// |MutatorsStack| and cull state of its own, and its calls to
+// |RasterCache::Prepare| are queued. The results are merged on the calling
+// thread in the order of the children, so that the raster cache and the
+// layers end up in the same state as after a serial preroll.
+class LayerDisplayList {
+ public:
+  // Containers are only prerolled in parallel if they have at least this many
+  // children and operations in their subtree. Below that, waking up the
+  // workers costs more than it saves.
+  static constexpr uint32_t kMinParallelPrerollChildren = 4;
+  static constexpr uint32_t kMinParallelPrerollOps = 64;
+
+  // Compiles the tree under |root_layer| by calling
+  // |Layer::AddToDisplayList| on it.
+  explicit LayerDisplayList(Layer* root_layer);
+
+  ~LayerDisplayList();
+
+  // Prerolls the children of wide containers on the calling thread and up to
+  // |helper_count| tasks posted to |task_runner|. Passing null goes back to
+  // prerolling serially, which is also done for frames with an external view
+  // embedder since platform views must be prerolled in order.
+  void SetPrerollTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+      size_t helper_count);
+
+  // Equivalent to calling |Layer::Preroll| on the root layer.
+  void Preroll(PrerollContext* context, const SkMatrix& matrix);
+
+  // Equivalent to calling |Layer::Paint| on the root layer if it needs
+  // painting. Must be called after |Preroll|.
+  void Paint(Layer::PaintContext& context) const;
+
+  size_t op_count() const { return ops_.size(); }
+
+  // The following are called by |Layer::AddToDisplayList| to record the
+  // layers. Every |Push| must be followed by the children of the layer and
+  // then by a call to |Pop|.
+
+  // Records a layer that is prerolled and painted through its virtual
+  // methods.
+  void AddLayer(Layer* layer);
+
+  void AddPicture(Layer* layer,
+                  SkPicture* picture,
+                  const SkPoint& offset,
+                  bool is_complex,
+                  bool will_change);
+
+  void PushContainer(Layer* layer);
+
+  void PushTransform(Layer* layer, const SkMatrix& transform);
+
+  // |children_inside_clip| is updated during |Preroll|, like the layer would
+  // when prerolled recursively.
+  void PushClipRect(Layer* layer,
+                    const SkRect& clip_rect,
+                    Clip clip_behavior,
+                    bool* children_inside_clip);
+
+  void PushClipRRect(Layer* layer,
+                     const SkRRect& clip_rrect,
+                     Clip clip_behavior,
+                     bool* children_inside_clip);
+
+  void PushClipPath(Layer* layer,
+                    const SkPath& clip_path,
+                    Clip clip_behavior,
+                    bool* children_inside_clip);
+
+  void Pop();
+
+ private:
+  enum class OpType : uint8_t {
+    kLayer,
+    kPicture,
+    kContainer,
+    kTransform,
+    kClipRect,
+    kClipRRect,
+    kClipPath,
+  };
+
+  struct Op {
+    OpType type;
+    // The index into |transforms_|, |clips_| or |pictures_|.
+    uint32_t data;
+    // The index of the first operation after the subtree of this one.
+    uint32_t end;
+    // The number of operations whose parent is this one.
+    uint32_t child_count;
+    Layer* layer;
+    // A copy of the paint bounds of the layer, updated by |Preroll|.
+    SkRect paint_bounds;
+  };
+
+  struct ClipData {
+    SkRect bounds;
+    SkRRect rrect;
+    const SkPath* path;
+    Clip behavior;
+    bool* children_inside_clip;
+
+    bool UsesSaveLayer() const {
+      return behavior == Clip::antiAliasWithSaveLayer;
+    }
+  };
+
+  struct PictureData {
+    SkPicture* picture;
+    SkPoint offset;
+    bool is_complex;
+    bool will_change;
+  };
+
+  // The state of a container whose children are being prerolled.
+  struct PrerollFrame {
+    uint32_t op;
+    SkMatrix child_matrix;
+    SkRect previous_cull_rect;
+    SkRect child_paint_bounds;
+    bool child_has_platform_view;
+    bool prev_surface_needs_readback;
+  };
+
+  using PrerollStack = std::vector<PrerollFrame>;
+
+  class ParallelPreroll;
+
+  // The state of a container whose children are being painted.
+  struct PaintFrame {
+    uint32_t end;
+    int restore_count;
+  };
+
+  std::vector<Op> ops_;
+  std::vector<SkMatrix> transforms_;
+  std::vector<ClipData> clips_;
+  std::vector<PictureData> pictures_;
+  // The operations pushed but not popped yet while compiling.
+  std::vector<uint32_t> open_ops_;
+  // The deepest nesting of containers, to size the stacks of the passes.
+  size_t max_depth_ = 0;
+  PrerollStack preroll_stack_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> preroll_task_runner_;
+  size_t preroll_helper_count_ = 0;
+
+  void AddOp(OpType type, uint32_t data, Layer* layer);
+
+  void PushOp(OpType type, uint32_t data, Layer* layer);
+
+  void PushClip(OpType type, Layer* layer, const ClipData& clip);
+
+  // Prerolls the subtrees from |begin| to |end|, whose parent is at the top
+  // of |stack| if any. |matrix| is the matrix of the operations without a
+  // parent.
+  void PrerollOps(PrerollContext* context,
+                  const SkMatrix& matrix,
+                  uint32_t begin,
+                  uint32_t end,
+                  PrerollStack* stack,
+                  bool allow_parallel);
+
+  void PushPrerollFrame(PrerollContext* context,
+                        PrerollStack* stack,
+                        uint32_t op,
+                        const SkMatrix& child_matrix,
+                        const SkRect& previous_cull_rect);
+
+  // Returns the index of the operation to preroll after |op|, which was just
+  // pushed onto |stack|: its first child, or the end of its subtree if its
+  // children were prerolled in parallel.
+  uint32_t PrerollChildren(PrerollContext* context,
+                           uint32_t op,
+                           PrerollStack* stack,
+                           bool allow_parallel);
+
+  bool ShouldPrerollInParallel(const PrerollContext* context,
+                               uint32_t op) const;
+
+  // Updates the paint bounds of |op| and folds them into the container being
+  // prerolled, like |ContainerLayer::PrerollChildren| does for each child.
+  void FinishPrerollOp(PrerollContext* context, PrerollStack* stack, Op& op);
+
+  void FinishPrerollFrame(PrerollContext* context, PrerollStack* stack);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(LayerDisplayList);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_LAYERS_LAYER_DISPLAY_LIST_H_
@@ -0,0 +1,207 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/utils/SkNWayCanvas.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr int kPicturesPerLevel = 4;
+
+// Builds a tree like the one of deeply nested scroll views: every level
+// translates and clips a few pictures and the next level.
+std::shared_ptr<ContainerLayer> BuildDeepTree(int64_t depth) {
+  sk_sp<SkPicture> picture =
+      SkPicture::MakePlaceholder(SkRect::MakeWH(100.0f, 20.0f));
+  auto root = std::make_shared<GroupLayer>();
+  std::shared_ptr<ContainerLayer> parent = root;
+  for (int64_t i = 0; i < depth; i++) {
+    auto transform =
+        std::make_shared<TransformLayer>(SkMatrix::MakeTrans(0.0f, 0.5f));
+    auto clip = std::make_shared<ClipRectLayer>(
+        SkRect::MakeWH(1000.0f, 2000.0f), Clip::hardEdge);
+    for (int j = 0; j < kPicturesPerLevel; j++) {
+      clip->Add(std::make_shared<PictureLayer>(
+          SkPoint::Make(0.0f, 20.0f * j),
+          SkiaGPUObject<SkPicture>(picture, nullptr), false, false));
+    }
+    transform->Add(clip);
+    parent->Add(transform);
+    parent = clip;
+  }
+  return root;
+}
+
+// Builds a tree like the one of a dashboard: a grid of |card_count| cards,
+// each with a shadow and a few pictures.
+std::shared_ptr<ContainerLayer> BuildWideTree(int64_t card_count) {
+  sk_sp<SkPicture> picture =
+      SkPicture::MakePlaceholder(SkRect::MakeWH(100.0f, 20.0f));
+  const SkPath card_path = SkPath().addRRect(
+      SkRRect::MakeRectXY(SkRect::MakeWH(100.0f, 100.0f), 8.0f, 8.0f));
+  auto root = std::make_shared<GroupLayer>();
+  for (int64_t i = 0; i < card_count; i++) {
+    auto transform = std::make_shared<TransformLayer>(
+        SkMatrix::MakeTrans(110.0f * (i % 8), 110.0f * (i / 8)));
+    auto card = std::make_shared<PhysicalShapeLayer>(
+        SK_ColorWHITE, SK_ColorBLACK, 4.0f, card_path, Clip::antiAlias);
+    for (int j = 0; j < kPicturesPerLevel; j++) {
+      card->Add(std::make_shared<PictureLayer>(
+          SkPoint::Make(0.0f, 20.0f * j),
+          SkiaGPUObject<SkPicture>(picture, nullptr), false, false));
+    }
+    transform->Add(card);
+    root->Add(transform);
+  }
+  return root;
+}
+
+// The contexts of a frame without a raster cache, painted to a canvas that
+// draws nothing.
+class Frame {
+ public:
+  Frame()
+      : canvas_(1000, 2000),
+        internal_nodes_canvas_(1000, 2000),
+        preroll_context_({
+            nullptr,            /* raster_cache */
+            nullptr,            /* gr_context */
+            nullptr,            /* external_view_embedder */
+            mutators_stack_,    /* mutators_stack */
+            nullptr,            /* dst_color_space */
+            kGiantRect,         /* cull_rect */
+            false,              /* layer reads from surface */
+            stopwatch_,         /* raster_time */
+            stopwatch_,         /* ui_time */
+            texture_registry_,  /* texture_registry */
+            false,              /* checkerboard_offscreen_layers */
+            100.0f,             /* frame_physical_depth */
+            1.0f,               /* frame_device_pixel_ratio */
+            0.0f,               /* total_elevation */
+            false,              /* has_platform_view */
+        }),
+        paint_context_({
+            &internal_nodes_canvas_, /* internal_nodes_canvas */
+            &canvas_,                /* leaf_nodes_canvas */
+            nullptr,                 /* gr_context */
+            nullptr,                 /* external_view_embedder */
+            stopwatch_,              /* raster_time */
+            stopwatch_,              /* ui_time */
+            texture_registry_,       /* texture_registry */
+            nullptr,                 /* raster_cache */
+            false,                   /* checkerboard_offscreen_layers */
+            100.0f,                  /* frame_physical_depth */
+            1.0f,                    /* frame_device_pixel_ratio */
+        }) {
+    internal_nodes_canvas_.addCanvas(&canvas_);
+  }
+
+  PrerollContext* preroll_context() { return &preroll_context_; }
+  Layer::PaintContext& paint_context() { return paint_context_; }
+
+ private:
+  MutatorsStack mutators_stack_;
+  const Stopwatch stopwatch_;
+  TextureRegistry texture_registry_;
+  SkNoDrawCanvas canvas_;
+  SkNWayCanvas internal_nodes_canvas_;
+  PrerollContext preroll_context_;
+  Layer::PaintContext paint_context_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Frame);
+};
+
+}  // namespace
+
+// The argument is the depth of the tree, see |BuildDeepTree|.
+
+static void BM_CompileDisplayList(benchmark::State& state) {
+  auto root = BuildDeepTree(state.range(0));
+  while (state.KeepRunning()) {
+    LayerDisplayList display_list(root.get());
+    benchmark::DoNotOptimize(display_list.op_count());
+  }
+}
+
+static void BM_PrerollRecursive(benchmark::State& state) {
+  auto root = BuildDeepTree(state.range(0));
+  Frame frame;
+  while (state.KeepRunning()) {
+    root->Preroll(frame.preroll_context(), SkMatrix::I());
+  }
+}
+
+static void BM_PrerollDisplayList(benchmark::State& state) {
+  auto root = BuildDeepTree(state.range(0));
+  LayerDisplayList display_list(root.get());
+  Frame frame;
+  while (state.KeepRunning()) {
+    display_list.Preroll(frame.preroll_context(), SkMatrix::I());
+  }
+}
+
+static void BM_PaintRecursive(benchmark::State& state) {
+  auto root = BuildDeepTree(state.range(0));
+  Frame frame;
+  root->Preroll(frame.preroll_context(), SkMatrix::I());
+  while (state.KeepRunning()) {
+    root->Paint(frame.paint_context());
+  }
+}
+
+static void BM_PaintDisplayList(benchmark::State& state) {
+  auto root = BuildDeepTree(state.range(0));
+  LayerDisplayList display_list(root.get());
+  Frame frame;
+  display_list.Preroll(frame.preroll_context(), SkMatrix::I());
+  while (state.KeepRunning()) {
+    display_list.Paint(frame.paint_context());
+  }
+}
+
+// The argument is the number of cards, see |BuildWideTree|.
+
+static void BM_PrerollWideSerial(benchmark::State& state) {
+  auto root = BuildWideTree(state.range(0));
+  LayerDisplayList display_list(root.get());
+  Frame frame;
+  while (state.KeepRunning()) {
+    display_list.Preroll(frame.preroll_context(), SkMatrix::I());
+  }
+}
+
+static void BM_PrerollWideParallel(benchmark::State& state) {
+  auto root = BuildWideTree(state.range(0));
+  LayerDisplayList display_list(root.get());
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  display_list.SetPrerollTaskRunner(loop->GetTaskRunner(),
+                                    loop->GetWorkerCount());
+  Frame frame;
+  while (state.KeepRunning()) {
+    display_list.Preroll(frame.preroll_context(), SkMatrix::I());
+  }
+}
+
+BENCHMARK(BM_CompileDisplayList)->Range(16, 1024);
+BENCHMARK(BM_PrerollRecursive)->Range(16, 1024);
+BENCHMARK(BM_PrerollDisplayList)->Range(16, 1024);
+BENCHMARK(BM_PaintRecursive)->Range(16, 1024);
+BENCHMARK(BM_PaintDisplayList)->Range(16, 1024);
+BENCHMARK(BM_PrerollWideSerial)->Range(16, 1024);
+BENCHMARK(BM_PrerollWideParallel)->Range(16, 1024);
+
+}  // namespace flutter
@@ -0,0 +1,327 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/flow/layers/layer_display_list.h"
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "flutter/flow/layers/clip_path_layer.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/clip_rrect_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/testing/mock_layer.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/testing/mock_canvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+namespace testing {
+
+class LayerDisplayListTest : public SkiaGPUObjectLayerTest {
+ public:
+  LayerDisplayListTest() = default;
+
+ protected:
+  struct TestTree {
+    std::shared_ptr<ContainerLayer> root;
+    // Every layer of the tree, in the order they were added.
+    std::vector<std::shared_ptr<Layer>> layers;
+    std::vector<std::shared_ptr<MockLayer>> mock_layers;
+  };
+
+  // Builds a tree with every kind of operation, including a clip that its
+  // children are outside of and a layer that can't be flattened.
+  TestTree BuildTree() {
+    TestTree tree;
+    auto add = [&tree](std::shared_ptr<ContainerLayer> parent, auto layer) {
+      parent->Add(layer);
+      tree.layers.push_back(layer);
+      return layer;
+    };
+    auto add_mock = [&tree, &add](std::shared_ptr<ContainerLayer> parent,
+                                  const SkRect& bounds,
+                                  bool fake_has_platform_view,
+                                  bool fake_needs_system_composite,
+                                  bool fake_reads_surface) {
+      auto layer = add(parent, std::make_shared<MockLayer>(
+                                   SkPath().addRect(bounds),
+                                   SkPaint(SkColors::kBlue),
+                                   fake_has_platform_view,
+                                   fake_needs_system_composite,
+                                   fake_reads_surface));
+      tree.mock_layers.push_back(layer);
+    };
+
+    tree.root = std::make_shared<GroupLayer>();
+    tree.layers.push_back(tree.root);
+    auto transform = add(tree.root, std::make_shared<TransformLayer>(
+                                        SkMatrix::MakeTrans(10.0f, 20.0f)));
+    auto clip_rect = add(transform, std::make_shared<ClipRectLayer>(
+                                        SkRect::MakeWH(50.0f, 50.0f),
+                                        Clip::antiAliasWithSaveLayer));
+    add_mock(clip_rect, SkRect::MakeLTRB(5.0f, 5.0f, 20.0f, 20.0f), false,
+             false, true);
+    add(clip_rect, std::make_shared<PictureLayer>(
+                       SkPoint::Make(5.0f, 6.0f),
+                       SkiaGPUObject(SkPicture::MakePlaceholder(
+                                         SkRect::MakeWH(30.0f, 30.0f)),
+                                     unref_queue()),
+                       false, false));
+    auto clip_path = add(
+        clip_rect,
+        std::make_shared<ClipPathLayer>(
+            SkPath().addRect(SkRect::MakeLTRB(100.0f, 100.0f, 150.0f, 150.0f)),
+            Clip::hardEdge));
+    add_mock(clip_path, SkRect::MakeLTRB(110.0f, 110.0f, 120.0f, 120.0f),
+             false, false, false);
+    auto clip_rrect = add(
+        transform, std::make_shared<ClipRRectLayer>(
+                       SkRRect::MakeRectXY(SkRect::MakeXYWH(60.0f, 0.0f, 40.0f,
+                                                            40.0f),
+                                           4.0f, 4.0f),
+                       Clip::antiAlias));
+    add_mock(clip_rrect, SkRect::MakeLTRB(50.0f, 10.0f, 80.0f, 30.0f), true,
+             false, false);
+    auto opacity = add(tree.root, std::make_shared<OpacityLayer>(
+                                      128, SkPoint::Make(1.0f, 2.0f)));
+    add_mock(opacity, SkRect::MakeLTRB(0.0f, 0.0f, 8.0f, 8.0f), false, true,
+             false);
+    return tree;
+  }
+
+  // Builds a tree with a clip wide and deep enough to be prerolled in
+  // parallel.
+  TestTree BuildWideTree() {
+    TestTree tree;
+    tree.root = std::make_shared<GroupLayer>();
+    tree.layers.push_back(tree.root);
+    auto clip = std::make_shared<ClipRectLayer>(SkRect::MakeWH(200.0f, 100.0f),
+                                                Clip::antiAliasWithSaveLayer);
+    tree.root->Add(clip);
+    tree.layers.push_back(clip);
+    for (int i = 0; i < 16; i++) {
+      auto transform = std::make_shared<TransformLayer>(
+          SkMatrix::MakeTrans(20.0f * i, 0.0f));
+      clip->Add(transform);
+      tree.layers.push_back(transform);
+      for (int j = 0; j < 4; j++) {
+        auto layer = std::make_shared<MockLayer>(
+            SkPath().addRect(SkRect::MakeXYWH(0.0f, 20.0f * j, 10.0f, 10.0f)),
+            SkPaint(SkColors::kBlue), i == 9 && j == 1, i == 3 && j == 0,
+            i == 5 && j == 2);
+        transform->Add(layer);
+        tree.layers.push_back(layer);
+        tree.mock_layers.push_back(layer);
+      }
+    }
+    EXPECT_GE(tree.layers.size() - 2,
+              LayerDisplayList::kMinParallelPrerollOps);
+    return tree;
+  }
+
+  // Checks that the layers of |actual| were prerolled like those of
+  // |expected|.
+  static void ExpectSamePrerollResults(const TestTree& actual,
+                                       const TestTree& expected) {
+    ASSERT_EQ(actual.layers.size(), expected.layers.size());
+    for (size_t i = 0; i < actual.layers.size(); i++) {
+      EXPECT_EQ(actual.layers[i]->paint_bounds(),
+                expected.layers[i]->paint_bounds());
+      EXPECT_EQ(actual.layers[i]->needs_system_composite(),
+                expected.layers[i]->needs_system_composite());
+    }
+    ASSERT_EQ(actual.mock_layers.size(), expected.mock_layers.size());
+    for (size_t i = 0; i < actual.mock_layers.size(); i++) {
+      const auto& actual_layer = actual.mock_layers[i];
+      const auto& expected_layer = expected.mock_layers[i];
+      EXPECT_EQ(actual_layer->parent_matrix(), expected_layer->parent_matrix());
+      EXPECT_EQ(actual_layer->parent_cull_rect(),
+                expected_layer->parent_cull_rect());
+      EXPECT_EQ(actual_layer->parent_mutators(),
+                expected_layer->parent_mutators());
+      EXPECT_EQ(actual_layer->parent_has_platform_view(),
+                expected_layer->parent_has_platform_view());
+    }
+  }
+
+ private:
+  FML_DISALLOW_COPY_AND_ASSIGN(LayerDisplayListTest);
+};
+
+TEST_F(LayerDisplayListTest, FlattensSupportedLayers) {
+  TestTree tree = BuildTree();
+  LayerDisplayList display_list(tree.root.get());
+
+  // The children of the opacity layer are prerolled and painted by the layer
+  // itself, so every layer but the last is an operation.
+  EXPECT_EQ(display_list.op_count(), tree.layers.size() - 1);
+}
+
+TEST_F(LayerDisplayListTest, RecordsOtherContainersAsSingleOperations) {
+  // A container that could do more than preroll and paint its children.
+  class CustomContainerLayer : public ContainerLayer {};
+
+  auto root = std::make_shared<GroupLayer>();
+  auto custom = std::make_shared<CustomContainerLayer>();
+  root->Add(custom);
+  auto group = std::make_shared<GroupLayer>();
+  custom->Add(group);
+  group->Add(std::make_shared<MockLayer>(SkPath(), SkPaint()));
+  custom->Add(std::make_shared<MockLayer>(SkPath(), SkPaint()));
+  LayerDisplayList display_list(root.get());
+
+  // The root and the custom container, which handles its own children.
+  EXPECT_EQ(display_list.op_count(), 2u);
+}
+
+TEST_F(LayerDisplayListTest, MatchesRecursivePrerollAndPaint) {
+  const SkMatrix initial_matrix = SkMatrix::MakeTrans(0.5f, 1.0f);
+
+  TestTree expected = BuildTree();
+  expected.root->Preroll(preroll_context(), initial_matrix);
+  const bool expected_surface_needs_readback =
+      preroll_context()->surface_needs_readback;
+  const bool expected_has_platform_view = preroll_context()->has_platform_view;
+  ASSERT_TRUE(expected.root->needs_painting());
+  expected.root->Paint(paint_context());
+
+  preroll_context()->surface_needs_readback = false;
+  preroll_context()->has_platform_view = false;
+  TestTree actual = BuildTree();
+  LayerDisplayList display_list(actual.root.get());
+  display_list.Preroll(preroll_context(), initial_matrix);
+  EXPECT_EQ(preroll_context()->surface_needs_readback,
+            expected_surface_needs_readback);
+  EXPECT_EQ(preroll_context()->has_platform_view, expected_has_platform_view);
+  EXPECT_TRUE(preroll_context()->mutators_stack.is_empty());
+  EXPECT_EQ(preroll_context()->cull_rect, kGiantRect);
+
+  MockCanvas canvas;
+  Layer::PaintContext paint_context = this->paint_context();
+  paint_context.internal_nodes_canvas = canvas.internal_canvas();
+  paint_context.leaf_nodes_canvas = &canvas;
+  display_list.Paint(paint_context);
+  EXPECT_EQ(canvas.draw_calls(), mock_canvas().draw_calls());
+
+  ExpectSamePrerollResults(actual, expected);
+}
+
+TEST_F(LayerDisplayListTest, SkipsChildrenOutsideClip) {
+  TestTree tree = BuildTree();
+  LayerDisplayList display_list(tree.root.get());
+  display_list.Preroll(preroll_context(), SkMatrix());
+
+  // The child of the clip path layer is outside of the enclosing clip rect.
+  const auto& outside_layer = tree.mock_layers[1];
+  EXPECT_FALSE(outside_layer->needs_painting());
+  EXPECT_EQ(outside_layer->parent_cull_rect(), kEmptyRect);
+
+  display_list.Paint(paint_context());
+  for (const auto& draw_call : mock_canvas().draw_calls()) {
+    if (auto* draw_path = std::get_if<MockCanvas::DrawPathData>(
+            &draw_call.data)) {
+      EXPECT_NE(draw_path->path.getBounds(),
+                SkRect::MakeLTRB(110.0f, 110.0f, 120.0f, 120.0f));
+    }
+  }
+}
+
+TEST_F(LayerDisplayListTest, ParallelPrerollMatchesSerialPreroll) {
+  TestTree expected = BuildWideTree();
+  LayerDisplayList serial_display_list(expected.root.get());
+  serial_display_list.Preroll(preroll_context(), SkMatrix());
+  const bool expected_surface_needs_readback =
+      preroll_context()->surface_needs_readback;
+  const bool expected_has_platform_view = preroll_context()->has_platform_view;
+  EXPECT_TRUE(expected_surface_needs_readback);
+  EXPECT_TRUE(expected_has_platform_view);
+  serial_display_list.Paint(paint_context());
+
+  preroll_context()->surface_needs_readback = false;
+  preroll_context()->has_platform_view = false;
+  TestTree actual = BuildWideTree();
+  LayerDisplayList display_list(actual.root.get());
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  display_list.SetPrerollTaskRunner(loop->GetTaskRunner(),
+                                    loop->GetWorkerCount());
+  display_list.Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(preroll_context()->surface_needs_readback,
+            expected_surface_needs_readback);
+  EXPECT_EQ(preroll_context()->has_platform_view, expected_has_platform_view);
+  EXPECT_TRUE(preroll_context()->mutators_stack.is_empty());
+  EXPECT_EQ(preroll_context()->cull_rect, kGiantRect);
+
+  MockCanvas canvas;
+  Layer::PaintContext paint_context = this->paint_context();
+  paint_context.internal_nodes_canvas = canvas.internal_canvas();
+  paint_context.leaf_nodes_canvas = &canvas;
+  display_list.Paint(paint_context);
+  EXPECT_EQ(canvas.draw_calls(), mock_canvas().draw_calls());
+
+  ExpectSamePrerollResults(actual, expected);
+}
+
+TEST_F(LayerDisplayListTest, ParallelPrerollPreparesRasterCacheInOrder) {
+  // More pictures are worth caching than can be cached in a frame, so the
+  // pictures that end up cached depend on the order of the calls to
+  // |RasterCache::Prepare|.
+  auto root = std::make_shared<GroupLayer>();
+  std::vector<sk_sp<SkPicture>> pictures;
+  for (int i = 0; i < 40; i++) {
+    auto transform = std::make_shared<TransformLayer>(
+        SkMatrix::MakeTrans(0.0f, 10.0f * i));
+    pictures.push_back(
+        SkPicture::MakePlaceholder(SkRect::MakeWH(100.0f, 10.0f)));
+    transform->Add(std::make_shared<PictureLayer>(
+        SkPoint::Make(0.0f, 0.0f),
+        SkiaGPUObject(pictures.back(), unref_queue()), true, false));
+    root->Add(transform);
+  }
+  LayerDisplayList display_list(root.get());
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  // Cached pictures are drawn as images, which the mock canvas doesn't
+  // support.
+  SkNoDrawCanvas canvas(100, 400);
+  RasterCache serial_cache(1, 3);
+  RasterCache parallel_cache(1, 3);
+  for (int frame = 0; frame < 3; frame++) {
+    for (RasterCache* cache : {&serial_cache, &parallel_cache}) {
+      display_list.SetPrerollTaskRunner(
+          cache == &parallel_cache ? loop->GetTaskRunner() : nullptr,
+          loop->GetWorkerCount());
+      preroll_context()->raster_cache = cache;
+      display_list.Preroll(preroll_context(), SkMatrix());
+      Layer::PaintContext paint_context = this->paint_context();
+      paint_context.internal_nodes_canvas = &canvas;
+      paint_context.leaf_nodes_canvas = &canvas;
+      paint_context.raster_cache = cache;
+      display_list.Paint(paint_context);
+      cache->SweepAfterFrame();
+    }
+  }
+
+  size_t cached_count = 0;
+  for (int i = 0; i < 40; i++) {
+    const SkMatrix ctm = SkMatrix::MakeTrans(0.0f, 10.0f * i);
+    const bool cached = serial_cache.HasValidEntry(*pictures[i], ctm);
+    EXPECT_EQ(parallel_cache.HasValidEntry(*pictures[i], ctm), cached);
+    cached_count += cached ? 1 : 0;
+  }
+  EXPECT_GT(cached_count, 0u);
+  EXPECT_LT(cached_count, pictures.size());
+}
+
+}  // namespace testing
+}  // namespace flutter
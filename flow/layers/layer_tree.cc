@@ -4,7 +4,9 @@
 
 #include "flutter/flow/layers/layer_tree.h"
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/layers/layer.h"
+#include "flutter/fml/hash_combine.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
 #include "third_party/skia/include/utils/SkNWayCanvas.h"
@@ -55,10 +57,20 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame_physical_depth_,
       frame_device_pixel_ratio_};
 
-  root_layer_->Preroll(&context, frame.root_surface_transformation());
+  LayerDisplayList& display_list = GetDisplayList();
+  display_list.SetPrerollTaskRunner(frame.context().preroll_task_runner(),
+                                    frame.context().preroll_helper_count());
+  display_list.Preroll(&context, frame.root_surface_transformation());
   return context.surface_needs_readback;
 }
 
+LayerDisplayList& LayerTree::GetDisplayList() {
+  if (!display_list_) {
+    display_list_ = std::make_unique<LayerDisplayList>(root_layer_.get());
+  }
+  return *display_list_;
+}
+
 #if defined(OS_FUCHSIA)
 void LayerTree::UpdateScene(SceneUpdateContext& context,
                             scenic::ContainerNode& container) {
@@ -126,8 +138,31 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
       frame_physical_depth_,
       frame_device_pixel_ratio_};
 
-  if (root_layer_->needs_painting())
-    root_layer_->Paint(context);
+  if (root_layer_->needs_painting()) {
+    if (display_list_) {
+      display_list_->Paint(context);
+    } else {
+      root_layer_->Paint(context);
+    }
+  }
+}
+
+void LayerTree::Diff(DiffContext* context) const {
+  TRACE_EVENT0("flutter", "LayerTree::Diff");
+
+  if (!root_layer_ || !root_layer_->needs_painting()) {
+    return;
+  }
+
+  // The checkerboard of each offscreen layer gets a new color on every frame.
+  if (checkerboard_offscreen_layers_) {
+    context->MarkFullDamage();
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->FoldState(
+      fml::HashCombine(frame_physical_depth_, frame_device_pixel_ratio_));
+  root_layer_->Diff(context);
 }
 
 sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
@@ -184,10 +219,11 @@ sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
   // Even if we don't have a root layer, we still need to create an empty
   // picture.
   if (root_layer_) {
-    root_layer_->Preroll(&preroll_context, root_surface_transformation);
+    LayerDisplayList& display_list = GetDisplayList();
+    display_list.Preroll(&preroll_context, root_surface_transformation);
     // The needs painting flag may be set after the preroll. So check it after.
     if (root_layer_->needs_painting()) {
-      root_layer_->Paint(paint_context);
+      display_list.Paint(paint_context);
     }
   }
 
@@ -11,6 +11,7 @@
 
 #include "flutter/flow/compositor_context.h"
 #include "flutter/flow/layers/layer.h"
+#include "flutter/flow/layers/layer_display_list.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_delta.h"
 #include "third_party/skia/include/core/SkPicture.h"
@@ -42,12 +43,17 @@ class LayerTree {
   void Paint(CompositorContext::ScopedFrame& frame,
              bool ignore_raster_cache = false) const;
 
+  // Collects the regions of the frame painted by the tree for damage
+  // tracking. Must be called after Preroll.
+  void Diff(DiffContext* context) const;
+
   sk_sp<SkPicture> Flatten(const SkRect& bounds);
 
   Layer* root_layer() const { return root_layer_.get(); }
 
   void set_root_layer(std::shared_ptr<Layer> root_layer) {
     root_layer_ = std::move(root_layer);
+    display_list_.reset();
   }
 
   const SkISize& frame_size() const { return frame_size_; }
@@ -82,6 +88,8 @@ class LayerTree {
 
  private:
   std::shared_ptr<Layer> root_layer_;
+  // The root layer compiled for the raster thread, on the first preroll.
+  std::unique_ptr<LayerDisplayList> display_list_;
   fml::TimePoint build_start_;
   fml::TimePoint build_finish_;
   SkISize frame_size_ = SkISize::MakeEmpty();  // Physical pixels.
@@ -91,6 +99,8 @@ class LayerTree {
   bool checkerboard_raster_cache_images_;
   bool checkerboard_offscreen_layers_;
 
+  LayerDisplayList& GetDisplayList();
+
   FML_DISALLOW_COPY_AND_ASSIGN(LayerTree);
 };
 
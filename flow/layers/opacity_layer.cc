@@ -4,6 +4,9 @@
 
 #include "flutter/flow/layers/opacity_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkPaint.h"
 
@@ -22,8 +25,8 @@ OpacityLayer::OpacityLayer(SkAlpha alpha, const SkPoint& offset)
   // save the costly saveLayer.
   //
   // Any children will be actually added as children of this empty
-  // ContainerLayer.
-  ContainerLayer::Add(std::make_shared<ContainerLayer>());
+  // GroupLayer.
+  ContainerLayer::Add(std::make_shared<GroupLayer>());
 }
 
 void OpacityLayer::Add(std::shared_ptr<Layer> layer) {
@@ -120,6 +123,26 @@ void OpacityLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void OpacityLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->Translate(offset_.fX, offset_.fY);
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  context->SetMatrix(RasterCache::GetIntegralTransCTM(context->matrix()));
+#endif
+
+  // Drawing the cached children is not pixel-identical to painting them.
+  const bool is_cached =
+      context->raster_cache() &&
+      context->raster_cache()->HasValidEntry(GetChildContainer(),
+                                             context->matrix());
+  context->FoldState(fml::HashCombine(alpha_, is_cached));
+  DiffChildren(context);
+}
+
+void OpacityLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 #if defined(OS_FUCHSIA)
 
 void OpacityLayer::UpdateScene(SceneUpdateContext& context) {
@@ -4,14 +4,14 @@
 
 #include "flutter/flow/layers/physical_shape_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
 #include "flutter/flow/paint_utils.h"
+#include "flutter/fml/hash_combine.h"
 #include "third_party/skia/include/utils/SkShadowUtils.h"
 
 namespace flutter {
 
-const SkScalar kLightHeight = 600;
-const SkScalar kLightRadius = 800;
-
 PhysicalShapeLayer::PhysicalShapeLayer(SkColor color,
                                        SkColor shadow_color,
                                        float elevation,
@@ -56,6 +56,7 @@ void PhysicalShapeLayer::Preroll(PrerollContext* context,
   PrerollChildren(context, matrix, &child_paint_bounds);
   context->total_elevation -= elevation_;
 
+  shadow_cache_key_.reset();
   if (elevation_ == 0) {
     set_paint_bounds(path_.getBounds());
   } else {
@@ -68,6 +69,14 @@ void PhysicalShapeLayer::Preroll(PrerollContext* context,
     // children to it so we don't need to join the child paint bounds.
     set_paint_bounds(ComputeShadowBounds(path_.getBounds(), elevation_,
                                          context->frame_device_pixel_ratio));
+    if (context->raster_cache) {
+      shadow_cache_key_ = context->raster_cache->GetShadowKey(
+          path_, matrix, shadow_color_, elevation_, SkColorGetA(color_) != 0xff,
+          context->frame_device_pixel_ratio);
+      if (shadow_cache_key_) {
+        context->raster_cache->PrepareShadow(context, *shadow_cache_key_);
+      }
+    }
 #endif  // defined(OS_FUCHSIA)
   }
 }
@@ -111,8 +120,14 @@ void PhysicalShapeLayer::Paint(PaintContext& context) const {
   FML_DCHECK(needs_painting());
 
   if (elevation_ != 0) {
-    DrawShadow(context.leaf_nodes_canvas, path_, shadow_color_, elevation_,
-               SkColorGetA(color_) != 0xff, context.frame_device_pixel_ratio);
+    const bool transparent_occluder = SkColorGetA(color_) != 0xff;
+    if (!context.raster_cache || !shadow_cache_key_ ||
+        !context.raster_cache->DrawShadow(*context.leaf_nodes_canvas,
+                                          *shadow_cache_key_,
+                                          path_.getBounds())) {
+      DrawShadow(context.leaf_nodes_canvas, path_, shadow_color_, elevation_,
+                 transparent_occluder, context.frame_device_pixel_ratio);
+    }
   }
 
   // Call drawPath without clip if possible for better performance.
@@ -152,6 +167,25 @@ void PhysicalShapeLayer::Paint(PaintContext& context) const {
   context.internal_nodes_canvas->restoreToCount(saveCount);
 }
 
+void PhysicalShapeLayer::Diff(DiffContext* context) const {
+  // The paint bounds include the shadow.
+  const uint64_t shape_hash = fml::HashCombine(
+      DiffContext::HashPath(path_), color_, shadow_color_, elevation_,
+      static_cast<int>(clip_behavior_));
+  context->AddPaintRegion(paint_bounds(), shape_hash);
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  if (clip_behavior_ != Clip::none) {
+    context->ClipRect(path_.getBounds());
+    context->FoldState(shape_hash);
+  }
+  DiffChildren(context);
+}
+
+void PhysicalShapeLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 SkRect PhysicalShapeLayer::ComputeShadowBounds(const SkRect& bounds,
                                                float elevation,
                                                float pixel_ratio) {
@@ -202,6 +236,17 @@ void PhysicalShapeLayer::DrawShadow(SkCanvas* canvas,
                                     float elevation,
                                     bool transparentOccluder,
                                     SkScalar dpr) {
+  DrawShadow(canvas, path, color, elevation, transparentOccluder, dpr,
+             SkVector::Make(0, 0));
+}
+
+void PhysicalShapeLayer::DrawShadow(SkCanvas* canvas,
+                                    const SkPath& path,
+                                    SkColor color,
+                                    float elevation,
+                                    bool transparentOccluder,
+                                    SkScalar dpr,
+                                    const SkVector& light_offset) {
   const SkScalar kAmbientAlpha = 0.039f;
   const SkScalar kSpotAlpha = 0.25f;
 
@@ -209,8 +254,8 @@ void PhysicalShapeLayer::DrawShadow(SkCanvas* canvas,
                             ? SkShadowFlags::kTransparentOccluder_ShadowFlag
                             : SkShadowFlags::kNone_ShadowFlag;
   const SkRect& bounds = path.getBounds();
-  SkScalar shadow_x = (bounds.left() + bounds.right()) / 2;
-  SkScalar shadow_y = bounds.top() - 600.0f;
+  SkScalar shadow_x = (bounds.left() + bounds.right()) / 2 + light_offset.x();
+  SkScalar shadow_y = bounds.top() - 600.0f + light_offset.y();
   SkColor inAmbient = SkColorSetA(color, kAmbientAlpha * SkColorGetA(color));
   SkColor inSpot = SkColorSetA(color, kSpotAlpha * SkColorGetA(color));
   SkColor ambientColor, spotColor;
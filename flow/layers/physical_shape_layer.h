@@ -5,7 +5,10 @@
 #ifndef FLUTTER_FLOW_LAYERS_PHYSICAL_SHAPE_LAYER_H_
 #define FLUTTER_FLOW_LAYERS_PHYSICAL_SHAPE_LAYER_H_
 
+#include <optional>
+
 #include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/raster_cache_key.h"
 
 namespace flutter {
 
@@ -17,6 +20,11 @@ class PhysicalShapeLayer : public ContainerLayer {
                      const SkPath& path,
                      Clip clip_behavior);
 
+  // The light that casts the shadows, in logical pixels. It is positioned in
+  // device coordinates, above the top of the shape.
+  static constexpr SkScalar kLightHeight = 600;
+  static constexpr SkScalar kLightRadius = 800;
+
   static SkRect ComputeShadowBounds(const SkRect& bounds,
                                     float elevation,
                                     float pixel_ratio);
@@ -26,11 +34,25 @@ class PhysicalShapeLayer : public ContainerLayer {
                          float elevation,
                          bool transparentOccluder,
                          SkScalar dpr);
+  // Like the above, with the light moved by |light_offset| in device
+  // coordinates. Used to draw the shadow of a path as it would look
+  // somewhere else on the canvas.
+  static void DrawShadow(SkCanvas* canvas,
+                         const SkPath& path,
+                         SkColor color,
+                         float elevation,
+                         bool transparentOccluder,
+                         SkScalar dpr,
+                         const SkVector& light_offset);
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
+  void AddToDisplayList(LayerDisplayList* display_list) override;
+
   bool UsesSaveLayer() const {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
@@ -50,6 +72,8 @@ class PhysicalShapeLayer : public ContainerLayer {
   bool isRect_;
   SkRRect frameRRect_;
   Clip clip_behavior_;
+  // The raster cache key of the shadow, made in |Preroll| for the frame.
+  std::optional<ShadowRasterCacheKey> shadow_cache_key_;
 };
 
 }  // namespace flutter
@@ -0,0 +1,140 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/raster_cache.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/utils/SkNWayCanvas.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr int kCardColumns = 8;
+constexpr int kCardRows = 16;
+constexpr SkScalar kCardSize = 100.0f;
+constexpr SkScalar kCardSpacing = 120.0f;
+constexpr int kWidth = static_cast<int>(kCardColumns * kCardSpacing);
+constexpr int kHeight = static_cast<int>(kCardRows * kCardSpacing);
+
+// Builds a tree like the one of a scrolled grid of |card_count| elevated
+// cards. Like the framework does, the cards are positioned by their paths
+// rather than by transforms. Past |kCardRows| rows, cards are stacked on top
+// of the earlier ones.
+std::shared_ptr<ContainerLayer> BuildCardGrid(int64_t card_count) {
+  auto root = std::make_shared<GroupLayer>();
+  auto scroll =
+      std::make_shared<TransformLayer>(SkMatrix::MakeTrans(0.0f, -40.0f));
+  for (int64_t i = 0; i < card_count; i++) {
+    const SkRect card_rect =
+        SkRect::MakeXYWH(kCardSpacing * (i % kCardColumns),
+                         kCardSpacing * ((i / kCardColumns) % kCardRows),
+                         kCardSize, kCardSize);
+    scroll->Add(std::make_shared<PhysicalShapeLayer>(
+        SK_ColorWHITE, SK_ColorBLACK, 8.0f,
+        SkPath().addRRect(SkRRect::MakeRectXY(card_rect, 8.0f, 8.0f)),
+        Clip::none));
+  }
+  root->Add(scroll);
+  return root;
+}
+
+// The contexts of a frame painted to a raster surface, with |raster_cache|
+// if it is not null.
+class Frame {
+ public:
+  explicit Frame(RasterCache* raster_cache)
+      : raster_cache_(raster_cache),
+        surface_(SkSurface::MakeRasterN32Premul(kWidth, kHeight)),
+        internal_nodes_canvas_(kWidth, kHeight),
+        preroll_context_({
+            raster_cache,       /* raster_cache */
+            nullptr,            /* gr_context */
+            nullptr,            /* external_view_embedder */
+            mutators_stack_,    /* mutators_stack */
+            nullptr,            /* dst_color_space */
+            kGiantRect,         /* cull_rect */
+            false,              /* layer reads from surface */
+            stopwatch_,         /* raster_time */
+            stopwatch_,         /* ui_time */
+            texture_registry_,  /* texture_registry */
+            false,              /* checkerboard_offscreen_layers */
+            100.0f,             /* frame_physical_depth */
+            1.0f,               /* frame_device_pixel_ratio */
+            0.0f,               /* total_elevation */
+            false,              /* has_platform_view */
+        }),
+        paint_context_({
+            &internal_nodes_canvas_, /* internal_nodes_canvas */
+            surface_->getCanvas(),   /* leaf_nodes_canvas */
+            nullptr,                 /* gr_context */
+            nullptr,                 /* external_view_embedder */
+            stopwatch_,              /* raster_time */
+            stopwatch_,              /* ui_time */
+            texture_registry_,       /* texture_registry */
+            raster_cache,            /* raster_cache */
+            false,                   /* checkerboard_offscreen_layers */
+            100.0f,                  /* frame_physical_depth */
+            1.0f,                    /* frame_device_pixel_ratio */
+        }) {
+    internal_nodes_canvas_.addCanvas(surface_->getCanvas());
+  }
+
+  void Draw(Layer* root) {
+    root->Preroll(&preroll_context_, SkMatrix::I());
+    root->Paint(paint_context_);
+    if (raster_cache_) {
+      raster_cache_->SweepAfterFrame();
+    }
+  }
+
+ private:
+  RasterCache* raster_cache_;
+  MutatorsStack mutators_stack_;
+  const Stopwatch stopwatch_;
+  TextureRegistry texture_registry_;
+  sk_sp<SkSurface> surface_;
+  SkNWayCanvas internal_nodes_canvas_;
+  PrerollContext preroll_context_;
+  Layer::PaintContext paint_context_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Frame);
+};
+
+}  // namespace
+
+// The argument is the number of cards, see |BuildCardGrid|.
+
+static void BM_DrawElevatedCards(benchmark::State& state) {
+  auto root = BuildCardGrid(state.range(0));
+  Frame frame(nullptr);
+  while (state.KeepRunning()) {
+    frame.Draw(root.get());
+  }
+}
+
+static void BM_DrawElevatedCardsCached(benchmark::State& state) {
+  auto root = BuildCardGrid(state.range(0));
+  RasterCache raster_cache;
+  Frame frame(&raster_cache);
+  // Past the access threshold, so that the shadows are cached.
+  for (int i = 0; i < 4; i++) {
+    frame.Draw(root.get());
+  }
+  while (state.KeepRunning()) {
+    frame.Draw(root.get());
+  }
+  state.counters["CachedShadows"] = raster_cache.GetCachedEntriesCount();
+}
+
+BENCHMARK(BM_DrawElevatedCards)->Range(16, 1024);
+BENCHMARK(BM_DrawElevatedCardsCached)->Range(16, 1024);
+
+}  // namespace flutter
@@ -4,6 +4,9 @@
 
 #include "flutter/flow/layers/picture_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
 #include "flutter/fml/logging.h"
 
 namespace flutter {
@@ -19,22 +22,28 @@ PictureLayer::PictureLayer(const SkPoint& offset,
 
 void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "PictureLayer::Preroll");
-  SkPicture* sk_picture = picture();
+  set_paint_bounds(PrerollPicture(context, matrix, picture(), offset_,
+                                  is_complex_, will_change_));
+}
 
+SkRect PictureLayer::PrerollPicture(PrerollContext* context,
+                                    const SkMatrix& matrix,
+                                    SkPicture* picture,
+                                    const SkPoint& offset,
+                                    bool is_complex,
+                                    bool will_change) {
   if (auto* cache = context->raster_cache) {
     TRACE_EVENT0("flutter", "PictureLayer::RasterCache (Preroll)");
 
     SkMatrix ctm = matrix;
-    ctm.postTranslate(offset_.x(), offset_.y());
+    ctm.postTranslate(offset.x(), offset.y());
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     ctm = RasterCache::GetIntegralTransCTM(ctm);
 #endif
-    cache->Prepare(context->gr_context, sk_picture, ctm,
-                   context->dst_color_space, is_complex_, will_change_);
+    cache->Prepare(context, picture, ctm, is_complex, will_change);
   }
 
-  SkRect bounds = sk_picture->cullRect().makeOffset(offset_.x(), offset_.y());
-  set_paint_bounds(bounds);
+  return picture->cullRect().makeOffset(offset.x(), offset.y());
 }
 
 void PictureLayer::Paint(PaintContext& context) const {
@@ -42,8 +51,14 @@ void PictureLayer::Paint(PaintContext& context) const {
   FML_DCHECK(picture_.get());
   FML_DCHECK(needs_painting());
 
+  PaintPicture(context, picture(), offset_);
+}
+
+void PictureLayer::PaintPicture(PaintContext& context,
+                                SkPicture* picture,
+                                const SkPoint& offset) {
   SkAutoCanvasRestore save(context.leaf_nodes_canvas, true);
-  context.leaf_nodes_canvas->translate(offset_.x(), offset_.y());
+  context.leaf_nodes_canvas->translate(offset.x(), offset.y());
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
   context.leaf_nodes_canvas->setMatrix(RasterCache::GetIntegralTransCTM(
       context.leaf_nodes_canvas->getTotalMatrix()));
@@ -51,7 +66,7 @@ void PictureLayer::Paint(PaintContext& context) const {
 
   if (context.raster_cache) {
     const SkMatrix& ctm = context.leaf_nodes_canvas->getTotalMatrix();
-    RasterCacheResult result = context.raster_cache->Get(*picture(), ctm);
+    RasterCacheResult result = context.raster_cache->Get(*picture, ctm);
     if (result.is_valid()) {
       TRACE_EVENT_INSTANT0("flutter", "raster cache hit");
 
@@ -59,7 +74,27 @@ void PictureLayer::Paint(PaintContext& context) const {
       return;
     }
   }
-  context.leaf_nodes_canvas->drawPicture(picture());
+  context.leaf_nodes_canvas->drawPicture(picture);
+}
+
+void PictureLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->Translate(offset_.x(), offset_.y());
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  context->SetMatrix(RasterCache::GetIntegralTransCTM(context->matrix()));
+#endif
+
+  // Drawing the cached picture is not pixel-identical to drawing the picture.
+  const bool is_cached =
+      context->raster_cache() &&
+      context->raster_cache()->HasValidEntry(*picture(), context->matrix());
+  context->AddPaintRegion(picture()->cullRect(),
+                          fml::HashCombine(picture()->uniqueID(), is_cached));
+}
+
+void PictureLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddPicture(this, picture(), offset_, is_complex_,
+                           will_change_);
 }
 
 }  // namespace flutter
@@ -26,6 +26,25 @@ class PictureLayer : public Layer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
+  void AddToDisplayList(LayerDisplayList* display_list) override;
+
+  // Prepares the raster cache for |picture| drawn at |offset| and returns its
+  // paint bounds. Shared with |LayerDisplayList|.
+  static SkRect PrerollPicture(PrerollContext* context,
+                               const SkMatrix& matrix,
+                               SkPicture* picture,
+                               const SkPoint& offset,
+                               bool is_complex,
+                               bool will_change);
+
+  // Draws |picture| at |offset|, from the raster cache if possible. Shared
+  // with |LayerDisplayList|.
+  static void PaintPicture(PaintContext& context,
+                           SkPicture* picture,
+                           const SkPoint& offset);
+
  private:
   SkPoint offset_;
   // Even though pictures themselves are not GPU resources, they may reference
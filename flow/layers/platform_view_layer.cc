@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/platform_view_layer.h"
 
+#include "flutter/flow/diff_context.h"
+
 namespace flutter {
 
 PlatformViewLayer::PlatformViewLayer(const SkPoint& offset,
@@ -41,4 +43,10 @@ void PlatformViewLayer::Paint(PaintContext& context) const {
   SkCanvas* canvas = context.view_embedder->CompositeEmbeddedView(view_id_);
   context.leaf_nodes_canvas = canvas;
 }
+
+void PlatformViewLayer::Diff(DiffContext* context) const {
+  // The overlays of the view embedder are not retained across frames.
+  context->MarkFullDamage();
+  Layer::Diff(context);
+}
 }  // namespace flutter
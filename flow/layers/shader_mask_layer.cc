@@ -4,6 +4,10 @@
 
 #include "flutter/flow/layers/shader_mask_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
 ShaderMaskLayer::ShaderMaskLayer(sk_sp<SkShader> shader,
@@ -33,4 +37,22 @@ void ShaderMaskLayer::Paint(PaintContext& context) const {
       SkRect::MakeWH(mask_rect_.width(), mask_rect_.height()), paint);
 }
 
+void ShaderMaskLayer::Diff(DiffContext* context) const {
+  // The mask applies to each pixel of the save layer independently, but it
+  // may also paint the parts of the layer that the children do not cover.
+  const uint64_t mask_hash = fml::HashCombine(
+      DiffContext::HashFlattenable(shader_.get()),
+      DiffContext::HashBytes(&mask_rect_, sizeof(mask_rect_)),
+      static_cast<int>(blend_mode_));
+  context->AddPaintRegion(paint_bounds(), mask_hash);
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->FoldState(mask_hash);
+  DiffChildren(context);
+}
+
+void ShaderMaskLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->AddLayer(this);
+}
+
 }  // namespace flutter
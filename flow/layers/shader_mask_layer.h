@@ -21,6 +21,10 @@ class ShaderMaskLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context) const override;
+
+  void AddToDisplayList(LayerDisplayList* display_list) override;
+
  private:
   sk_sp<SkShader> shader_;
   SkRect mask_rect_;
@@ -4,6 +4,9 @@
 
 #include "flutter/flow/layers/transform_layer.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/flow/layers/layer_display_list.h"
+
 namespace flutter {
 
 TransformLayer::TransformLayer(const SkMatrix& transform)
@@ -72,4 +75,16 @@ void TransformLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void TransformLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->Concat(transform_);
+  DiffChildren(context);
+}
+
+void TransformLayer::AddToDisplayList(LayerDisplayList* display_list) {
+  display_list->PushTransform(this, transform_);
+  AddChildrenToDisplayList(display_list);
+  display_list->Pop();
+}
+
 }  // namespace flutter
@@ -0,0 +1,235 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/off_thread_rasterization.h"
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkShader.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+
+namespace {
+
+class OffThreadRasterizationChecker final : public SkNoDrawCanvas {
+ public:
+  OffThreadRasterizationChecker(int width, int height)
+      : SkNoDrawCanvas(width, height) {}
+
+  bool can_rasterize_off_thread() const { return can_rasterize_off_thread_; }
+
+ protected:
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    CheckPaint(rec.fPaint);
+    if (rec.fBackdrop) {
+      can_rasterize_off_thread_ = false;
+    }
+    return SkNoDrawCanvas::getSaveLayerStrategy(rec);
+  }
+
+  void onDrawPaint(const SkPaint& paint) override { CheckPaint(&paint); }
+
+  void onDrawBehind(const SkPaint& paint) override { CheckPaint(&paint); }
+
+  void onDrawPoints(PointMode,
+                    size_t,
+                    const SkPoint[],
+                    const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawRect(const SkRect&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawRegion(const SkRegion&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawOval(const SkRect&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawArc(const SkRect&,
+                 SkScalar,
+                 SkScalar,
+                 bool,
+                 const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawRRect(const SkRRect&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawDRRect(const SkRRect&,
+                    const SkRRect&,
+                    const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawPath(const SkPath&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawTextBlob(const SkTextBlob*,
+                      SkScalar,
+                      SkScalar,
+                      const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawPatch(const SkPoint[12],
+                   const SkColor[4],
+                   const SkPoint[4],
+                   SkBlendMode,
+                   const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawVerticesObject(const SkVertices*,
+                            const SkVertices::Bone[],
+                            int,
+                            SkBlendMode,
+                            const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  void onDrawBitmap(const SkBitmap&,
+                    SkScalar,
+                    SkScalar,
+                    const SkPaint* paint) override {
+    CheckPaint(paint);
+  }
+
+  void onDrawBitmapRect(const SkBitmap&,
+                        const SkRect*,
+                        const SkRect&,
+                        const SkPaint* paint,
+                        SrcRectConstraint) override {
+    CheckPaint(paint);
+  }
+
+  void onDrawBitmapNine(const SkBitmap&,
+                        const SkIRect&,
+                        const SkRect&,
+                        const SkPaint* paint) override {
+    CheckPaint(paint);
+  }
+
+  void onDrawBitmapLattice(const SkBitmap&,
+                           const Lattice&,
+                           const SkRect&,
+                           const SkPaint* paint) override {
+    CheckPaint(paint);
+  }
+
+  void onDrawImage(const SkImage* image,
+                   SkScalar,
+                   SkScalar,
+                   const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  void onDrawImageRect(const SkImage* image,
+                       const SkRect*,
+                       const SkRect&,
+                       const SkPaint* paint,
+                       SrcRectConstraint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  void onDrawImageNine(const SkImage* image,
+                       const SkIRect&,
+                       const SkRect&,
+                       const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  void onDrawImageLattice(const SkImage* image,
+                          const Lattice&,
+                          const SkRect&,
+                          const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  void onDrawAtlas(const SkImage* image,
+                   const SkRSXform[],
+                   const SkRect[],
+                   const SkColor[],
+                   int,
+                   SkBlendMode,
+                   const SkRect*,
+                   const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  void onDrawEdgeAAImageSet(const ImageSetEntry set[],
+                            int count,
+                            const SkPoint[],
+                            const SkMatrix[],
+                            const SkPaint* paint,
+                            SrcRectConstraint) override {
+    for (int i = 0; i < count; i++) {
+      CheckImage(set[i].fImage.get());
+    }
+    CheckPaint(paint);
+  }
+
+  void onDrawDrawable(SkDrawable*, const SkMatrix*) override {
+    // Drawables may draw anything at playback time.
+    can_rasterize_off_thread_ = false;
+  }
+
+ private:
+  bool can_rasterize_off_thread_ = true;
+
+  void CheckImage(const SkImage* image) {
+    if (image != nullptr && image->isTextureBacked()) {
+      can_rasterize_off_thread_ = false;
+    }
+  }
+
+  void CheckPaint(const SkPaint* paint) {
+    if (paint == nullptr) {
+      return;
+    }
+    if (paint->getImageFilter() != nullptr) {
+      can_rasterize_off_thread_ = false;
+    }
+    if (const SkShader* shader = paint->getShader()) {
+      if (SkImage* image = shader->isAImage(nullptr, nullptr)) {
+        CheckImage(image);
+      } else if (shader->asAGradient(nullptr) ==
+                 SkShader::kNone_GradientType) {
+        // Picture shaders, compose shaders, ...
+        can_rasterize_off_thread_ = false;
+      }
+    }
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(OffThreadRasterizationChecker);
+};
+
+}  // namespace
+
+bool CanRasterizeOffThread(const SkPicture& picture) {
+  // Large enough that no operation is culled that could touch the pixels of
+  // the picture at any scale the raster cache would use.
+  constexpr int kCheckerSize = 1 << 24;
+  OffThreadRasterizationChecker checker(kCheckerSize, kCheckerSize);
+  const SkRect cull_rect = picture.cullRect();
+  checker.translate(kCheckerSize / 2 - cull_rect.centerX(),
+                    kCheckerSize / 2 - cull_rect.centerY());
+  picture.playback(&checker);
+  return checker.can_rasterize_off_thread();
+}
+
+}  // namespace flutter
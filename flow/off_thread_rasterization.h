@@ -0,0 +1,28 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_OFF_THREAD_RASTERIZATION_H_
+#define FLUTTER_FLOW_OFF_THREAD_RASTERIZATION_H_
+
+#include "third_party/skia/include/core/SkPicture.h"
+
+namespace flutter {
+
+// Whether |picture| can be played back into a CPU raster canvas on a thread
+// other than the raster thread.
+//
+// Pictures may reference texture backed images (such as the images uploaded
+// by the IO thread), which can only be read on the thread that owns their
+// GrContext. Since there is no way to ask an |SkPicture| for the images it
+// references, this plays the picture back into a canvas that draws nothing
+// and inspects every image, shader and filter along the way. Anything that
+// cannot be inspected (drawables, image filters, shaders other than image
+// shaders and gradients) is assumed to be unsafe.
+//
+// This must be called on the raster thread.
+bool CanRasterizeOffThread(const SkPicture& picture);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_OFF_THREAD_RASTERIZATION_H_
@@ -0,0 +1,84 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/off_thread_rasterization.h"
+
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkBlurImageFilter.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+
+namespace flutter {
+namespace testing {
+namespace {
+
+template <class DrawFunction>
+sk_sp<SkPicture> RecordPicture(DrawFunction draw) {
+  SkPictureRecorder recorder;
+  draw(recorder.beginRecording(SkRect::MakeWH(100, 100)));
+  return recorder.finishRecordingAsPicture();
+}
+
+sk_sp<SkImage> MakeRasterImage() {
+  auto surface = SkSurface::MakeRasterN32Premul(10, 10);
+  surface->getCanvas()->clear(SK_ColorRED);
+  return surface->makeImageSnapshot();
+}
+
+}  // namespace
+
+TEST(OffThreadRasterizationTest, AcceptsShapesAndRasterImages) {
+  auto picture = RecordPicture([](SkCanvas* canvas) {
+    SkPaint paint;
+    SkPoint points[] = {SkPoint::Make(0, 0), SkPoint::Make(100, 100)};
+    SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    paint.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2,
+                                                 SkTileMode::kClamp));
+    canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+    canvas->drawImage(MakeRasterImage(), 10, 10);
+  });
+
+  EXPECT_TRUE(CanRasterizeOffThread(*picture));
+}
+
+TEST(OffThreadRasterizationTest, RejectsImageFilters) {
+  auto picture = RecordPicture([](SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setImageFilter(SkBlurImageFilter::Make(5, 5, nullptr));
+    canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+  });
+
+  EXPECT_FALSE(CanRasterizeOffThread(*picture));
+}
+
+TEST(OffThreadRasterizationTest, RejectsPictureShaders) {
+  auto shader_picture = RecordPicture(
+      [](SkCanvas* canvas) { canvas->drawImage(MakeRasterImage(), 0, 0); });
+  auto picture = RecordPicture([&](SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setShader(shader_picture->makeShader(SkTileMode::kRepeat,
+                                               SkTileMode::kRepeat));
+    canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+  });
+
+  EXPECT_FALSE(CanRasterizeOffThread(*picture));
+}
+
+TEST(OffThreadRasterizationTest, ChecksNestedPictures) {
+  auto nested_picture = RecordPicture([](SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setImageFilter(SkBlurImageFilter::Make(5, 5, nullptr));
+    canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+  });
+  auto picture = RecordPicture(
+      [&](SkCanvas* canvas) { canvas->drawPicture(nested_picture); });
+
+  EXPECT_FALSE(CanRasterizeOffThread(*picture));
+}
+
+}  // namespace testing
+}  // namespace flutter
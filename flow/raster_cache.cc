@@ -4,11 +4,15 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "flutter/flow/layers/layer.h"
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/flow/off_thread_rasterization.h"
 #include "flutter/flow/paint_utils.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -32,11 +36,88 @@ void RasterCacheResult::draw(SkCanvas& canvas, const SkPaint* paint) const {
 }
 
 RasterCache::RasterCache(size_t access_threshold,
-                         size_t picture_cache_limit_per_frame)
+                         size_t picture_cache_limit_per_frame,
+                         size_t max_bytes,
+                         size_t max_unused_frames)
     : access_threshold_(access_threshold),
       picture_cache_limit_per_frame_(picture_cache_limit_per_frame),
+      max_bytes_(max_bytes),
+      max_unused_frames_(max_unused_frames),
       checkerboard_images_(false) {}
 
+// The images are always N32.
+static size_t ByteSizeForDimensions(const SkISize& dimensions) {
+  return static_cast<size_t>(dimensions.width()) * dimensions.height() * 4;
+}
+
+size_t RasterCache::ImageByteSize(const RasterCacheResult& image) {
+  return ByteSizeForDimensions(image.image_dimensions());
+}
+
+void RasterCache::UpdatePriority(Entry& entry) const {
+  const size_t bytes = std::max<size_t>(ImageByteSize(entry.image), 1);
+  // Rasterizing anything costs at least a microsecond.
+  const double cost =
+      std::max<double>(entry.raster_cost.ToMicrosecondsF(), 1.0);
+  entry.priority = eviction_priority_floor_ + entry.frames_used * cost / bytes;
+}
+
+void RasterCache::AddImage(Entry& entry,
+                           RasterCacheResult image,
+                           fml::TimeDelta raster_cost) {
+  entry.image = std::move(image);
+  if (!entry.image.is_valid()) {
+    return;
+  }
+  cached_bytes_ += ImageByteSize(entry.image);
+  // Counted when the frame is swept.
+  entry.frames_used = 0;
+  entry.raster_cost = raster_cost;
+  UpdatePriority(entry);
+}
+
+bool RasterCache::ReserveBytes(size_t bytes) {
+  if (bytes > max_bytes_) {
+    return false;
+  }
+  // Prefers |lhs| when both have the same priority.
+  auto lowest_priority = [](const Entry* lhs, const Entry* rhs) {
+    if (lhs == nullptr || (rhs != nullptr && rhs->priority < lhs->priority)) {
+      return rhs;
+    }
+    return lhs;
+  };
+  while (cached_bytes_ + bytes > max_bytes_) {
+    auto picture_candidate = FindEvictionCandidate(picture_cache_);
+    auto layer_candidate = FindEvictionCandidate(layer_cache_);
+    auto shadow_candidate = FindEvictionCandidate(shadow_cache_);
+    const Entry* picture_entry = picture_candidate != picture_cache_.end()
+                                     ? &picture_candidate->second
+                                     : nullptr;
+    const Entry* layer_entry =
+        layer_candidate != layer_cache_.end() ? &layer_candidate->second
+                                              : nullptr;
+    const Entry* shadow_entry =
+        shadow_candidate != shadow_cache_.end() ? &shadow_candidate->second
+                                                : nullptr;
+    const Entry* victim = lowest_priority(
+        lowest_priority(picture_entry, layer_entry), shadow_entry);
+    if (victim == nullptr) {
+      // Everything in the cache is used by the current frame.
+      return false;
+    }
+    eviction_priority_floor_ = victim->priority;
+    if (victim == picture_entry) {
+      Evict(picture_cache_, picture_candidate);
+    } else if (victim == layer_entry) {
+      Evict(layer_cache_, layer_candidate);
+    } else {
+      Evict(shadow_cache_, shadow_candidate);
+    }
+  }
+  return true;
+}
+
 static bool CanRasterizePicture(SkPicture* picture) {
   if (picture == nullptr) {
     return false;
@@ -129,15 +210,75 @@ RasterCacheResult RasterizePicture(SkPicture* picture,
                    [=](SkCanvas* canvas) { canvas->drawPicture(picture); });
 }
 
+RasterCachePrepareQueue::RasterCachePrepareQueue() = default;
+
+RasterCachePrepareQueue::~RasterCachePrepareQueue() = default;
+
+void RasterCachePrepareQueue::AddPicture(SkPicture* picture,
+                                         const SkMatrix& ctm,
+                                         bool is_complex,
+                                         bool will_change) {
+  calls_.push_back({picture, nullptr, nullptr, ctm, is_complex, will_change});
+}
+
+void RasterCachePrepareQueue::AddLayer(Layer* layer, const SkMatrix& ctm) {
+  calls_.push_back({nullptr, layer, nullptr, ctm, false, false});
+}
+
+void RasterCachePrepareQueue::AddShadow(const ShadowRasterCacheKey& key) {
+  calls_.push_back({nullptr, nullptr, &key, SkMatrix::I(), false, false});
+}
+
+void RasterCachePrepareQueue::Flush(PrerollContext* context) {
+  FML_DCHECK(context->deferred_raster_cache_prepares == nullptr);
+  RasterCache* cache = context->raster_cache;
+  for (const Call& call : calls_) {
+    if (call.picture) {
+      cache->Prepare(context->gr_context, call.picture, call.ctm,
+                     context->dst_color_space, call.is_complex,
+                     call.will_change);
+    } else if (call.layer) {
+      cache->Prepare(context, call.layer, call.ctm);
+    } else {
+      cache->PrepareShadow(context->gr_context, *call.shadow_key,
+                           context->dst_color_space);
+    }
+  }
+  calls_.clear();
+}
+
+void RasterCache::Prepare(PrerollContext* context,
+                          SkPicture* picture,
+                          const SkMatrix& transformation_matrix,
+                          bool is_complex,
+                          bool will_change) {
+  if (auto* queue = context->deferred_raster_cache_prepares) {
+    queue->AddPicture(picture, transformation_matrix, is_complex, will_change);
+    return;
+  }
+  Prepare(context->gr_context, picture, transformation_matrix,
+          context->dst_color_space, is_complex, will_change);
+}
+
 void RasterCache::Prepare(PrerollContext* context,
                           Layer* layer,
                           const SkMatrix& ctm) {
+  if (auto* queue = context->deferred_raster_cache_prepares) {
+    queue->AddLayer(layer, ctm);
+    return;
+  }
   LayerRasterCacheKey cache_key(layer->unique_id(), ctm);
   Entry& entry = layer_cache_[cache_key];
   entry.access_count++;
   entry.used_this_frame = true;
   if (!entry.image.is_valid()) {
-    entry.image = Rasterize(
+    const size_t bytes = ByteSizeForDimensions(
+        GetDeviceBounds(layer->paint_bounds(), ctm).size());
+    if (!ReserveBytes(bytes)) {
+      return;
+    }
+    const fml::TimePoint start = fml::TimePoint::Now();
+    RasterCacheResult image = Rasterize(
         context->gr_context, ctm, context->dst_color_space,
         checkerboard_images_, layer->paint_bounds(),
         [layer, context](SkCanvas* canvas) {
@@ -161,6 +302,7 @@ void RasterCache::Prepare(PrerollContext* context,
             layer->Paint(paintContext);
           }
         });
+    AddImage(entry, std::move(image), fml::TimePoint::Now() - start);
   }
 }
 
@@ -174,7 +316,11 @@ bool RasterCache::Prepare(GrContext* context,
   if (access_threshold_ == 0) {
     return false;
   }
-  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+  // With a concurrent task runner, the limit only applies to the pictures
+  // that cannot be rasterized off the raster thread, which is only known once
+  // the threshold has been reached.
+  if (!concurrent_task_runner_ &&
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
     return false;
   }
   if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
@@ -195,19 +341,306 @@ bool RasterCache::Prepare(GrContext* context,
 
   // Creates an entry, if not present prior.
   Entry& entry = picture_cache_[cache_key];
+  // The picture is about to be painted, so make sure that the entry is not
+  // evicted to make room for other pictures prepared in the same frame.
+  entry.used_this_frame = true;
   if (entry.access_count < access_threshold_) {
     // Frame threshold has not yet been reached.
     return false;
   }
 
   if (!entry.image.is_valid()) {
-    entry.image = RasterizePicture(picture, context, transformation_matrix,
-                                   dst_color_space, checkerboard_images_);
+    const size_t bytes = ByteSizeForDimensions(
+        GetDeviceBounds(picture->cullRect(), transformation_matrix).size());
+    if (concurrent_task_runner_) {
+      if (!entry.can_rasterize_off_thread.has_value()) {
+        entry.can_rasterize_off_thread = CanRasterizeOffThread(*picture);
+      }
+      if (entry.can_rasterize_off_thread.value()) {
+        RasterizeOffThread(entry, cache_key, picture, transformation_matrix,
+                           dst_color_space, bytes);
+        return false;
+      }
+      if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+        return false;
+      }
+    }
+    if (!ReserveBytes(bytes)) {
+      return false;
+    }
+    const fml::TimePoint start = fml::TimePoint::Now();
+    RasterCacheResult image =
+        RasterizePicture(picture, context, transformation_matrix,
+                         dst_color_space, checkerboard_images_);
+    AddImage(entry, std::move(image), fml::TimePoint::Now() - start);
     picture_cached_this_frame_++;
   }
   return true;
 }
 
+// How far the spot shadow of a path at |elevation| moves relative to the path
+// when the ctm moves the path by one pixel. The light is positioned in device
+// coordinates, so it does not move with the ctm.
+static SkScalar SpotShiftRatio(float elevation) {
+  return elevation / (PhysicalShapeLayer::kLightHeight - elevation);
+}
+
+// How far, in steps of |ShadowRasterCacheKey::kSpotShiftStep|, the spot
+// shadow of a path with |bounds| is shifted relative to the path on a canvas
+// with |matrix|.
+static SkIPoint GetSpotShift(const SkRect& bounds,
+                             const SkMatrix& matrix,
+                             float elevation) {
+  const SkPoint device_origin = matrix.mapXY(bounds.left(), bounds.top());
+  const SkScalar ratio = SpotShiftRatio(elevation);
+  const SkScalar step = ShadowRasterCacheKey::kSpotShiftStep;
+  return SkIPoint::Make(
+      SkScalarRoundToInt((device_origin.x() - bounds.left()) * ratio / step),
+      SkScalarRoundToInt((device_origin.y() - bounds.top()) * ratio / step));
+}
+
+std::optional<ShadowRasterCacheKey> RasterCache::GetShadowKey(
+    const SkPath& path,
+    const SkMatrix& ctm,
+    SkColor color,
+    float elevation,
+    bool transparent_occluder,
+    float dpr) const {
+  if (access_threshold_ == 0) {
+    return std::nullopt;
+  }
+  if (elevation <= 0 || elevation >= PhysicalShapeLayer::kLightHeight) {
+    return std::nullopt;
+  }
+  const SkRect& bounds = path.getBounds();
+  if (bounds.isEmpty() || !bounds.isFinite()) {
+    return std::nullopt;
+  }
+  if (ctm.hasPerspective() || !MatrixDecomposition(ctm).IsValid()) {
+    return std::nullopt;
+  }
+  const SkMatrix matrix = GetIntegralTransCTM(ctm);
+  return ShadowRasterCacheKey(path, matrix, color, elevation,
+                              transparent_occluder, dpr,
+                              GetSpotShift(bounds, matrix, elevation));
+}
+
+bool RasterCache::PrepareShadow(GrContext* context,
+                                const ShadowRasterCacheKey& key,
+                                SkColorSpace* dst_color_space) {
+  if (access_threshold_ == 0) {
+    return false;
+  }
+
+  Entry& entry = shadow_cache_[key];
+  entry.used_this_frame = true;
+  if (entry.image.is_valid()) {
+    return true;
+  }
+  if (entry.access_count < access_threshold_ ||
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+    return false;
+  }
+
+  // The shadow is drawn for the middle of the range of spot shifts of the
+  // key, as if the path were |device_offset| away from its local position.
+  const float elevation = key.elevation();
+  const float dpr = key.dpr();
+  const SkScalar ratio = SpotShiftRatio(elevation);
+  const SkScalar step = ShadowRasterCacheKey::kSpotShiftStep;
+  const SkVector spot_shift = SkVector::Make(key.spot_shift().x() * step,
+                                             key.spot_shift().y() * step);
+  const SkVector device_offset =
+      SkVector::Make(spot_shift.x() / ratio, spot_shift.y() / ratio);
+
+  // |ComputeShadowBounds| assumes that the light is above the path.
+  const SkScalar min_scale = key.matrix().getMinScale();
+  if (min_scale <= 0) {
+    return false;
+  }
+  SkRect logical_rect = PhysicalShapeLayer::ComputeShadowBounds(
+      key.path().getBounds(), elevation, dpr);
+  const SkScalar spot_outset = spot_shift.length() / min_scale;
+  logical_rect.outset(spot_outset, spot_outset);
+
+  const size_t bytes = ByteSizeForDimensions(
+      GetDeviceBounds(logical_rect, key.matrix()).size());
+  if (!ReserveBytes(bytes)) {
+    return false;
+  }
+  const fml::TimePoint start = fml::TimePoint::Now();
+  RasterCacheResult image = Rasterize(
+      context, key.matrix(), dst_color_space, checkerboard_images_,
+      logical_rect, [&](SkCanvas* canvas) {
+        // The light is positioned in device coordinates, in which the path
+        // starts at the translation of the canvas.
+        const SkMatrix& matrix = canvas->getTotalMatrix();
+        PhysicalShapeLayer::DrawShadow(
+            canvas, key.path(), key.color(), elevation,
+            key.transparent_occluder(), dpr,
+            SkVector::Make(matrix.getTranslateX() - device_offset.x(),
+                           matrix.getTranslateY() - device_offset.y()));
+      });
+  AddImage(entry, std::move(image), fml::TimePoint::Now() - start);
+  picture_cached_this_frame_++;
+  return entry.image.is_valid();
+}
+
+bool RasterCache::PrepareShadow(GrContext* context,
+                                const SkPath& path,
+                                const SkMatrix& ctm,
+                                SkColorSpace* dst_color_space,
+                                SkColor color,
+                                float elevation,
+                                bool transparent_occluder,
+                                float dpr) {
+  std::optional<ShadowRasterCacheKey> key =
+      GetShadowKey(path, ctm, color, elevation, transparent_occluder, dpr);
+  return key && PrepareShadow(context, *key, dst_color_space);
+}
+
+void RasterCache::PrepareShadow(PrerollContext* context,
+                                const ShadowRasterCacheKey& key) {
+  if (auto* queue = context->deferred_raster_cache_prepares) {
+    queue->AddShadow(key);
+    return;
+  }
+  PrepareShadow(context->gr_context, key, context->dst_color_space);
+}
+
+bool RasterCache::DrawShadow(SkCanvas& canvas,
+                             const ShadowRasterCacheKey& key,
+                             const SkRect& path_bounds) const {
+  if (shadow_cache_.empty()) {
+    return false;
+  }
+  // The key was made for the ctm the path was prerolled with, which only
+  // differs from the ctm of |canvas| if the path is painted into an image of
+  // another layer.
+  SkMatrix matrix = GetIntegralTransCTM(canvas.getTotalMatrix());
+  const SkIPoint spot_shift =
+      GetSpotShift(path_bounds, matrix, key.elevation());
+  const SkPoint device_origin =
+      matrix.mapXY(path_bounds.left(), path_bounds.top());
+  matrix[SkMatrix::kMTransX] = 0;
+  matrix[SkMatrix::kMTransY] = 0;
+  if (matrix != key.matrix() || spot_shift != key.spot_shift()) {
+    return false;
+  }
+  auto it = shadow_cache_.find(key);
+  if (it == shadow_cache_.end()) {
+    return false;
+  }
+
+  Entry& entry = it->second;
+  entry.access_count++;
+  entry.used_this_frame = true;
+  if (!entry.image.is_valid()) {
+    stats_.miss_count++;
+    return false;
+  }
+  stats_.hit_count++;
+
+  // Like pictures, the shadow is snapped to whole device pixels.
+  matrix.postTranslate(SkScalarRoundToScalar(device_origin.x()),
+                       SkScalarRoundToScalar(device_origin.y()));
+  SkAutoCanvasRestore auto_restore(&canvas, true);
+  canvas.setMatrix(matrix);
+  entry.image.draw(canvas);
+  return true;
+}
+
+bool RasterCache::DrawShadow(SkCanvas& canvas,
+                             const SkPath& path,
+                             SkColor color,
+                             float elevation,
+                             bool transparent_occluder,
+                             float dpr) const {
+  if (shadow_cache_.empty()) {
+    return false;
+  }
+  std::optional<ShadowRasterCacheKey> key =
+      GetShadowKey(path, canvas.getTotalMatrix(), color, elevation,
+                   transparent_occluder, dpr);
+  return key && DrawShadow(canvas, *key, path.getBounds());
+}
+
+void RasterCache::SetConcurrentTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  concurrent_task_runner_ = std::move(task_runner);
+  if (concurrent_task_runner_ && !async_results_) {
+    async_results_ = std::make_shared<AsyncResults>();
+  }
+}
+
+void RasterCache::RasterizeOffThread(Entry& entry,
+                                     const PictureRasterCacheKey& cache_key,
+                                     SkPicture* picture,
+                                     const SkMatrix& transformation_matrix,
+                                     SkColorSpace* dst_color_space,
+                                     size_t bytes) {
+  if (entry.is_rasterizing_off_thread) {
+    return;
+  }
+  if (bytes > max_bytes_ || async_pending_bytes_ + bytes > max_bytes_) {
+    return;
+  }
+  entry.is_rasterizing_off_thread = true;
+  async_pending_bytes_ += bytes;
+  concurrent_task_runner_->PostTask(
+      [weak_results = std::weak_ptr<AsyncResults>(async_results_),
+       picture = sk_ref_sp(picture), transformation_matrix,
+       dst_color_space = sk_ref_sp(dst_color_space),
+       checkerboard = checkerboard_images_, cache_key,
+       generation = async_generation_, bytes]() {
+        auto results = weak_results.lock();
+        if (!results) {
+          return;
+        }
+        const fml::TimePoint start = fml::TimePoint::Now();
+        // Always rasterized with the CPU backend. Skia uploads the image the
+        // first time it is drawn on the raster thread.
+        RasterCacheResult image =
+            RasterizePicture(picture.get(), nullptr, transformation_matrix,
+                             dst_color_space.get(), checkerboard);
+        const fml::TimeDelta raster_cost = fml::TimePoint::Now() - start;
+        std::scoped_lock lock(results->mutex);
+        results->results.push_back(
+            {cache_key, generation, bytes, std::move(image), raster_cost});
+      });
+}
+
+void RasterCache::PublishAsyncResults() {
+  if (!async_results_) {
+    return;
+  }
+  std::vector<AsyncResult> results;
+  {
+    std::scoped_lock lock(async_results_->mutex);
+    results.swap(async_results_->results);
+  }
+  for (AsyncResult& result : results) {
+    async_pending_bytes_ -= result.estimated_bytes;
+    if (result.generation != async_generation_) {
+      continue;
+    }
+    auto it = picture_cache_.find(result.key);
+    if (it == picture_cache_.end()) {
+      // Evicted while the picture was being rasterized.
+      continue;
+    }
+    Entry& entry = it->second;
+    entry.is_rasterizing_off_thread = false;
+    if (entry.image.is_valid() || !result.image.is_valid()) {
+      continue;
+    }
+    if (!ReserveBytes(ImageByteSize(result.image))) {
+      continue;
+    }
+    AddImage(entry, std::move(result.image), result.raster_cost);
+  }
+}
+
 RasterCacheResult RasterCache::Get(const SkPicture& picture,
                                    const SkMatrix& ctm) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), ctm);
@@ -219,6 +652,11 @@ RasterCacheResult RasterCache::Get(const SkPicture& picture,
   Entry& entry = it->second;
   entry.access_count++;
   entry.used_this_frame = true;
+  if (entry.image.is_valid()) {
+    stats_.hit_count++;
+  } else {
+    stats_.miss_count++;
+  }
 
   return entry.image;
 }
@@ -233,24 +671,50 @@ RasterCacheResult RasterCache::Get(Layer* layer, const SkMatrix& ctm) const {
   Entry& entry = it->second;
   entry.access_count++;
   entry.used_this_frame = true;
+  if (entry.image.is_valid()) {
+    stats_.hit_count++;
+  } else {
+    stats_.miss_count++;
+  }
 
   return entry.image;
 }
 
+bool RasterCache::HasValidEntry(const SkPicture& picture,
+                                const SkMatrix& ctm) const {
+  PictureRasterCacheKey cache_key(picture.uniqueID(), ctm);
+  auto it = picture_cache_.find(cache_key);
+  return it != picture_cache_.end() && it->second.image.is_valid();
+}
+
+bool RasterCache::HasValidEntry(Layer* layer, const SkMatrix& ctm) const {
+  LayerRasterCacheKey cache_key(layer->unique_id(), ctm);
+  auto it = layer_cache_.find(cache_key);
+  return it != layer_cache_.end() && it->second.image.is_valid();
+}
+
 void RasterCache::SweepAfterFrame() {
+  // Before the sweep, so that entries used in this frame are not evicted to
+  // make room for the results.
+  PublishAsyncResults();
   SweepOneCacheAfterFrame(picture_cache_);
   SweepOneCacheAfterFrame(layer_cache_);
+  SweepOneCacheAfterFrame(shadow_cache_);
   picture_cached_this_frame_ = 0;
   TraceStatsToTimeline();
+  stats_at_frame_start_ = stats_;
 }
 
 void RasterCache::Clear() {
   picture_cache_.clear();
   layer_cache_.clear();
+  shadow_cache_.clear();
+  cached_bytes_ = 0;
+  async_generation_++;
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
-  return layer_cache_.size() + picture_cache_.size();
+  return layer_cache_.size() + picture_cache_.size() + shadow_cache_.size();
 }
 
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
@@ -272,17 +736,25 @@ void RasterCache::TraceStatsToTimeline() const {
   size_t layer_cache_bytes = 0;
   size_t picture_cache_count = 0;
   size_t picture_cache_bytes = 0;
+  size_t shadow_cache_count = 0;
+  size_t shadow_cache_bytes = 0;
 
   for (const auto& item : layer_cache_) {
     const auto dimensions = item.second.image.image_dimensions();
     layer_cache_count++;
-    layer_cache_bytes += dimensions.width() * dimensions.height() * 4;
+    layer_cache_bytes += ByteSizeForDimensions(dimensions);
   }
 
   for (const auto& item : picture_cache_) {
     const auto dimensions = item.second.image.image_dimensions();
     picture_cache_count++;
-    picture_cache_bytes += dimensions.width() * dimensions.height() * 4;
+    picture_cache_bytes += ByteSizeForDimensions(dimensions);
+  }
+
+  for (const auto& item : shadow_cache_) {
+    const auto dimensions = item.second.image.image_dimensions();
+    shadow_cache_count++;
+    shadow_cache_bytes += ByteSizeForDimensions(dimensions);
   }
 
   FML_TRACE_COUNTER("flutter", "RasterCache",
@@ -290,7 +762,18 @@ void RasterCache::TraceStatsToTimeline() const {
                     "LayerCount", layer_cache_count,             //
                     "LayerMBytes", layer_cache_bytes * 1e-6,     //
                     "PictureCount", picture_cache_count,         //
-                    "PictureMBytes", picture_cache_bytes * 1e-6  //
+                    "PictureMBytes", picture_cache_bytes * 1e-6,  //
+                    "ShadowCount", shadow_cache_count,            //
+                    "ShadowMBytes", shadow_cache_bytes * 1e-6     //
+  );
+
+  // Per frame.
+  FML_TRACE_COUNTER(
+      "flutter", "RasterCacheAccesses", reinterpret_cast<int64_t>(this),  //
+      "HitCount", stats_.hit_count - stats_at_frame_start_.hit_count,     //
+      "MissCount", stats_.miss_count - stats_at_frame_start_.miss_count,  //
+      "EvictionCount",
+      stats_.eviction_count - stats_at_frame_start_.eviction_count  //
   );
 
 #endif  // !FLUTTER_RELEASE
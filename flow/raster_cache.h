@@ -6,12 +6,17 @@
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/time/time_delta.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -42,6 +47,48 @@ class RasterCacheResult {
 
 struct PrerollContext;
 
+// The calls to |RasterCache::Prepare| made while a subtree is prerolled off
+// the raster thread (see |PrerollContext::deferred_raster_cache_prepares|).
+// They are made on the raster thread once the subtree is done, in the order a
+// serial preroll would have made them.
+class RasterCachePrepareQueue {
+ public:
+  RasterCachePrepareQueue();
+
+  ~RasterCachePrepareQueue();
+
+  void AddPicture(SkPicture* picture,
+                  const SkMatrix& ctm,
+                  bool is_complex,
+                  bool will_change);
+
+  void AddLayer(Layer* layer, const SkMatrix& ctm);
+
+  // |key| must outlive the queue.
+  void AddShadow(const ShadowRasterCacheKey& key);
+
+  // Makes the queued calls on |context->raster_cache| and empties the queue.
+  // Must be called on the raster thread.
+  void Flush(PrerollContext* context);
+
+  bool empty() const { return calls_.empty(); }
+
+ private:
+  struct Call {
+    // Exactly one of |picture|, |layer| and |shadow_key| is set.
+    SkPicture* picture;
+    Layer* layer;
+    const ShadowRasterCacheKey* shadow_key;
+    SkMatrix ctm;
+    bool is_complex;
+    bool will_change;
+  };
+
+  std::vector<Call> calls_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(RasterCachePrepareQueue);
+};
+
 class RasterCache {
  public:
   // The default max number of picture raster caches to be generated per frame.
@@ -50,9 +97,20 @@ class RasterCache {
   // multiple frames.
   static constexpr int kDefaultPictureCacheLimitPerFrame = 3;
 
+  // The default max number of bytes held by the rasterized images of the
+  // cache. Entries are evicted to make room for new ones once this is reached.
+  static constexpr size_t kDefaultMaxBytes = 64 * (1 << 20);
+
+  // The default number of consecutive frames an entry may go unused before it
+  // is evicted. This lets content that is briefly scrolled off screen or
+  // hidden come back without being rasterized again.
+  static constexpr size_t kDefaultMaxUnusedFrames = 60;
+
   explicit RasterCache(
       size_t access_threshold = 3,
-      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame);
+      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame,
+      size_t max_bytes = kDefaultMaxBytes,
+      size_t max_unused_frames = kDefaultMaxUnusedFrames);
 
   static SkIRect GetDeviceBounds(const SkRect& rect, const SkMatrix& ctm) {
     SkRect device_rect;
@@ -69,6 +127,15 @@ class RasterCache {
     return result;
   }
 
+  // Rasterizes pictures on the workers of |task_runner| instead of in
+  // |Prepare|, as long as they can be played back off the raster thread (see
+  // |CanRasterizeOffThread|). Until the results are published by a later
+  // |SweepAfterFrame|, the pictures are drawn directly. Such pictures do not
+  // count towards the picture cache limit per frame. Passing null goes back
+  // to rasterizing all pictures in |Prepare|.
+  void SetConcurrentTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
   // Return true if the cache is generated.
   //
   // We may return false and not generate the cache if
@@ -77,6 +144,10 @@ class RasterCache {
   // 3. The picture is accessed too few times
   // 4. There are too many pictures to be cached in the current frame.
   //    (See also kDefaultPictureCacheLimitPerFrame.)
+  // 5. The rasterized picture would not fit in the byte budget, even after
+  //    evicting all the entries that were not used in the current frame.
+  // 6. The picture is being rasterized on a worker (see
+  //    |SetConcurrentTaskRunner|).
   bool Prepare(GrContext* context,
                SkPicture* picture,
                const SkMatrix& transformation_matrix,
@@ -84,12 +155,81 @@ class RasterCache {
                bool is_complex,
                bool will_change);
 
+  // Like the above, with the frame state of |context|. The call is only
+  // queued if |context| has deferred raster cache prepares.
+  void Prepare(PrerollContext* context,
+               SkPicture* picture,
+               const SkMatrix& transformation_matrix,
+               bool is_complex,
+               bool will_change);
+
+  // The call is only queued if |context| has deferred raster cache prepares.
   void Prepare(PrerollContext* context, Layer* layer, const SkMatrix& ctm);
 
+  // The key of the shadow that |PhysicalShapeLayer::DrawShadow| draws for
+  // |path| on a canvas with |ctm|. Paths of the same shape share the key,
+  // unless they are far enough apart for their spot shadows to look different
+  // (see |ShadowRasterCacheKey|). Empty if shadows are not cached or this one
+  // cannot be.
+  //
+  // Making the key copies and hashes |path|, so layers make it once per frame
+  // and pass it to |PrepareShadow| and |DrawShadow|.
+  std::optional<ShadowRasterCacheKey> GetShadowKey(const SkPath& path,
+                                                   const SkMatrix& ctm,
+                                                   SkColor color,
+                                                   float elevation,
+                                                   bool transparent_occluder,
+                                                   float dpr) const;
+
+  // Rasterizes the shadow of |key|, once shadows with the key have been drawn
+  // |access_threshold| times. Returns true if the shadow is cached.
+  //
+  // Shadows count towards the picture cache limit per frame and the byte
+  // budget.
+  bool PrepareShadow(GrContext* context,
+                     const ShadowRasterCacheKey& key,
+                     SkColorSpace* dst_color_space);
+
+  // Like the above, for the key of the shadow of |path|.
+  bool PrepareShadow(GrContext* context,
+                     const SkPath& path,
+                     const SkMatrix& ctm,
+                     SkColorSpace* dst_color_space,
+                     SkColor color,
+                     float elevation,
+                     bool transparent_occluder,
+                     float dpr);
+
+  // Like the above, with the frame state of |context|. The call is only
+  // queued if |context| has deferred raster cache prepares, in which case
+  // |key| must outlive the preroll.
+  void PrepareShadow(PrerollContext* context, const ShadowRasterCacheKey& key);
+
+  // Draws the shadow of |key| to |canvas| from the cache, for the path with
+  // |path_bounds|. Returns false if it is not cached, or if the shadow of the
+  // path on |canvas| has another key, in which case the caller draws it.
+  bool DrawShadow(SkCanvas& canvas,
+                  const ShadowRasterCacheKey& key,
+                  const SkRect& path_bounds) const;
+
+  // Like the above, for the key of the shadow of |path| on |canvas|.
+  bool DrawShadow(SkCanvas& canvas,
+                  const SkPath& path,
+                  SkColor color,
+                  float elevation,
+                  bool transparent_occluder,
+                  float dpr) const;
+
   RasterCacheResult Get(const SkPicture& picture, const SkMatrix& ctm) const;
 
   RasterCacheResult Get(Layer* layer, const SkMatrix& ctm) const;
 
+  // Whether |Get| would return a valid result. Unlike |Get|, this does not
+  // count as an access of the entry.
+  bool HasValidEntry(const SkPicture& picture, const SkMatrix& ctm) const;
+
+  bool HasValidEntry(Layer* layer, const SkMatrix& ctm) const;
+
   void SweepAfterFrame();
 
   void Clear();
@@ -98,36 +238,166 @@ class RasterCache {
 
   size_t GetCachedEntriesCount() const;
 
+  // The number of bytes held by the rasterized images of the cache.
+  size_t GetCachedBytes() const { return cached_bytes_; }
+
+  struct Stats {
+    // Calls to |Get| and |DrawShadow| that found a rasterized image.
+    size_t hit_count = 0;
+    // Calls to |Get| and |DrawShadow| for a prepared entry that has no
+    // rasterized image yet (or could not be rasterized).
+    size_t miss_count = 0;
+    // Rasterized images dropped because they went unused for too long or to
+    // make room for others.
+    size_t eviction_count = 0;
+  };
+
+  // The totals since the cache was created.
+  const Stats& GetStats() const { return stats_; }
+
  private:
   struct Entry {
     bool used_this_frame = false;
     size_t access_count = 0;
     RasterCacheResult image;
+    // The number of consecutive frames in which the entry was not used.
+    size_t unused_frames = 0;
+    // The following are only meaningful while |image| is valid.
+    //
+    // The number of frames in which the image was used.
+    size_t frames_used = 0;
+    // The time it took to rasterize the image. On GPU surfaces this only
+    // accounts for recording the draw calls.
+    fml::TimeDelta raster_cost;
+    // See |UpdatePriority|.
+    double priority = 0;
+    // Only used for pictures while there is a concurrent task runner.
+    std::optional<bool> can_rasterize_off_thread;
+    bool is_rasterizing_off_thread = false;
+  };
+
+  // A picture rasterized by a concurrent worker.
+  struct AsyncResult {
+    PictureRasterCacheKey key;
+    // The value of |async_generation_| when the task was posted.
+    size_t generation;
+    size_t estimated_bytes;
+    RasterCacheResult image;
+    fml::TimeDelta raster_cost;
+  };
+
+  // Shared with the worker tasks, which may outlive the cache.
+  struct AsyncResults {
+    std::mutex mutex;
+    std::vector<AsyncResult> results;
   };
 
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
+  void SweepOneCacheAfterFrame(Cache& cache) {
     std::vector<typename Cache::iterator> dead;
 
     for (auto it = cache.begin(); it != cache.end(); ++it) {
       Entry& entry = it->second;
-      if (!entry.used_this_frame) {
+      if (entry.used_this_frame) {
+        entry.unused_frames = 0;
+        if (entry.image.is_valid()) {
+          entry.frames_used++;
+          UpdatePriority(entry);
+        }
+      } else if (++entry.unused_frames > max_unused_frames_) {
         dead.push_back(it);
       }
       entry.used_this_frame = false;
     }
 
     for (auto it : dead) {
-      cache.erase(it);
+      Evict(cache, it);
+    }
+  }
+
+  // Finds the entry of |cache| with the lowest priority among those that
+  // have a rasterized image and were not used in the current frame.
+  template <class Cache>
+  static typename Cache::iterator FindEvictionCandidate(Cache& cache) {
+    auto candidate = cache.end();
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      const Entry& entry = it->second;
+      if (entry.used_this_frame || !entry.image.is_valid()) {
+        continue;
+      }
+      if (candidate == cache.end() ||
+          entry.priority < candidate->second.priority) {
+        candidate = it;
+      }
+    }
+    return candidate;
+  }
+
+  template <class Cache>
+  void Evict(Cache& cache, typename Cache::iterator it) {
+    if (it->second.image.is_valid()) {
+      cached_bytes_ -= ImageByteSize(it->second.image);
+      stats_.eviction_count++;
     }
+    cache.erase(it);
   }
 
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
+  const size_t max_bytes_;
+  const size_t max_unused_frames_;
   size_t picture_cached_this_frame_ = 0;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
+  mutable ShadowRasterCacheKey::Map<Entry> shadow_cache_;
   bool checkerboard_images_;
+  size_t cached_bytes_ = 0;
+  // The priority of the last entry evicted to make room for another. See
+  // |UpdatePriority|.
+  double eviction_priority_floor_ = 0;
+  mutable Stats stats_;
+  Stats stats_at_frame_start_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  std::shared_ptr<AsyncResults> async_results_;
+  // Bumped whenever the cache is cleared so that the results of tasks that
+  // were posted earlier are dropped.
+  size_t async_generation_ = 0;
+  // The estimated size of the images being rasterized by workers, which is
+  // bounded by the byte budget as well.
+  size_t async_pending_bytes_ = 0;
+
+  static size_t ImageByteSize(const RasterCacheResult& image);
+
+  // Entries are evicted in the order of GreedyDual-Size-Frequency (Cherkasova,
+  // "Improving WWW Proxies Performance with Greedy-Dual-Size-Frequency
+  // Caching Policy"): the priority of an entry is the number of frames it was
+  // used in times its rasterization cost per byte, plus the priority of the
+  // last evicted entry at the time it was last used. The latter ages entries
+  // that are no longer used in favor of new ones, however often they were
+  // used in the past.
+  void UpdatePriority(Entry& entry) const;
+
+  // Records that |entry| has just been rasterized into |image|.
+  void AddImage(Entry& entry,
+                RasterCacheResult image,
+                fml::TimeDelta raster_cost);
+
+  // Posts a task that rasterizes |picture| on a concurrent worker, unless
+  // one is in flight for the entry already.
+  void RasterizeOffThread(Entry& entry,
+                          const PictureRasterCacheKey& cache_key,
+                          SkPicture* picture,
+                          const SkMatrix& transformation_matrix,
+                          SkColorSpace* dst_color_space,
+                          size_t bytes);
+
+  // Moves the images rasterized by workers since the last call into their
+  // entries.
+  void PublishAsyncResults();
+
+  // Evicts entries that were not used in the current frame, least valuable
+  // first, until |bytes| more fit in the budget. Returns false if they do not.
+  bool ReserveBytes(size_t bytes);
 
   void TraceStatsToTimeline() const;
 
@@ -4,8 +4,42 @@
 
 #include "flutter/flow/raster_cache_key.h"
 
+#include "flutter/flow/diff_context.h"
+#include "flutter/fml/hash_combine.h"
+
 namespace flutter {
 
-//
+ShadowRasterCacheKey::ShadowRasterCacheKey(const SkPath& path,
+                                           const SkMatrix& ctm,
+                                           SkColor color,
+                                           float elevation,
+                                           bool transparent_occluder,
+                                           float dpr,
+                                           SkIPoint spot_shift)
+    : matrix_(ctm),
+      color_(color),
+      elevation_(elevation),
+      transparent_occluder_(transparent_occluder),
+      dpr_(dpr),
+      spot_shift_(spot_shift) {
+  const SkRect& bounds = path.getBounds();
+  path.offset(-bounds.left(), -bounds.top(), &path_);
+  matrix_[SkMatrix::kMTransX] = 0;
+  matrix_[SkMatrix::kMTransY] = 0;
+  // The framework creates new paths for every frame, so their generation IDs
+  // cannot be used.
+  hash_ = fml::HashCombine(DiffContext::HashPath(path_), color_, elevation_,
+                           dpr_, spot_shift_.x(), spot_shift_.y());
+}
+
+bool ShadowRasterCacheKey::Equal::operator()(
+    const ShadowRasterCacheKey& lhs,
+    const ShadowRasterCacheKey& rhs) const {
+  return lhs.hash_ == rhs.hash_ && lhs.matrix_ == rhs.matrix_ &&
+         lhs.color_ == rhs.color_ && lhs.elevation_ == rhs.elevation_ &&
+         lhs.transparent_occluder_ == rhs.transparent_occluder_ &&
+         lhs.dpr_ == rhs.dpr_ && lhs.spot_shift_ == rhs.spot_shift_ &&
+         lhs.path_ == rhs.path_;
+}
 
 }  // namespace flutter
@@ -8,6 +8,8 @@
 #include <unordered_map>
 #include "flutter/flow/matrix_decomposition.h"
 #include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkPath.h"
 
 namespace flutter {
 
@@ -59,6 +61,58 @@ class Layer;
 // The ID is the uint64_t layer unique_id
 using LayerRasterCacheKey = RasterCacheKey<uint64_t>;
 
+// The shadow of a path, wherever the path is on the canvas. The path is moved
+// to the origin and only the scale and skew of the ctm are kept. Since the
+// light that casts the spot shadow does not move with the ctm, the key also
+// has how far the spot shadow is shifted relative to the path, in steps of
+// |kSpotShiftStep| device pixels.
+class ShadowRasterCacheKey {
+ public:
+  static constexpr SkScalar kSpotShiftStep = 1.0f;
+
+  ShadowRasterCacheKey(const SkPath& path,
+                       const SkMatrix& ctm,
+                       SkColor color,
+                       float elevation,
+                       bool transparent_occluder,
+                       float dpr,
+                       SkIPoint spot_shift);
+
+  // |path| moved so that its bounds start at the origin.
+  const SkPath& path() const { return path_; }
+  // The ctm without translation.
+  const SkMatrix& matrix() const { return matrix_; }
+  SkColor color() const { return color_; }
+  float elevation() const { return elevation_; }
+  bool transparent_occluder() const { return transparent_occluder_; }
+  float dpr() const { return dpr_; }
+  SkIPoint spot_shift() const { return spot_shift_; }
+
+  struct Hash {
+    size_t operator()(const ShadowRasterCacheKey& key) const {
+      return key.hash_;
+    }
+  };
+
+  struct Equal {
+    bool operator()(const ShadowRasterCacheKey& lhs,
+                    const ShadowRasterCacheKey& rhs) const;
+  };
+
+  template <class Value>
+  using Map = std::unordered_map<ShadowRasterCacheKey, Value, Hash, Equal>;
+
+ private:
+  SkPath path_;
+  SkMatrix matrix_;
+  SkColor color_;
+  float elevation_;
+  bool transparent_occluder_;
+  float dpr_;
+  SkIPoint spot_shift_;
+  size_t hash_;
+};
+
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_RASTER_CACHE_KEY_H_
@@ -4,9 +4,12 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
 
 namespace flutter {
 namespace testing {
@@ -22,6 +25,17 @@ sk_sp<SkPicture> GetSamplePicture() {
   return recorder.finishRecordingAsPicture();
 }
 
+// The size of the images rasterized from |GetSamplePicture| with an identity
+// matrix.
+constexpr size_t kSamplePictureBytes = 150 * 100 * 4;
+
+constexpr float kSampleElevation = 4.0f;
+
+SkPath GetSampleShadowPath(SkScalar left, SkScalar top) {
+  return SkPath().addRRect(
+      SkRRect::MakeRectXY(SkRect::MakeXYWH(left, top, 50, 50), 4, 4));
+}
+
 }  // namespace
 
 TEST(RasterCache, SimpleInitialization) {
@@ -97,7 +111,10 @@ TEST(RasterCache, PictureCacheLimitPerFrameIsRespectedWhenZero) {
 
 TEST(RasterCache, SweepsRemoveUnusedFrames) {
   size_t threshold = 1;
-  flutter::RasterCache cache(threshold);
+  size_t max_unused_frames = 0;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             RasterCache::kDefaultMaxBytes, max_unused_frames);
 
   SkMatrix matrix = SkMatrix::I();
 
@@ -122,5 +139,388 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
 }
 
+TEST(RasterCache, EntriesSurviveShortAbsences) {
+  size_t threshold = 1;
+  size_t max_unused_frames = 2;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             RasterCache::kDefaultMaxBytes, max_unused_frames);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Get(*picture, matrix).is_valid());
+  ASSERT_EQ(cache.GetCachedBytes(), kSamplePictureBytes);
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // Two frames without the picture.
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.HasValidEntry(*picture, matrix));
+  ASSERT_EQ(cache.GetStats().eviction_count, 0u);
+
+  cache.SweepAfterFrame();  // One too many.
+
+  ASSERT_FALSE(cache.HasValidEntry(*picture, matrix));
+  ASSERT_EQ(cache.GetStats().eviction_count, 1u);
+  ASSERT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST(RasterCache, ByteBudgetIsRespected) {
+  size_t threshold = 1;
+  size_t max_bytes = 2 * kSamplePictureBytes;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             max_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+  auto picture3 = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  cache.Get(*picture1, matrix);
+  cache.Get(*picture2, matrix);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  ASSERT_EQ(cache.GetCachedBytes(), max_bytes);
+
+  cache.SweepAfterFrame();
+
+  // Only the first picture remains on screen and the third one shows up.
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture3.get(), matrix, srgb.get(), true, false));
+  cache.Get(*picture1, matrix);
+  cache.Get(*picture3, matrix);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture3.get(), matrix, srgb.get(), true, false));
+
+  // The second picture was not used in this frame, so it made room.
+  ASSERT_TRUE(cache.HasValidEntry(*picture1, matrix));
+  ASSERT_FALSE(cache.HasValidEntry(*picture2, matrix));
+  ASSERT_TRUE(cache.HasValidEntry(*picture3, matrix));
+  ASSERT_EQ(cache.GetCachedBytes(), max_bytes);
+  ASSERT_EQ(cache.GetStats().eviction_count, 1u);
+}
+
+TEST(RasterCache, EntriesUsedInTheCurrentFrameAreNotEvicted) {
+  size_t threshold = 1;
+  size_t max_bytes = kSamplePictureBytes;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             max_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  cache.Get(*picture1, matrix);
+  cache.Get(*picture2, matrix);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+
+  ASSERT_TRUE(cache.Get(*picture1, matrix).is_valid());
+  ASSERT_FALSE(cache.Get(*picture2, matrix).is_valid());
+  ASSERT_EQ(cache.GetStats().eviction_count, 0u);
+}
+
+TEST(RasterCache, EntriesLargerThanTheBudgetAreNotCached) {
+  size_t threshold = 1;
+  size_t max_bytes = kSamplePictureBytes - 1;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             max_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
+
+  cache.SweepAfterFrame();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
+  ASSERT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST(RasterCache, HitsAndMissesAreCounted) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+  auto unprepared_picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
+  // Pictures that were never prepared are not cache misses.
+  ASSERT_FALSE(cache.Get(*unprepared_picture, matrix).is_valid());
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Get(*picture, matrix).is_valid());
+
+  ASSERT_EQ(cache.GetStats().hit_count, 1u);
+  ASSERT_EQ(cache.GetStats().miss_count, 1u);
+  ASSERT_EQ(cache.GetStats().eviction_count, 0u);
+}
+
+TEST(RasterCache, PicturesAreRasterizedOnConcurrentWorkers) {
+  size_t threshold = 1;
+  // No pictures may be rasterized on the raster thread.
+  size_t picture_cache_limit_per_frame = 0;
+  flutter::RasterCache cache(threshold, picture_cache_limit_per_frame);
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  cache.SetConcurrentTaskRunner(loop->GetTaskRunner());
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
+
+  cache.SweepAfterFrame();
+
+  // Posts the rasterization to the worker, drawn directly in the meantime.
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Get(*picture, matrix).is_valid());
+
+  // The single worker runs the tasks in order.
+  fml::AutoResetWaitableEvent latch;
+  loop->GetTaskRunner()->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  ASSERT_FALSE(cache.HasValidEntry(*picture, matrix));
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.HasValidEntry(*picture, matrix));
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Get(*picture, matrix).is_valid());
+  ASSERT_EQ(cache.GetCachedBytes(), kSamplePictureBytes);
+}
+
+TEST(RasterCache, ResultsOfConcurrentWorkersAreDroppedWhenCleared) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  cache.SetConcurrentTaskRunner(loop->GetTaskRunner());
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  cache.Get(*picture, matrix);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+
+  fml::AutoResetWaitableEvent latch;
+  loop->GetTaskRunner()->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  // For example, because checkerboarding was toggled.
+  cache.Clear();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  cache.Get(*picture, matrix);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_FALSE(cache.HasValidEntry(*picture, matrix));
+  ASSERT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST(RasterCache, ShadowThresholdIsRespected) {
+  size_t threshold = 2;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkPath path = GetSampleShadowPath(10, 10);
+  SkNoDrawCanvas canvas(200, 200);
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  for (int i = 0; i < 2; i++) {
+    ASSERT_FALSE(cache.PrepareShadow(NULL, path, matrix, srgb.get(),
+                                     SK_ColorBLACK, kSampleElevation, false,
+                                     1.0f));
+    ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorBLACK,
+                                  kSampleElevation, false, 1.0f));
+    cache.SweepAfterFrame();
+  }
+
+  ASSERT_TRUE(cache.PrepareShadow(NULL, path, matrix, srgb.get(),
+                                  SK_ColorBLACK, kSampleElevation, false,
+                                  1.0f));
+  ASSERT_TRUE(cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation,
+                               false, 1.0f));
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 1u);
+  ASSERT_GT(cache.GetCachedBytes(), 0u);
+}
+
+TEST(RasterCache, ShadowsHaveNoKeyWithoutAThreshold) {
+  flutter::RasterCache cache(0);
+
+  SkPath path = GetSampleShadowPath(10, 10);
+  ASSERT_FALSE(cache.GetShadowKey(path, SkMatrix::I(), SK_ColorBLACK,
+                                  kSampleElevation, false, 1.0f));
+}
+
+TEST(RasterCache, ShadowKeyIsOnlyDrawnOnCanvasesWithTheSameKey) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkPath path = GetSampleShadowPath(10, 10);
+  SkNoDrawCanvas canvas(2000, 2000);
+
+  std::optional<ShadowRasterCacheKey> key = cache.GetShadowKey(
+      path, matrix, SK_ColorBLACK, kSampleElevation, false, 1.0f);
+  ASSERT_TRUE(key);
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.PrepareShadow(NULL, *key, srgb.get()));
+  cache.DrawShadow(canvas, *key, path.getBounds());
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.PrepareShadow(NULL, *key, srgb.get()));
+  ASSERT_TRUE(cache.DrawShadow(canvas, *key, path.getBounds()));
+  canvas.translate(0, 1000);
+  ASSERT_FALSE(cache.DrawShadow(canvas, *key, path.getBounds()));
+  canvas.translate(0, -1000);
+  canvas.scale(2, 2);
+  ASSERT_FALSE(cache.DrawShadow(canvas, *key, path.getBounds()));
+}
+
+TEST(RasterCache, ShadowsOfNearbyPathsOfTheSameShapeAreShared) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkPath path = GetSampleShadowPath(10, 10);
+  SkNoDrawCanvas canvas(200, 200);
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.PrepareShadow(NULL, path, matrix, srgb.get(),
+                                   SK_ColorBLACK, kSampleElevation, false,
+                                   1.0f));
+  cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation, false, 1.0f);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.PrepareShadow(NULL, path, matrix, srgb.get(),
+                                  SK_ColorBLACK, kSampleElevation, false,
+                                  1.0f));
+
+  // The light is placed relative to the path, but in device coordinates, so
+  // translating the canvas by a few pixels shifts the spot shadow by much
+  // less than a pixel and moving the path does not shift it at all.
+  SkPath moved_path = GetSampleShadowPath(30, 10);
+  ASSERT_TRUE(cache.DrawShadow(canvas, moved_path, SK_ColorBLACK,
+                               kSampleElevation, false, 1.0f));
+  canvas.translate(0, 20);
+  ASSERT_TRUE(cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation,
+                               false, 1.0f));
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 1u);
+
+  // Other shadows of the same path do not share the entry.
+  ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorRED, kSampleElevation,
+                                false, 1.0f));
+  ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorBLACK,
+                                kSampleElevation * 2, false, 1.0f));
+  ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation,
+                                true, 1.0f));
+  ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation,
+                                false, 2.0f));
+  canvas.scale(2, 2);
+  ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation,
+                                false, 1.0f));
+}
+
+TEST(RasterCache, ShadowsOfDistantPathsAreNotShared) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkPath path = GetSampleShadowPath(10, 10);
+  SkNoDrawCanvas canvas(2000, 2000);
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.PrepareShadow(NULL, path, matrix, srgb.get(),
+                                   SK_ColorBLACK, kSampleElevation, false,
+                                   1.0f));
+  cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation, false, 1.0f);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.PrepareShadow(NULL, path, matrix, srgb.get(),
+                                  SK_ColorBLACK, kSampleElevation, false,
+                                  1.0f));
+
+  // The light does not move with the canvas, so the spot shadow of a path
+  // drawn a thousand pixels down is shifted by several pixels.
+  canvas.translate(0, 1000);
+  ASSERT_FALSE(cache.DrawShadow(canvas, path, SK_ColorBLACK, kSampleElevation,
+                                false, 1.0f));
+}
+
 }  // namespace testing
 }  // namespace flutter
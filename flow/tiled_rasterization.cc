@@ -0,0 +1,172 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/tiled_rasterization.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+
+namespace {
+
+class TiledRasterizationChecker final : public SkNoDrawCanvas {
+ public:
+  TiledRasterizationChecker(int width, int height)
+      : SkNoDrawCanvas(width, height) {}
+
+  bool can_rasterize_tiled() const { return can_rasterize_tiled_; }
+
+ protected:
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    if (rec.fBackdrop) {
+      can_rasterize_tiled_ = false;
+    }
+    return SkNoDrawCanvas::getSaveLayerStrategy(rec);
+  }
+
+  void onDrawDrawable(SkDrawable*, const SkMatrix*) override {
+    // Drawables may draw anything at playback time, and are not required to
+    // support being drawn on several threads at once.
+    can_rasterize_tiled_ = false;
+  }
+
+ private:
+  bool can_rasterize_tiled_ = true;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TiledRasterizationChecker);
+};
+
+// Shared by the calling thread and the helper tasks. Helpers that only start
+// once every tile has been taken return without touching the pixels, so the
+// calling thread only waits for the tiles and not for the helpers.
+class TiledRasterization {
+ public:
+  TiledRasterization(sk_sp<SkPicture> picture,
+                     const SkPixmap& pixels,
+                     const SkSurfaceProps& props,
+                     std::vector<SkIRect> tiles)
+      : picture_(std::move(picture)),
+        pixels_(pixels),
+        props_(props),
+        tiles_(std::move(tiles)),
+        remaining_tiles_(tiles_.size()) {}
+
+  // Rasterizes tiles until none are left to take.
+  void RasterizeTiles() {
+    for (size_t index = next_tile_.fetch_add(1); index < tiles_.size();
+         index = next_tile_.fetch_add(1)) {
+      RasterizeTile(tiles_[index]);
+      remaining_tiles_.CountDown();
+    }
+  }
+
+  void WaitForTiles() { remaining_tiles_.Wait(); }
+
+  size_t tile_count() const { return tiles_.size(); }
+
+ private:
+  const sk_sp<SkPicture> picture_;
+  const SkPixmap pixels_;
+  const SkSurfaceProps props_;
+  const std::vector<SkIRect> tiles_;
+  std::atomic_size_t next_tile_ = {0};
+  fml::CountDownLatch remaining_tiles_;
+
+  void RasterizeTile(const SkIRect& tile) {
+    TRACE_EVENT0("flutter", "RasterizeTile");
+    SkPixmap tile_pixels;
+    if (!pixels_.extractSubset(&tile_pixels, tile)) {
+      return;
+    }
+    auto canvas = SkCanvas::MakeRasterDirect(tile_pixels.info(),
+                                             tile_pixels.writable_addr(),
+                                             tile_pixels.rowBytes(), &props_);
+    if (!canvas) {
+      return;
+    }
+    canvas->translate(-tile.x(), -tile.y());
+    canvas->drawPicture(picture_);
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TiledRasterization);
+};
+
+}  // namespace
+
+bool RasterizePictureTiled(
+    const sk_sp<SkPicture>& picture,
+    SkSurface* surface,
+    const SkIRect& dirty_bounds,
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t helper_count) {
+  TRACE_EVENT0("flutter", "RasterizePictureTiled");
+  if (!picture || !surface) {
+    return false;
+  }
+
+  {
+    TRACE_EVENT0("flutter", "CheckTiledRasterization");
+    TiledRasterizationChecker checker(surface->width(), surface->height());
+    picture->playback(&checker);
+    if (!checker.can_rasterize_tiled()) {
+      return false;
+    }
+  }
+
+  // Snapshots of the surface share its pixels until it is drawn to again, so
+  // they have to be copied before the pixels are written behind its back.
+  surface->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+  SkPixmap pixels;
+  if (!surface->peekPixels(&pixels)) {
+    return false;
+  }
+
+  // Tiles are only clipped to the surface, so that each of them starts at a
+  // multiple of the tile size.
+  const SkIRect surface_bounds =
+      SkIRect::MakeWH(pixels.width(), pixels.height());
+  SkIRect bounds = surface_bounds;
+  if (!bounds.intersect(dirty_bounds)) {
+    return true;
+  }
+  std::vector<SkIRect> tiles;
+  const int first_column = bounds.left() / kRasterizationTileSize;
+  const int first_row = bounds.top() / kRasterizationTileSize;
+  for (int y = first_row * kRasterizationTileSize; y < bounds.bottom();
+       y += kRasterizationTileSize) {
+    for (int x = first_column * kRasterizationTileSize; x < bounds.right();
+         x += kRasterizationTileSize) {
+      SkIRect tile = SkIRect::MakeXYWH(x, y, kRasterizationTileSize,
+                                       kRasterizationTileSize);
+      if (tile.intersect(surface_bounds)) {
+        tiles.push_back(tile);
+      }
+    }
+  }
+
+  auto rasterization = std::make_shared<TiledRasterization>(
+      picture, pixels, surface->props(), std::move(tiles));
+  if (task_runner) {
+    // The calling thread takes one of the tiles itself.
+    const size_t task_count =
+        std::min(helper_count, rasterization->tile_count() - 1);
+    for (size_t i = 0; i < task_count; i++) {
+      task_runner->PostTask(
+          [rasterization]() { rasterization->RasterizeTiles(); });
+    }
+  }
+  rasterization->RasterizeTiles();
+  rasterization->WaitForTiles();
+  return true;
+}
+
+}  // namespace flutter
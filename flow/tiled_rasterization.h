@@ -0,0 +1,43 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_TILED_RASTERIZATION_H_
+#define FLUTTER_FLOW_TILED_RASTERIZATION_H_
+
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+// The size of the square tiles that |RasterizePictureTiled| splits the pixels
+// into. A multiple of the size of the dither matrices used by Skia so that
+// every tile dithers exactly like the whole frame would.
+constexpr int kRasterizationTileSize = 256;
+
+// Draws |picture| into the pixels of the CPU backed |surface| with an identity
+// matrix and no clip, but splits the surface into tiles that are rasterized in
+// parallel. The calling thread rasterizes tiles too and up to |helper_count|
+// tasks posted to |task_runner| (if any) help it. Tiles that do not intersect
+// |dirty_bounds| are left untouched, the others are drawn in full. Returns
+// once every tile has been rasterized.
+//
+// Each tile has a canvas of its own that can only see the pixels of the tile.
+// Pictures that read back the pixels they draw onto (backdrop filters) would
+// miss the pixels of their neighboring tiles, so those are not rasterized at
+// all and false is returned. False is also returned if the pixels of |surface|
+// cannot be accessed directly. The caller must then draw the picture itself.
+bool RasterizePictureTiled(
+    const sk_sp<SkPicture>& picture,
+    SkSurface* surface,
+    const SkIRect& dirty_bounds,
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t helper_count);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_TILED_RASTERIZATION_H_
@@ -0,0 +1,158 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/tiled_rasterization.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/effects/SkBlurImageFilter.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+
+namespace flutter {
+namespace testing {
+namespace {
+
+constexpr int kWidth = 700;
+constexpr int kHeight = 500;
+
+template <class DrawFunction>
+sk_sp<SkPicture> RecordPicture(DrawFunction draw) {
+  SkPictureRecorder recorder;
+  draw(recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight)));
+  return recorder.finishRecordingAsPicture();
+}
+
+sk_sp<SkSurface> MakeSurface(SkColor color) {
+  auto surface = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  surface->getCanvas()->clear(color);
+  return surface;
+}
+
+bool HaveSamePixels(SkSurface* a, SkSurface* b) {
+  SkPixmap a_pixels, b_pixels;
+  if (!a->peekPixels(&a_pixels) || !b->peekPixels(&b_pixels)) {
+    return false;
+  }
+  for (int y = 0; y < kHeight; y++) {
+    if (memcmp(a_pixels.addr32(0, y), b_pixels.addr32(0, y),
+               kWidth * sizeof(uint32_t)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SkColor GetPixel(SkSurface* surface, int x, int y) {
+  SkPixmap pixels;
+  if (!surface->peekPixels(&pixels)) {
+    return SK_ColorTRANSPARENT;
+  }
+  return pixels.getColor(x, y);
+}
+
+}  // namespace
+
+TEST(TiledRasterizationTest, MatchesRasterizationWithoutTiles) {
+  // Shapes, gradients and filters that all cross the edges of the tiles.
+  auto picture = RecordPicture([](SkCanvas* canvas) {
+    canvas->clear(SK_ColorWHITE);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    SkPoint points[] = {SkPoint::Make(0, 0), SkPoint::Make(kWidth, kHeight)};
+    SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    paint.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2,
+                                                 SkTileMode::kClamp));
+    paint.setDither(true);
+    canvas->drawCircle(kWidth / 2, kHeight / 2, 200, paint);
+    paint.setShader(nullptr);
+    paint.setColor(SK_ColorGREEN);
+    paint.setImageFilter(SkBlurImageFilter::Make(10, 10, nullptr));
+    canvas->rotate(15);
+    canvas->drawRect(SkRect::MakeLTRB(200, 100, 400, 300), paint);
+  });
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+
+  auto expected = MakeSurface(SK_ColorTRANSPARENT);
+  expected->getCanvas()->drawPicture(picture);
+  auto tiled = MakeSurface(SK_ColorTRANSPARENT);
+  ASSERT_TRUE(RasterizePictureTiled(picture, tiled.get(),
+                                    SkIRect::MakeWH(kWidth, kHeight),
+                                    loop->GetTaskRunner(), 4));
+
+  EXPECT_TRUE(HaveSamePixels(tiled.get(), expected.get()));
+}
+
+TEST(TiledRasterizationTest, RasterizesOnCallingThreadWithoutTaskRunner) {
+  auto picture = RecordPicture([](SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawCircle(kWidth / 2, kHeight / 2, 200, paint);
+  });
+
+  auto expected = MakeSurface(SK_ColorWHITE);
+  expected->getCanvas()->drawPicture(picture);
+  auto tiled = MakeSurface(SK_ColorWHITE);
+  ASSERT_TRUE(RasterizePictureTiled(picture, tiled.get(),
+                                    SkIRect::MakeWH(kWidth, kHeight), nullptr,
+                                    0));
+
+  EXPECT_TRUE(HaveSamePixels(tiled.get(), expected.get()));
+}
+
+TEST(TiledRasterizationTest, OnlyRasterizesDirtyTiles) {
+  auto picture = RecordPicture(
+      [](SkCanvas* canvas) { canvas->drawColor(SK_ColorBLUE); });
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+
+  auto surface = MakeSurface(SK_ColorRED);
+  ASSERT_TRUE(RasterizePictureTiled(picture, surface.get(),
+                                    SkIRect::MakeLTRB(10, 10, 20, 20),
+                                    loop->GetTaskRunner(), 4));
+
+  // The whole tile containing the dirty bounds is drawn.
+  EXPECT_EQ(GetPixel(surface.get(), 0, 0), SK_ColorBLUE);
+  EXPECT_EQ(GetPixel(surface.get(), kRasterizationTileSize - 1,
+                     kRasterizationTileSize - 1),
+            SK_ColorBLUE);
+  EXPECT_EQ(GetPixel(surface.get(), kRasterizationTileSize, 0), SK_ColorRED);
+  EXPECT_EQ(GetPixel(surface.get(), 0, kRasterizationTileSize), SK_ColorRED);
+}
+
+TEST(TiledRasterizationTest, KeepsSnapshotsOfTheSurface) {
+  auto picture = RecordPicture(
+      [](SkCanvas* canvas) { canvas->drawColor(SK_ColorBLUE); });
+  auto surface = MakeSurface(SK_ColorRED);
+  auto snapshot = surface->makeImageSnapshot();
+
+  ASSERT_TRUE(RasterizePictureTiled(picture, surface.get(),
+                                    SkIRect::MakeWH(kWidth, kHeight), nullptr,
+                                    0));
+
+  SkPixmap snapshot_pixels;
+  ASSERT_TRUE(snapshot->peekPixels(&snapshot_pixels));
+  EXPECT_EQ(snapshot_pixels.getColor(0, 0), SK_ColorRED);
+  EXPECT_EQ(GetPixel(surface.get(), 0, 0), SK_ColorBLUE);
+}
+
+TEST(TiledRasterizationTest, RejectsBackdropFilters) {
+  auto picture = RecordPicture([](SkCanvas* canvas) {
+    auto filter = SkBlurImageFilter::Make(5, 5, nullptr);
+    canvas->saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr, filter.get(),
+                                             0));
+    canvas->restore();
+  });
+
+  auto surface = MakeSurface(SK_ColorRED);
+  EXPECT_FALSE(RasterizePictureTiled(picture, surface.get(),
+                                     SkIRect::MakeWH(kWidth, kHeight),
+                                     nullptr, 0));
+  EXPECT_EQ(GetPixel(surface.get(), 0, 0), SK_ColorRED);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/compression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace fml {
+
+namespace {
+
+// See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md for the
+// format and the constraints on the end of a block.
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchStartLimit = 12;
+constexpr size_t kMaxOffset = std::numeric_limits<uint16_t>::max();
+constexpr size_t kHashBits = 16;
+
+uint32_t Read32(const uint8_t* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void WriteLength(std::vector<uint8_t>& output, size_t length) {
+  for (; length >= 255; length -= 255) {
+    output.push_back(255);
+  }
+  output.push_back(static_cast<uint8_t>(length));
+}
+
+void WriteSequence(std::vector<uint8_t>& output,
+                   const uint8_t* literals,
+                   size_t literal_count,
+                   size_t offset,
+                   size_t match_length) {
+  const size_t match_code = match_length - kMinMatch;
+  output.push_back(static_cast<uint8_t>(
+      (std::min<size_t>(literal_count, 15) << 4) |
+      (offset == 0 ? 0 : std::min<size_t>(match_code, 15))));
+  if (literal_count >= 15) {
+    WriteLength(output, literal_count - 15);
+  }
+  output.insert(output.end(), literals, literals + literal_count);
+  if (offset == 0) {
+    // The last sequence only has literals.
+    return;
+  }
+  output.push_back(static_cast<uint8_t>(offset & 0xff));
+  output.push_back(static_cast<uint8_t>(offset >> 8));
+  if (match_code >= 15) {
+    WriteLength(output, match_code - 15);
+  }
+}
+
+bool ReadLength(const uint8_t* data, size_t size, size_t& index, size_t& out) {
+  uint8_t byte;
+  do {
+    if (index >= size) {
+      return false;
+    }
+    byte = data[index++];
+    out += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+std::vector<uint8_t> CompressLZ4(const uint8_t* data, size_t size) {
+  std::vector<uint8_t> output;
+  output.reserve(size + size / 255 + 16);
+
+  // The position of the last occurrence of each hashed sequence, plus one.
+  std::vector<size_t> positions(size_t{1} << kHashBits, 0);
+  size_t anchor = 0;
+  size_t index = 0;
+  while (size >= kMatchStartLimit && index <= size - kMatchStartLimit) {
+    const uint32_t sequence = Read32(data + index);
+    size_t& position = positions[Hash(sequence)];
+    const size_t candidate = position - 1;
+    position = index + 1;
+    if (candidate == std::numeric_limits<size_t>::max() ||
+        index - candidate > kMaxOffset ||
+        Read32(data + candidate) != sequence) {
+      index++;
+      continue;
+    }
+
+    size_t match_length = kMinMatch;
+    while (index + match_length < size - kLastLiterals &&
+           data[candidate + match_length] == data[index + match_length]) {
+      match_length++;
+    }
+    WriteSequence(output, data + anchor, index - anchor, index - candidate,
+                  match_length);
+    index += match_length;
+    anchor = index;
+  }
+  WriteSequence(output, data + anchor, size - anchor, 0, kMinMatch);
+  return output;
+}
+
+bool DecompressLZ4(const uint8_t* data,
+                   size_t size,
+                   uint8_t* decompressed,
+                   size_t decompressed_size) {
+  size_t input = 0;
+  size_t output = 0;
+  while (input < size) {
+    const uint8_t token = data[input++];
+
+    size_t literal_count = token >> 4;
+    if (literal_count == 15 && !ReadLength(data, size, input, literal_count)) {
+      return false;
+    }
+    if (literal_count > size - input ||
+        literal_count > decompressed_size - output) {
+      return false;
+    }
+    std::memcpy(decompressed + output, data + input, literal_count);
+    input += literal_count;
+    output += literal_count;
+
+    if (input == size) {
+      // The last sequence only has literals.
+      return output == decompressed_size;
+    }
+
+    if (size - input < 2) {
+      return false;
+    }
+    const size_t offset = data[input] | (data[input + 1] << 8);
+    input += 2;
+    if (offset == 0 || offset > output) {
+      return false;
+    }
+
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLength(data, size, input, match_length)) {
+      return false;
+    }
+    match_length += kMinMatch;
+    if (match_length > decompressed_size - output) {
+      return false;
+    }
+    // Matches may overlap the bytes they produce, so copy one at a time.
+    for (size_t i = 0; i < match_length; i++, output++) {
+      decompressed[output] = decompressed[output - offset];
+    }
+  }
+  // A valid block always ends with literals, even if there are none.
+  return false;
+}
+
+}  // namespace fml
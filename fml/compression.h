@@ -0,0 +1,29 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_COMPRESSION_H_
+#define FLUTTER_FML_COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fml {
+
+/// Compresses `size` bytes at `data` into a block in the LZ4 block format,
+/// without a frame. Compression is fast and decompression is much faster, at
+/// the expense of ratio.
+std::vector<uint8_t> CompressLZ4(const uint8_t* data, size_t size);
+
+/// Decompresses the LZ4 block of `size` bytes at `data` into exactly
+/// `decompressed_size` bytes at `decompressed`. Returns false if the block is
+/// malformed or does not decompress to that size.
+bool DecompressLZ4(const uint8_t* data,
+                   size_t size,
+                   uint8_t* decompressed,
+                   size_t decompressed_size);
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_COMPRESSION_H_
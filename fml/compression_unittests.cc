@@ -0,0 +1,68 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/compression.h"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+namespace {
+
+void RoundTripLZ4(const std::vector<uint8_t>& data) {
+  auto compressed = CompressLZ4(data.data(), data.size());
+  std::vector<uint8_t> decompressed(data.size());
+  ASSERT_TRUE(DecompressLZ4(compressed.data(), compressed.size(),
+                            decompressed.data(), decompressed.size()));
+  ASSERT_EQ(decompressed, data);
+}
+
+}  // namespace
+
+TEST(CompressionTest, LZ4RoundTripsCompressibleData) {
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i < 100000; i++) {
+    data.push_back("flutter"[i % 7]);
+  }
+  RoundTripLZ4(data);
+  ASSERT_LT(CompressLZ4(data.data(), data.size()).size(), data.size() / 50);
+}
+
+TEST(CompressionTest, LZ4RoundTripsIncompressibleData) {
+  std::mt19937 random(42);
+  std::vector<uint8_t> data(70000);
+  for (auto& byte : data) {
+    byte = random() & 0xff;
+  }
+  RoundTripLZ4(data);
+}
+
+TEST(CompressionTest, LZ4RoundTripsShortData) {
+  for (size_t size = 0; size < 32; size++) {
+    RoundTripLZ4(std::vector<uint8_t>(size, 'a'));
+  }
+}
+
+TEST(CompressionTest, LZ4RejectsMalformedBlocks) {
+  std::vector<uint8_t> data(1000, 'x');
+  auto compressed = CompressLZ4(data.data(), data.size());
+  std::vector<uint8_t> decompressed(data.size());
+
+  // Truncated.
+  ASSERT_FALSE(DecompressLZ4(compressed.data(), compressed.size() - 1,
+                             decompressed.data(), decompressed.size()));
+  // Wrong decompressed size.
+  ASSERT_FALSE(DecompressLZ4(compressed.data(), compressed.size(),
+                             decompressed.data(), decompressed.size() - 1));
+  // A match referring to bytes before the start of the output.
+  const uint8_t bad_offset[] = {0x10, 'a', 0x02, 0x00, 0x00};
+  ASSERT_FALSE(
+      DecompressLZ4(bad_offset, sizeof(bad_offset), decompressed.data(), 5));
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -5,25 +5,65 @@
 #include "flutter/fml/concurrent_message_loop.h"
 
 #include <algorithm>
+#include <random>
 
+#include "flutter/fml/synchronization/work_stealing_deque.h"
 #include "flutter/fml/thread.h"
+#include "flutter/fml/thread_local.h"
 #include "flutter/fml/trace_event.h"
 
 namespace fml {
 
+// The maximum number of tasks a stealing worker moves from the injection
+// queue into its own deque at once. The rest stay behind for other workers.
+static constexpr size_t kMaxInjectedTaskBatch = 32;
+
+struct ConcurrentMessageLoop::StealingWorker {
+  WorkStealingDeque<fml::UniqueClosure*> deque;
+  std::minstd_rand random;
+  std::atomic_bool has_thread_tasks = {false};
+
+  explicit StealingWorker(size_t index) : random(index + 1) {}
+};
+
+namespace {
+
+struct StealingWorkerIdentity {
+  const ConcurrentMessageLoop* loop = nullptr;
+  size_t index = 0;
+};
+
+}  // namespace
+
+FML_THREAD_LOCAL ThreadLocalUniquePtr<StealingWorkerIdentity>
+    tls_stealing_worker;
+
 std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
-    size_t worker_count) {
+    size_t worker_count,
+    SchedulingMode mode) {
   return std::shared_ptr<ConcurrentMessageLoop>{
-      new ConcurrentMessageLoop(worker_count)};
+      new ConcurrentMessageLoop(worker_count, mode)};
 }
 
-ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
-    : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count,
+                                             SchedulingMode mode)
+    : mode_(mode), worker_count_(std::max<size_t>(worker_count, 1ul)) {
+  if (mode_ == SchedulingMode::kWorkStealing) {
+    // All deques must exist before any worker starts looking for victims.
+    for (size_t i = 0; i < worker_count_; ++i) {
+      stealing_workers_.emplace_back(std::make_unique<StealingWorker>(i));
+    }
+  }
+
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.flutter.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      if (mode_ == SchedulingMode::kWorkStealing) {
+        StealingWorkerMain(i);
+      } else {
+        WorkerMain();
+      }
     });
   }
 
@@ -37,21 +77,44 @@ ConcurrentMessageLoop::~ConcurrentMessageLoop() {
   for (auto& worker : workers_) {
     worker.join();
   }
+
+  // Workers drain their deques before exiting. This only collects tasks that
+  // lost a race with shutdown.
+  for (auto& worker : stealing_workers_) {
+    while (auto task = worker->deque.Steal()) {
+      delete task;
+    }
+  }
 }
 
 size_t ConcurrentMessageLoop::GetWorkerCount() const {
   return worker_count_;
 }
 
+ConcurrentMessageLoop::SchedulingMode
+ConcurrentMessageLoop::GetSchedulingMode() const {
+  return mode_;
+}
+
 std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+void ConcurrentMessageLoop::PostTask(fml::UniqueClosure task) {
   if (!task) {
     return;
   }
 
+  // Tasks posted from one of our own stealing workers go to that worker's
+  // deque without taking any locks.
+  if (auto identity = tls_stealing_worker.get();
+      identity != nullptr && identity->loop == this) {
+    stealing_workers_[identity->index]->deque.Push(
+        new fml::UniqueClosure(std::move(task)));
+    WakeParkedWorker();
+    return;
+  }
+
   std::unique_lock lock(tasks_mutex_);
 
   // Don't just drop tasks on the floor in case of shutdown.
@@ -64,7 +127,8 @@ void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
     return;
   }
 
-  tasks_.push(task);
+  tasks_.push(std::move(task));
+  injected_task_count_.fetch_add(1);
 
   // Unlock the mutex before notifying the condition variable because that mutex
   // has to be acquired on the other thread anyway. Waiting in this scope till
@@ -83,12 +147,13 @@ void ConcurrentMessageLoop::WorkerMain() {
 
     // Shutdown cannot be read with the task mutex unlocked.
     bool shutdown_now = shutdown_;
-    fml::closure task;
+    fml::UniqueClosure task;
     std::vector<fml::closure> thread_tasks;
 
     if (tasks_.size() != 0) {
-      task = tasks_.front();
+      task = std::move(tasks_.front());
       tasks_.pop();
+      injected_task_count_.fetch_sub(1);
     }
 
     if (HasThreadTasksLocked()) {
@@ -117,6 +182,155 @@ void ConcurrentMessageLoop::WorkerMain() {
   }
 }
 
+void ConcurrentMessageLoop::StealingWorkerMain(size_t worker_index) {
+  tls_stealing_worker.reset(new StealingWorkerIdentity{this, worker_index});
+  auto& worker = *stealing_workers_[worker_index];
+
+  while (true) {
+    if (worker.has_thread_tasks.load()) {
+      std::vector<fml::closure> thread_tasks;
+      {
+        std::scoped_lock lock(tasks_mutex_);
+        worker.has_thread_tasks = false;
+        if (HasThreadTasksLocked()) {
+          thread_tasks = GetThreadTasksLocked();
+        }
+      }
+      for (const auto& thread_task : thread_tasks) {
+        thread_task();
+      }
+    }
+
+    if (auto task = FindStealingTask(worker_index)) {
+      (*task)();
+      continue;
+    }
+
+    // Nothing to do. Announce that this worker is about to park before
+    // checking for work one final time. A producer that publishes a task
+    // after that check is guaranteed to observe the parked count and notify.
+    parked_worker_count_.fetch_add(1);
+    std::unique_lock lock(tasks_mutex_);
+    tasks_condition_.wait(lock, [&]() {
+      return shutdown_ || tasks_.size() > 0 || HasThreadTasksLocked() ||
+             HasStealableTasks();
+    });
+    parked_worker_count_.fetch_sub(1);
+
+    // Unlike the shared queue mode, drain all remaining work before exiting
+    // since tasks in the deques cannot be handed to another worker later.
+    if (shutdown_ && tasks_.size() == 0 && !HasThreadTasksLocked() &&
+        !HasStealableTasks()) {
+      break;
+    }
+
+    if (HasThreadTasksLocked()) {
+      worker.has_thread_tasks = true;
+    }
+    lock.unlock();
+
+    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
+  }
+
+  tls_stealing_worker.reset(nullptr);
+}
+
+std::unique_ptr<fml::UniqueClosure> ConcurrentMessageLoop::FindStealingTask(
+    size_t worker_index) {
+  if (auto task = stealing_workers_[worker_index]->deque.Pop()) {
+    return std::unique_ptr<fml::UniqueClosure>(task);
+  }
+
+  if (auto task = TakeInjectedTasks(worker_index)) {
+    return task;
+  }
+
+  return StealTask(worker_index);
+}
+
+std::unique_ptr<fml::UniqueClosure> ConcurrentMessageLoop::TakeInjectedTasks(
+    size_t worker_index) {
+  if (injected_task_count_.load() == 0) {
+    return nullptr;
+  }
+
+  std::unique_lock lock(tasks_mutex_);
+  if (tasks_.size() == 0) {
+    return nullptr;
+  }
+
+  // Take a fair share of the injected tasks so that a burst of posts from a
+  // non-worker thread is spread across workers through stealing instead of
+  // every worker going back to the mutex for each task.
+  const size_t batch =
+      std::min(kMaxInjectedTaskBatch,
+               std::max<size_t>(tasks_.size() / worker_count_, 1));
+
+  auto task = std::make_unique<fml::UniqueClosure>(std::move(tasks_.front()));
+  tasks_.pop();
+  auto& deque = stealing_workers_[worker_index]->deque;
+  for (size_t i = 1; i < batch; ++i) {
+    deque.Push(new fml::UniqueClosure(std::move(tasks_.front())));
+    tasks_.pop();
+  }
+  injected_task_count_.fetch_sub(batch);
+  lock.unlock();
+
+  if (batch > 1) {
+    WakeParkedWorker();
+  }
+
+  return task;
+}
+
+std::unique_ptr<fml::UniqueClosure> ConcurrentMessageLoop::StealTask(
+    size_t worker_index) {
+  if (worker_count_ < 2) {
+    return nullptr;
+  }
+
+  // Visit every other worker once, starting at a random victim so that
+  // thieves don't all converge on the same deque.
+  auto& random = stealing_workers_[worker_index]->random;
+  const size_t start = random() % worker_count_;
+  for (size_t i = 0; i < worker_count_; ++i) {
+    const size_t victim = (start + i) % worker_count_;
+    if (victim == worker_index) {
+      continue;
+    }
+    if (auto task = stealing_workers_[victim]->deque.Steal()) {
+      return std::unique_ptr<fml::UniqueClosure>(task);
+    }
+  }
+
+  return nullptr;
+}
+
+bool ConcurrentMessageLoop::HasStealableTasks() const {
+  for (const auto& worker : stealing_workers_) {
+    if (worker->deque.ApproximateSize() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ConcurrentMessageLoop::WakeParkedWorker() {
+  // Orders the publication of the task before the read of the parked count.
+  // Pairs with the increment of the count in |StealingWorkerMain|.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (parked_worker_count_.load() == 0) {
+    return;
+  }
+
+  // The parked worker re-checks for work under the mutex before waiting, so
+  // acquiring it here ensures the notification cannot be lost.
+  {
+    std::scoped_lock lock(tasks_mutex_);
+  }
+  tasks_condition_.notify_one();
+}
+
 void ConcurrentMessageLoop::Terminate() {
   std::scoped_lock lock(tasks_mutex_);
   shutdown_ = true;
@@ -132,6 +346,9 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
   for (const auto& worker_thread_id : worker_thread_ids_) {
     thread_tasks_[worker_thread_id].emplace_back(task);
   }
+  for (auto& worker : stealing_workers_) {
+    worker->has_thread_tasks = true;
+  }
   tasks_condition_.notify_all();
 }
 
@@ -154,13 +371,13 @@ ConcurrentTaskRunner::ConcurrentTaskRunner(
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(fml::UniqueClosure task) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(std::move(task));
     return;
   }
 
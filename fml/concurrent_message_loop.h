@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <queue>
@@ -12,6 +13,7 @@
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
+#include "flutter/fml/unique_closure.h"
 
 namespace fml {
 
@@ -20,13 +22,26 @@ class ConcurrentTaskRunner;
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
+  enum class SchedulingMode {
+    // All workers wait on a single queue guarded by one mutex.
+    kSharedQueue,
+    // Each worker owns a lock-free deque. Tasks posted from a worker go to
+    // that worker's deque, tasks posted from other threads go to a shared
+    // injection queue that workers drain in batches. Idle workers steal from
+    // randomly selected peers before parking.
+    kWorkStealing,
+  };
+
   static std::shared_ptr<ConcurrentMessageLoop> Create(
-      size_t worker_count = std::thread::hardware_concurrency());
+      size_t worker_count = std::thread::hardware_concurrency(),
+      SchedulingMode mode = SchedulingMode::kSharedQueue);
 
   ~ConcurrentMessageLoop();
 
   size_t GetWorkerCount() const;
 
+  SchedulingMode GetSchedulingMode() const;
+
   std::shared_ptr<ConcurrentTaskRunner> GetTaskRunner();
 
   void Terminate();
@@ -36,25 +51,46 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
+  // Per-worker state used in |SchedulingMode::kWorkStealing|.
+  struct StealingWorker;
+
+  const SchedulingMode mode_;
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
   std::mutex tasks_mutex_;
   std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
+  std::queue<fml::UniqueClosure> tasks_;
   std::vector<std::thread::id> worker_thread_ids_;
   std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
   bool shutdown_ = false;
+  std::vector<std::unique_ptr<StealingWorker>> stealing_workers_;
+  // Mirrors |tasks_.size()| so that stealing workers can skip |tasks_mutex_|
+  // when there is nothing to take.
+  std::atomic_size_t injected_task_count_ = {0};
+  std::atomic_size_t parked_worker_count_ = {0};
 
-  ConcurrentMessageLoop(size_t worker_count);
+  ConcurrentMessageLoop(size_t worker_count, SchedulingMode mode);
 
   void WorkerMain();
 
-  void PostTask(const fml::closure& task);
+  void StealingWorkerMain(size_t worker_index);
+
+  void PostTask(fml::UniqueClosure task);
 
   bool HasThreadTasksLocked() const;
 
   std::vector<fml::closure> GetThreadTasksLocked();
 
+  std::unique_ptr<fml::UniqueClosure> FindStealingTask(size_t worker_index);
+
+  std::unique_ptr<fml::UniqueClosure> TakeInjectedTasks(size_t worker_index);
+
+  std::unique_ptr<fml::UniqueClosure> StealTask(size_t worker_index);
+
+  bool HasStealableTasks() const;
+
+  void WakeParkedWorker();
+
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
 
@@ -64,7 +100,7 @@ class ConcurrentTaskRunner {
 
   ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task);
+  void PostTask(fml::UniqueClosure task);
 
  private:
   friend ConcurrentMessageLoop;
@@ -0,0 +1,79 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <thread>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+
+namespace fml {
+namespace benchmarking {
+
+static constexpr size_t kTasksPerIteration = 10000;
+
+static ConcurrentMessageLoop::SchedulingMode SchedulingModeForArg(
+    int64_t arg) {
+  return arg == 0 ? ConcurrentMessageLoop::SchedulingMode::kSharedQueue
+                  : ConcurrentMessageLoop::SchedulingMode::kWorkStealing;
+}
+
+// Posts every task from the benchmark thread, which is how the raster and IO
+// threads hand work to the loop.
+static void BM_ConcurrentMessageLoopExternalPosts(benchmark::State& state) {
+  auto loop = ConcurrentMessageLoop::Create(
+      state.range(0), SchedulingModeForArg(state.range(1)));
+  auto task_runner = loop->GetTaskRunner();
+  while (state.KeepRunning()) {
+    CountDownLatch latch(kTasksPerIteration);
+    for (size_t i = 0; i < kTasksPerIteration; ++i) {
+      task_runner->PostTask([&latch]() { latch.CountDown(); });
+    }
+    latch.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+
+// Posts a few tasks that each fan out into many more from the workers
+// themselves, which is how image decoding and shader precompilation bursts
+// behave.
+static void BM_ConcurrentMessageLoopFanOutPosts(benchmark::State& state) {
+  auto loop = ConcurrentMessageLoop::Create(
+      state.range(0), SchedulingModeForArg(state.range(1)));
+  auto task_runner = loop->GetTaskRunner();
+  const size_t fan_out = 100;
+  while (state.KeepRunning()) {
+    CountDownLatch latch(kTasksPerIteration);
+    for (size_t i = 0; i < kTasksPerIteration / fan_out; ++i) {
+      task_runner->PostTask([&latch, task_runner, fan_out]() {
+        for (size_t j = 0; j < fan_out; ++j) {
+          task_runner->PostTask([&latch]() { latch.CountDown(); });
+        }
+      });
+    }
+    latch.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+
+static void WorkerCountsAndModes(benchmark::internal::Benchmark* benchmark) {
+  const int max_workers =
+      std::max<int>(std::thread::hardware_concurrency(), 1);
+  for (int mode = 0; mode < 2; ++mode) {
+    for (int workers = 1; workers <= max_workers; workers *= 2) {
+      benchmark->Args({workers, mode});
+    }
+    if ((max_workers & (max_workers - 1)) != 0) {
+      benchmark->Args({max_workers, mode});
+    }
+  }
+  benchmark->UseRealTime();
+}
+
+BENCHMARK(BM_ConcurrentMessageLoopExternalPosts)->Apply(WorkerCountsAndModes);
+BENCHMARK(BM_ConcurrentMessageLoopFanOutPosts)->Apply(WorkerCountsAndModes);
+
+}  // namespace benchmarking
+}  // namespace fml
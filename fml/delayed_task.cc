@@ -8,23 +8,47 @@
 
 namespace fml {
 
+fml::TimeDelta GetStarvationLimit(TaskPriority priority) {
+  switch (priority) {
+    case TaskPriority::kVsync:
+      return fml::TimeDelta::Zero();
+    case TaskPriority::kInput:
+      return fml::TimeDelta::FromMilliseconds(16);
+    case TaskPriority::kNormal:
+      return fml::TimeDelta::FromMilliseconds(100);
+    case TaskPriority::kIdle:
+      return fml::TimeDelta::FromSeconds(1);
+  }
+  return fml::TimeDelta::Zero();
+}
+
 DelayedTask::DelayedTask(size_t order,
-                         const fml::closure& task,
-                         fml::TimePoint target_time)
-    : order_(order), task_(task), target_time_(target_time) {}
+                         fml::UniqueClosure task,
+                         fml::TimePoint target_time,
+                         TaskPriority priority)
+    : order_(order),
+      task_(std::move(task)),
+      target_time_(target_time),
+      priority_(priority) {}
 
-DelayedTask::DelayedTask(const DelayedTask& other) = default;
+DelayedTask::DelayedTask(DelayedTask&& other) = default;
+
+DelayedTask& DelayedTask::operator=(DelayedTask&& other) = default;
 
 DelayedTask::~DelayedTask() = default;
 
-const fml::closure& DelayedTask::GetTask() const {
-  return task_;
+fml::UniqueClosure DelayedTask::TakeTask() {
+  return std::move(task_);
 }
 
 fml::TimePoint DelayedTask::GetTargetTime() const {
   return target_time_;
 }
 
+TaskPriority DelayedTask::GetPriority() const {
+  return priority_;
+}
+
 bool DelayedTask::operator>(const DelayedTask& other) const {
   if (target_time_ == other.target_time_) {
     return order_ > other.order_;
@@ -5,38 +5,80 @@
 #ifndef FLUTTER_FML_DELAYED_TASK_H_
 #define FLUTTER_FML_DELAYED_TASK_H_
 
-#include "flutter/fml/closure.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 
+#include <algorithm>
 #include <queue>
+#include <vector>
 
 namespace fml {
 
+// The classes of tasks, from the highest priority to the lowest. A due task
+// runs ahead of due tasks of lower priority unless those have waited for
+// longer than their class tolerates.
+enum class TaskPriority {
+  // Work for the frame being produced, like the vsync callback.
+  kVsync,
+  // Delivering input to the framework.
+  kInput,
+  // Everything else.
+  kNormal,
+  // Work that may wait until the loop has nothing else to do.
+  kIdle,
+};
+
+constexpr size_t kTaskPriorityCount =
+    static_cast<size_t>(TaskPriority::kIdle) + 1;
+
+// How long a due task of |priority| may wait while due tasks of higher
+// priority run ahead of it. Due tasks that have waited for longer than that
+// run in order of their deadlines, their target times plus this limit.
+fml::TimeDelta GetStarvationLimit(TaskPriority priority);
+
 class DelayedTask {
  public:
   DelayedTask(size_t order,
-              const fml::closure& task,
-              fml::TimePoint target_time);
+              fml::UniqueClosure task,
+              fml::TimePoint target_time,
+              TaskPriority priority = TaskPriority::kNormal);
 
-  DelayedTask(const DelayedTask& other);
+  DelayedTask(DelayedTask&& other);
+
+  DelayedTask& operator=(DelayedTask&& other);
 
   ~DelayedTask();
 
-  const fml::closure& GetTask() const;
+  fml::UniqueClosure TakeTask();
 
   fml::TimePoint GetTargetTime() const;
 
+  TaskPriority GetPriority() const;
+
   bool operator>(const DelayedTask& other) const;
 
  private:
   size_t order_;
-  fml::closure task_;
+  fml::UniqueClosure task_;
   fml::TimePoint target_time_;
+  TaskPriority priority_;
 };
 
-using DelayedTaskQueue = std::priority_queue<DelayedTask,
-                                             std::deque<DelayedTask>,
-                                             std::greater<DelayedTask>>;
+// Tasks are move-only, so the next one is taken out of the queue with |Pop|
+// rather than copied from |top|. Backed by a vector, which keeps its capacity
+// as tasks come and go.
+class DelayedTaskQueue
+    : public std::priority_queue<DelayedTask,
+                                 std::vector<DelayedTask>,
+                                 std::greater<DelayedTask>> {
+ public:
+  DelayedTask Pop() {
+    std::pop_heap(c.begin(), c.end(), comp);
+    DelayedTask task = std::move(c.back());
+    c.pop_back();
+    return task;
+  }
+};
 
 }  // namespace fml
 
@@ -90,6 +90,11 @@ bool WriteAtomically(const fml::UniqueFD& base_directory,
                      const char* file_name,
                      const Mapping& mapping);
 
+/// Writes the contents of `mapping` at the end of `file`, which must have been
+/// opened for writing. Returns false if not all of it could be written, in
+/// which case part of it may have been.
+bool AppendToFile(const fml::UniqueFD& file, const Mapping& mapping);
+
 /// Signature of a callback on a file in `directory` with `filename` (relative
 /// to `directory`). The returned bool should be false if and only if further
 /// traversal should be stopped. For example, a file-search visitor may return
@@ -124,6 +129,25 @@ bool VisitFiles(const fml::UniqueFD& directory, const FileVisitor& visitor);
 bool VisitFilesRecursively(const fml::UniqueFD& directory,
                            const FileVisitor& visitor);
 
+/// Holds an exclusive lock on a file while it is in scope, waiting for any
+/// other process holding a lock on it to release it first. The lock is
+/// advisory: it only excludes other users of |ScopedFileLock|.
+class ScopedFileLock {
+ public:
+  /// `file` must outlive the lock.
+  explicit ScopedFileLock(const fml::UniqueFD& file);
+
+  ~ScopedFileLock();
+
+  bool is_locked() const { return is_locked_; }
+
+ private:
+  const fml::UniqueFD& file_;
+  bool is_locked_ = false;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ScopedFileLock);
+};
+
 class ScopedTemporaryDirectory {
  public:
   ScopedTemporaryDirectory();
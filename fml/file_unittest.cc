@@ -8,9 +8,11 @@
 #include "gtest/gtest.h"
 
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/fml/unique_fd.h"
 
 static bool WriteStringToFile(const fml::UniqueFD& fd,
@@ -253,6 +255,46 @@ TEST(FileTest, AtomicWriteTest) {
   ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "precious_data"));
 }
 
+TEST(FileTest, AppendToFileTest) {
+  fml::ScopedTemporaryDirectory dir;
+
+  {
+    auto file = fml::OpenFile(dir.fd(), "log", true,
+                              fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(WriteStringToFile(file, "first"));
+    ASSERT_TRUE(fml::AppendToFile(file, fml::DataMapping(" second")));
+    ASSERT_TRUE(fml::AppendToFile(file, fml::DataMapping("")));
+    ASSERT_TRUE(fml::AppendToFile(file, fml::DataMapping(" third")));
+  }
+
+  ASSERT_EQ("first second third",
+            ReadStringFromFile(fml::OpenFile(dir.fd(), "log", false,
+                                             fml::FilePermission::kRead)));
+
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "log"));
+}
+
+TEST(FileTest, ScopedFileLockTest) {
+  fml::ScopedTemporaryDirectory dir;
+
+  {
+    auto file =
+        fml::OpenFile(dir.fd(), "lock", true, fml::FilePermission::kReadWrite);
+    auto other_file = fml::OpenFile(dir.fd(), "lock", false,
+                                    fml::FilePermission::kReadWrite);
+    {
+      fml::ScopedFileLock lock(file);
+      ASSERT_TRUE(lock.is_locked());
+    }
+    // The lock was released, so it can be taken through another descriptor.
+    fml::ScopedFileLock lock(other_file);
+    ASSERT_TRUE(lock.is_locked());
+  }
+  ASSERT_FALSE(fml::ScopedFileLock(fml::UniqueFD()).is_locked());
+
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "lock"));
+}
+
 TEST(FileTest, EmptyMappingTest) {
   fml::ScopedTemporaryDirectory dir;
 
@@ -269,6 +311,45 @@ TEST(FileTest, EmptyMappingTest) {
   ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "my_contents"));
 }
 
+TEST(FileTest, MappingWithHintsTest) {
+  fml::ScopedTemporaryDirectory dir;
+  const std::string contents(3 * 4096 + 17, 'x');
+
+  {
+    auto file = fml::OpenFile(dir.fd(), "my_contents", true,
+                              fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(WriteStringToFile(file, contents));
+  }
+
+  auto mapping = fml::FileMapping::CreateReadOnly(
+      dir.fd(), "my_contents",
+      {fml::FileMapping::Hint::kPopulate, fml::FileMapping::Hint::kWillNeed,
+       fml::FileMapping::Hint::kHugePages});
+  ASSERT_TRUE(mapping);
+  ASSERT_EQ(std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                        mapping->GetSize()),
+            contents);
+  mapping.reset();
+
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "my_contents"));
+}
+
+TEST(FileTest, PrefetchMappingKeepsMappingAlive) {
+  std::vector<uint8_t> data(3 * 4096 + 17, 1);
+  fml::AutoResetWaitableEvent released;
+  auto mapping = std::make_shared<fml::NonOwnedMapping>(
+      data.data(), data.size(),
+      [&released](const uint8_t* data, size_t size) { released.Signal(); });
+
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto task_runner = loop->GetTaskRunner();
+  fml::PrefetchMappingAsync(mapping, *task_runner, 4096, 8192);
+  fml::PrefetchMappingAsync(mapping, *task_runner, data.size(), 1);
+  fml::PrefetchMappingAsync(nullptr, *task_runner);
+  mapping.reset();
+  released.Wait();
+}
+
 TEST(FileTest, FileTestsWork) {
   fml::ScopedTemporaryDirectory dir;
   ASSERT_TRUE(dir.fd().is_valid());
@@ -7,8 +7,16 @@
 #include <algorithm>
 #include <sstream>
 
+#include "flutter/fml/concurrent_message_loop.h"
+
 namespace fml {
 
+// Mapping
+
+uint8_t* Mapping::GetMutableMapping() {
+  return nullptr;
+}
+
 // FileMapping
 
 uint8_t* FileMapping::GetMutableMapping() {
@@ -16,21 +24,24 @@ uint8_t* FileMapping::GetMutableMapping() {
 }
 
 std::unique_ptr<FileMapping> FileMapping::CreateReadOnly(
-    const std::string& path) {
+    const std::string& path,
+    std::initializer_list<Hint> hints) {
   return CreateReadOnly(OpenFile(path.c_str(), false, FilePermission::kRead),
-                        "");
+                        "", hints);
 }
 
 std::unique_ptr<FileMapping> FileMapping::CreateReadOnly(
     const fml::UniqueFD& base_fd,
-    const std::string& sub_path) {
+    const std::string& sub_path,
+    std::initializer_list<Hint> hints) {
   if (sub_path.size() != 0) {
     return CreateReadOnly(
-        OpenFile(base_fd, sub_path.c_str(), false, FilePermission::kRead), "");
+        OpenFile(base_fd, sub_path.c_str(), false, FilePermission::kRead), "",
+        hints);
   }
 
   auto mapping = std::make_unique<FileMapping>(
-      base_fd, std::initializer_list<Protection>{Protection::kRead});
+      base_fd, std::initializer_list<Protection>{Protection::kRead}, hints);
 
   if (!mapping->IsValid()) {
     return nullptr;
@@ -40,22 +51,27 @@ std::unique_ptr<FileMapping> FileMapping::CreateReadOnly(
 }
 
 std::unique_ptr<FileMapping> FileMapping::CreateReadExecute(
-    const std::string& path) {
+    const std::string& path,
+    std::initializer_list<Hint> hints) {
   return CreateReadExecute(
-      OpenFile(path.c_str(), false, FilePermission::kRead));
+      OpenFile(path.c_str(), false, FilePermission::kRead), "", hints);
 }
 
 std::unique_ptr<FileMapping> FileMapping::CreateReadExecute(
     const fml::UniqueFD& base_fd,
-    const std::string& sub_path) {
+    const std::string& sub_path,
+    std::initializer_list<Hint> hints) {
   if (sub_path.size() != 0) {
     return CreateReadExecute(
-        OpenFile(base_fd, sub_path.c_str(), false, FilePermission::kRead), "");
+        OpenFile(base_fd, sub_path.c_str(), false, FilePermission::kRead), "",
+        hints);
   }
 
   auto mapping = std::make_unique<FileMapping>(
-      base_fd, std::initializer_list<Protection>{Protection::kRead,
-                                                 Protection::kExecute});
+      base_fd,
+      std::initializer_list<Protection>{Protection::kRead,
+                                        Protection::kExecute},
+      hints);
 
   if (!mapping->IsValid()) {
     return nullptr;
@@ -81,6 +97,10 @@ const uint8_t* DataMapping::GetMapping() const {
   return data_.data();
 }
 
+uint8_t* DataMapping::GetMutableMapping() {
+  return data_.data();
+}
+
 // NonOwnedMapping
 
 NonOwnedMapping::NonOwnedMapping(const uint8_t* data,
@@ -135,4 +155,30 @@ const uint8_t* SymbolMapping::GetMapping() const {
   return mapping_;
 }
 
+// Prefetching
+
+void PrefetchMappingAsync(std::shared_ptr<const Mapping> mapping,
+                          ConcurrentTaskRunner& task_runner,
+                          size_t offset,
+                          size_t length) {
+  if (!mapping || mapping->GetMapping() == nullptr ||
+      offset >= mapping->GetSize()) {
+    return;
+  }
+  length = std::min(length, mapping->GetSize() - offset);
+
+  task_runner.PostTask([mapping = std::move(mapping), offset, length]() {
+    // Touching one byte in every page is enough to fault it in. Pages may be
+    // larger than this, in which case some are touched more than once.
+    constexpr size_t kPageSize = 4096;
+    const volatile uint8_t* begin = mapping->GetMapping() + offset;
+    uint8_t sum = 0;
+    for (size_t i = 0; i < length; i += kPageSize) {
+      sum += begin[i];
+    }
+    sum += begin[length - 1];
+    (void)sum;
+  });
+}
+
 }  // namespace fml
@@ -6,6 +6,7 @@
 #define FLUTTER_FML_MAPPING_H_
 
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +19,8 @@
 
 namespace fml {
 
+class ConcurrentTaskRunner;
+
 class Mapping {
  public:
   Mapping();
@@ -28,6 +31,9 @@ class Mapping {
 
   virtual const uint8_t* GetMapping() const = 0;
 
+  // Returns null unless the contents may be written to through the mapping.
+  virtual uint8_t* GetMutableMapping();
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Mapping);
 };
@@ -40,24 +46,43 @@ class FileMapping final : public Mapping {
     kExecute,
   };
 
+  // Hints about how the pages of the mapping are going to be used, which can
+  // reduce the number of page faults taken when they are first accessed. Hints
+  // not supported by the platform are ignored.
+  enum class Hint {
+    // Read the whole file and map all its pages while the mapping is created.
+    kPopulate,
+    // Start reading the whole file in the background.
+    kWillNeed,
+    // Back the mapping with huge pages where the kernel supports it for file
+    // mappings.
+    kHugePages,
+  };
+
   FileMapping(const fml::UniqueFD& fd,
               std::initializer_list<Protection> protection = {
-                  Protection::kRead});
+                  Protection::kRead},
+              std::initializer_list<Hint> hints = {});
 
   ~FileMapping() override;
 
-  static std::unique_ptr<FileMapping> CreateReadOnly(const std::string& path);
+  static std::unique_ptr<FileMapping> CreateReadOnly(
+      const std::string& path,
+      std::initializer_list<Hint> hints = {});
 
   static std::unique_ptr<FileMapping> CreateReadOnly(
       const fml::UniqueFD& base_fd,
-      const std::string& sub_path = "");
+      const std::string& sub_path = "",
+      std::initializer_list<Hint> hints = {});
 
   static std::unique_ptr<FileMapping> CreateReadExecute(
-      const std::string& path);
+      const std::string& path,
+      std::initializer_list<Hint> hints = {});
 
   static std::unique_ptr<FileMapping> CreateReadExecute(
       const fml::UniqueFD& base_fd,
-      const std::string& sub_path = "");
+      const std::string& sub_path = "",
+      std::initializer_list<Hint> hints = {});
 
   // |Mapping|
   size_t GetSize() const override;
@@ -65,7 +90,8 @@ class FileMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
-  uint8_t* GetMutableMapping();
+  // |Mapping|
+  uint8_t* GetMutableMapping() override;
 
   bool IsValid() const;
 
@@ -96,6 +122,9 @@ class DataMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  uint8_t* GetMutableMapping() override;
+
  private:
   std::vector<uint8_t> data_;
 
@@ -145,6 +174,27 @@ class SymbolMapping final : public Mapping {
   FML_DISALLOW_COPY_AND_ASSIGN(SymbolMapping);
 };
 
+//------------------------------------------------------------------------------
+/// @brief      Reads a range of the pages of a mapping on a concurrent worker,
+///             so that they are already resident and mapped when they are
+///             first accessed by other threads. This is useful for large file
+///             mappings, such as AOT snapshots, whose pages would otherwise be
+///             faulted in one at a time on the critical path.
+///
+/// @param[in]  mapping      The mapping. It is kept alive until the prefetch
+///                          is done. Mappings of unknown size are ignored.
+/// @param[in]  task_runner  The task runner of the workers to read the pages
+///                          on.
+/// @param[in]  offset       The offset of the range to prefetch.
+/// @param[in]  length       The length of the range to prefetch. It is clamped
+///                          to the end of the mapping.
+///
+void PrefetchMappingAsync(
+    std::shared_ptr<const Mapping> mapping,
+    ConcurrentTaskRunner& task_runner,
+    size_t offset = 0,
+    size_t length = std::numeric_limits<size_t>::max());
+
 }  // namespace fml
 
 #endif  // FLUTTER_FML_MAPPING_H_
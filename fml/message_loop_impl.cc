@@ -54,16 +54,16 @@ MessageLoopImpl::~MessageLoopImpl() {
   task_queue_->Dispose(queue_id_);
 }
 
-void MessageLoopImpl::PostTask(const fml::closure& task,
-                               fml::TimePoint target_time) {
-  FML_DCHECK(task != nullptr);
-  FML_DCHECK(task != nullptr);
+void MessageLoopImpl::PostTask(fml::UniqueClosure task,
+                               fml::TimePoint target_time,
+                               TaskPriority priority) {
+  FML_DCHECK(task);
   if (terminated_) {
     // If the message loop has already been terminated, PostTask should destruct
     // |task| synchronously within this function.
     return;
   }
-  task_queue_->RegisterTask(queue_id_, task, target_time);
+  task_queue_->RegisterTask(queue_id_, std::move(task), target_time, priority);
 }
 
 void MessageLoopImpl::AddTaskObserver(intptr_t key,
@@ -119,7 +119,7 @@ void MessageLoopImpl::DoTerminate() {
 
 void MessageLoopImpl::FlushTasks(FlushType type) {
   TRACE_EVENT0("fml", "MessageLoop::FlushTasks");
-  std::vector<fml::closure> invocations;
+  std::vector<fml::UniqueClosure> invocations;
 
   task_queue_->GetTasksToRunNow(queue_id_, type, invocations);
 
@@ -34,7 +34,9 @@ class MessageLoopImpl : public Wakeable,
 
   virtual void Terminate() = 0;
 
-  void PostTask(const fml::closure& task, fml::TimePoint target_time);
+  void PostTask(fml::UniqueClosure task,
+                fml::TimePoint target_time,
+                TaskPriority priority = TaskPriority::kNormal);
 
   void AddTaskObserver(intptr_t key, const fml::closure& callback);
 
@@ -9,6 +9,7 @@
 #include "flutter/fml/message_loop_impl.h"
 
 #include <iostream>
+#include <thread>
 
 namespace fml {
 
@@ -19,12 +20,51 @@ const size_t TaskQueueId::kUnmerged = ULONG_MAX;
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::instance_;
 
 TaskQueueEntry::TaskQueueEntry()
-    : owner_of(_kUnmerged), subsumed_by(_kUnmerged) {
-  wakeable = NULL;
+    : wakeable(nullptr),
+      wake_time(fml::TimePoint::Max()),
+      is_merged(false),
+      owner_of(_kUnmerged),
+      subsumed_by(_kUnmerged),
+      id(TaskQueueId::kUnmerged),
+      users(0),
+      generation(0) {
   task_observers = TaskObservers();
-  delayed_tasks = DelayedTaskQueue();
 }
 
+// Locks a queue and, unless it is subsumed, the queue it owns. The loop of
+// an owner runs the tasks of both.
+class MessageLoopTaskQueues::LockedQueues {
+ public:
+  LockedQueues(const MessageLoopTaskQueues* queues, TaskQueueId queue_id)
+      : entry_(queues->GetEntry(queue_id)), lock_(entry_->mutex) {
+    if (entry_->subsumed_by != _kUnmerged) {
+      return;
+    }
+    owner_ = entry_.get();
+    if (entry_->owner_of != _kUnmerged) {
+      subsumed_ = queues->GetEntry(entry_->owner_of);
+      subsumed_lock_ = std::unique_lock(subsumed_->mutex);
+    }
+  }
+
+  TaskQueueEntry* entry() const { return entry_.get(); }
+
+  // Null if the queue is subsumed by another one.
+  TaskQueueEntry* owner() const { return owner_; }
+
+  // Null unless the queue owns another one.
+  TaskQueueEntry* subsumed() const { return subsumed_.get(); }
+
+ private:
+  EntryRef entry_;
+  std::unique_lock<std::mutex> lock_;
+  TaskQueueEntry* owner_ = nullptr;
+  EntryRef subsumed_;
+  std::unique_lock<std::mutex> subsumed_lock_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(LockedQueues);
+};
+
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
   std::scoped_lock creation(creation_mutex_);
   if (!instance_) {
@@ -35,111 +75,280 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
   std::lock_guard guard(queue_mutex_);
-  TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
-  ++task_queue_id_counter_;
-  queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>();
-  return loop_id;
+  size_t index;
+  TaskQueueEntry* entry;
+  if (!free_entries_.empty()) {
+    index = free_entries_.front();
+    free_entries_.pop_front();
+    entry = segments_[index / kQueuesPerSegment]
+                .load(std::memory_order_relaxed)
+                ->entries[index % kQueuesPerSegment]
+                .load(std::memory_order_relaxed);
+  } else {
+    index = entry_count_;
+    FML_CHECK(index < kMaxQueues) << "Too many task queues.";
+    const size_t segment_index = index / kQueuesPerSegment;
+    Segment* segment = segments_[segment_index].load(std::memory_order_relaxed);
+    if (segment == nullptr) {
+      owned_segments_.push_back(std::make_unique<Segment>());
+      segment = owned_segments_.back().get();
+      segments_[segment_index].store(segment, std::memory_order_release);
+    }
+    entry = new TaskQueueEntry();
+    segment->entries[index % kQueuesPerSegment].store(
+        entry, std::memory_order_release);
+    ++entry_count_;
+  }
+
+  const size_t id = entry->generation * kMaxQueues + index;
+  entry->generation = (entry->generation + 1) % kGenerations;
+  entry->id.store(id, std::memory_order_release);
+  return TaskQueueId(id);
 }
 
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : task_queue_id_counter_(0), order_(0) {}
+    : entry_count_(0), order_(0) {}
+
+MessageLoopTaskQueues::~MessageLoopTaskQueues() {
+  for (const auto& segment : owned_segments_) {
+    for (auto& entry : segment->entries) {
+      delete entry.load(std::memory_order_relaxed);
+    }
+  }
+}
 
-MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
+MessageLoopTaskQueues::EntryRef MessageLoopTaskQueues::GetEntry(
+    TaskQueueId queue_id) const {
+  EntryRef entry = FindEntry(queue_id);
+  FML_CHECK(entry) << "Unknown task queue: " << static_cast<int>(queue_id);
+  return entry;
+}
+
+MessageLoopTaskQueues::EntryRef MessageLoopTaskQueues::FindEntry(
+    TaskQueueId queue_id) const {
+  const int id = queue_id;
+  if (id < 0) {
+    return {};
+  }
+  const size_t index = id % kMaxQueues;
+  Segment* segment =
+      segments_[index / kQueuesPerSegment].load(std::memory_order_acquire);
+  if (segment == nullptr) {
+    return {};
+  }
+  TaskQueueEntry* entry =
+      segment->entries[index % kQueuesPerSegment].load(
+          std::memory_order_acquire);
+  if (entry == nullptr) {
+    return {};
+  }
+  // Either the entry is seen to be taken over by another queue here, or its
+  // disposal sees this lookup and waits for it (see |Dispose|).
+  entry->users.fetch_add(1, std::memory_order_seq_cst);
+  if (entry->id.load(std::memory_order_seq_cst) !=
+      static_cast<size_t>(id)) {
+    entry->users.fetch_sub(1, std::memory_order_release);
+    return {};
+  }
+  return EntryRef(entry);
+}
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
+  // Destroyed once the queue mutex is released, as tasks may own the last
+  // reference to another loop.
+  std::vector<DelayedTask> tasks;
+  TaskQueueEntry::TaskObservers observers;
+
   std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
-  TaskQueueId subsumed = queue_entry->owner_of;
-  queue_entries_.erase(queue_id);
-  if (subsumed != _kUnmerged) {
-    queue_entries_.erase(subsumed);
+  TaskQueueEntry* queue_entry;
+  {
+    EntryRef entry = GetEntry(queue_id);
+    std::lock_guard entry_guard(entry->mutex);
+    FML_DCHECK(entry->subsumed_by == _kUnmerged);
+    if (entry->owner_of != _kUnmerged) {
+      // The loop of the subsumed queue is still alive. Unmerge it so that
+      // the loop runs its tasks again, and leave it to be disposed of by
+      // that loop.
+      EntryRef subsumed_entry = GetEntry(entry->owner_of);
+      std::lock_guard subsumed_guard(subsumed_entry->mutex);
+      subsumed_entry->subsumed_by = _kUnmerged;
+      entry->owner_of = _kUnmerged;
+      subsumed_entry->is_merged.store(false, std::memory_order_seq_cst);
+      entry->is_merged.store(false, std::memory_order_seq_cst);
+      const auto wake_time =
+          PublishWakeTimeUnlocked(subsumed_entry.get(), nullptr);
+      if (HasPendingTasksUnlocked(subsumed_entry.get(), nullptr)) {
+        IssueWakeUp(subsumed_entry.get(), wake_time);
+      }
+    }
+    // Lookups of the id fail from now on.
+    entry->id.store(TaskQueueId::kUnmerged, std::memory_order_seq_cst);
+    queue_entry = entry.get();
   }
+
+  // Wait for the lookups made before then to be done with the entry. Those
+  // may be registering tasks or waking up the loop, which is about to be
+  // destroyed.
+  while (queue_entry->users.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+
+  {
+    std::lock_guard entry_guard(queue_entry->mutex);
+    queue_entry->wakeable.store(nullptr, std::memory_order_relaxed);
+    queue_entry->incoming_tasks.TakeAll(
+        [&tasks](DelayedTask task) { tasks.push_back(std::move(task)); });
+    for (auto& delayed_tasks : queue_entry->delayed_tasks) {
+      while (!delayed_tasks.empty()) {
+        tasks.push_back(delayed_tasks.Pop());
+      }
+    }
+    std::swap(observers, queue_entry->task_observers);
+    queue_entry->wake_time.store(fml::TimePoint::Max(),
+                                 std::memory_order_relaxed);
+  }
+
+  const size_t index = static_cast<int>(queue_id) % kMaxQueues;
+  free_entries_.push_back(index);
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
-  TaskQueueId subsumed = queue_entry->owner_of;
-  queue_entry->delayed_tasks = {};
-  if (subsumed != _kUnmerged) {
-    queue_entries_.at(subsumed)->delayed_tasks = {};
+  LockedQueues queues(this, queue_id);
+  FML_DCHECK(queues.owner() != nullptr);
+  if (queues.owner() == nullptr) {
+    return;
+  }
+  for (TaskQueueEntry* entry : {queues.owner(), queues.subsumed()}) {
+    if (entry != nullptr) {
+      entry->incoming_tasks.TakeAll([](DelayedTask) {});
+      for (auto& tasks : entry->delayed_tasks) {
+        tasks = {};
+      }
+    }
   }
+  PublishWakeTimeUnlocked(queues.owner(), queues.subsumed());
 }
 
 void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
-                                         const fml::closure& task,
-                                         fml::TimePoint target_time) {
-  std::lock_guard guard(queue_mutex_);
+                                         fml::UniqueClosure task,
+                                         fml::TimePoint target_time,
+                                         TaskPriority priority) {
   size_t order = order_++;
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  queue_entry->delayed_tasks.push({order, task, target_time});
-  TaskQueueId loop_to_wake = queue_id;
-  if (queue_entry->subsumed_by != _kUnmerged) {
-    loop_to_wake = queue_entry->subsumed_by;
-  }
-  WakeUpUnlocked(loop_to_wake,
-                 queue_entry->delayed_tasks.top().GetTargetTime());
+  EntryRef queue_entry = GetEntry(queue_id);
+  queue_entry->incoming_tasks.Push(
+      {order, std::move(task), target_time, priority});
+
+  if (queue_entry->is_merged.load(std::memory_order_seq_cst)) {
+    // Merges are rare and short-lived. Wake up the owner with the mutexes
+    // held rather than having producers of both queues race on the wake
+    // times of both.
+    WakeUpMergedForTask(queue_id, target_time);
+    return;
+  }
+
+  // Lower the wake time to the target time of this task. Either the loop
+  // takes the task before it next publishes its wake time, or it publishes
+  // it before this load (see |PublishWakeTimeUnlocked|).
+  fml::TimePoint wake_time =
+      queue_entry->wake_time.load(std::memory_order_seq_cst);
+  while (target_time < wake_time &&
+         !queue_entry->wake_time.compare_exchange_weak(
+             wake_time, target_time, std::memory_order_seq_cst)) {
+  }
+  wake_time = std::min(wake_time, target_time);
+
+  IssueWakeUp(queue_entry.get(), wake_time);
+}
+
+void MessageLoopTaskQueues::WakeUpMergedForTask(TaskQueueId queue_id,
+                                                fml::TimePoint time) const {
+  EntryRef queue_entry = GetEntry(queue_id);
+  EntryRef owner_entry;
+  std::unique_lock lock(queue_entry->mutex);
+  while (queue_entry->subsumed_by != _kUnmerged) {
+    // Lock the owner instead, which is locked before the queue it subsumed
+    // everywhere else. The queues may be unmerged in between.
+    // The owner may also be disposed of in between, which unmerges them.
+    const TaskQueueId owner = queue_entry->subsumed_by;
+    lock.unlock();
+    owner_entry = FindEntry(owner);
+    if (owner_entry) {
+      lock = std::unique_lock(owner_entry->mutex);
+      if (owner_entry->owner_of == queue_id) {
+        break;
+      }
+      lock.unlock();
+      owner_entry = {};
+    }
+    lock = std::unique_lock(queue_entry->mutex);
+  }
+  TaskQueueEntry* wake_entry =
+      owner_entry ? owner_entry.get() : queue_entry.get();
+
+  const fml::TimePoint wake_time =
+      std::min(time, wake_entry->wake_time.load(std::memory_order_seq_cst));
+  wake_entry->wake_time.store(wake_time, std::memory_order_seq_cst);
+  if (wake_entry->owner_of != _kUnmerged) {
+    GetEntry(wake_entry->owner_of)
+        ->wake_time.store(wake_time, std::memory_order_seq_cst);
+  }
+  IssueWakeUp(wake_entry, wake_time);
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
-  return HasPendingTasksUnlocked(queue_id);
+  LockedQueues queues(this, queue_id);
+  if (queues.owner() == nullptr) {
+    return false;
+  }
+  TakeIncomingTasksUnlocked(queues.owner(), queues.subsumed());
+  return HasPendingTasksUnlocked(queues.owner(), queues.subsumed());
 }
 
 void MessageLoopTaskQueues::GetTasksToRunNow(
     TaskQueueId queue_id,
     FlushType type,
-    std::vector<fml::closure>& invocations) {
-  std::lock_guard guard(queue_mutex_);
-  if (!HasPendingTasksUnlocked(queue_id)) {
+    std::vector<fml::UniqueClosure>& invocations) {
+  LockedQueues queues(this, queue_id);
+  TaskQueueEntry* owner = queues.owner();
+  TaskQueueEntry* subsumed = queues.subsumed();
+  if (owner == nullptr) {
+    return;
+  }
+
+  TakeIncomingTasksUnlocked(owner, subsumed);
+  if (!HasPendingTasksUnlocked(owner, subsumed)) {
     return;
   }
 
   const auto now = fml::TimePoint::Now();
 
-  while (HasPendingTasksUnlocked(queue_id)) {
-    TaskQueueId top_queue = _kUnmerged;
-    const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
-    if (top.GetTargetTime() > now) {
-      break;
-    }
-    invocations.emplace_back(top.GetTask());
-    queue_entries_.at(top_queue)->delayed_tasks.pop();
+  TaskPriority priority;
+  while (TaskQueueEntry* top_queue =
+             PeekNextDueTaskUnlocked(owner, subsumed, now, &priority)) {
+    auto& tasks = top_queue->delayed_tasks[static_cast<size_t>(priority)];
+    invocations.emplace_back(tasks.Pop().TakeTask());
     if (type == FlushType::kSingle) {
       break;
     }
   }
 
-  if (!HasPendingTasksUnlocked(queue_id)) {
-    WakeUpUnlocked(queue_id, fml::TimePoint::Max());
-  } else {
-    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
-  }
-}
-
-void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
-                                           fml::TimePoint time) const {
-  if (queue_entries_.at(queue_id)->wakeable) {
-    queue_entries_.at(queue_id)->wakeable->WakeUp(time);
-  }
+  IssueWakeUp(owner, PublishWakeTimeUnlocked(owner, subsumed));
 }
 
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  if (queue_entry->subsumed_by != _kUnmerged) {
+  LockedQueues queues(this, queue_id);
+  if (queues.owner() == nullptr) {
     return 0;
   }
 
+  TakeIncomingTasksUnlocked(queues.owner(), queues.subsumed());
   size_t total_tasks = 0;
-  total_tasks += queue_entry->delayed_tasks.size();
-
-  TaskQueueId subsumed = queue_entry->owner_of;
-  if (subsumed != _kUnmerged) {
-    const auto& subsumed_entry = queue_entries_.at(subsumed);
-    total_tasks += subsumed_entry->delayed_tasks.size();
+  for (const TaskQueueEntry* entry : {queues.owner(), queues.subsumed()}) {
+    if (entry != nullptr) {
+      for (const auto& tasks : entry->delayed_tasks) {
+        total_tasks += tasks.size();
+      }
+    }
   }
   return total_tasks;
 }
@@ -147,33 +356,34 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
                                             intptr_t key,
                                             const fml::closure& callback) {
-  std::lock_guard guard(queue_mutex_);
+  EntryRef queue_entry = GetEntry(queue_id);
+  std::lock_guard guard(queue_entry->mutex);
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
-  queue_entries_.at(queue_id)->task_observers[key] = callback;
+  queue_entry->task_observers[key] = callback;
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
-  std::lock_guard guard(queue_mutex_);
-  queue_entries_.at(queue_id)->task_observers.erase(key);
+  EntryRef queue_entry = GetEntry(queue_id);
+  std::lock_guard guard(queue_entry->mutex);
+  queue_entry->task_observers.erase(key);
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  LockedQueues queues(this, queue_id);
   std::vector<fml::closure> observers;
 
-  if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
+  if (queues.owner() == nullptr) {
     return observers;
   }
 
-  for (const auto& observer : queue_entries_.at(queue_id)->task_observers) {
+  for (const auto& observer : queues.owner()->task_observers) {
     observers.push_back(observer.second);
   }
 
-  TaskQueueId subsumed = queue_entries_.at(queue_id)->owner_of;
-  if (subsumed != _kUnmerged) {
-    for (const auto& observer : queue_entries_.at(subsumed)->task_observers) {
+  if (queues.subsumed() != nullptr) {
+    for (const auto& observer : queues.subsumed()->task_observers) {
       observers.push_back(observer.second);
     }
   }
@@ -183,19 +393,20 @@ std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
-  std::lock_guard guard(queue_mutex_);
-  FML_CHECK(!queue_entries_.at(queue_id)->wakeable)
+  EntryRef queue_entry = GetEntry(queue_id);
+  std::lock_guard guard(queue_entry->mutex);
+  FML_CHECK(!queue_entry->wakeable.load(std::memory_order_relaxed))
       << "Wakeable can only be set once.";
-  queue_entries_.at(queue_id)->wakeable = wakeable;
+  queue_entry->wakeable.store(wakeable, std::memory_order_release);
 }
 
 bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   if (owner == subsumed) {
     return true;
   }
-  std::lock_guard guard(queue_mutex_);
-  auto& owner_entry = queue_entries_.at(owner);
-  auto& subsumed_entry = queue_entries_.at(subsumed);
+  EntryRef owner_entry = GetEntry(owner);
+  EntryRef subsumed_entry = GetEntry(subsumed);
+  std::scoped_lock lock(owner_entry->mutex, subsumed_entry->mutex);
 
   if (owner_entry->owner_of == subsumed) {
     return true;
@@ -213,31 +424,38 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 
   owner_entry->owner_of = subsumed;
   subsumed_entry->subsumed_by = owner;
+  owner_entry->is_merged.store(true, std::memory_order_seq_cst);
+  subsumed_entry->is_merged.store(true, std::memory_order_seq_cst);
 
-  if (HasPendingTasksUnlocked(owner)) {
-    WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
+  const auto wake_time =
+      PublishWakeTimeUnlocked(owner_entry.get(), subsumed_entry.get());
+  if (HasPendingTasksUnlocked(owner_entry.get(), subsumed_entry.get())) {
+    IssueWakeUp(owner_entry.get(), wake_time);
   }
 
   return true;
 }
 
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& owner_entry = queue_entries_.at(owner);
+  EntryRef owner_entry = GetEntry(owner);
+  std::unique_lock owner_lock(owner_entry->mutex);
   const TaskQueueId subsumed = owner_entry->owner_of;
   if (subsumed == _kUnmerged) {
     return false;
   }
+  EntryRef subsumed_entry = GetEntry(subsumed);
+  std::unique_lock subsumed_lock(subsumed_entry->mutex);
 
-  queue_entries_.at(subsumed)->subsumed_by = _kUnmerged;
+  subsumed_entry->subsumed_by = _kUnmerged;
   owner_entry->owner_of = _kUnmerged;
+  owner_entry->is_merged.store(false, std::memory_order_seq_cst);
+  subsumed_entry->is_merged.store(false, std::memory_order_seq_cst);
 
-  if (HasPendingTasksUnlocked(owner)) {
-    WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
-  }
-
-  if (HasPendingTasksUnlocked(subsumed)) {
-    WakeUpUnlocked(subsumed, GetNextWakeTimeUnlocked(subsumed));
+  for (TaskQueueEntry* entry : {owner_entry.get(), subsumed_entry.get()}) {
+    const auto wake_time = PublishWakeTimeUnlocked(entry, nullptr);
+    if (HasPendingTasksUnlocked(entry, nullptr)) {
+      IssueWakeUp(entry, wake_time);
+    }
   }
 
   return true;
@@ -245,70 +463,145 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
 
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
-  std::lock_guard guard(queue_mutex_);
-  return subsumed == queue_entries_.at(owner)->owner_of || owner == subsumed;
+  if (owner == subsumed) {
+    return true;
+  }
+  EntryRef owner_entry = GetEntry(owner);
+  std::lock_guard guard(owner_entry->mutex);
+  return subsumed == owner_entry->owner_of;
+}
+
+void MessageLoopTaskQueues::TakeIncomingTasksUnlocked(
+    TaskQueueEntry* owner,
+    TaskQueueEntry* subsumed) {
+  for (TaskQueueEntry* entry : {owner, subsumed}) {
+    if (entry != nullptr) {
+      entry->incoming_tasks.TakeAll([entry](DelayedTask task) {
+        entry->delayed_tasks[static_cast<size_t>(task.GetPriority())].push(
+            std::move(task));
+      });
+    }
+  }
 }
 
 // Subsumed queues will never have pending tasks.
 // Owning queues will consider both their and their subsumed tasks.
 bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
-    TaskQueueId queue_id) const {
-  const auto& entry = queue_entries_.at(queue_id);
-  bool is_subsumed = entry->subsumed_by != _kUnmerged;
-  if (is_subsumed) {
-    return false;
+    const TaskQueueEntry* owner,
+    const TaskQueueEntry* subsumed) {
+  for (const TaskQueueEntry* entry : {owner, subsumed}) {
+    if (entry == nullptr) {
+      continue;
+    }
+    for (const auto& tasks : entry->delayed_tasks) {
+      if (!tasks.empty()) {
+        return true;
+      }
+    }
   }
+  return false;
+}
 
-  if (!entry->delayed_tasks.empty()) {
-    return true;
+TaskQueueEntry* MessageLoopTaskQueues::PeekNextTaskUnlocked(
+    TaskQueueEntry* owner,
+    TaskQueueEntry* subsumed,
+    TaskPriority priority) {
+  const size_t index = static_cast<size_t>(priority);
+  const auto& owner_tasks = owner->delayed_tasks[index];
+  if (subsumed == nullptr || subsumed->delayed_tasks[index].empty()) {
+    return owner_tasks.empty() ? nullptr : owner;
   }
 
-  const TaskQueueId subsumed = entry->owner_of;
-  if (subsumed == _kUnmerged) {
-    // this is not an owner and queue is empty.
-    return false;
-  } else {
-    return !queue_entries_.at(subsumed)->delayed_tasks.empty();
+  // we are owning another task queue
+  const auto& subsumed_tasks = subsumed->delayed_tasks[index];
+  if (owner_tasks.empty() || owner_tasks.top() > subsumed_tasks.top()) {
+    return subsumed;
   }
+  return owner;
 }
 
-fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
-    TaskQueueId queue_id) const {
-  TaskQueueId tmp = _kUnmerged;
-  return PeekNextTaskUnlocked(queue_id, tmp).GetTargetTime();
+TaskQueueEntry* MessageLoopTaskQueues::PeekNextDueTaskUnlocked(
+    TaskQueueEntry* owner,
+    TaskQueueEntry* subsumed,
+    fml::TimePoint now,
+    TaskPriority* priority) {
+  // Due tasks run in order of priority unless some have waited for longer
+  // than their priority tolerates, in which case the one of those with the
+  // earliest deadline runs. The earliest task of a priority is the one that
+  // has waited the longest, so only those need to be considered.
+  TaskQueueEntry* next = nullptr;
+  bool next_is_starved = false;
+  fml::TimePoint next_deadline;
+  for (size_t index = 0; index < kTaskPriorityCount; index++) {
+    const auto candidate_priority = static_cast<TaskPriority>(index);
+    TaskQueueEntry* entry =
+        PeekNextTaskUnlocked(owner, subsumed, candidate_priority);
+    if (entry == nullptr) {
+      continue;
+    }
+    const fml::TimePoint target_time =
+        entry->delayed_tasks[index].top().GetTargetTime();
+    if (target_time > now) {
+      continue;
+    }
+    const fml::TimePoint deadline =
+        target_time + GetStarvationLimit(candidate_priority);
+    const bool starved = deadline < now;
+    if (next == nullptr ||
+        (starved && (!next_is_starved || deadline < next_deadline))) {
+      next = entry;
+      next_is_starved = starved;
+      next_deadline = deadline;
+      *priority = candidate_priority;
+    }
+  }
+  return next;
 }
 
-const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
-    TaskQueueId owner,
-    TaskQueueId& top_queue_id) const {
-  FML_DCHECK(HasPendingTasksUnlocked(owner));
-  const auto& entry = queue_entries_.at(owner);
-  const TaskQueueId subsumed = entry->owner_of;
-  if (subsumed == _kUnmerged) {
-    top_queue_id = owner;
-    return entry->delayed_tasks.top();
+fml::TimePoint MessageLoopTaskQueues::PublishWakeTimeUnlocked(
+    TaskQueueEntry* owner,
+    TaskQueueEntry* subsumed) {
+  while (true) {
+    TakeIncomingTasksUnlocked(owner, subsumed);
+    fml::TimePoint wake_time = fml::TimePoint::Max();
+    for (size_t index = 0; index < kTaskPriorityCount; index++) {
+      const TaskQueueEntry* entry = PeekNextTaskUnlocked(
+          owner, subsumed, static_cast<TaskPriority>(index));
+      if (entry != nullptr) {
+        wake_time = std::min(
+            wake_time, entry->delayed_tasks[index].top().GetTargetTime());
+      }
+    }
+    owner->wake_time.store(wake_time, std::memory_order_seq_cst);
+    if (subsumed != nullptr) {
+      subsumed->wake_time.store(wake_time, std::memory_order_seq_cst);
+    }
+    // A task registered concurrently either shows up in its incoming list
+    // here or its registration sees the wake time stored above.
+    if (owner->incoming_tasks.IsEmpty() &&
+        (subsumed == nullptr || subsumed->incoming_tasks.IsEmpty())) {
+      return wake_time;
+    }
   }
+}
 
-  const auto& owner_tasks = entry->delayed_tasks;
-  const auto& subsumed_tasks = queue_entries_.at(subsumed)->delayed_tasks;
-
-  // we are owning another task queue
-  const bool subsumed_has_task = !subsumed_tasks.empty();
-  const bool owner_has_task = !owner_tasks.empty();
-  if (owner_has_task && subsumed_has_task) {
-    const auto owner_task = owner_tasks.top();
-    const auto subsumed_task = subsumed_tasks.top();
-    if (owner_task > subsumed_task) {
-      top_queue_id = subsumed;
-    } else {
-      top_queue_id = owner;
-    }
-  } else if (owner_has_task) {
-    top_queue_id = owner;
-  } else {
-    top_queue_id = subsumed;
+void MessageLoopTaskQueues::IssueWakeUp(TaskQueueEntry* entry,
+                                        fml::TimePoint wake_time) {
+  Wakeable* wakeable = entry->wakeable.load(std::memory_order_acquire);
+  if (wakeable == nullptr) {
+    return;
+  }
+  wakeable->WakeUp(wake_time);
+  // Each wake up replaces the previous one. A wake up for an earlier time,
+  // issued concurrently by a registration that lowered the wake time, may
+  // have been replaced by the one above.
+  for (fml::TimePoint earlier_time =
+           entry->wake_time.load(std::memory_order_seq_cst);
+       earlier_time < wake_time;
+       earlier_time = entry->wake_time.load(std::memory_order_seq_cst)) {
+    wake_time = earlier_time;
+    wakeable->WakeUp(wake_time);
   }
-  return queue_entries_.at(top_queue_id)->delayed_tasks.top();
 }
 
 }  // namespace fml
@@ -5,15 +5,21 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <array>
+#include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/delayed_task.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
-#include "flutter/fml/synchronization/shared_mutex.h"
+#include "flutter/fml/synchronization/mpsc_list.h"
+#include "flutter/fml/unique_closure.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -34,20 +40,51 @@ static const TaskQueueId _kUnmerged = TaskQueueId(TaskQueueId::kUnmerged);
 
 // This is keyed by the |TaskQueueId| and contains all the queue
 // components that make up a single TaskQueue.
+//
+// Tasks are registered into |incoming_tasks| without taking any lock. They
+// are moved into |delayed_tasks|, the timer heap of their priority, by
+// whichever thread next holds |mutex|, which guards all of the other
+// non-atomic fields.
 class TaskQueueEntry {
  public:
   using TaskObservers = std::map<intptr_t, fml::closure>;
-  Wakeable* wakeable;
+  std::mutex mutex;
+  std::atomic<Wakeable*> wakeable;
   TaskObservers task_observers;
-  DelayedTaskQueue delayed_tasks;
+  MpscList<DelayedTask> incoming_tasks;
+  std::array<DelayedTaskQueue, kTaskPriorityCount> delayed_tasks;
+
+  // The earliest target time of the tasks of this queue, and of the queue it
+  // is merged with, as of the last time the loop that runs them took the
+  // incoming tasks. Registrations lower it without a lock to wake up the
+  // loop at the right time.
+  std::atomic<fml::TimePoint> wake_time;
+
+  // Set while this queue owns or is subsumed by another one, in which case
+  // registrations wake up the loop of the owner with the mutexes held.
+  std::atomic_bool is_merged;
 
   // Note: Both of these can be _kUnmerged, which indicates that
   // this queue has not been merged or subsumed. OR exactly one
   // of these will be _kUnmerged, if owner_of is _kUnmerged, it means
   // that the queue has been subsumed or else it owns another queue.
+  // Only written with the mutexes of both queues held.
   TaskQueueId owner_of;
   TaskQueueId subsumed_by;
 
+  // The id of the queue that currently uses this entry, or
+  // |TaskQueueId::kUnmerged| while the entry is free. Entries are reused for
+  // new queues once disposed of.
+  std::atomic<size_t> id;
+
+  // The number of lookups of this entry still in use. Disposal waits for
+  // them to be done with the entry before it is reused.
+  std::atomic<size_t> users;
+
+  // Bumped whenever the entry is reused, so that the new queue gets a new
+  // id. Guarded by the |MessageLoopTaskQueues| queue mutex.
+  size_t generation;
+
   TaskQueueEntry();
 
  private:
@@ -77,15 +114,18 @@ class MessageLoopTaskQueues
 
   // Tasks methods.
 
+  // Once due, a task runs ahead of the due tasks of lower |priority| (see
+  // |TaskPriority|).
   void RegisterTask(TaskQueueId queue_id,
-                    const fml::closure& task,
-                    fml::TimePoint target_time);
+                    fml::UniqueClosure task,
+                    fml::TimePoint target_time,
+                    TaskPriority priority = TaskPriority::kNormal);
 
   bool HasPendingTasks(TaskQueueId queue_id) const;
 
   void GetTasksToRunNow(TaskQueueId queue_id,
                         FlushType type,
-                        std::vector<fml::closure>& invocations);
+                        std::vector<fml::UniqueClosure>& invocations);
 
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
@@ -131,22 +171,114 @@ class MessageLoopTaskQueues
 
   ~MessageLoopTaskQueues();
 
-  void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
+  // Queues are looked up on every task registration, from every thread, so
+  // the lookup takes no lock. Entries are held in fixed-size segments that
+  // are never moved, and are only freed along with this. The entry of a
+  // disposed queue is reused for a new one, under a new id, once the lookups
+  // made before the disposal are done with it.
+  static constexpr size_t kQueuesPerSegment = 256;
+  static constexpr size_t kMaxSegments = 256;
+  static constexpr size_t kMaxQueues = kQueuesPerSegment * kMaxSegments;
+  // The ids of the queues that reuse an entry cycle through this many
+  // values, all of which fit in an int.
+  static constexpr size_t kGenerations = (size_t{1} << 31) / kMaxQueues;
+  struct Segment {
+    std::atomic<TaskQueueEntry*> entries[kQueuesPerSegment] = {};
+  };
+
+  class LockedQueues;
+
+  // Holds a lookup of an entry. The entry is not reused while this is alive.
+  class EntryRef {
+   public:
+    EntryRef() = default;
+
+    explicit EntryRef(TaskQueueEntry* entry) : entry_(entry) {}
+
+    EntryRef(EntryRef&& other) : entry_(std::exchange(other.entry_, nullptr)) {}
+
+    EntryRef& operator=(EntryRef&& other) {
+      std::swap(entry_, other.entry_);
+      return *this;
+    }
+
+    ~EntryRef() {
+      if (entry_ != nullptr) {
+        entry_->users.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    TaskQueueEntry* get() const { return entry_; }
 
-  bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
+    TaskQueueEntry* operator->() const { return entry_; }
 
-  const DelayedTask& PeekNextTaskUnlocked(TaskQueueId owner,
-                                          TaskQueueId& top_queue_id) const;
+    explicit operator bool() const { return entry_ != nullptr; }
 
-  fml::TimePoint GetNextWakeTimeUnlocked(TaskQueueId queue_id) const;
+   private:
+    TaskQueueEntry* entry_ = nullptr;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(EntryRef);
+  };
+
+  // Aborts if |queue_id| is unknown or has been disposed of.
+  EntryRef GetEntry(TaskQueueId queue_id) const;
+
+  // Returns an empty reference if |queue_id| is unknown or has been disposed
+  // of.
+  EntryRef FindEntry(TaskQueueId queue_id) const;
+
+  // Wakes up the loop that runs the tasks of the merged queue |queue_id| at
+  // |time| or the earlier wake time of its owner.
+  void WakeUpMergedForTask(TaskQueueId queue_id, fml::TimePoint time) const;
+
+  // The following take the owner of a queue, the queue it subsumed (or null)
+  // and require the mutexes of both to be held.
+
+  static void TakeIncomingTasksUnlocked(TaskQueueEntry* owner,
+                                        TaskQueueEntry* subsumed);
+
+  static bool HasPendingTasksUnlocked(const TaskQueueEntry* owner,
+                                      const TaskQueueEntry* subsumed);
+
+  // Returns the queue with the earliest task of |priority|, or null if
+  // there are none.
+  static TaskQueueEntry* PeekNextTaskUnlocked(TaskQueueEntry* owner,
+                                              TaskQueueEntry* subsumed,
+                                              TaskPriority priority);
+
+  // Returns the queue with the task to run next at |now| and sets |priority|
+  // to its priority, or returns null if no task is due.
+  static TaskQueueEntry* PeekNextDueTaskUnlocked(TaskQueueEntry* owner,
+                                                 TaskQueueEntry* subsumed,
+                                                 fml::TimePoint now,
+                                                 TaskPriority* priority);
+
+  // Takes the incoming tasks and publishes the target time of the next
+  // pending task as the wake time of both queues. Returns that time.
+  static fml::TimePoint PublishWakeTimeUnlocked(TaskQueueEntry* owner,
+                                                TaskQueueEntry* subsumed);
+
+  // Wakes up the loop of |entry| at |wake_time|, or at its wake time if that
+  // has been lowered in the meantime. May be called without holding a lock,
+  // but a lookup of |entry| must be held so that the loop is not destroyed
+  // in the meantime.
+  static void IssueWakeUp(TaskQueueEntry* entry, fml::TimePoint wake_time);
 
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
-  std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
+  // Guards the creation and disposal of queues.
+  std::mutex queue_mutex_;
+  std::atomic<Segment*> segments_[kMaxSegments] = {};
+  std::vector<std::unique_ptr<Segment>> owned_segments_;
+
+  // The number of entries created so far.
+  size_t entry_count_;
 
-  size_t task_queue_id_counter_;
+  // The indices of the entries of disposed queues. The one disposed of the
+  // longest ago is reused first, so that the ids of a single entry take as
+  // long as possible to cycle.
+  std::deque<size_t> free_entries_;
 
   std::atomic_int order_;
 
@@ -0,0 +1,77 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// These benchmarks replace the global allocation functions to count the
+// allocations made while they run, so they are built into their own
+// executable rather than skewing the timings of the other benchmarks.
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/message_loop_task_queues.h"
+
+// Counts the allocations made by the benchmarks below.
+static std::atomic<size_t> allocation_count = 0;
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+namespace fml {
+namespace benchmarking {
+
+// The allocations per task of posting and running tasks whose captures are
+// about as large as those of the tasks the engine posts.
+static void BM_AllocationsPerPost(benchmark::State& state) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  const TaskQueueId queue_id = task_queues->CreateTaskQueue();
+  const int num_tasks = 100;
+  const fml::TimePoint past = fml::TimePoint::Now();
+  std::array<int64_t, 5> captures = {};
+  int64_t sum = 0;
+  std::vector<fml::UniqueClosure> invocations;
+  invocations.reserve(num_tasks);
+
+  size_t allocations = 0;
+  while (state.KeepRunning()) {
+    const size_t allocations_before = allocation_count.load();
+    for (int i = 0; i < num_tasks; i++) {
+      task_queues->RegisterTask(
+          queue_id, [captures, &sum]() { sum += captures[0]; }, past);
+    }
+    task_queues->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                  invocations);
+    for (const auto& invocation : invocations) {
+      invocation();
+    }
+    invocations.clear();
+    allocations += allocation_count.load() - allocations_before;
+  }
+
+  task_queues->Dispose(queue_id);
+  benchmark::DoNotOptimize(sum);
+  state.counters["allocations_per_post"] =
+      static_cast<double>(allocations) / (state.iterations() * num_tasks);
+}
+
+BENCHMARK(BM_AllocationsPerPost);
+
+}  // namespace benchmarking
+}  // namespace fml
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <atomic>
 #include <cassert>
 #include <string>
 #include <thread>
@@ -9,6 +10,7 @@
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/fml/message_loop_task_queues.h"
 #include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 
 namespace fml {
 namespace benchmarking {
@@ -21,8 +23,9 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {
     const int num_tasks_per_queue = 100;
     const fml::TimePoint past = fml::TimePoint::Now();
 
+    std::vector<TaskQueueId> queue_ids;
     for (int i = 0; i < num_task_queues; i++) {
-      task_queue->CreateTaskQueue();
+      queue_ids.push_back(task_queue->CreateTaskQueue());
     }
 
     std::vector<std::thread> threads;
@@ -31,17 +34,17 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {
     CountDownLatch tasks_done(num_task_queues);
 
     for (int i = 0; i < num_task_queues; i++) {
-      threads.emplace_back([task_runner_id = i, &task_queue, past, &tasks_done,
-                            &tasks_registered]() {
+      threads.emplace_back([queue_id = queue_ids[i], &task_queue, past,
+                            &tasks_done, &tasks_registered]() {
         for (int j = 0; j < num_tasks_per_queue; j++) {
           task_queue->RegisterTask(
-              TaskQueueId(task_runner_id), [] {}, past);
+              queue_id, [] {}, past);
         }
         tasks_registered.CountDown();
         tasks_registered.Wait();
-        std::vector<fml::closure> invocations;
-        task_queue->GetTasksToRunNow(TaskQueueId(task_runner_id),
-                                     fml::FlushType::kAll, invocations);
+        std::vector<fml::UniqueClosure> invocations;
+        task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                     invocations);
         assert(invocations.size() == num_tasks_per_queue);
         tasks_done.CountDown();
       });
@@ -52,10 +55,81 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {
     for (auto& thread : threads) {
       thread.join();
     }
+
+    for (TaskQueueId queue_id : queue_ids) {
+      task_queue->Dispose(queue_id);
+    }
   }
 }
 
 BENCHMARK(BM_RegisterAndGetTasks);
 
+// Stands in for the loop of a queue, whose thread sleeps until it is woken up
+// for a task.
+class WaitingWakeable : public fml::Wakeable {
+ public:
+  // |fml::Wakeable|
+  void WakeUp(fml::TimePoint time_point) override {
+    // The loop would sleep through wake ups for no task.
+    if (time_point != fml::TimePoint::Max()) {
+      wake_up_.Signal();
+    }
+  }
+
+  void Wait() { wake_up_.Wait(); }
+
+ private:
+  fml::AutoResetWaitableEvent wake_up_;
+};
+
+// Posting from many threads to the queue of one loop, which runs the tasks as
+// they arrive and waits to be woken up when there are none.
+static void BM_CrossThreadPostThroughput(benchmark::State& state) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  const TaskQueueId queue_id = task_queues->CreateTaskQueue();
+  WaitingWakeable wakeable;
+  task_queues->SetWakeable(queue_id, &wakeable);
+  const int num_producers = state.range(0);
+  const int num_tasks_per_producer = 1000;
+  const int num_tasks = num_producers * num_tasks_per_producer;
+  const fml::TimePoint past = fml::TimePoint::Now();
+
+  while (state.KeepRunning()) {
+    std::atomic<int> tasks_run = 0;
+    std::vector<std::thread> producers;
+    for (int i = 0; i < num_producers; i++) {
+      producers.emplace_back([&task_queues, queue_id, past, &tasks_run]() {
+        for (int j = 0; j < num_tasks_per_producer; j++) {
+          task_queues->RegisterTask(
+              queue_id, [&tasks_run] { tasks_run++; }, past);
+        }
+      });
+    }
+
+    std::vector<fml::UniqueClosure> invocations;
+    while (tasks_run.load() < num_tasks) {
+      task_queues->GetTasksToRunNow(queue_id, fml::FlushType::kAll,
+                                    invocations);
+      if (invocations.empty()) {
+        wakeable.Wait();
+        continue;
+      }
+      for (const auto& invocation : invocations) {
+        invocation();
+      }
+      invocations.clear();
+    }
+
+    for (auto& producer : producers) {
+      producer.join();
+    }
+  }
+
+  task_queues->Dispose(queue_id);
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
+BENCHMARK(BM_CrossThreadPostThroughput)->Arg(4)->Arg(16)->UseRealTime();
+
 }  // namespace benchmarking
 }  // namespace fml
@@ -83,6 +83,47 @@ TEST(MessageLoopTaskQueueMergeUnmerge, MergeUnmergeTasksPreserved) {
   ASSERT_EQ(1u, task_queue->GetNumPendingTasks(queue_id_2));
 }
 
+TEST(MessageLoopTaskQueueMergeUnmerge, AfterMergeSubsumedTasksRunByPriority) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  auto queue_id_1 = task_queue->CreateTaskQueue();
+  auto queue_id_2 = task_queue->CreateTaskQueue();
+  int test_val = 0;
+  const auto now = fml::TimePoint::Now();
+
+  task_queue->RegisterTask(
+      queue_id_1, [&test_val]() { test_val = 2; }, now);
+  task_queue->RegisterTask(
+      queue_id_2, [&test_val]() { test_val = 1; }, now,
+      fml::TaskPriority::kVsync);
+  task_queue->Merge(queue_id_1, queue_id_2);
+
+  std::vector<fml::UniqueClosure> invocations;
+  task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kSingle,
+                               invocations);
+  ASSERT_EQ(1u, invocations.size());
+  invocations[0]();
+  ASSERT_EQ(1, test_val);
+}
+
+TEST(MessageLoopTaskQueueMergeUnmerge, DisposeOfOwnerUnmergesSubsumed) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  auto queue_id_1 = task_queue->CreateTaskQueue();
+  auto queue_id_2 = task_queue->CreateTaskQueue();
+
+  task_queue->RegisterTask(
+      queue_id_2, []() {}, fml::TimePoint::Now());
+  task_queue->Merge(queue_id_1, queue_id_2);
+  task_queue->Dispose(queue_id_1);
+
+  ASSERT_EQ(1u, task_queue->GetNumPendingTasks(queue_id_2));
+  task_queue->RegisterTask(
+      queue_id_2, []() {}, fml::TimePoint::Now());
+  ASSERT_EQ(2u, task_queue->GetNumPendingTasks(queue_id_2));
+  task_queue->Dispose(queue_id_2);
+}
+
 TEST(MessageLoopTaskQueueMergeUnmerge, MergeFailIfAlreadyMergedOrSubsumed) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
 
@@ -127,7 +168,7 @@ TEST(MessageLoopTaskQueueMergeUnmerge, MergeInvokesBothWakeables) {
 
   task_queue->Merge(queue_id_1, queue_id_2);
 
-  std::vector<fml::closure> invocations;
+  std::vector<fml::UniqueClosure> invocations;
   task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
 
   latch.Wait();
@@ -157,7 +198,7 @@ TEST(MessageLoopTaskQueueMergeUnmerge,
   task_queue->Merge(queue_id_1, queue_id_2);
   task_queue->Unmerge(queue_id_1);
 
-  std::vector<fml::closure> invocations;
+  std::vector<fml::UniqueClosure> invocations;
 
   task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
   latch_1.Wait();
@@ -184,7 +225,7 @@ TEST(MessageLoopTaskQueueMergeUnmerge, GetTasksToRunNowBlocksMerge) {
                           }));
 
   std::thread tasks_to_run_now_thread([&]() {
-    std::vector<fml::closure> invocations;
+    std::vector<fml::UniqueClosure> invocations;
     task_queue->GetTasksToRunNow(queue_id_1, fml::FlushType::kAll, invocations);
   });
 
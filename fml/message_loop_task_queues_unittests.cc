@@ -4,6 +4,7 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
 #include <thread>
 
 #include "flutter/fml/message_loop_task_queues.h"
@@ -69,7 +70,7 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   task_queue->RegisterTask(
       queue_id, [&test_val]() { test_val = 2; }, fml::TimePoint::Now());
 
-  std::vector<fml::closure> invocations;
+  std::vector<fml::UniqueClosure> invocations;
   task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
 
   int expected_value = 1;
@@ -81,6 +82,77 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   }
 }
 
+// Runs the due tasks, which set |test_val|, and returns the values they set.
+static std::vector<int> RunTasksNow(fml::TaskQueueId queue_id, int* test_val) {
+  std::vector<fml::UniqueClosure> invocations;
+  fml::MessageLoopTaskQueues::GetInstance()->GetTasksToRunNow(
+      queue_id, fml::FlushType::kAll, invocations);
+  std::vector<int> order;
+  for (auto& invocation : invocations) {
+    invocation();
+    order.push_back(*test_val);
+  }
+  return order;
+}
+
+TEST(MessageLoopTaskQueue, DueTasksRunInPriorityOrder) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  int test_val = 0;
+  const auto now = fml::TimePoint::Now();
+
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 4; }, now,
+      fml::TaskPriority::kIdle);
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 3; }, now);
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 2; }, now,
+      fml::TaskPriority::kInput);
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 1; }, now,
+      fml::TaskPriority::kVsync);
+
+  ASSERT_EQ(RunTasksNow(queue_id, &test_val),
+            std::vector<int>({1, 2, 3, 4}));
+}
+
+TEST(MessageLoopTaskQueue, PriorityDoesNotRunTasksBeforeTheirTime) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  int test_val = 0;
+
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 1; }, fml::TimePoint::Max(),
+      fml::TaskPriority::kVsync);
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 2; }, fml::TimePoint::Now());
+
+  ASSERT_EQ(RunTasksNow(queue_id, &test_val), std::vector<int>({2}));
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 1u);
+}
+
+TEST(MessageLoopTaskQueue, StarvedTasksRunAheadOfHigherPriorityTasks) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  int test_val = 0;
+  const auto now = fml::TimePoint::Now();
+  const auto starved = now - fml::GetStarvationLimit(fml::TaskPriority::kIdle) -
+                       fml::TimeDelta::FromSeconds(1);
+
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 1; }, now,
+      fml::TaskPriority::kVsync);
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 2; }, now);
+  task_queue->RegisterTask(
+      queue_id, [&test_val]() { test_val = 3; }, starved,
+      fml::TaskPriority::kIdle);
+
+  ASSERT_EQ(RunTasksNow(queue_id, &test_val),
+            std::vector<int>({3, 1, 2}));
+}
+
 void TestNotifyObservers(fml::TaskQueueId queue_id) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   std::vector<fml::closure> observers =
@@ -148,6 +220,61 @@ TEST(MessageLoopTaskQueue, WokenUpWithNewerTime) {
   latch.Wait();
 }
 
+TEST(MessageLoopTaskQueue, IdsOfDisposedQueuesAreNotReused) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  const auto queue_id = task_queues->CreateTaskQueue();
+  task_queues->RegisterTask(
+      queue_id, [] {}, fml::TimePoint::Now());
+  task_queues->Dispose(queue_id);
+
+  const auto new_queue_id = task_queues->CreateTaskQueue();
+  ASSERT_NE(new_queue_id, queue_id);
+  ASSERT_FALSE(task_queues->HasPendingTasks(new_queue_id));
+  task_queues->Dispose(new_queue_id);
+}
+
+TEST(MessageLoopTaskQueue, DisposedQueuesMakeRoomForNewOnes) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  // More than can exist at once.
+  for (int i = 0; i < 100000; i++) {
+    const auto queue_id = task_queues->CreateTaskQueue();
+    task_queues->RegisterTask(
+        queue_id, [] {}, fml::TimePoint::Now());
+    task_queues->Dispose(queue_id);
+  }
+}
+
+TEST(MessageLoopTaskQueue, DisposeWaitsForWakeUpsInProgress) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  const auto queue_id = task_queues->CreateTaskQueue();
+  fml::AutoResetWaitableEvent waking_up, finish_wake_up;
+  TestWakeable wakeable([&](fml::TimePoint) {
+    waking_up.Signal();
+    finish_wake_up.Wait();
+  });
+  task_queues->SetWakeable(queue_id, &wakeable);
+
+  std::thread registration([&]() {
+    task_queues->RegisterTask(
+        queue_id, [] {}, fml::TimePoint::Now());
+  });
+  waking_up.Wait();
+
+  std::atomic_bool disposed = false;
+  std::thread disposal([&]() {
+    task_queues->Dispose(queue_id);
+    disposed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // The loop that owns the wakeable is destroyed once disposal returns.
+  EXPECT_FALSE(disposed);
+
+  finish_wake_up.Signal();
+  registration.join();
+  disposal.join();
+  ASSERT_TRUE(disposed);
+}
+
 TEST(MessageLoopTaskQueue, NotifyObserversWhileCreatingQueues) {
   auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
   fml::TaskQueueId queue_id = task_queues->CreateTaskQueue();
@@ -315,3 +315,88 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopRunsAllTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      4u, fml::ConcurrentMessageLoop::SchedulingMode::kWorkStealing);
+  ASSERT_EQ(loop->GetSchedulingMode(),
+            fml::ConcurrentMessageLoop::SchedulingMode::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 1000;
+  fml::CountDownLatch latch(kCount);
+  std::atomic_size_t ran = 0;
+  for (size_t i = 0; i < kCount; ++i) {
+    task_runner->PostTask([&]() {
+      ran++;
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  ASSERT_EQ(ran.load(), kCount);
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopStealsNestedTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      4u, fml::ConcurrentMessageLoop::SchedulingMode::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kNestedCount = 50;
+  fml::CountDownLatch latch(kNestedCount);
+  fml::AutoResetWaitableEvent nested_tasks_done;
+  std::atomic_size_t nested_tasks_left = kNestedCount;
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  std::thread::id poster_id;
+  task_runner->PostTask([&]() {
+    poster_id = std::this_thread::get_id();
+    // Posted from a worker, so these land in that worker's own deque and
+    // can only reach other workers by being stolen.
+    for (size_t i = 0; i < kNestedCount; ++i) {
+      task_runner->PostTask([&]() {
+        {
+          std::scoped_lock lock(thread_ids_mutex);
+          thread_ids.insert(std::this_thread::get_id());
+        }
+        if (--nested_tasks_left == 0) {
+          nested_tasks_done.Signal();
+        }
+        latch.CountDown();
+      });
+    }
+    // Keep the poster busy so that it does not run any of them itself. If
+    // they are not stolen, it ends up running them all after the timeout.
+    nested_tasks_done.WaitWithTimeout(fml::TimeDelta::FromSeconds(10));
+  });
+  latch.Wait();
+  ASSERT_FALSE(thread_ids.empty());
+  ASSERT_EQ(thread_ids.count(poster_id), 0u);
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopRunsTasksOnAllWorkers) {
+  const size_t kWorkerCount = 4u;
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      kWorkerCount, fml::ConcurrentMessageLoop::SchedulingMode::kWorkStealing);
+  fml::CountDownLatch latch(kWorkerCount);
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  loop->PostTaskToAllWorkers([&]() {
+    std::scoped_lock lock(thread_ids_mutex);
+    thread_ids.insert(std::this_thread::get_id());
+    latch.CountDown();
+  });
+  latch.Wait();
+  ASSERT_EQ(thread_ids.size(), kWorkerCount);
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopDrainsTasksOnShutdown) {
+  std::atomic_size_t ran = 0;
+  const size_t kCount = 1000;
+  {
+    auto loop = fml::ConcurrentMessageLoop::Create(
+        2u, fml::ConcurrentMessageLoop::SchedulingMode::kWorkStealing);
+    auto task_runner = loop->GetTaskRunner();
+    for (size_t i = 0; i < kCount; ++i) {
+      task_runner->PostTask([&]() { ran++; });
+    }
+  }
+  ASSERT_EQ(ran.load(), kCount);
+}
@@ -6,6 +6,7 @@
 
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/file.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -222,6 +223,41 @@ bool WriteAtomically(const fml::UniqueFD& base_directory,
                     base_directory.get(), file_name) == 0;
 }
 
+ScopedFileLock::ScopedFileLock(const fml::UniqueFD& file) : file_(file) {
+  if (file_.is_valid()) {
+    is_locked_ = FML_HANDLE_EINTR(::flock(file_.get(), LOCK_EX)) == 0;
+  }
+}
+
+ScopedFileLock::~ScopedFileLock() {
+  if (is_locked_) {
+    ::flock(file_.get(), LOCK_UN);
+  }
+}
+
+bool AppendToFile(const fml::UniqueFD& file, const Mapping& mapping) {
+  if (!file.is_valid()) {
+    return false;
+  }
+
+  if (::lseek(file.get(), 0, SEEK_END) < 0) {
+    return false;
+  }
+
+  const uint8_t* data = mapping.GetMapping();
+  size_t remaining = mapping.GetSize();
+  while (remaining > 0) {
+    const ssize_t written =
+        FML_HANDLE_EINTR(::write(file.get(), data, remaining));
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    remaining -= written;
+  }
+  return true;
+}
+
 bool VisitFiles(const fml::UniqueFD& directory, const FileVisitor& visitor) {
   fml::UniqueFD dup_fd(dup(directory.get()));
   if (!dup_fd.is_valid()) {
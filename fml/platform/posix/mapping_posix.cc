@@ -46,12 +46,50 @@ static bool IsWritable(
   return false;
 }
 
+static bool HasHint(std::initializer_list<FileMapping::Hint> hints,
+                    FileMapping::Hint hint) {
+  for (auto candidate : hints) {
+    if (candidate == hint) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int ToPosixMapFlags(std::initializer_list<FileMapping::Hint> hints) {
+  int flags = 0;
+#if defined(MAP_POPULATE)
+  if (HasHint(hints, FileMapping::Hint::kPopulate)) {
+    flags |= MAP_POPULATE;
+  }
+#endif  // defined(MAP_POPULATE)
+  return flags;
+}
+
+static void AdviseMapping(void* mapping,
+                          size_t size,
+                          std::initializer_list<FileMapping::Hint> hints) {
+  // The advice is only a hint, failures are not worth reporting. Huge pages
+  // are requested first so that the pages read ahead may already use them.
+#if defined(MADV_HUGEPAGE)
+  if (HasHint(hints, FileMapping::Hint::kHugePages)) {
+    ::madvise(mapping, size, MADV_HUGEPAGE);
+  }
+#endif  // defined(MADV_HUGEPAGE)
+#if defined(MADV_WILLNEED)
+  if (HasHint(hints, FileMapping::Hint::kWillNeed)) {
+    ::madvise(mapping, size, MADV_WILLNEED);
+  }
+#endif  // defined(MADV_WILLNEED)
+}
+
 Mapping::Mapping() = default;
 
 Mapping::~Mapping() = default;
 
 FileMapping::FileMapping(const fml::UniqueFD& handle,
-                         std::initializer_list<Protection> protection)
+                         std::initializer_list<Protection> protection,
+                         std::initializer_list<Hint> hints)
     : size_(0), mapping_(nullptr) {
   if (!handle.is_valid()) {
     return;
@@ -70,14 +108,17 @@ FileMapping::FileMapping(const fml::UniqueFD& handle,
 
   const auto is_writable = IsWritable(protection);
 
-  auto* mapping =
-      ::mmap(nullptr, stat_buffer.st_size, ToPosixProtectionFlags(protection),
-             is_writable ? MAP_SHARED : MAP_PRIVATE, handle.get(), 0);
+  auto* mapping = ::mmap(
+      nullptr, stat_buffer.st_size, ToPosixProtectionFlags(protection),
+      (is_writable ? MAP_SHARED : MAP_PRIVATE) | ToPosixMapFlags(hints),
+      handle.get(), 0);
 
   if (mapping == MAP_FAILED) {
     return;
   }
 
+  AdviseMapping(mapping, stat_buffer.st_size, hints);
+
   mapping_ = static_cast<uint8_t*>(mapping);
   size_ = stat_buffer.st_size;
   valid_ = true;
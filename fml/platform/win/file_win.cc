@@ -10,6 +10,7 @@
 #include <limits.h>
 
 #include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "flutter/fml/build_config.h"
@@ -406,6 +407,51 @@ bool WriteAtomically(const fml::UniqueFD& base_directory,
   return true;
 }
 
+ScopedFileLock::ScopedFileLock(const fml::UniqueFD& file) : file_(file) {
+  if (!file_.is_valid()) {
+    return;
+  }
+  OVERLAPPED overlapped = {};
+  is_locked_ = ::LockFileEx(file_.get(), LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD,
+                            MAXDWORD, &overlapped);
+  if (!is_locked_) {
+    FML_DLOG(ERROR) << "Could not lock the file. " << GetLastErrorMessage();
+  }
+}
+
+ScopedFileLock::~ScopedFileLock() {
+  if (is_locked_) {
+    OVERLAPPED overlapped = {};
+    ::UnlockFileEx(file_.get(), 0, MAXDWORD, MAXDWORD, &overlapped);
+  }
+}
+
+bool AppendToFile(const fml::UniqueFD& file, const Mapping& mapping) {
+  LARGE_INTEGER distance = {};
+  if (!::SetFilePointerEx(file.get(), distance, nullptr, FILE_END)) {
+    FML_DLOG(ERROR) << "Could not seek to the end of the file. "
+                    << GetLastErrorMessage();
+    return false;
+  }
+
+  const uint8_t* data = mapping.GetMapping();
+  size_t remaining = mapping.GetSize();
+  while (remaining > 0) {
+    const DWORD chunk_size = static_cast<DWORD>(
+        std::min<size_t>(remaining, std::numeric_limits<DWORD>::max()));
+    DWORD written = 0;
+    if (!::WriteFile(file.get(), data, chunk_size, &written, nullptr) ||
+        written == 0) {
+      FML_DLOG(ERROR) << "Could not write to the file. "
+                      << GetLastErrorMessage();
+      return false;
+    }
+    data += written;
+    remaining -= written;
+  }
+  return true;
+}
+
 bool VisitFiles(const fml::UniqueFD& directory, const FileVisitor& visitor) {
   std::string search_pattern = GetFullHandlePath(directory) + "\\*";
   WIN32_FIND_DATA find_file_data;
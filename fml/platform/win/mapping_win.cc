@@ -40,8 +40,10 @@ static bool IsExecutable(
   return false;
 }
 
+// Mapping hints are not supported on Windows and are ignored.
 FileMapping::FileMapping(const fml::UniqueFD& fd,
-                         std::initializer_list<Protection> protections)
+                         std::initializer_list<Protection> protections,
+                         std::initializer_list<Hint> hints)
     : size_(0), mapping_(nullptr) {
   if (!fd.is_valid()) {
     return;
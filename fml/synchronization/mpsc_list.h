@@ -0,0 +1,84 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_SYNCHRONIZATION_MPSC_LIST_H_
+#define FLUTTER_FML_SYNCHRONIZATION_MPSC_LIST_H_
+
+#include <atomic>
+#include <utility>
+
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+// A lock-free list that any number of threads may push to and that one thread
+// at a time takes all of the items from.
+//
+// |Push| is a single compare-and-swap on the head of the list (a Treiber
+// stack). |TakeAll| detaches the whole list with one exchange, so there is no
+// ABA problem, and hands the items out in the order they were pushed.
+template <typename T>
+class MpscList {
+ public:
+  MpscList() = default;
+
+  ~MpscList() {
+    TakeAll([](T) {});
+  }
+
+  // Any thread.
+  void Push(T value) {
+    Node* node = new Node(std::move(value));
+    node->next = head_.load(std::memory_order_relaxed);
+    // Sequentially consistent so that a consumer that stores a value and then
+    // checks |IsEmpty| either sees this item or has its store seen by a
+    // producer that pushes and then loads that value.
+    while (!head_.compare_exchange_weak(node->next, node,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  // Any thread. Only a snapshot, unless no thread is pushing.
+  bool IsEmpty() const {
+    return head_.load(std::memory_order_seq_cst) == nullptr;
+  }
+
+  // One thread at a time. Invokes |callback| with every item pushed before
+  // the call, oldest first.
+  template <typename Callback>
+  void TakeAll(Callback callback) {
+    Node* node = head_.exchange(nullptr, std::memory_order_seq_cst);
+    // Reverse the list into push order.
+    Node* oldest = nullptr;
+    while (node != nullptr) {
+      Node* next = node->next;
+      node->next = oldest;
+      oldest = node;
+      node = next;
+    }
+    while (oldest != nullptr) {
+      Node* next = oldest->next;
+      callback(std::move(oldest->value));
+      delete oldest;
+      oldest = next;
+    }
+  }
+
+ private:
+  struct Node {
+    explicit Node(T p_value) : value(std::move(p_value)) {}
+
+    T value;
+    Node* next = nullptr;
+  };
+
+  std::atomic<Node*> head_ = {nullptr};
+
+  FML_DISALLOW_COPY_AND_ASSIGN(MpscList);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_SYNCHRONIZATION_MPSC_LIST_H_
@@ -0,0 +1,80 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/synchronization/mpsc_list.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(MpscListTest, TakeAllReturnsItemsInPushOrder) {
+  MpscList<int> list;
+  ASSERT_TRUE(list.IsEmpty());
+  list.Push(1);
+  list.Push(2);
+  list.Push(3);
+  ASSERT_FALSE(list.IsEmpty());
+
+  std::vector<int> taken;
+  list.TakeAll([&taken](int value) { taken.push_back(value); });
+  ASSERT_EQ(taken, std::vector<int>({1, 2, 3}));
+  ASSERT_TRUE(list.IsEmpty());
+
+  taken.clear();
+  list.TakeAll([&taken](int value) { taken.push_back(value); });
+  ASSERT_TRUE(taken.empty());
+}
+
+TEST(MpscListTest, DestroysItemsThatWereNeverTaken) {
+  auto item = std::make_shared<int>(0);
+  {
+    MpscList<std::shared_ptr<int>> list;
+    list.Push(item);
+    list.Push(item);
+    ASSERT_EQ(item.use_count(), 3);
+  }
+  ASSERT_EQ(item.use_count(), 1);
+}
+
+TEST(MpscListTest, EveryItemIsTakenExactlyOnceInPerProducerOrder) {
+  const int kProducerCount = 8;
+  const int kItemsPerProducer = 20000;
+  MpscList<std::pair<int, int>> list;
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kProducerCount; ++producer) {
+    producers.emplace_back([&list, producer]() {
+      for (int i = 0; i < kItemsPerProducer; ++i) {
+        list.Push({producer, i});
+      }
+    });
+  }
+
+  std::vector<int> next_item(kProducerCount, 0);
+  int taken = 0;
+  auto take = [&]() {
+    list.TakeAll([&](std::pair<int, int> item) {
+      ASSERT_EQ(item.second, next_item[item.first]);
+      next_item[item.first]++;
+      taken++;
+    });
+  };
+  while (taken < kProducerCount * kItemsPerProducer) {
+    take();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  take();
+
+  ASSERT_EQ(taken, kProducerCount * kItemsPerProducer);
+  ASSERT_TRUE(list.IsEmpty());
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_SYNCHRONIZATION_WORK_STEALING_DEQUE_H_
+#define FLUTTER_FML_SYNCHRONIZATION_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+// A lock-free, single-owner, multi-thief deque (Chase & Lev, "Dynamic
+// Circular Work-Stealing Deque", using the memory orderings from Lê et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models").
+//
+// Only the owning thread may call |Push| and |Pop|, which operate on the
+// bottom of the deque in LIFO order. Any thread may call |Steal|, which takes
+// from the top in FIFO order. Items are raw pointers; the deque never takes
+// ownership of the pointees.
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_pointer<T>::value,
+                "WorkStealingDeque can only hold pointer types.");
+
+ public:
+  explicit WorkStealingDeque(size_t initial_capacity = 64)
+      : buffer_(new Buffer(RoundUpToPowerOfTwo(initial_capacity))) {
+    buffers_.emplace_back(buffer_.load(std::memory_order_relaxed));
+  }
+
+  ~WorkStealingDeque() = default;
+
+  // Owner only.
+  void Push(T item) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<int64_t>(buffer->capacity) - 1) {
+      buffer = Grow(buffer, top, bottom);
+    }
+    buffer->Put(bottom, item);
+    // Publishes the item (and everything the owner wrote to the pointee) to
+    // thieves that acquire |bottom_|.
+    bottom_.store(bottom + 1, std::memory_order_release);
+  }
+
+  // Owner only. Returns |nullptr| if the deque is empty or the last item was
+  // lost to a concurrent |Steal|.
+  T Pop() {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    // All stores to |bottom_| are releases so that whichever one a thief
+    // observes also publishes the items pushed before it.
+    bottom_.store(bottom, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      // Empty.
+      bottom_.store(bottom + 1, std::memory_order_release);
+      return nullptr;
+    }
+
+    T item = buffer->Get(bottom);
+    if (top == bottom) {
+      // Last item. Race against thieves for it.
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_release);
+    }
+    return item;
+  }
+
+  // Any thread. Returns |nullptr| if the deque is empty or the steal lost a
+  // race against the owner or another thief.
+  T Steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    T item = buffer->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Any thread. The result is only a snapshot and may be stale by the time
+  // the caller inspects it.
+  size_t ApproximateSize() const {
+    const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    const int64_t top = top_.load(std::memory_order_seq_cst);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0u;
+  }
+
+ private:
+  struct Buffer {
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<std::atomic<T>[]> items;
+
+    explicit Buffer(size_t p_capacity)
+        : capacity(p_capacity),
+          mask(p_capacity - 1),
+          items(new std::atomic<T>[p_capacity]) {}
+
+    T Get(int64_t index) const {
+      return items[index & mask].load(std::memory_order_relaxed);
+    }
+
+    void Put(int64_t index, T item) {
+      items[index & mask].store(item, std::memory_order_relaxed);
+    }
+  };
+
+  std::atomic<int64_t> top_ = {0};
+  std::atomic<int64_t> bottom_ = {0};
+  std::atomic<Buffer*> buffer_;
+  // Owns every buffer ever used by this deque. Thieves may still be reading
+  // from a buffer after the owner has grown the deque, so buffers are only
+  // collected when the deque itself dies. Since the capacity doubles each
+  // time, this is at most twice the peak footprint.
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  Buffer* Grow(Buffer* old_buffer, int64_t top, int64_t bottom) {
+    auto new_buffer = std::make_unique<Buffer>(old_buffer->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+      new_buffer->Put(i, old_buffer->Get(i));
+    }
+    Buffer* result = new_buffer.get();
+    buffers_.emplace_back(std::move(new_buffer));
+    buffer_.store(result, std::memory_order_release);
+    return result;
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_SYNCHRONIZATION_WORK_STEALING_DEQUE_H_
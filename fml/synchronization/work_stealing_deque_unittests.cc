@@ -0,0 +1,96 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/synchronization/work_stealing_deque.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(WorkStealingDequeTest, EmptyDequeReturnsNull) {
+  WorkStealingDeque<int*> deque;
+  ASSERT_EQ(deque.Pop(), nullptr);
+  ASSERT_EQ(deque.Steal(), nullptr);
+  ASSERT_EQ(deque.ApproximateSize(), 0u);
+}
+
+TEST(WorkStealingDequeTest, PopIsLIFOAndStealIsFIFO) {
+  int values[3] = {};
+  WorkStealingDeque<int*> deque;
+  deque.Push(&values[0]);
+  deque.Push(&values[1]);
+  deque.Push(&values[2]);
+  ASSERT_EQ(deque.ApproximateSize(), 3u);
+  ASSERT_EQ(deque.Pop(), &values[2]);
+  ASSERT_EQ(deque.Steal(), &values[0]);
+  ASSERT_EQ(deque.Pop(), &values[1]);
+  ASSERT_EQ(deque.Pop(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, GrowsPastInitialCapacity) {
+  std::vector<int> values(1000);
+  WorkStealingDeque<int*> deque(4);
+  for (auto& value : values) {
+    deque.Push(&value);
+  }
+  ASSERT_EQ(deque.ApproximateSize(), values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(deque.Steal(), &values[i]);
+  }
+  ASSERT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, EveryItemIsTakenExactlyOnce) {
+  const size_t kItemCount = 100000;
+  const size_t kThiefCount = 4;
+  std::vector<std::atomic_int> taken(kItemCount);
+  std::vector<size_t> indices(kItemCount);
+  for (size_t i = 0; i < kItemCount; ++i) {
+    indices[i] = i;
+  }
+
+  WorkStealingDeque<size_t*> deque(16);
+  std::atomic_bool done = false;
+  std::vector<std::thread> thieves;
+  for (size_t i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      while (!done) {
+        if (auto item = deque.Steal()) {
+          taken[*item]++;
+        }
+      }
+    });
+  }
+
+  for (size_t i = 0; i < kItemCount; ++i) {
+    deque.Push(&indices[i]);
+    if (i % 3 == 0) {
+      if (auto item = deque.Pop()) {
+        taken[*item]++;
+      }
+    }
+  }
+  while (auto item = deque.Pop()) {
+    taken[*item]++;
+  }
+  while (deque.ApproximateSize() > 0) {
+    std::this_thread::yield();
+  }
+
+  done = true;
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  for (size_t i = 0; i < kItemCount; ++i) {
+    ASSERT_EQ(taken[i].load(), 1) << "Item " << i;
+  }
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -20,18 +20,30 @@ TaskRunner::TaskRunner(fml::RefPtr<MessageLoopImpl> loop)
 
 TaskRunner::~TaskRunner() = default;
 
-void TaskRunner::PostTask(const fml::closure& task) {
-  loop_->PostTask(task, fml::TimePoint::Now());
+void TaskRunner::PostTask(fml::UniqueClosure task) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now());
 }
 
-void TaskRunner::PostTaskForTime(const fml::closure& task,
+void TaskRunner::PostTaskForTime(fml::UniqueClosure task,
                                  fml::TimePoint target_time) {
-  loop_->PostTask(task, target_time);
+  loop_->PostTask(std::move(task), target_time);
 }
 
-void TaskRunner::PostDelayedTask(const fml::closure& task,
+void TaskRunner::PostDelayedTask(fml::UniqueClosure task,
                                  fml::TimeDelta delay) {
-  loop_->PostTask(task, fml::TimePoint::Now() + delay);
+  loop_->PostTask(std::move(task), fml::TimePoint::Now() + delay);
+}
+
+void TaskRunner::PostTaskWithPriority(fml::UniqueClosure task,
+                                      TaskPriority priority) {
+  PostTaskForTimeWithPriority(std::move(task), fml::TimePoint::Now(),
+                              priority);
+}
+
+void TaskRunner::PostTaskForTimeWithPriority(fml::UniqueClosure task,
+                                             fml::TimePoint target_time,
+                                             TaskPriority priority) {
+  loop_->PostTask(std::move(task), target_time, priority);
 }
 
 TaskQueueId TaskRunner::GetTaskQueueId() {
@@ -63,7 +75,7 @@ bool TaskRunner::RunsTasksOnCurrentThread() {
 }
 
 void TaskRunner::RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                                  const fml::closure& task) {
+                                  fml::UniqueClosure task) {
   FML_DCHECK(runner);
   if (runner->RunsTasksOnCurrentThread()) {
     task();
@@ -11,6 +11,7 @@
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/fml/message_loop_task_queues.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 
 namespace fml {
 
@@ -20,19 +21,29 @@ class TaskRunner : public fml::RefCountedThreadSafe<TaskRunner> {
  public:
   virtual ~TaskRunner();
 
-  virtual void PostTask(const fml::closure& task);
+  virtual void PostTask(fml::UniqueClosure task);
 
-  virtual void PostTaskForTime(const fml::closure& task,
+  virtual void PostTaskForTime(fml::UniqueClosure task,
                                fml::TimePoint target_time);
 
-  virtual void PostDelayedTask(const fml::closure& task, fml::TimeDelta delay);
+  virtual void PostDelayedTask(fml::UniqueClosure task, fml::TimeDelta delay);
+
+  // Like |PostTask|, but once due the task runs ahead of the due tasks of
+  // lower |priority|.
+  void PostTaskWithPriority(fml::UniqueClosure task, TaskPriority priority);
+
+  // Like |PostTaskForTime|, but once due the task runs ahead of the due tasks
+  // of lower |priority|.
+  virtual void PostTaskForTimeWithPriority(fml::UniqueClosure task,
+                                           fml::TimePoint target_time,
+                                           TaskPriority priority);
 
   virtual bool RunsTasksOnCurrentThread();
 
   virtual TaskQueueId GetTaskQueueId();
 
   static void RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                               const fml::closure& task);
+                               fml::UniqueClosure task);
 
  protected:
   TaskRunner(fml::RefPtr<MessageLoopImpl> loop);
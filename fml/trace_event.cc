@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <initializer_list>
 #include <utility>
 
 #include "flutter/fml/build_config.h"
@@ -22,11 +23,38 @@ namespace tracing {
 
 #if TIMELINE_ENABLED
 
+static int64_t RecorderNowMicros() {
+  return TimePoint::Now().ToEpochDelta().ToMicroseconds();
+}
+
+// Records an event with the |TraceRecorder| in addition to the Dart timeline.
+static void RecordEvent(Dart_Timeline_Event_Type type,
+                        TraceArg category_group,
+                        TraceArg name,
+                        TraceIDArg id,
+                        std::initializer_list<TraceRecorder::Arg> args = {}) {
+  if (TraceRecorder::IsRecording()) {
+    TraceRecorder::GetInstance().Record(type, category_group, name, id,
+                                        RecorderNowMicros(), args.begin(),
+                                        args.size());
+  }
+}
+
 size_t TraceNonce() {
   static std::atomic_size_t gLastItem;
   return ++gLastItem;
 }
 
+void RecordTimelineEventWithArgs(TraceArg category_group,
+                                 TraceArg name,
+                                 TraceIDArg id,
+                                 Dart_Timeline_Event_Type type,
+                                 const TraceRecorder::Arg* args,
+                                 size_t arg_count) {
+  TraceRecorder::GetInstance().Record(type, category_group, name, id,
+                                      RecorderNowMicros(), args, arg_count);
+}
+
 void TraceTimelineEvent(TraceArg category_group,
                         TraceArg name,
                         TraceIDArg identifier,
@@ -54,6 +82,7 @@ void TraceTimelineEvent(TraceArg category_group,
 }
 
 void TraceEvent0(TraceArg category_group, TraceArg name) {
+  RecordEvent(Dart_Timeline_Event_Begin, category_group, name, 0);
   Dart_TimelineEvent(name,                       // label
                      Dart_TimelineGetMicros(),   // timestamp0
                      0,                          // timestamp1_or_async_id
@@ -68,6 +97,8 @@ void TraceEvent1(TraceArg category_group,
                  TraceArg name,
                  TraceArg arg1_name,
                  TraceArg arg1_val) {
+  RecordEvent(Dart_Timeline_Event_Begin, category_group, name, 0,
+              {{arg1_name, arg1_val}});
   const char* arg_names[] = {arg1_name};
   const char* arg_values[] = {arg1_val};
   Dart_TimelineEvent(name,                       // label
@@ -86,6 +117,8 @@ void TraceEvent2(TraceArg category_group,
                  TraceArg arg1_val,
                  TraceArg arg2_name,
                  TraceArg arg2_val) {
+  RecordEvent(Dart_Timeline_Event_Begin, category_group, name, 0,
+              {{arg1_name, arg1_val}, {arg2_name, arg2_val}});
   const char* arg_names[] = {arg1_name, arg2_name};
   const char* arg_values[] = {arg1_val, arg2_val};
   Dart_TimelineEvent(name,                       // label
@@ -99,6 +132,7 @@ void TraceEvent2(TraceArg category_group,
 }
 
 void TraceEventEnd(TraceArg name) {
+  RecordEvent(Dart_Timeline_Event_End, nullptr, name, 0);
   Dart_TimelineEvent(name,                      // label
                      Dart_TimelineGetMicros(),  // timestamp0
                      0,                         // timestamp1_or_async_id
@@ -119,6 +153,14 @@ void TraceEventAsyncComplete(TraceArg category_group,
     std::swap(begin, end);
   }
 
+  if (TraceRecorder::IsRecording()) {
+    auto& recorder = TraceRecorder::GetInstance();
+    recorder.Record(Dart_Timeline_Event_Async_Begin, category_group, name,
+                    identifier, begin.ToEpochDelta().ToMicroseconds());
+    recorder.Record(Dart_Timeline_Event_Async_End, category_group, name,
+                    identifier, end.ToEpochDelta().ToMicroseconds());
+  }
+
   Dart_TimelineEvent(name,                                   // label
                      begin.ToEpochDelta().ToMicroseconds(),  // timestamp0
                      identifier,                       // timestamp1_or_async_id
@@ -140,6 +182,7 @@ void TraceEventAsyncComplete(TraceArg category_group,
 void TraceEventAsyncBegin0(TraceArg category_group,
                            TraceArg name,
                            TraceIDArg id) {
+  RecordEvent(Dart_Timeline_Event_Async_Begin, category_group, name, id);
   Dart_TimelineEvent(name,                             // label
                      Dart_TimelineGetMicros(),         // timestamp0
                      id,                               // timestamp1_or_async_id
@@ -153,6 +196,7 @@ void TraceEventAsyncBegin0(TraceArg category_group,
 void TraceEventAsyncEnd0(TraceArg category_group,
                          TraceArg name,
                          TraceIDArg id) {
+  RecordEvent(Dart_Timeline_Event_Async_End, category_group, name, id);
   Dart_TimelineEvent(name,                           // label
                      Dart_TimelineGetMicros(),       // timestamp0
                      id,                             // timestamp1_or_async_id
@@ -168,6 +212,8 @@ void TraceEventAsyncBegin1(TraceArg category_group,
                            TraceIDArg id,
                            TraceArg arg1_name,
                            TraceArg arg1_val) {
+  RecordEvent(Dart_Timeline_Event_Async_Begin, category_group, name, id,
+              {{arg1_name, arg1_val}});
   const char* arg_names[] = {arg1_name};
   const char* arg_values[] = {arg1_val};
   Dart_TimelineEvent(name,                             // label
@@ -185,6 +231,8 @@ void TraceEventAsyncEnd1(TraceArg category_group,
                          TraceIDArg id,
                          TraceArg arg1_name,
                          TraceArg arg1_val) {
+  RecordEvent(Dart_Timeline_Event_Async_End, category_group, name, id,
+              {{arg1_name, arg1_val}});
   const char* arg_names[] = {arg1_name};
   const char* arg_values[] = {arg1_val};
   Dart_TimelineEvent(name,                           // label
@@ -198,6 +246,7 @@ void TraceEventAsyncEnd1(TraceArg category_group,
 }
 
 void TraceEventInstant0(TraceArg category_group, TraceArg name) {
+  RecordEvent(Dart_Timeline_Event_Instant, category_group, name, 0);
   Dart_TimelineEvent(name,                         // label
                      Dart_TimelineGetMicros(),     // timestamp0
                      0,                            // timestamp1_or_async_id
@@ -211,6 +260,7 @@ void TraceEventInstant0(TraceArg category_group, TraceArg name) {
 void TraceEventFlowBegin0(TraceArg category_group,
                           TraceArg name,
                           TraceIDArg id) {
+  RecordEvent(Dart_Timeline_Event_Flow_Begin, category_group, name, id);
   Dart_TimelineEvent(name,                            // label
                      Dart_TimelineGetMicros(),        // timestamp0
                      id,                              // timestamp1_or_async_id
@@ -224,6 +274,7 @@ void TraceEventFlowBegin0(TraceArg category_group,
 void TraceEventFlowStep0(TraceArg category_group,
                          TraceArg name,
                          TraceIDArg id) {
+  RecordEvent(Dart_Timeline_Event_Flow_Step, category_group, name, id);
   Dart_TimelineEvent(name,                           // label
                      Dart_TimelineGetMicros(),       // timestamp0
                      id,                             // timestamp1_or_async_id
@@ -235,6 +286,7 @@ void TraceEventFlowStep0(TraceArg category_group,
 }
 
 void TraceEventFlowEnd0(TraceArg category_group, TraceArg name, TraceIDArg id) {
+  RecordEvent(Dart_Timeline_Event_Flow_End, category_group, name, id);
   Dart_TimelineEvent(name,                          // label
                      Dart_TimelineGetMicros(),      // timestamp0
                      id,                            // timestamp1_or_async_id
@@ -251,6 +303,13 @@ size_t TraceNonce() {
   return 0;
 }
 
+void RecordTimelineEventWithArgs(TraceArg category_group,
+                                 TraceArg name,
+                                 TraceIDArg id,
+                                 Dart_Timeline_Event_Type type,
+                                 const TraceRecorder::Arg* args,
+                                 size_t arg_count) {}
+
 void TraceTimelineEvent(TraceArg category_group,
                         TraceArg name,
                         TraceIDArg identifier,
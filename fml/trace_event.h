@@ -39,6 +39,7 @@
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/trace_recorder.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 
 #if !defined(OS_FUCHSIA)
@@ -164,6 +165,40 @@ SplitArguments(Key key, Value value, Args... args) {
   return std::make_pair(std::move(keys), std::move(values));
 }
 
+inline void CollectRecordArgs(TraceRecorder::Arg* args) {}
+
+// Takes the values by reference, as string arguments point into them.
+template <typename Key, typename Value, typename... Args>
+void CollectRecordArgs(TraceRecorder::Arg* args,
+                       Key key,
+                       const Value& value,
+                       const Args&... rest) {
+  *args = TraceRecorder::Arg(key, value);
+  CollectRecordArgs(args + 1, rest...);
+}
+
+// Records an event with the |TraceRecorder|, keeping the arguments as raw
+// values.
+void RecordTimelineEventWithArgs(TraceArg category_group,
+                                 TraceArg name,
+                                 TraceIDArg id,
+                                 Dart_Timeline_Event_Type type,
+                                 const TraceRecorder::Arg* args,
+                                 size_t arg_count);
+
+template <typename... Args>
+void RecordTimelineEvent(TraceArg category_group,
+                         TraceArg name,
+                         TraceIDArg id,
+                         Dart_Timeline_Event_Type type,
+                         const Args&... args) {
+  // One extra element, as arrays cannot be empty.
+  TraceRecorder::Arg record_args[sizeof...(Args) / 2 + 1];
+  CollectRecordArgs(record_args, args...);
+  RecordTimelineEventWithArgs(category_group, name, id, type, record_args,
+                              sizeof...(Args) / 2);
+}
+
 size_t TraceNonce();
 
 template <typename... Args>
@@ -171,6 +206,10 @@ void TraceCounter(TraceArg category,
                   TraceArg name,
                   TraceIDArg identifier,
                   Args... args) {
+  if (TraceRecorder::IsRecording()) {
+    RecordTimelineEvent(category, name, identifier,
+                        Dart_Timeline_Event_Counter, args...);
+  }
   auto split = SplitArguments(args...);
   TraceTimelineEvent(category, name, identifier, Dart_Timeline_Event_Counter,
                      split.first, split.second);
@@ -186,6 +225,10 @@ void TraceCounterNopHACK(TraceArg category,
 
 template <typename... Args>
 void TraceEvent(TraceArg category, TraceArg name, Args... args) {
+  if (TraceRecorder::IsRecording()) {
+    RecordTimelineEvent(category, name, 0, Dart_Timeline_Event_Begin,
+                        args...);
+  }
   auto split = SplitArguments(args...);
   TraceTimelineEvent(category, name, 0, Dart_Timeline_Event_Begin, split.first,
                      split.second);
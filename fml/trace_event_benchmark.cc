@@ -0,0 +1,62 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/fml/trace_recorder.h"
+
+namespace fml {
+namespace benchmarking {
+
+// The argument is whether the trace recorder is recording.
+static void SetRecording(const benchmark::State& state) {
+  auto& recorder = tracing::TraceRecorder::GetInstance();
+  if (state.range(0) != 0) {
+    recorder.Start();
+  } else {
+    recorder.Stop();
+  }
+}
+
+static void BM_TraceEvent0(benchmark::State& state) {
+  SetRecording(state);
+  while (state.KeepRunning()) {
+    TRACE_EVENT0("flutter", "BM_TraceEvent0");
+  }
+  tracing::TraceRecorder::GetInstance().Stop();
+}
+
+static void BM_TraceCounter(benchmark::State& state) {
+  SetRecording(state);
+  int64_t count = 0;
+  while (state.KeepRunning()) {
+    FML_TRACE_COUNTER("flutter", "BM_TraceCounter", 0,  //
+                      "Count", count++,                 //
+                      "MBytes", count * 1e-6            //
+    );
+  }
+  tracing::TraceRecorder::GetInstance().Stop();
+}
+
+static void BM_TraceRecorderExport(benchmark::State& state) {
+  auto& recorder = tracing::TraceRecorder::GetInstance();
+  recorder.Clear();
+  recorder.Start();
+  for (size_t i = 0; i < tracing::TraceRecorder::kRecordsPerThread / 2; i++) {
+    TRACE_EVENT1("flutter", "BM_TraceRecorderExport", "mode", "basic");
+  }
+  recorder.Stop();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(recorder.ExportChromeJSON());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          tracing::TraceRecorder::kRecordsPerThread);
+}
+
+BENCHMARK(BM_TraceEvent0)->Arg(0)->Arg(1);
+BENCHMARK(BM_TraceCounter)->Arg(0)->Arg(1);
+BENCHMARK(BM_TraceRecorderExport);
+
+}  // namespace benchmarking
+}  // namespace fml
@@ -0,0 +1,536 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/trace_recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/thread_local.h"
+
+namespace fml {
+namespace tracing {
+
+namespace {
+
+// The layout of a record, in 64-bit words.
+constexpr size_t kTimestampWord = 0;
+constexpr size_t kIdWord = 1;
+// The interned name in the low half and category in the high half.
+constexpr size_t kNameWord = 2;
+// The event type in bits 0-7, the argument count in bits 8-15 and the kinds
+// of the arguments in bits 16-23, two bits each.
+constexpr size_t kHeaderWord = 3;
+// The interned argument names, two per word.
+constexpr size_t kArgNamesWord = 4;
+constexpr size_t kArgValuesWord = 6;
+constexpr size_t kRecordWords = kArgValuesWord + TraceRecorder::kMaxArgs;
+
+using PackedRecord = std::array<uint64_t, kRecordWords>;
+
+// Names are interned for good, so bound how many there can be in case an
+// event uses a name that is different every time.
+constexpr size_t kMaxInternedStrings = 1 << 16;
+constexpr uint32_t kNullStringId = 0;
+constexpr uint32_t kOverflowStringId = 1;
+
+// One more slot than there are records to keep, as the slot after the newest
+// record may be in the middle of being overwritten.
+constexpr size_t kSlotsPerThread = TraceRecorder::kRecordsPerThread + 1;
+
+// String argument values are copied into a per-thread ring of words. The
+// value of the argument in the record holds the index of the first word of
+// the string in the upper bits and the length of the string in the low byte.
+constexpr size_t kStringWordsPerThread =
+    TraceRecorder::kStringArgBytesPerThread / sizeof(uint64_t);
+constexpr int kStringLengthBits = 8;
+static_assert(TraceRecorder::kMaxStringArgLength < (1 << kStringLengthBits),
+              "String lengths must fit in the low byte of their value.");
+
+// Stands in for string values that were overwritten before they were read.
+constexpr char kOverwrittenString[] = "(overwritten)";
+
+// The number of entries in the per-thread cache of interned strings.
+constexpr size_t kStringCacheSize = 128;
+
+constexpr int kChromeTraceProcessId = 1;
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+/// A single-producer ring buffer of records. Only the owning thread appends,
+/// while any thread may read. Readers detect records that were overwritten
+/// while they were being copied by checking the write index again afterwards,
+/// like a sequence lock.
+///
+class TraceRecorder::ThreadBuffer {
+ public:
+  struct CachedString {
+    const char* key = nullptr;
+    const char* interned = nullptr;
+    uint32_t id = kNullStringId;
+  };
+
+  // The records of a thread, with the values of their string arguments
+  // replaced by indices into |strings|.
+  struct Records {
+    std::vector<PackedRecord> records;
+    std::vector<std::string> strings;
+  };
+
+  explicit ThreadBuffer(size_t thread_id)
+      : thread_id_(thread_id),
+        words_(new std::atomic<uint64_t>[kSlotsPerThread * kRecordWords]()),
+        string_words_(new std::atomic<uint64_t>[kStringWordsPerThread]()) {}
+
+  size_t GetThreadId() const { return thread_id_; }
+
+  // Only used by the owning thread.
+  std::array<CachedString, kStringCacheSize>& GetStringCache() {
+    return string_cache_;
+  }
+
+  void Append(const PackedRecord& record) {
+    const uint64_t index = write_index_.load(std::memory_order_relaxed);
+    // Orders the write index published by the last append before the writes
+    // to the slot, which may hold a record that is being read.
+    std::atomic_thread_fence(std::memory_order_release);
+    auto* slot = &words_[(index % kSlotsPerThread) * kRecordWords];
+    for (size_t i = 0; i < kRecordWords; i++) {
+      slot[i].store(record[i], std::memory_order_relaxed);
+    }
+    write_index_.store(index + 1, std::memory_order_release);
+  }
+
+  // Copies the string into the ring of string words and returns the value
+  // of the argument. Only called by the owning thread, before it appends the
+  // record that refers to the string.
+  uint64_t AppendString(const char* string) {
+    const size_t length =
+        string == nullptr ? 0 : strnlen(string, kMaxStringArgLength);
+    const size_t word_count =
+        (length + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    const uint64_t index = string_write_index_.load(std::memory_order_relaxed);
+    // Published before the words are overwritten, so that readers of the
+    // strings that used them can tell.
+    string_write_index_.store(index + word_count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < word_count; i++) {
+      uint64_t word = 0;
+      std::memcpy(&word, string + i * sizeof(uint64_t),
+                  std::min(sizeof(uint64_t), length - i * sizeof(uint64_t)));
+      string_words_[(index + i) % kStringWordsPerThread].store(
+          word, std::memory_order_relaxed);
+    }
+    return index << kStringLengthBits | length;
+  }
+
+  Records Read() const {
+    const uint64_t end = write_index_.load(std::memory_order_acquire);
+    const uint64_t begin =
+        std::max(clear_index_.load(std::memory_order_acquire),
+                 end > kRecordsPerThread ? end - kRecordsPerThread : 0);
+    Records result;
+    auto& records = result.records;
+    records.resize(end - begin);
+    for (uint64_t index = begin; index < end; index++) {
+      const auto* slot = &words_[(index % kSlotsPerThread) * kRecordWords];
+      for (size_t i = 0; i < kRecordWords; i++) {
+        records[index - begin][i] = slot[i].load(std::memory_order_relaxed);
+      }
+    }
+
+    // The string values are read before the write indices are checked again
+    // below, as the records that refer to them may have been overwritten.
+    std::vector<uint64_t> string_indices;
+    for (auto& record : records) {
+      const uint64_t header = record[kHeaderWord];
+      const size_t arg_count =
+          std::min<size_t>((header >> 8) & 0xFF, TraceRecorder::kMaxArgs);
+      for (size_t i = 0; i < arg_count; i++) {
+        if (static_cast<Arg::Kind>((header >> (16 + 2 * i)) & 0x3) !=
+            Arg::Kind::kString) {
+          continue;
+        }
+        uint64_t& value = record[kArgValuesWord + i];
+        string_indices.push_back(value >> kStringLengthBits);
+        result.strings.push_back(
+            ReadString(value >> kStringLengthBits,
+                       value & ((1 << kStringLengthBits) - 1)));
+        value = result.strings.size() - 1;
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t string_now =
+        string_write_index_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < string_indices.size(); i++) {
+      if (string_now > string_indices[i] + kStringWordsPerThread) {
+        result.strings[i] = kOverwrittenString;
+      }
+    }
+
+    // The slot of a record starts being reused once the write index reaches
+    // the index of the record plus the number of slots.
+    const uint64_t now = write_index_.load(std::memory_order_relaxed);
+    const uint64_t first_intact =
+        now >= kSlotsPerThread ? now - kSlotsPerThread + 1 : 0;
+    if (first_intact > begin) {
+      records.erase(records.begin(),
+                    records.begin() + std::min(first_intact - begin,
+                                               uint64_t{records.size()}));
+    }
+    return result;
+  }
+
+  void Clear() {
+    clear_index_.store(write_index_.load(std::memory_order_acquire),
+                       std::memory_order_release);
+  }
+
+  void ResetStringCache() { string_cache_.fill({}); }
+
+ private:
+  const size_t thread_id_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  std::atomic<uint64_t> write_index_ = 0;
+  std::atomic<uint64_t> clear_index_ = 0;
+  std::unique_ptr<std::atomic<uint64_t>[]> string_words_;
+  // The number of string words ever written, which only increases.
+  std::atomic<uint64_t> string_write_index_ = 0;
+  std::array<CachedString, kStringCacheSize> string_cache_;
+
+  std::string ReadString(uint64_t index, size_t length) const {
+    std::string string(length, '\0');
+    for (size_t offset = 0; offset < length; offset += sizeof(uint64_t)) {
+      const uint64_t word =
+          string_words_[(index + offset / sizeof(uint64_t)) %
+                        kStringWordsPerThread]
+              .load(std::memory_order_relaxed);
+      std::memcpy(&string[offset], &word,
+                  std::min(sizeof(uint64_t), length - offset));
+    }
+    return string;
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ThreadBuffer);
+};
+
+//------------------------------------------------------------------------------
+/// Returns the buffer of a thread to the recorder when the thread exits.
+///
+class TraceRecorder::ThreadBufferLease {
+ public:
+  explicit ThreadBufferLease(ThreadBuffer* buffer) : buffer_(buffer) {}
+
+  ~ThreadBufferLease() { TraceRecorder::GetInstance().ReleaseBuffer(buffer_); }
+
+  ThreadBuffer* GetBuffer() const { return buffer_; }
+
+ private:
+  ThreadBuffer* buffer_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ThreadBufferLease);
+};
+
+std::atomic_bool TraceRecorder::recording_ = false;
+
+TraceRecorder& TraceRecorder::GetInstance() {
+  // Never destroyed, as threads may record events during shutdown.
+  static TraceRecorder* recorder = new TraceRecorder();
+  return *recorder;
+}
+
+TraceRecorder::TraceRecorder() {
+  strings_.emplace_back("");
+  strings_.emplace_back("(too many trace strings)");
+}
+
+TraceRecorder::~TraceRecorder() = default;
+
+void TraceRecorder::Start() {
+  recording_.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::Stop() {
+  recording_.store(false, std::memory_order_relaxed);
+}
+
+void TraceRecorder::Clear() {
+  std::scoped_lock lock(buffers_mutex_);
+  for (const auto& buffer : buffers_) {
+    buffer->Clear();
+  }
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::GetBufferForCurrentThread() {
+  FML_THREAD_LOCAL ThreadLocalUniquePtr<ThreadBufferLease> tls_lease;
+  if (auto lease = tls_lease.get()) {
+    return lease->GetBuffer();
+  }
+
+  ThreadBuffer* buffer = nullptr;
+  {
+    std::scoped_lock lock(buffers_mutex_);
+    if (free_buffers_.empty()) {
+      buffers_.push_back(std::make_unique<ThreadBuffer>(buffers_.size() + 1));
+      buffer = buffers_.back().get();
+    } else {
+      buffer = free_buffers_.back();
+      free_buffers_.pop_back();
+    }
+  }
+  buffer->ResetStringCache();
+  tls_lease.reset(new ThreadBufferLease(buffer));
+  return buffer;
+}
+
+void TraceRecorder::ReleaseBuffer(ThreadBuffer* buffer) {
+  std::scoped_lock lock(buffers_mutex_);
+  free_buffers_.push_back(buffer);
+}
+
+uint32_t TraceRecorder::InternString(ThreadBuffer* buffer, const char* string) {
+  if (string == nullptr) {
+    return kNullStringId;
+  }
+
+  // The pointer alone is not enough to identify the string, as the storage
+  // of a dynamic string may be reused for another one.
+  const auto hash = reinterpret_cast<uintptr_t>(string);
+  auto& cached = buffer->GetStringCache()[(hash ^ (hash >> 7)) %
+                                          kStringCacheSize];
+  if (cached.key == string && std::strcmp(string, cached.interned) == 0) {
+    return cached.id;
+  }
+
+  std::scoped_lock lock(strings_mutex_);
+  auto found = string_ids_.find(string);
+  if (found == string_ids_.end()) {
+    if (strings_.size() >= kMaxInternedStrings) {
+      return kOverflowStringId;
+    }
+    strings_.emplace_back(string);
+    found = string_ids_.emplace(strings_.back(), strings_.size() - 1).first;
+  }
+  cached.key = string;
+  cached.interned = found->first.data();
+  cached.id = found->second;
+  return cached.id;
+}
+
+void TraceRecorder::Record(Dart_Timeline_Event_Type type,
+                           const char* category,
+                           const char* name,
+                           int64_t id,
+                           int64_t timestamp_micros,
+                           const Arg* args,
+                           size_t arg_count) {
+  if (!IsRecording()) {
+    return;
+  }
+
+  ThreadBuffer* buffer = GetBufferForCurrentThread();
+  arg_count = std::min(arg_count, kMaxArgs);
+
+  PackedRecord record = {};
+  record[kTimestampWord] = timestamp_micros;
+  record[kIdWord] = id;
+  record[kNameWord] = InternString(buffer, name) |
+                      uint64_t{InternString(buffer, category)} << 32;
+  uint64_t header = static_cast<uint8_t>(type) | uint64_t{arg_count} << 8;
+  for (size_t i = 0; i < arg_count; i++) {
+    const Arg& arg = args[i];
+    header |= uint64_t{static_cast<uint8_t>(arg.kind)} << (16 + 2 * i);
+    record[kArgNamesWord + i / 2] |= uint64_t{InternString(buffer, arg.name)}
+                                     << (32 * (i % 2));
+    uint64_t value = 0;
+    switch (arg.kind) {
+      case Arg::Kind::kInt:
+        value = arg.int_value;
+        break;
+      case Arg::Kind::kDouble:
+        std::memcpy(&value, &arg.double_value, sizeof(value));
+        break;
+      case Arg::Kind::kString:
+        value = buffer->AppendString(arg.string_value);
+        break;
+    }
+    record[kArgValuesWord + i] = value;
+  }
+  record[kHeaderWord] = header;
+
+  buffer->Append(record);
+}
+
+static void AppendJSONString(std::string& out, std::string_view string) {
+  out.push_back('"');
+  for (char c : string) {
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out.append(escaped);
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+// The Chrome trace event phase of each Dart timeline event type.
+static const char* GetChromePhase(Dart_Timeline_Event_Type type) {
+  switch (type) {
+    case Dart_Timeline_Event_Begin:
+      return "B";
+    case Dart_Timeline_Event_End:
+      return "E";
+    case Dart_Timeline_Event_Async_Begin:
+      return "b";
+    case Dart_Timeline_Event_Async_End:
+      return "e";
+    case Dart_Timeline_Event_Async_Instant:
+      return "n";
+    case Dart_Timeline_Event_Counter:
+      return "C";
+    case Dart_Timeline_Event_Flow_Begin:
+      return "s";
+    case Dart_Timeline_Event_Flow_Step:
+      return "t";
+    case Dart_Timeline_Event_Flow_End:
+      return "f";
+    default:
+      return "i";
+  }
+}
+
+std::string TraceRecorder::ExportChromeJSON() {
+  std::vector<std::pair<size_t, ThreadBuffer::Records>> threads;
+  {
+    std::scoped_lock lock(buffers_mutex_);
+    for (const auto& buffer : buffers_) {
+      threads.emplace_back(buffer->GetThreadId(), buffer->Read());
+    }
+  }
+
+  // The interned names are never removed, so only the names that exist now
+  // can be referenced by the records read above.
+  std::scoped_lock lock(strings_mutex_);
+  auto lookup = [this](uint64_t id) -> std::string_view {
+    return id < strings_.size() ? strings_[id] : strings_[kOverflowStringId];
+  };
+
+  std::string json = "{\"traceEvents\":[";
+  bool first = true;
+  char buffer[64];
+  for (const auto& [thread_id, thread_records] : threads) {
+    for (const auto& record : thread_records.records) {
+      const uint64_t header = record[kHeaderWord];
+      const auto type = static_cast<Dart_Timeline_Event_Type>(header & 0xFF);
+      const size_t arg_count = (header >> 8) & 0xFF;
+
+      if (!first) {
+        json.push_back(',');
+      }
+      first = false;
+
+      json.append("{\"name\":");
+      AppendJSONString(json, lookup(record[kNameWord] & 0xFFFFFFFF));
+      json.append(",\"cat\":");
+      AppendJSONString(json, lookup(record[kNameWord] >> 32));
+      json.append(",\"ph\":\"");
+      json.append(GetChromePhase(type));
+      std::snprintf(buffer, sizeof(buffer),
+                    "\",\"ts\":%" PRId64 ",\"pid\":%d,\"tid\":%zu",
+                    static_cast<int64_t>(record[kTimestampWord]),
+                    kChromeTraceProcessId, thread_id);
+      json.append(buffer);
+
+      switch (type) {
+        case Dart_Timeline_Event_Instant:
+          json.append(",\"s\":\"t\"");
+          break;
+        case Dart_Timeline_Event_Flow_End:
+          // Binds the flow to the enclosing slice, as the other flow events
+          // are bound by default.
+          json.append(",\"bp\":\"e\"");
+          [[fallthrough]];
+        case Dart_Timeline_Event_Async_Begin:
+        case Dart_Timeline_Event_Async_End:
+        case Dart_Timeline_Event_Async_Instant:
+        case Dart_Timeline_Event_Counter:
+        case Dart_Timeline_Event_Flow_Begin:
+        case Dart_Timeline_Event_Flow_Step:
+          std::snprintf(buffer, sizeof(buffer), ",\"id\":\"0x%" PRIx64 "\"",
+                        record[kIdWord]);
+          json.append(buffer);
+          break;
+        default:
+          break;
+      }
+
+      if (arg_count > 0) {
+        json.append(",\"args\":{");
+        for (size_t i = 0; i < arg_count; i++) {
+          if (i > 0) {
+            json.push_back(',');
+          }
+          const uint64_t value = record[kArgValuesWord + i];
+          AppendJSONString(json, lookup((record[kArgNamesWord + i / 2] >>
+                                         (32 * (i % 2))) &
+                                        0xFFFFFFFF));
+          json.push_back(':');
+          switch (static_cast<Arg::Kind>((header >> (16 + 2 * i)) & 0x3)) {
+            case Arg::Kind::kInt:
+              std::snprintf(buffer, sizeof(buffer), "%" PRId64,
+                            static_cast<int64_t>(value));
+              json.append(buffer);
+              break;
+            case Arg::Kind::kDouble: {
+              double double_value;
+              std::memcpy(&double_value, &value, sizeof(double_value));
+              if (std::isfinite(double_value)) {
+                std::snprintf(buffer, sizeof(buffer), "%.17g", double_value);
+                json.append(buffer);
+              } else {
+                // JSON has no representation for these.
+                json.append("null");
+              }
+              break;
+            }
+            case Arg::Kind::kString:
+              AppendJSONString(json, thread_records.strings[value]);
+              break;
+          }
+        }
+        json.push_back('}');
+      }
+      json.push_back('}');
+    }
+  }
+  json.append("]}");
+  return json;
+}
+
+}  // namespace tracing
+}  // namespace fml
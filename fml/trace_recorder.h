@@ -0,0 +1,175 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TRACE_RECORDER_H_
+#define FLUTTER_FML_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_point.h"
+#include "third_party/dart/runtime/include/dart_tools_api.h"
+
+namespace fml {
+namespace tracing {
+
+//------------------------------------------------------------------------------
+/// @brief      Records trace events into per-thread ring buffers of compact
+///             binary records, independently of the Dart timeline. Names and
+///             categories are interned, which takes a lock the first time a
+///             thread records a given name. Arguments are stored as raw
+///             values, and string values are copied into the thread's buffer,
+///             so recording an event otherwise does not lock, allocate or
+///             format anything. Checking whether to record is a single relaxed
+///             load, so the overhead is negligible while the recorder is
+///             stopped.
+///
+///             The recorded events can be exported as Chrome trace event JSON,
+///             which can be loaded in `chrome://tracing` and Perfetto.
+///
+///             Each thread owns a ring buffer of `kRecordsPerThread` records,
+///             and one of `kStringArgBytesPerThread` bytes for the string
+///             values, allocated the first time it records an event. When a
+///             buffer is full, the oldest records or strings are overwritten.
+///             The buffers of threads that have exited are reused by new
+///             threads.
+///
+class TraceRecorder {
+ public:
+  //----------------------------------------------------------------------------
+  /// An argument of a trace event. The name is interned and a string value is
+  /// copied when the event is recorded, so they only need to live for the
+  /// duration of that call. String values longer than `kMaxStringArgLength`
+  /// bytes are truncated.
+  ///
+  struct Arg {
+    enum class Kind : uint8_t {
+      kInt,
+      kDouble,
+      kString,
+    };
+
+    const char* name = nullptr;
+    Kind kind = Kind::kInt;
+    union {
+      int64_t int_value = 0;
+      double double_value;
+      const char* string_value;
+    };
+
+    Arg() = default;
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    Arg(const char* p_name, T value)
+        : name(p_name), kind(Kind::kInt), int_value(value) {}
+
+    Arg(const char* p_name, double value)
+        : name(p_name), kind(Kind::kDouble), double_value(value) {}
+
+    Arg(const char* p_name, float value) : Arg(p_name, double{value}) {}
+
+    Arg(const char* p_name, const char* value)
+        : name(p_name), kind(Kind::kString), string_value(value) {}
+
+    Arg(const char* p_name, const std::string& value)
+        : Arg(p_name, value.c_str()) {}
+
+    Arg(const char* p_name, TimePoint value)
+        : Arg(p_name, value.ToEpochDelta().ToNanoseconds()) {}
+  };
+
+  static constexpr size_t kMaxArgs = 4;
+  static constexpr size_t kRecordsPerThread = 8192;
+  static constexpr size_t kMaxStringArgLength = 255;
+  static constexpr size_t kStringArgBytesPerThread = 64 * 1024;
+
+  static TraceRecorder& GetInstance();
+
+  static bool IsRecording() {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  void Start();
+
+  void Stop();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Discards the events recorded so far.
+  ///
+  void Clear();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Records an event on the calling thread's buffer, if the
+  ///             recorder is recording.
+  ///
+  /// @param[in]  type              The type of the event.
+  /// @param[in]  category          The category of the event.
+  /// @param[in]  name              The name of the event.
+  /// @param[in]  id                The async or flow id of the event, or the
+  ///                               counter id.
+  /// @param[in]  timestamp_micros  The time of the event on the monotonic
+  ///                               clock used by `fml::TimePoint`.
+  /// @param[in]  args              The arguments. Only the first `kMaxArgs`
+  ///                               are recorded.
+  /// @param[in]  arg_count         The number of arguments.
+  ///
+  void Record(Dart_Timeline_Event_Type type,
+              const char* category,
+              const char* name,
+              int64_t id,
+              int64_t timestamp_micros,
+              const Arg* args = nullptr,
+              size_t arg_count = 0);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Exports the recorded events as a Chrome trace event JSON
+  ///             object. May be called while recording. The events of each
+  ///             thread are exported in the order they were recorded.
+  ///
+  /// @return     The JSON object, with the events in its `traceEvents` array.
+  ///
+  std::string ExportChromeJSON();
+
+ private:
+  class ThreadBuffer;
+  class ThreadBufferLease;
+
+  static std::atomic_bool recording_;
+
+  std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  std::vector<ThreadBuffer*> free_buffers_;
+
+  std::mutex strings_mutex_;
+  // Keys point into |strings_|, whose elements never move.
+  std::unordered_map<std::string_view, uint32_t> string_ids_;
+  std::deque<std::string> strings_;
+
+  TraceRecorder();
+
+  ~TraceRecorder();
+
+  ThreadBuffer* GetBufferForCurrentThread();
+
+  void ReleaseBuffer(ThreadBuffer* buffer);
+
+  uint32_t InternString(ThreadBuffer* buffer, const char* string);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TraceRecorder);
+};
+
+}  // namespace tracing
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TRACE_RECORDER_H_
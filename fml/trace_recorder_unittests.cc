@@ -0,0 +1,173 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/trace_recorder.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/trace_event.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace tracing {
+namespace testing {
+
+class TraceRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TraceRecorder::GetInstance().Clear();
+    TraceRecorder::GetInstance().Start();
+  }
+
+  void TearDown() override { TraceRecorder::GetInstance().Stop(); }
+
+  static void RecordInstant(const char* name, TraceRecorder::Arg arg) {
+    TraceRecorder::GetInstance().Record(Dart_Timeline_Event_Instant, "flutter",
+                                        name, 0, 0, &arg, 1);
+  }
+
+  static size_t CountOccurrences(const std::string& string,
+                                 const std::string& pattern) {
+    size_t count = 0;
+    for (size_t found = string.find(pattern); found != std::string::npos;
+         found = string.find(pattern, found + 1)) {
+      count++;
+    }
+    return count;
+  }
+};
+
+TEST_F(TraceRecorderTest, DoesNotRecordWhileStopped) {
+  TraceRecorder::GetInstance().Stop();
+  TraceEventInstant0("flutter", "NotRecorded");
+  ASSERT_EQ(TraceRecorder::GetInstance().ExportChromeJSON(),
+            "{\"traceEvents\":[]}");
+}
+
+TEST_F(TraceRecorderTest, ExportsDurationEvents) {
+  { TRACE_EVENT1("flutter", "Duration", "mode", "basic"); }
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_NE(
+      json.find("{\"name\":\"Duration\",\"cat\":\"flutter\",\"ph\":\"B\""),
+      std::string::npos);
+  ASSERT_NE(json.find("\"args\":{\"mode\":\"basic\"}"), std::string::npos);
+  ASSERT_NE(json.find("{\"name\":\"Duration\",\"cat\":\"\",\"ph\":\"E\""),
+            std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, KeepsArgumentsAsRawValues) {
+  FML_TRACE_COUNTER("flutter", "Counter", 255, "count", 42, "ratio", 0.5,
+                    "negative", -7, "label", std::string("dynamic"));
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_NE(json.find("\"ph\":\"C\""), std::string::npos);
+  ASSERT_NE(json.find("\"id\":\"0xff\""), std::string::npos);
+  ASSERT_NE(json.find("\"args\":{\"count\":42,\"ratio\":0.5,\"negative\":-7,"
+                      "\"label\":\"dynamic\"}"),
+            std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, DistinguishesStringsAtTheSameAddress) {
+  std::string name = "First";
+  TraceEventInstant0("flutter", name.c_str());
+  name.replace(0, 5, "Other");
+  TraceEventInstant0("flutter", name.c_str());
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_NE(json.find("\"name\":\"First\""), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"Other\""), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, CopiesStringArguments) {
+  std::string value = "First";
+  RecordInstant("Copied", {"value", value.c_str()});
+  value.replace(0, 5, "Other");
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_NE(json.find("\"args\":{\"value\":\"First\"}"), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, DoesNotInternStringArguments) {
+  // More distinct values than there can be interned names.
+  for (size_t i = 0; i < (1 << 16); i++) {
+    RecordInstant("Frame", {"number", std::to_string(i)});
+  }
+  TraceEventInstant0("flutter", "NewName");
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_NE(json.find("\"name\":\"NewName\""), std::string::npos);
+  ASSERT_NE(json.find("\"args\":{\"number\":\"65535\"}"),
+            std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, OverwritesTheOldestStringArguments) {
+  const std::string long_value(TraceRecorder::kMaxStringArgLength + 1, 'x');
+  // Each truncated value takes up its length rounded up to whole words.
+  const size_t count = TraceRecorder::kStringArgBytesPerThread /
+                       (TraceRecorder::kMaxStringArgLength + 1);
+  for (size_t i = 0; i < count + 1; i++) {
+    RecordInstant("Long", {"value", long_value});
+  }
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  const std::string truncated(TraceRecorder::kMaxStringArgLength, 'x');
+  ASSERT_EQ(CountOccurrences(json, "\"value\":\"(overwritten)\""), 1u);
+  ASSERT_EQ(CountOccurrences(json, "\"value\":\"" + truncated + "\""),
+            count);
+}
+
+TEST_F(TraceRecorderTest, EscapesStrings) {
+  TraceEventInstant0("flutter", "Quote\" Backslash\\ Newline\n");
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_NE(json.find("\"name\":\"Quote\\\" Backslash\\\\ Newline\\n\""),
+            std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, OverwritesTheOldestRecordsWhenFull) {
+  TraceEventInstant0("flutter", "Oldest");
+  for (size_t i = 0; i < TraceRecorder::kRecordsPerThread; i++) {
+    TraceEventInstant0("flutter", "Newer");
+  }
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  ASSERT_EQ(json.find("\"name\":\"Oldest\""), std::string::npos);
+  ASSERT_EQ(CountOccurrences(json, "\"name\":\"Newer\""),
+            TraceRecorder::kRecordsPerThread);
+}
+
+TEST_F(TraceRecorderTest, RecordsEachThreadSeparately) {
+  TraceEventInstant0("flutter", "MainThread");
+  std::thread thread([]() { TraceEventInstant0("flutter", "OtherThread"); });
+  thread.join();
+  const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+  const auto main_thread = json.find("\"name\":\"MainThread\"");
+  const auto other_thread = json.find("\"name\":\"OtherThread\"");
+  ASSERT_NE(main_thread, std::string::npos);
+  ASSERT_NE(other_thread, std::string::npos);
+  const auto tid = [&json](size_t from) {
+    const auto begin = json.find("\"tid\":", from);
+    return json.substr(begin, json.find_first_of(",}", begin) - begin);
+  };
+  ASSERT_NE(tid(main_thread), tid(other_thread));
+}
+
+TEST_F(TraceRecorderTest, CanExportWhileRecording) {
+  std::atomic_bool done = false;
+  fml::AutoResetWaitableEvent started;
+  std::thread thread([&done, &started]() {
+    FML_TRACE_COUNTER("flutter", "Busy", 0, "value", 1);
+    started.Signal();
+    while (!done) {
+      FML_TRACE_COUNTER("flutter", "Busy", 0, "value", 1);
+    }
+  });
+  started.Wait();
+  for (int i = 0; i < 100; i++) {
+    const auto json = TraceRecorder::GetInstance().ExportChromeJSON();
+    EXPECT_EQ(json.find("\"name\":\"\""), std::string::npos);
+  }
+  done = true;
+  thread.join();
+}
+
+}  // namespace testing
+}  // namespace tracing
+}  // namespace fml
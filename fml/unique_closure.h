@@ -0,0 +1,140 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_UNIQUE_CLOSURE_H_
+#define FLUTTER_FML_UNIQUE_CLOSURE_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+//------------------------------------------------------------------------------
+/// @brief      A move-only `void()` callable, used for the tasks posted to
+///             task runners.
+///
+///             Unlike an `fml::closure`, it does not need the callable to be
+///             copyable, so lambdas that capture move-only values need no
+///             `fml::MakeCopyable`, and it stores callables of up to
+///             `kInlineSize` bytes without allocating. Larger callables are
+///             moved to the heap.
+///
+class UniqueClosure {
+ public:
+  static constexpr size_t kInlineSize = 64;
+
+  UniqueClosure() = default;
+
+  UniqueClosure(std::nullptr_t) {}
+
+  template <typename Callable,
+            typename Decayed = std::decay_t<Callable>,
+            typename = std::enable_if_t<
+                !std::is_same_v<Decayed, UniqueClosure> &&
+                std::is_invocable_r_v<void, Decayed&>>>
+  UniqueClosure(Callable&& callable) {
+    // Empty |fml::closure|s and null function pointers stay empty.
+    if constexpr (std::is_constructible_v<bool, const Decayed&>) {
+      if (!static_cast<bool>(callable)) {
+        return;
+      }
+    }
+    if constexpr (IsInline<Decayed>()) {
+      new (storage_) Decayed(std::forward<Callable>(callable));
+      ops_ = &kInlineOps<Decayed>;
+    } else {
+      *reinterpret_cast<Decayed**>(storage_) =
+          new Decayed(std::forward<Callable>(callable));
+      ops_ = &kHeapOps<Decayed>;
+    }
+  }
+
+  UniqueClosure(UniqueClosure&& other) noexcept { MoveFrom(other); }
+
+  UniqueClosure& operator=(UniqueClosure&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  UniqueClosure& operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+
+  ~UniqueClosure() { Reset(); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  void operator()() const { ops_->invoke(storage_); }
+
+  // Whether |Callable| is stored without allocating.
+  template <typename Callable>
+  static constexpr bool IsInline() {
+    return sizeof(Callable) <= kInlineSize &&
+           alignof(Callable) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<Callable>;
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    // Move constructs the callable at |to| and destroys the one at |from|.
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Callable>
+  static constexpr Ops kInlineOps = {
+      [](void* storage) { (*static_cast<Callable*>(storage))(); },
+      [](void* from, void* to) {
+        new (to) Callable(std::move(*static_cast<Callable*>(from)));
+        static_cast<Callable*>(from)->~Callable();
+      },
+      [](void* storage) { static_cast<Callable*>(storage)->~Callable(); },
+  };
+
+  template <typename Callable>
+  static constexpr Ops kHeapOps = {
+      [](void* storage) { (**static_cast<Callable**>(storage))(); },
+      [](void* from, void* to) {
+        *static_cast<Callable**>(to) = *static_cast<Callable**>(from);
+      },
+      [](void* storage) { delete *static_cast<Callable**>(storage); },
+  };
+
+  // Mutable so that, like an |fml::closure|, a const closure can be invoked
+  // even if the callable it holds is mutable.
+  alignas(std::max_align_t) mutable unsigned char storage_[kInlineSize];
+  const Ops* ops_ = nullptr;
+
+  void MoveFrom(UniqueClosure& other) {
+    if (other.ops_ != nullptr) {
+      other.ops_->relocate(other.storage_, storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void Reset() {
+    if (ops_ != nullptr) {
+      // Clear first in case destroying the callable touches this closure.
+      const Ops* ops = ops_;
+      ops_ = nullptr;
+      ops->destroy(storage_);
+    }
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(UniqueClosure);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_UNIQUE_CLOSURE_H_
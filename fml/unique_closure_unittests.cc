@@ -0,0 +1,90 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/unique_closure.h"
+
+#include <array>
+#include <memory>
+
+#include "flutter/fml/closure.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(UniqueClosureTest, DefaultConstructedIsEmpty) {
+  UniqueClosure closure;
+  ASSERT_FALSE(closure);
+  UniqueClosure null_closure = nullptr;
+  ASSERT_FALSE(null_closure);
+}
+
+TEST(UniqueClosureTest, EmptyClosureConvertsToEmpty) {
+  fml::closure empty;
+  UniqueClosure closure = empty;
+  ASSERT_FALSE(closure);
+
+  void (*null_function)() = nullptr;
+  UniqueClosure function_closure = null_function;
+  ASSERT_FALSE(function_closure);
+}
+
+TEST(UniqueClosureTest, InvokesSmallCallable) {
+  int count = 0;
+  UniqueClosure closure = [&count]() { count++; };
+  ASSERT_TRUE(closure);
+  closure();
+  closure();
+  ASSERT_EQ(count, 2);
+}
+
+TEST(UniqueClosureTest, InvokesLargeCallable) {
+  std::array<int, 32> values = {};
+  values[31] = 1;
+  static_assert(!UniqueClosure::IsInline<std::array<int, 32>>());
+  int sum = 0;
+  UniqueClosure closure = [values, &sum]() { sum += values[31]; };
+  UniqueClosure moved = std::move(closure);
+  ASSERT_FALSE(closure);
+  moved();
+  ASSERT_EQ(sum, 1);
+}
+
+TEST(UniqueClosureTest, AcceptsMoveOnlyCaptures) {
+  auto value = std::make_unique<int>(42);
+  int result = 0;
+  UniqueClosure closure = [value = std::move(value), &result]() {
+    result = *value;
+  };
+  closure();
+  ASSERT_EQ(result, 42);
+}
+
+TEST(UniqueClosureTest, InvokesMutableCallable) {
+  int result = 0;
+  const UniqueClosure closure = [count = 0, &result]() mutable {
+    result = ++count;
+  };
+  closure();
+  closure();
+  ASSERT_EQ(result, 2);
+}
+
+TEST(UniqueClosureTest, DestroysCapturesExactlyOnce) {
+  auto value = std::make_shared<int>(0);
+  {
+    UniqueClosure closure = [value]() {};
+    ASSERT_EQ(value.use_count(), 2);
+    UniqueClosure moved = std::move(closure);
+    ASSERT_EQ(value.use_count(), 2);
+    moved = nullptr;
+    ASSERT_EQ(value.use_count(), 1);
+    moved = [value]() {};
+    ASSERT_EQ(value.use_count(), 2);
+  }
+  ASSERT_EQ(value.use_count(), 1);
+}
+
+}  // namespace testing
+}  // namespace fml
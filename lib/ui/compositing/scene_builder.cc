@@ -81,9 +81,9 @@ void SceneBuilder::RegisterNatives(tonic::DartLibraryNatives* natives) {
 }
 
 SceneBuilder::SceneBuilder() {
-  // Add a ContainerLayer as the root layer, so that AddLayer operations are
+  // Add a GroupLayer as the root layer, so that AddLayer operations are
   // always valid.
-  PushLayer(std::make_shared<flutter::ContainerLayer>());
+  PushLayer(std::make_shared<flutter::GroupLayer>());
 }
 
 SceneBuilder::~SceneBuilder() = default;
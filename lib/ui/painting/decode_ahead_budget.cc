@@ -0,0 +1,73 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decode_ahead_budget.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+DecodeAheadBudget& DecodeAheadBudget::GetInstance() {
+  // Codecs may outlive the engines and still be destroyed during static
+  // destruction, so the instance is never destroyed.
+  static DecodeAheadBudget* instance = new DecodeAheadBudget();
+  return *instance;
+}
+
+DecodeAheadBudget::DecodeAheadBudget() = default;
+
+DecodeAheadBudget::~DecodeAheadBudget() = default;
+
+void DecodeAheadBudget::SetMaxBytes(size_t max_bytes) {
+  std::scoped_lock lock(mutex_);
+  max_bytes_ = max_bytes;
+}
+
+size_t DecodeAheadBudget::GetMaxBytes() const {
+  std::scoped_lock lock(mutex_);
+  return max_bytes_;
+}
+
+size_t DecodeAheadBudget::GetReservedBytes() const {
+  std::scoped_lock lock(mutex_);
+  return reserved_bytes_;
+}
+
+bool DecodeAheadBudget::TryReserve(size_t bytes) {
+  std::scoped_lock lock(mutex_);
+  if (bytes > max_bytes_ || reserved_bytes_ > max_bytes_ - bytes) {
+    return false;
+  }
+  reserved_bytes_ += bytes;
+  return true;
+}
+
+void DecodeAheadBudget::Release(size_t bytes) {
+  std::scoped_lock lock(mutex_);
+  FML_DCHECK(bytes <= reserved_bytes_);
+  reserved_bytes_ -= std::min(bytes, reserved_bytes_);
+}
+
+void DecodeAheadBudget::AddClient(Client* client) {
+  std::scoped_lock lock(mutex_);
+  clients_.insert(client);
+}
+
+void DecodeAheadBudget::RemoveClient(Client* client) {
+  std::scoped_lock lock(mutex_);
+  clients_.erase(client);
+}
+
+void DecodeAheadBudget::Purge() {
+  std::scoped_lock lock(mutex_);
+  for (Client* client : clients_) {
+    const size_t bytes = client->PurgeDecodedFrames();
+    FML_DCHECK(bytes <= reserved_bytes_);
+    reserved_bytes_ -= std::min(bytes, reserved_bytes_);
+  }
+}
+
+}  // namespace flutter
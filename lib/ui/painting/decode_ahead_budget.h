@@ -0,0 +1,72 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_DECODE_AHEAD_BUDGET_H_
+#define FLUTTER_LIB_UI_PAINTING_DECODE_AHEAD_BUDGET_H_
+
+#include <mutex>
+#include <set>
+
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+// The bytes that animated image codecs may hold in frames they decoded ahead
+// of the frames requested so far. The budget is shared by all the codecs
+// registered with it, on all threads.
+class DecodeAheadBudget {
+ public:
+  class Client {
+   public:
+    virtual ~Client() = default;
+
+    // Drops all the frames decoded ahead of time and returns the number of
+    // bytes that were reserved for them. Called with the budget locked, so
+    // this must not call back into the budget.
+    virtual size_t PurgeDecodedFrames() = 0;
+  };
+
+  // The budget shared by the codecs of all engines in the process. Its
+  // maximum is zero, and thus decoding ahead disabled, until it is set.
+  static DecodeAheadBudget& GetInstance();
+
+  DecodeAheadBudget();
+
+  ~DecodeAheadBudget();
+
+  // Setting a smaller maximum does not purge any frames, but no more bytes
+  // can be reserved until enough of them have been released.
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t GetMaxBytes() const;
+
+  size_t GetReservedBytes() const;
+
+  // Returns false if reserving |bytes| would exceed the maximum.
+  bool TryReserve(size_t bytes);
+
+  void Release(size_t bytes);
+
+  void AddClient(Client* client);
+
+  // Once this returns, |client| is not purged anymore. The bytes still
+  // reserved by the client must be released separately.
+  void RemoveClient(Client* client);
+
+  // Purges the frames of every client and releases their bytes. Used when the
+  // platform is low on memory.
+  void Purge();
+
+ private:
+  mutable std::mutex mutex_;
+  size_t max_bytes_ = 0;
+  size_t reserved_bytes_ = 0;
+  std::set<Client*> clients_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodeAheadBudget);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_DECODE_AHEAD_BUDGET_H_
@@ -0,0 +1,95 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decode_ahead_budget.h"
+
+#include <limits>
+
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+class TestClient : public DecodeAheadBudget::Client {
+ public:
+  explicit TestClient(DecodeAheadBudget& budget) : budget_(budget) {}
+
+  bool Decode(size_t bytes) {
+    if (!budget_.TryReserve(bytes)) {
+      return false;
+    }
+    bytes_ += bytes;
+    return true;
+  }
+
+  size_t bytes() const { return bytes_; }
+
+  // |DecodeAheadBudget::Client|
+  size_t PurgeDecodedFrames() override {
+    size_t bytes = bytes_;
+    bytes_ = 0;
+    return bytes;
+  }
+
+ private:
+  DecodeAheadBudget& budget_;
+  size_t bytes_ = 0;
+};
+
+}  // namespace
+
+TEST(DecodeAheadBudgetTest, IsDisabledByDefault) {
+  DecodeAheadBudget budget;
+  EXPECT_EQ(budget.GetMaxBytes(), 0u);
+  EXPECT_FALSE(budget.TryReserve(1));
+  EXPECT_TRUE(budget.TryReserve(0));
+}
+
+TEST(DecodeAheadBudgetTest, IsSharedByAllClients) {
+  DecodeAheadBudget budget;
+  budget.SetMaxBytes(100);
+  TestClient a(budget), b(budget);
+
+  EXPECT_TRUE(a.Decode(60));
+  EXPECT_FALSE(b.Decode(60));
+  EXPECT_TRUE(b.Decode(40));
+  EXPECT_EQ(budget.GetReservedBytes(), 100u);
+
+  budget.Release(60);
+  EXPECT_TRUE(b.Decode(60));
+  EXPECT_EQ(budget.GetReservedBytes(), 100u);
+}
+
+TEST(DecodeAheadBudgetTest, HugeReservationsDoNotOverflow) {
+  DecodeAheadBudget budget;
+  budget.SetMaxBytes(100);
+  EXPECT_TRUE(budget.TryReserve(50));
+  EXPECT_FALSE(budget.TryReserve(std::numeric_limits<size_t>::max() - 10));
+  EXPECT_EQ(budget.GetReservedBytes(), 50u);
+}
+
+TEST(DecodeAheadBudgetTest, PurgeReleasesTheBytesOfAllClients) {
+  DecodeAheadBudget budget;
+  budget.SetMaxBytes(100);
+  TestClient a(budget), b(budget), removed(budget);
+  budget.AddClient(&a);
+  budget.AddClient(&b);
+  budget.AddClient(&removed);
+  ASSERT_TRUE(a.Decode(30));
+  ASSERT_TRUE(b.Decode(20));
+  ASSERT_TRUE(removed.Decode(10));
+  budget.RemoveClient(&removed);
+
+  budget.Purge();
+
+  EXPECT_EQ(a.bytes(), 0u);
+  EXPECT_EQ(b.bytes(), 0u);
+  EXPECT_EQ(removed.bytes(), 10u);
+  EXPECT_EQ(budget.GetReservedBytes(), 10u);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -5,8 +5,10 @@
 #include "flutter/lib/ui/painting/image_decoder.h"
 
 #include <algorithm>
+#include <mutex>
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/lib/ui/painting/progressive_image_decoder.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
@@ -36,13 +38,9 @@ static double AspectRatio(const SkISize& size) {
   return static_cast<double>(size.width()) / size.height();
 }
 
-// Get the updated dimensions of the image. If both dimensions are specified,
-// use them. If one of them is specified, respect the one that is and use the
-// aspect ratio to calculate the other. If neither dimension is specified, use
-// intrinsic dimensions of the image.
-static SkISize GetResizedDimensions(SkISize current_size,
-                                    std::optional<uint32_t> target_width,
-                                    std::optional<uint32_t> target_height) {
+SkISize GetResizedDimensions(SkISize current_size,
+                             std::optional<uint32_t> target_width,
+                             std::optional<uint32_t> target_height) {
   if (current_size.isEmpty()) {
     return SkISize::MakeEmpty();
   }
@@ -236,6 +234,17 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
     }
   }
 
+  // The codec cannot scale while decoding. Sampling still decodes straight to
+  // close to the target dimensions instead of decoding at full size.
+  ProgressiveImageDecoder sampling_decoder(target_width, target_height);
+  sampling_decoder.AddData(data);
+  sampling_decoder.SetComplete();
+  if (sampling_decoder.Decode() ==
+      ProgressiveImageDecoder::Status::kComplete) {
+    return ResizeRasterImage(sampling_decoder.GetImage(), resized_dimensions,
+                             flow);
+  }
+
   auto image = SkImage::MakeFromEncoded(data);
   if (!image) {
     return nullptr;
@@ -299,18 +308,14 @@ static SkiaGPUObject<SkImage> UploadRasterImage(
   return result;
 }
 
-void ImageDecoder::Decode(ImageDescriptor descriptor,
-                          const ImageResult& callback) {
-  TRACE_EVENT0("flutter", __FUNCTION__);
-  fml::tracing::TraceFlow flow(__FUNCTION__);
-
-  FML_DCHECK(callback);
-  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+using DecodeResult =
+    std::function<void(SkiaGPUObject<SkImage>, fml::tracing::TraceFlow)>;
 
-  // Always service the callback on the UI thread.
-  auto result = [callback, ui_runner = runners_.GetUITaskRunner()](
-                    SkiaGPUObject<SkImage> image,
-                    fml::tracing::TraceFlow flow) {
+// Always service the callback on the UI thread.
+static DecodeResult ResultOnUIThread(ImageDecoder::ImageResult callback,
+                                     fml::RefPtr<fml::TaskRunner> ui_runner) {
+  return [callback, ui_runner](SkiaGPUObject<SkImage> image,
+                               fml::tracing::TraceFlow flow) {
     ui_runner->PostTask(fml::MakeCopyable(
         [callback, image = std::move(image), flow = std::move(flow)]() mutable {
           // We are going to terminate the trace flow here. Flows cannot
@@ -320,6 +325,53 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
           callback(std::move(image));
         }));
   };
+}
+
+// Update the image to the GPU on the IO thread.
+static void UploadOnIOThread(sk_sp<SkImage> decompressed,
+                             fml::WeakPtr<IOManager> io_manager,
+                             const fml::RefPtr<fml::TaskRunner>& io_runner,
+                             DecodeResult result,
+                             fml::tracing::TraceFlow flow) {
+  io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+                                         flow = std::move(flow)]() mutable {
+    if (!io_manager) {
+      FML_LOG(ERROR) << "Could not acquire IO manager.";
+      return result({}, std::move(flow));
+    }
+
+    // If the IO manager does not have a resource context, the caller
+    // might not have set one or a software backend could be in use.
+    // Either way, just return the image as-is.
+    if (!io_manager->GetResourceContext()) {
+      result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
+             std::move(flow));
+      return;
+    }
+
+    auto uploaded =
+        UploadRasterImage(std::move(decompressed), io_manager, flow);
+
+    if (!uploaded.get()) {
+      FML_LOG(ERROR) << "Could not upload image to the GPU.";
+      result({}, std::move(flow));
+      return;
+    }
+
+    // Finally, all done.
+    result(std::move(uploaded), std::move(flow));
+  }));
+}
+
+void ImageDecoder::Decode(ImageDescriptor descriptor,
+                          const ImageResult& callback) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  fml::tracing::TraceFlow flow(__FUNCTION__);
+
+  FML_DCHECK(callback);
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  auto result = ResultOnUIThread(callback, runners_.GetUITaskRunner());
 
   if (!descriptor.data || descriptor.data->size() == 0) {
     result({}, std::move(flow));
@@ -359,38 +411,176 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
         // Step 2: Update the image to the GPU.
         // On IO Thread.
 
-        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
-                                               flow =
-                                                   std::move(flow)]() mutable {
-          if (!io_manager) {
-            FML_LOG(ERROR) << "Could not acquire IO manager.";
-            return result({}, std::move(flow));
-          }
-
-          // If the IO manager does not have a resource context, the caller
-          // might not have set one or a software backend could be in use.
-          // Either way, just return the image as-is.
-          if (!io_manager->GetResourceContext()) {
-            result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
-                   std::move(flow));
-            return;
-          }
-
-          auto uploaded =
-              UploadRasterImage(std::move(decompressed), io_manager, flow);
-
-          if (!uploaded.get()) {
-            FML_LOG(ERROR) << "Could not upload image to the GPU.";
-            result({}, std::move(flow));
-            return;
-          }
-
-          // Finally, all done.
-          result(std::move(uploaded), std::move(flow));
-        }));
+        UploadOnIOThread(std::move(decompressed), io_manager, io_runner,
+                         std::move(result), std::move(flow));
       }));
 }
 
+// Decodes the data of an |ImageStream| on the concurrent task runner as it
+// arrives. At most one decode task is in flight at any time, so the
+// progressive decoder is only ever used by one thread at a time.
+class ImageDecoder::ImageStream::State
+    : public std::enable_shared_from_this<State> {
+ public:
+  State(std::optional<uint32_t> target_width,
+        std::optional<uint32_t> target_height,
+        std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+        fml::RefPtr<fml::TaskRunner> ui_runner,
+        fml::RefPtr<fml::TaskRunner> io_runner,
+        fml::WeakPtr<IOManager> io_manager,
+        DecodeResult result,
+        PartialImageResult partial_result)
+      : target_width_(target_width),
+        target_height_(target_height),
+        concurrent_task_runner_(std::move(concurrent_task_runner)),
+        ui_runner_(std::move(ui_runner)),
+        io_runner_(std::move(io_runner)),
+        io_manager_(std::move(io_manager)),
+        result_(std::move(result)),
+        partial_result_(std::move(partial_result)),
+        decoder_(target_width,
+                 target_height,
+                 static_cast<bool>(partial_result_)),
+        flow_("ImageDecoder::DecodeStream") {}
+
+  void AddData(sk_sp<SkData> data) {
+    decoder_.AddData(std::move(data));
+    ScheduleDecode();
+  }
+
+  void SetComplete() {
+    decoder_.SetComplete();
+    ScheduleDecode();
+  }
+
+ private:
+  const std::optional<uint32_t> target_width_;
+  const std::optional<uint32_t> target_height_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  fml::RefPtr<fml::TaskRunner> ui_runner_;
+  fml::RefPtr<fml::TaskRunner> io_runner_;
+  fml::WeakPtr<IOManager> io_manager_;
+  DecodeResult result_;
+  PartialImageResult partial_result_;
+  ProgressiveImageDecoder decoder_;
+  fml::tracing::TraceFlow flow_;
+  std::mutex mutex_;
+  bool decode_scheduled_ = false;
+  bool decode_again_ = false;
+  bool done_ = false;
+
+  void ScheduleDecode() {
+    {
+      std::scoped_lock lock(mutex_);
+      if (decode_scheduled_) {
+        decode_again_ = true;
+        return;
+      }
+      decode_scheduled_ = true;
+    }
+    concurrent_task_runner_->PostTask(
+        [state = shared_from_this()]() { state->DecodeAvailableData(); });
+  }
+
+  void DecodeAvailableData() {
+    while (true) {
+      if (!done_) {
+        DecodeStep();
+      }
+      std::scoped_lock lock(mutex_);
+      if (!decode_again_) {
+        decode_scheduled_ = false;
+        return;
+      }
+      decode_again_ = false;
+    }
+  }
+
+  void DecodeStep() {
+    TRACE_EVENT0("flutter", "ImageDecoder::DecodeStreamStep");
+    flow_.Step(__FUNCTION__);
+    switch (decoder_.Decode()) {
+      case ProgressiveImageDecoder::Status::kNeedsData:
+        return;
+      case ProgressiveImageDecoder::Status::kPartial:
+        if (partial_result_) {
+          ui_runner_->PostTask([partial_result = partial_result_,
+                                image = decoder_.GetImage()]() {
+            partial_result(image);
+          });
+        }
+        return;
+      case ProgressiveImageDecoder::Status::kComplete: {
+        done_ = true;
+        auto resized_dimensions = GetResizedDimensions(
+            decoder_.GetSourceDimensions(), target_width_, target_height_);
+        auto decompressed =
+            ResizeRasterImage(decoder_.GetImage(), resized_dimensions, flow_);
+        if (!decompressed) {
+          result_({}, std::move(flow_));
+          return;
+        }
+        UploadOnIOThread(std::move(decompressed), io_manager_, io_runner_,
+                         std::move(result_), std::move(flow_));
+        return;
+      }
+      case ProgressiveImageDecoder::Status::kError:
+        done_ = true;
+        FML_LOG(ERROR) << "Could not decompress image.";
+        result_({}, std::move(flow_));
+        return;
+    }
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+ImageDecoder::ImageStream::ImageStream(std::shared_ptr<State> state)
+    : state_(std::move(state)) {}
+
+ImageDecoder::ImageStream::~ImageStream() {
+  state_->SetComplete();
+}
+
+void ImageDecoder::ImageStream::AddData(sk_sp<SkData> data) {
+  state_->AddData(std::move(data));
+}
+
+void ImageDecoder::ImageStream::AddMapping(
+    std::unique_ptr<fml::Mapping> mapping) {
+  if (!mapping || mapping->GetSize() == 0) {
+    return;
+  }
+  SkData::ReleaseProc on_release = [](const void* ptr, void* context) -> void {
+    delete reinterpret_cast<fml::Mapping*>(context);
+  };
+  auto data = SkData::MakeWithProc(mapping->GetMapping(), mapping->GetSize(),
+                                   on_release, mapping.get());
+  // The mapping is now owned by Skia.
+  mapping.release();
+  state_->AddData(std::move(data));
+}
+
+void ImageDecoder::ImageStream::SetComplete() {
+  state_->SetComplete();
+}
+
+std::unique_ptr<ImageDecoder::ImageStream> ImageDecoder::DecodeStream(
+    std::optional<uint32_t> target_width,
+    std::optional<uint32_t> target_height,
+    const ImageResult& result,
+    const PartialImageResult& partial_result) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  FML_DCHECK(result);
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  auto state = std::make_shared<ImageStream::State>(
+      target_width, target_height, concurrent_task_runner_,
+      runners_.GetUITaskRunner(), runners_.GetIOTaskRunner(), io_manager_,
+      ResultOnUIThread(result, runners_.GetUITaskRunner()), partial_result);
+  return std::unique_ptr<ImageStream>(new ImageStream(std::move(state)));
+}
+
 fml::WeakPtr<ImageDecoder> ImageDecoder::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
 }
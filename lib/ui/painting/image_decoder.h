@@ -58,6 +58,51 @@ class ImageDecoder {
   // callback is guaranteed to return on the UI thread.
   void Decode(ImageDescriptor descriptor, const ImageResult& result);
 
+  using PartialImageResult = std::function<void(sk_sp<SkImage>)>;
+
+  // Receives the encoded bytes of an image decoded by |DecodeStream| as they
+  // arrive, e.g. from a network response or a platform channel. May be used
+  // on any thread. Destroying the stream completes it.
+  class ImageStream {
+   public:
+    ~ImageStream();
+
+    void AddData(sk_sp<SkData> data);
+
+    // The mapping is handed to the decoder without copying it.
+    void AddMapping(std::unique_ptr<fml::Mapping> mapping);
+
+    // No more data will be added. The image is decoded from what was added
+    // so far.
+    void SetComplete();
+
+   private:
+    friend class ImageDecoder;
+
+    class State;
+
+    explicit ImageStream(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> state_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(ImageStream);
+  };
+
+  // Like |Decode|, but decodes the image as its encoded bytes are added to the
+  // returned stream instead of waiting for all of them. The image is decoded
+  // at (close to) the target dimensions rather than at its full size, which
+  // lowers the peak memory usage for large images.
+  //
+  // For formats that support it, |partial_result| (which may be null) is
+  // invoked on the UI thread with copies of the parts decoded so far, at the
+  // decode dimensions. |result| is invoked once on the UI thread after the
+  // stream is completed.
+  std::unique_ptr<ImageStream> DecodeStream(
+      std::optional<uint32_t> target_width,
+      std::optional<uint32_t> target_height,
+      const ImageResult& result,
+      const PartialImageResult& partial_result = nullptr);
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
  private:
@@ -69,6 +114,14 @@ class ImageDecoder {
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
+// Get the updated dimensions of the image. If both dimensions are specified,
+// use them. If one of them is specified, respect the one that is and use the
+// aspect ratio to calculate the other. If neither dimension is specified, use
+// intrinsic dimensions of the image.
+SkISize GetResizedDimensions(SkISize current_size,
+                             std::optional<uint32_t> target_width,
+                             std::optional<uint32_t> target_height);
+
 sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
                                        std::optional<uint32_t> target_width,
                                        std::optional<uint32_t> target_height,
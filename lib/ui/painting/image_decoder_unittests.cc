@@ -6,6 +6,7 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/painting/image_decoder.h"
+#include "flutter/lib/ui/painting/progressive_image_decoder.h"
 #include "flutter/testing/test_gl_surface.h"
 #include "flutter/testing/testing.h"
 #include "flutter/testing/thread_test.h"
@@ -497,6 +498,63 @@ TEST_F(ImageDecoderFixtureTest, CanResizeWithoutDecode) {
   latch.Wait();
 }
 
+TEST_F(ImageDecoderFixtureTest, CanDecodeStreamInChunks) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("gpu"),       // gpu
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+
+  std::unique_ptr<IOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+  SkISize final_size = SkISize::MakeEmpty();
+
+  auto release_io_manager = [&]() {
+    io_manager.reset();
+    latch.Signal();
+  };
+
+  auto decode_image = [&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+
+    auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+    ASSERT_TRUE(data);
+
+    ImageDecoder::ImageResult callback = [&](SkiaGPUObject<SkImage> image) {
+      ASSERT_TRUE(runners.GetUITaskRunner()->RunsTasksOnCurrentThread());
+      ASSERT_TRUE(image.get());
+      final_size = image.get()->dimensions();
+      image_decoder.reset();
+      runners.GetIOTaskRunner()->PostTask(release_io_manager);
+    };
+    auto stream = image_decoder->DecodeStream(100, {}, callback);
+
+    const size_t chunk_size = 4096;
+    for (size_t offset = 0; offset < data->size(); offset += chunk_size) {
+      stream->AddMapping(std::make_unique<fml::NonOwnedMapping>(
+          data->bytes() + offset, std::min(chunk_size, data->size() - offset),
+          [data](const uint8_t*, size_t) {}));
+    }
+    stream->SetComplete();
+  };
+
+  auto setup_io_manager_and_decode = [&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    runners.GetUITaskRunner()->PostTask(decode_image);
+  };
+
+  runners.GetIOTaskRunner()->PostTask(setup_io_manager_and_decode);
+
+  latch.Wait();
+  ASSERT_EQ(final_size, SkISize::Make(100, 133));
+}
+
 // Verifies https://skia-review.googlesource.com/c/skia/+/259161 is present in
 // Flutter.
 TEST(ImageDecoderTest,
@@ -557,5 +615,99 @@ TEST(ImageDecoderTest, VerifySubpixelDecodingPreservesExifOrientation) {
   assert_image(decode({}, 100));
 }
 
+static ProgressiveImageDecoder::Status DecodeInChunks(
+    ProgressiveImageDecoder* decoder,
+    const sk_sp<SkData>& data,
+    size_t chunk_size,
+    size_t* partial_count) {
+  for (size_t offset = 0; offset < data->size(); offset += chunk_size) {
+    decoder->AddData(SkData::MakeSubset(
+        data.get(), offset, std::min(chunk_size, data->size() - offset)));
+    if (decoder->Decode() == ProgressiveImageDecoder::Status::kPartial) {
+      (*partial_count)++;
+    }
+  }
+  decoder->SetComplete();
+  return decoder->Decode();
+}
+
+TEST(ImageDecoderTest, ProgressiveDecoderProducesPartialImages) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data != nullptr);
+  auto expected = SkImage::MakeFromEncoded(data);
+  ASSERT_TRUE(expected != nullptr);
+
+  ProgressiveImageDecoder decoder({}, {}, true);
+  size_t partial_count = 0;
+  ASSERT_EQ(DecodeInChunks(&decoder, data, 256, &partial_count),
+            ProgressiveImageDecoder::Status::kComplete);
+  ASSERT_GT(partial_count, 0u);
+  // However many chunks the data arrived in.
+  ASSERT_LE(partial_count,
+            static_cast<size_t>(ProgressiveImageDecoder::kMaxPartialImages));
+
+  auto image = decoder.GetImage();
+  ASSERT_EQ(image->dimensions(), expected->dimensions());
+  ASSERT_TRUE(image->encodeToData(SkEncodedImageFormat::kPNG, 100)
+                  ->equals(expected->encodeToData(SkEncodedImageFormat::kPNG,
+                                                  100)
+                               .get()));
+}
+
+TEST(ImageDecoderTest, ProgressiveDecoderOnlyMakesPartialImagesIfAsked) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data != nullptr);
+
+  ProgressiveImageDecoder decoder({}, {});
+  size_t partial_count = 0;
+  ASSERT_EQ(DecodeInChunks(&decoder, data, 256, &partial_count),
+            ProgressiveImageDecoder::Status::kComplete);
+  ASSERT_EQ(partial_count, 0u);
+  ASSERT_EQ(decoder.GetImage()->dimensions(), SkISize::Make(300, 100));
+}
+
+TEST(ImageDecoderTest, ProgressiveDecoderScalesJpegAndPreservesExif) {
+  auto data = OpenFixtureAsSkData("Horizontal.jpg");
+  ASSERT_TRUE(data != nullptr);
+  auto expected_data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(expected_data != nullptr);
+
+  ProgressiveImageDecoder decoder(300, {});
+  size_t partial_count = 0;
+  ASSERT_EQ(DecodeInChunks(&decoder, data, 1024, &partial_count),
+            ProgressiveImageDecoder::Status::kComplete);
+  ASSERT_EQ(decoder.GetSourceDimensions(), SkISize::Make(600, 200));
+
+  auto image = decoder.GetImage();
+  ASSERT_EQ(image->dimensions(), SkISize::Make(300, 100));
+  ASSERT_TRUE(image->encodeToData(SkEncodedImageFormat::kPNG, 100)
+                  ->equals(expected_data.get()));
+}
+
+TEST(ImageDecoderTest, ProgressiveDecoderSamplesWhenCodecCannotScale) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data != nullptr);
+
+  ProgressiveImageDecoder decoder(100, {});
+  size_t partial_count = 0;
+  ASSERT_EQ(DecodeInChunks(&decoder, data, 1024, &partial_count),
+            ProgressiveImageDecoder::Status::kComplete);
+  ASSERT_EQ(decoder.GetSourceDimensions(), SkISize::Make(300, 100));
+  // Sampled by 3 instead of decoded at full size.
+  ASSERT_EQ(decoder.GetImage()->dimensions(), SkISize::Make(100, 33));
+}
+
+TEST(ImageDecoderTest, ProgressiveDecoderFailsOnTruncatedHeader) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  ASSERT_TRUE(data != nullptr);
+
+  ProgressiveImageDecoder decoder({}, {});
+  decoder.AddData(SkData::MakeSubset(data.get(), 0, 16));
+  ASSERT_EQ(decoder.Decode(), ProgressiveImageDecoder::Status::kNeedsData);
+  decoder.SetComplete();
+  ASSERT_EQ(decoder.Decode(), ProgressiveImageDecoder::Status::kError);
+  ASSERT_EQ(decoder.GetImage(), nullptr);
+}
+
 }  // namespace testing
 }  // namespace flutter
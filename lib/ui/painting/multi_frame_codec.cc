@@ -5,6 +5,7 @@
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "third_party/tonic/logging/dart_invoke.h"
@@ -15,9 +16,15 @@ MultiFrameCodec::MultiFrameCodec(std::unique_ptr<SkCodec> codec)
     : codec_(std::move(codec)),
       frameCount_(codec_->getFrameCount()),
       repetitionCount_(codec_->getRepetitionCount()),
-      nextFrameIndex_(0) {}
+      nextFrameIndex_(0) {
+  DecodeAheadBudget::GetInstance().AddClient(this);
+}
 
-MultiFrameCodec::~MultiFrameCodec() = default;
+MultiFrameCodec::~MultiFrameCodec() {
+  DecodeAheadBudget& budget = DecodeAheadBudget::GetInstance();
+  budget.RemoveClient(this);
+  budget.Release(PurgeDecodedFrames());
+}
 
 static void InvokeNextFrameCallback(
     fml::RefPtr<FrameInfo> frameInfo,
@@ -70,13 +77,17 @@ static bool CopyToBitmap(SkBitmap* dst,
   return true;
 }
 
-sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage(
-    fml::WeakPtr<GrContext> resourceContext) {
-  SkBitmap bitmap = SkBitmap();
+SkImageInfo MultiFrameCodec::GetFrameImageInfo() const {
   SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
   if (info.alphaType() == kUnpremul_SkAlphaType) {
     info = info.makeAlphaType(kPremul_SkAlphaType);
   }
+  return info;
+}
+
+bool MultiFrameCodec::DecodeNextFrame(SkBitmap* result) {
+  SkBitmap bitmap = SkBitmap();
+  SkImageInfo info = GetFrameImageInfo();
   bitmap.allocPixels(info);
 
   SkCodec::Options options;
@@ -86,17 +97,18 @@ sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage(
   const int requiredFrameIndex = frameInfo.fRequiredFrame;
   if (requiredFrameIndex != SkCodec::kNoFrame) {
     if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
+      // The required frame was purged before it was taken. The codec decodes
+      // the frames this one depends on itself.
+      FML_DLOG(INFO) << "Frame " << nextFrameIndex_ << " depends on frame "
                      << requiredFrameIndex
                      << " and no required frames are cached.";
-      return nullptr;
     } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
       FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
                      << " is not cached. Using " << lastRequiredFrameIndex_
                      << " instead";
     }
 
-    if (lastRequiredFrame_->getPixels() &&
+    if (lastRequiredFrame_ != nullptr && lastRequiredFrame_->getPixels() &&
         CopyToBitmap(&bitmap, lastRequiredFrame_->colorType(),
                      *lastRequiredFrame_)) {
       options.fPriorFrame = requiredFrameIndex;
@@ -106,7 +118,7 @@ sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage(
   if (SkCodec::kSuccess != codec_->getPixels(info, bitmap.getPixels(),
                                              bitmap.rowBytes(), &options)) {
     FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
-    return nullptr;
+    return false;
   }
 
   // Hold onto this if we need it to decode future frames.
@@ -115,6 +127,13 @@ sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage(
     lastRequiredFrameIndex_ = nextFrameIndex_;
   }
 
+  result->swap(bitmap);
+  return true;
+}
+
+sk_sp<SkImage> MultiFrameCodec::MakeFrameImage(
+    const SkBitmap& bitmap,
+    fml::WeakPtr<GrContext> resourceContext) {
   if (resourceContext) {
     SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
                     bitmap.pixelRef()->rowBytes());
@@ -128,23 +147,159 @@ sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage(
   }
 }
 
+bool MultiFrameCodec::TakeDecodedFrame(DecodedFrame* frame) {
+  {
+    std::scoped_lock lock(decodedFramesMutex_);
+    if (decodedFrames_.empty()) {
+      return false;
+    }
+    *frame = std::move(decodedFrames_.front());
+    decodedFrames_.pop_front();
+  }
+  DecodeAheadBudget::GetInstance().Release(frame->bytes);
+  return true;
+}
+
+void MultiFrameCodec::ResumeAfterPurge() {
+  int purgedFrameIndex;
+  {
+    std::scoped_lock lock(decodedFramesMutex_);
+    purgedFrameIndex = purgedFrameIndex_;
+    purgedFrameIndex_ = -1;
+  }
+  if (purgedFrameIndex < 0) {
+    return;
+  }
+
+  // The frames from |purgedFrameIndex| up to |nextFrameIndex_| were decoded
+  // and dropped, possibly wrapping around the end of the animation.
+  int droppedFrameCount =
+      (nextFrameIndex_ - purgedFrameIndex + frameCount_) % frameCount_;
+  if (droppedFrameCount == 0) {
+    droppedFrameCount = frameCount_;
+  }
+  if (lastRequiredFrameIndex_ >= 0 &&
+      (lastRequiredFrameIndex_ - purgedFrameIndex + frameCount_) %
+              frameCount_ <
+          droppedFrameCount) {
+    lastRequiredFrame_ = nullptr;
+    lastRequiredFrameIndex_ = -1;
+  }
+  nextFrameIndex_ = purgedFrameIndex;
+}
+
+void MultiFrameCodec::ScheduleDecodeAhead(
+    fml::RefPtr<fml::TaskRunner> io_task_runner) {
+  if (decodeAheadPending_ ||
+      DecodeAheadBudget::GetInstance().GetMaxBytes() == 0) {
+    return;
+  }
+  decodeAheadPending_ = true;
+  // One frame per task, so that requests for frames are not held up.
+  io_task_runner->PostTask([codec = fml::Ref(this), io_task_runner]() {
+    codec->DecodeAhead(io_task_runner);
+  });
+}
+
+void MultiFrameCodec::DecodeAhead(fml::RefPtr<fml::TaskRunner> io_task_runner) {
+  decodeAheadPending_ = false;
+  ResumeAfterPurge();
+  {
+    std::scoped_lock lock(decodedFramesMutex_);
+    if (decodedFrames_.size() >= kMaxDecodeAheadFrames) {
+      return;
+    }
+  }
+
+  DecodeAheadBudget& budget = DecodeAheadBudget::GetInstance();
+  DecodedFrame frame = {nextFrameIndex_, SkBitmap(),
+                        GetFrameImageInfo().computeMinByteSize()};
+  if (!budget.TryReserve(frame.bytes)) {
+    return;
+  }
+
+  {
+    TRACE_EVENT0("flutter", "MultiFrameCodec::DecodeAhead");
+    if (!DecodeNextFrame(&frame.bitmap)) {
+      // Still queued so that the failure is reported for the right frame.
+      budget.Release(frame.bytes);
+      frame.bitmap.reset();
+      frame.bytes = 0;
+    }
+  }
+  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+
+  bool queued = false;
+  {
+    std::scoped_lock lock(decodedFramesMutex_);
+    // Unless the frames before this one were purged while it was decoded, in
+    // which case it is decoded again once the animation gets back to it.
+    if (purgedFrameIndex_ < 0) {
+      decodedFrames_.push_back(std::move(frame));
+      queued = true;
+    }
+  }
+  if (!queued) {
+    budget.Release(frame.bytes);
+  }
+  ScheduleDecodeAhead(std::move(io_task_runner));
+}
+
+size_t MultiFrameCodec::PurgeDecodedFrames() {
+  std::scoped_lock lock(decodedFramesMutex_);
+  if (decodedFrames_.empty()) {
+    return 0;
+  }
+  size_t bytes = 0;
+  for (const DecodedFrame& frame : decodedFrames_) {
+    bytes += frame.bytes;
+  }
+  // The decoder has moved past these frames. It rewinds to the first of them
+  // on the IO thread, so that the animation does not skip them.
+  purgedFrameIndex_ = decodedFrames_.front().index;
+  decodedFrames_.clear();
+  return bytes;
+}
+
+MultiFrameCodec::DecodedFrame MultiFrameCodec::GetNextDecodedFrame(
+    fml::RefPtr<fml::TaskRunner> io_task_runner) {
+  DecodedFrame frame;
+  if (!TakeDecodedFrame(&frame)) {
+    ResumeAfterPurge();
+    frame.index = nextFrameIndex_;
+    frame.bytes = 0;
+    if (!DecodeNextFrame(&frame.bitmap)) {
+      frame.bitmap.reset();
+    }
+    nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+  }
+
+  // Get the frames after this one ready while the animation shows it.
+  ScheduleDecodeAhead(std::move(io_task_runner));
+  return frame;
+}
+
 void MultiFrameCodec::GetNextFrameAndInvokeCallback(
     std::unique_ptr<DartPersistentValue> callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
     fml::WeakPtr<GrContext> resourceContext,
     fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
     size_t trace_id) {
+  DecodedFrame frame = GetNextDecodedFrame(std::move(io_task_runner));
+
   fml::RefPtr<FrameInfo> frameInfo = NULL;
-  sk_sp<SkImage> skImage = GetNextFrameImage(resourceContext);
+  sk_sp<SkImage> skImage = frame.bitmap.isNull()
+                               ? nullptr
+                               : MakeFrameImage(frame.bitmap, resourceContext);
   if (skImage) {
     fml::RefPtr<CanvasImage> image = CanvasImage::Create();
     image->set_image({skImage, std::move(unref_queue)});
     SkCodec::FrameInfo skFrameInfo;
-    codec_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
+    codec_->getFrameInfo(frame.index, &skFrameInfo);
     frameInfo =
         fml::MakeRefCounted<FrameInfo>(std::move(image), skFrameInfo.fDuration);
   }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
 
   ui_task_runner->PostTask(fml::MakeCopyable(
       [callback = std::move(callback), frameInfo, trace_id]() mutable {
@@ -168,11 +323,12 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
       [callback = std::make_unique<DartPersistentValue>(
            tonic::DartState::Current(), callback_handle),
        this, trace_id, ui_task_runner = task_runners.GetUITaskRunner(),
+       io_task_runner = task_runners.GetIOTaskRunner(),
        io_manager = dart_state->GetIOManager()]() mutable {
         GetNextFrameAndInvokeCallback(
             std::move(callback), std::move(ui_task_runner),
-            io_manager->GetResourceContext(), io_manager->GetSkiaUnrefQueue(),
-            trace_id);
+            std::move(io_task_runner), io_manager->GetResourceContext(),
+            io_manager->GetSkiaUnrefQueue(), trace_id);
       }));
 
   return Dart_Null();
@@ -5,13 +5,29 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include <deque>
+#include <mutex>
+
 #include "flutter/fml/macros.h"
 #include "flutter/lib/ui/painting/codec.h"
+#include "flutter/lib/ui/painting/decode_ahead_budget.h"
 
 namespace flutter {
 
-class MultiFrameCodec : public Codec {
+namespace testing {
+class MultiFrameCodecTest;
+}  // namespace testing
+
+// Decodes the frames of animated images on the IO thread.
+//
+// If the shared |DecodeAheadBudget| allows it, each codec also decodes up to
+// |kMaxDecodeAheadFrames| frames ahead of those requested so far, once a frame
+// has been requested. Requests for those frames are then answered without
+// decoding anything.
+class MultiFrameCodec : public Codec, private DecodeAheadBudget::Client {
  public:
+  static constexpr size_t kMaxDecodeAheadFrames = 3;
+
   MultiFrameCodec(std::unique_ptr<SkCodec> codec);
 
   ~MultiFrameCodec() override;
@@ -36,15 +52,63 @@ class MultiFrameCodec : public Codec {
   // The index of the last decoded required frame.
   int lastRequiredFrameIndex_ = -1;
 
-  sk_sp<SkImage> GetNextFrameImage(fml::WeakPtr<GrContext> resourceContext);
+  struct DecodedFrame {
+    int index;
+    // Empty if the frame could not be decoded.
+    SkBitmap bitmap;
+    // The bytes reserved from the |DecodeAheadBudget| for the frame.
+    size_t bytes;
+  };
+
+  // The frames decoded ahead of time, in the order they will be requested.
+  // Only the IO thread adds or takes frames, but they may be purged from any
+  // thread.
+  std::mutex decodedFramesMutex_;
+  std::deque<DecodedFrame> decodedFrames_;
+  // The index of the first frame dropped by the last purge, from which the
+  // IO thread resumes decoding, or -1 if there has been no purge since it
+  // last did. Frames decoded while a purge is pending are dropped as well.
+  int purgedFrameIndex_ = -1;
+  // Whether a task that decodes a frame ahead of time has been posted to the
+  // IO thread. Only accessed on the IO thread.
+  bool decodeAheadPending_ = false;
+
+  SkImageInfo GetFrameImageInfo() const;
+
+  // Decodes the frame at |nextFrameIndex_| into |bitmap|. Does not advance
+  // |nextFrameIndex_|.
+  bool DecodeNextFrame(SkBitmap* bitmap);
+
+  sk_sp<SkImage> MakeFrameImage(const SkBitmap& bitmap,
+                                fml::WeakPtr<GrContext> resourceContext);
+
+  bool TakeDecodedFrame(DecodedFrame* frame);
+
+  // Rewinds |nextFrameIndex_| to the first frame dropped by a pending purge,
+  // and forgets the required frame if it was decoded after that frame.
+  void ResumeAfterPurge();
+
+  // Takes the next frame of the animation, decoding it unless it was decoded
+  // ahead of time, and starts decoding the frames after it.
+  DecodedFrame GetNextDecodedFrame(fml::RefPtr<fml::TaskRunner> io_task_runner);
+
+  void ScheduleDecodeAhead(fml::RefPtr<fml::TaskRunner> io_task_runner);
+
+  void DecodeAhead(fml::RefPtr<fml::TaskRunner> io_task_runner);
+
+  // |DecodeAheadBudget::Client|
+  size_t PurgeDecodedFrames() override;
 
   void GetNextFrameAndInvokeCallback(
       std::unique_ptr<DartPersistentValue> callback,
       fml::RefPtr<fml::TaskRunner> ui_task_runner,
+      fml::RefPtr<fml::TaskRunner> io_task_runner,
       fml::WeakPtr<GrContext> resourceContext,
       fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
       size_t trace_id);
 
+  friend class testing::MultiFrameCodecTest;
+
   FML_FRIEND_MAKE_REF_COUNTED(MultiFrameCodec);
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(MultiFrameCodec);
 };
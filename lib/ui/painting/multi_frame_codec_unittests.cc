@@ -0,0 +1,198 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/multi_frame_codec.h"
+
+#include <cstring>
+
+#include "flutter/fml/paths.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/testing/testing.h"
+#include "flutter/testing/thread_test.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+
+namespace flutter {
+namespace testing {
+
+static sk_sp<SkData> OpenAnimatedImage() {
+  // 20 frames, each of which is drawn on top of the one before it.
+  const auto path =
+      fml::paths::JoinPaths({GetFixturesPath(), "hello_loop_2.gif"});
+  return SkData::MakeFromFileName(path.c_str());
+}
+
+class MultiFrameCodecTest : public ThreadTest {
+ public:
+  MultiFrameCodecTest() : io_task_runner_(CreateNewThread("io")) {}
+
+  void TearDown() override {
+    DecodeAheadBudget& budget = DecodeAheadBudget::GetInstance();
+    budget.Purge();
+    budget.SetMaxBytes(0);
+  }
+
+ protected:
+  static fml::RefPtr<MultiFrameCodec> CreateCodec() {
+    return fml::MakeRefCounted<MultiFrameCodec>(
+        SkCodec::MakeFromData(OpenAnimatedImage()));
+  }
+
+  static size_t GetFrameBytes(const fml::RefPtr<MultiFrameCodec>& codec) {
+    return codec->GetFrameImageInfo().computeMinByteSize();
+  }
+
+  static size_t GetDecodedFrameCount(
+      const fml::RefPtr<MultiFrameCodec>& codec) {
+    std::scoped_lock lock(codec->decodedFramesMutex_);
+    return codec->decodedFrames_.size();
+  }
+
+  // Decodes |index| on its own, the way the codec would without decoding any
+  // of the other frames.
+  static SkBitmap DecodeFrame(const fml::RefPtr<MultiFrameCodec>& codec,
+                              int index) {
+    auto sk_codec = SkCodec::MakeFromData(OpenAnimatedImage());
+    const SkImageInfo info = codec->GetFrameImageInfo();
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    SkCodec::Options options;
+    options.fFrameIndex = index;
+    FML_CHECK(sk_codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes(),
+                                  &options) == SkCodec::kSuccess);
+    return bitmap;
+  }
+
+  static bool HaveSamePixels(const SkBitmap& a, const SkBitmap& b) {
+    return a.info() == b.info() && a.rowBytes() == b.rowBytes() &&
+           std::memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()) == 0;
+  }
+
+  // Takes the next frame of the animation on the IO thread, and waits for the
+  // frames after it to be decoded ahead of time.
+  int TakeNextFrame(const fml::RefPtr<MultiFrameCodec>& codec,
+                    SkBitmap* bitmap = nullptr) {
+    int index = -1;
+    RunOnIOThread([&]() {
+      auto frame = codec->GetNextDecodedFrame(io_task_runner_);
+      index = frame.index;
+      if (bitmap) {
+        *bitmap = frame.bitmap;
+      }
+    });
+    // Every frame decoded ahead of time posts the task that decodes the next
+    // one, so each round trip lets at least one of them run.
+    for (size_t i = 0; i <= MultiFrameCodec::kMaxDecodeAheadFrames; i++) {
+      RunOnIOThread([]() {});
+    }
+    return index;
+  }
+
+ private:
+  fml::RefPtr<fml::TaskRunner> io_task_runner_;
+
+  void RunOnIOThread(const fml::closure& closure) {
+    fml::AutoResetWaitableEvent latch;
+    io_task_runner_->PostTask([&]() {
+      closure();
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+};
+
+TEST_F(MultiFrameCodecTest, DoesNotDecodeAheadWithoutABudget) {
+  auto codec = CreateCodec();
+  ASSERT_EQ(codec->frameCount(), 20);
+
+  ASSERT_EQ(TakeNextFrame(codec), 0);
+  ASSERT_EQ(GetDecodedFrameCount(codec), 0u);
+  ASSERT_EQ(TakeNextFrame(codec), 1);
+}
+
+TEST_F(MultiFrameCodecTest, DecodesFramesAheadWithinTheBudget) {
+  auto codec = CreateCodec();
+  const size_t frame_bytes = GetFrameBytes(codec);
+  DecodeAheadBudget& budget = DecodeAheadBudget::GetInstance();
+
+  budget.SetMaxBytes(2 * frame_bytes);
+  ASSERT_EQ(TakeNextFrame(codec), 0);
+  ASSERT_EQ(GetDecodedFrameCount(codec), 2u);
+  ASSERT_EQ(budget.GetReservedBytes(), 2 * frame_bytes);
+
+  // Taking a frame decoded ahead of time makes room for the next one.
+  ASSERT_EQ(TakeNextFrame(codec), 1);
+  ASSERT_EQ(GetDecodedFrameCount(codec), 2u);
+  ASSERT_EQ(budget.GetReservedBytes(), 2 * frame_bytes);
+
+  // A codec never gets more than a few frames ahead.
+  budget.SetMaxBytes(10 * frame_bytes);
+  ASSERT_EQ(TakeNextFrame(codec), 2);
+  ASSERT_EQ(GetDecodedFrameCount(codec),
+            MultiFrameCodec::kMaxDecodeAheadFrames);
+  ASSERT_EQ(budget.GetReservedBytes(),
+            MultiFrameCodec::kMaxDecodeAheadFrames * frame_bytes);
+
+  codec = nullptr;
+  ASSERT_EQ(budget.GetReservedBytes(), 0u);
+}
+
+TEST_F(MultiFrameCodecTest, BudgetIsSharedByAllCodecs) {
+  auto codec_a = CreateCodec();
+  auto codec_b = CreateCodec();
+  DecodeAheadBudget& budget = DecodeAheadBudget::GetInstance();
+  budget.SetMaxBytes(MultiFrameCodec::kMaxDecodeAheadFrames *
+                     GetFrameBytes(codec_a));
+
+  ASSERT_EQ(TakeNextFrame(codec_a), 0);
+  ASSERT_EQ(GetDecodedFrameCount(codec_a),
+            MultiFrameCodec::kMaxDecodeAheadFrames);
+  ASSERT_EQ(TakeNextFrame(codec_b), 0);
+  ASSERT_EQ(GetDecodedFrameCount(codec_b), 0u);
+
+  // Purging the frames of every codec lets the other one decode ahead.
+  budget.Purge();
+  ASSERT_EQ(GetDecodedFrameCount(codec_a), 0u);
+  ASSERT_EQ(budget.GetReservedBytes(), 0u);
+  ASSERT_EQ(TakeNextFrame(codec_b), 1);
+  ASSERT_EQ(GetDecodedFrameCount(codec_b),
+            MultiFrameCodec::kMaxDecodeAheadFrames);
+}
+
+TEST_F(MultiFrameCodecTest, PurgeDoesNotSkipFrames) {
+  auto codec = CreateCodec();
+  DecodeAheadBudget& budget = DecodeAheadBudget::GetInstance();
+  budget.SetMaxBytes(MultiFrameCodec::kMaxDecodeAheadFrames *
+                     GetFrameBytes(codec));
+
+  ASSERT_EQ(TakeNextFrame(codec), 0);
+  ASSERT_EQ(TakeNextFrame(codec), 1);
+  ASSERT_EQ(GetDecodedFrameCount(codec),
+            MultiFrameCodec::kMaxDecodeAheadFrames);
+
+  // Frames 2 to 4 are dropped, including frame 4 which frame 5 is drawn on.
+  budget.Purge();
+  ASSERT_EQ(budget.GetReservedBytes(), 0u);
+  for (int i = 2; i < 7; i++) {
+    SkBitmap bitmap;
+    ASSERT_EQ(TakeNextFrame(codec, &bitmap), i);
+    ASSERT_TRUE(HaveSamePixels(bitmap, DecodeFrame(codec, i)));
+  }
+}
+
+TEST_F(MultiFrameCodecTest, FramesDecodedAheadMatchFramesDecodedOnTheirOwn) {
+  auto codec = CreateCodec();
+  DecodeAheadBudget::GetInstance().SetMaxBytes(
+      MultiFrameCodec::kMaxDecodeAheadFrames * GetFrameBytes(codec));
+
+  // Through the end of the animation and back to its start.
+  for (int i = 0; i < codec->frameCount() + 2; i++) {
+    SkBitmap bitmap;
+    const int index = TakeNextFrame(codec, &bitmap);
+    ASSERT_EQ(index, i % codec->frameCount());
+    ASSERT_TRUE(HaveSamePixels(bitmap, DecodeFrame(codec, index)));
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,444 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/progressive_image_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
+#include "third_party/skia/include/codec/SkAndroidCodec.h"
+#include "third_party/skia/include/core/SkStream.h"
+#include "third_party/skia/src/core/SkPixmapPriv.h"
+
+namespace flutter {
+
+// The encoded bytes received so far. Chunks are kept as they were added so
+// that mappings handed to the decoder are never copied into a single buffer.
+class ProgressiveImageDecoder::EncodedData {
+ public:
+  EncodedData() = default;
+
+  void Add(sk_sp<SkData> data) {
+    std::scoped_lock lock(mutex_);
+    if (complete_ || data->isEmpty()) {
+      return;
+    }
+    offsets_.push_back(size_);
+    size_ += data->size();
+    chunks_.push_back(std::move(data));
+  }
+
+  void SetComplete() {
+    std::scoped_lock lock(mutex_);
+    complete_ = true;
+  }
+
+  size_t GetSize() const {
+    std::scoped_lock lock(mutex_);
+    return size_;
+  }
+
+  bool IsComplete() const {
+    std::scoped_lock lock(mutex_);
+    return complete_;
+  }
+
+  // Copies up to |length| bytes starting at |offset| into |buffer|, which may
+  // be null to skip them instead. Returns the number of bytes available.
+  size_t Read(size_t offset, void* buffer, size_t length) const {
+    std::scoped_lock lock(mutex_);
+    if (offset >= size_) {
+      return 0;
+    }
+    length = std::min(length, size_ - offset);
+    size_t chunk =
+        std::upper_bound(offsets_.begin(), offsets_.end(), offset) -
+        offsets_.begin() - 1;
+    size_t copied = 0;
+    while (copied < length) {
+      const sk_sp<SkData>& data = chunks_[chunk];
+      const size_t chunk_offset = offset + copied - offsets_[chunk];
+      const size_t count =
+          std::min(length - copied, data->size() - chunk_offset);
+      if (buffer != nullptr) {
+        memcpy(static_cast<uint8_t*>(buffer) + copied,
+               data->bytes() + chunk_offset, count);
+      }
+      copied += count;
+      chunk++;
+    }
+    return copied;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<sk_sp<SkData>> chunks_;
+  std::vector<size_t> offsets_;
+  size_t size_ = 0;
+  bool complete_ = false;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EncodedData);
+};
+
+// A stream over the data received so far. Reads past the end of that data
+// come up short, which codecs report as incomplete input. Codecs that support
+// incremental decoding pick up where they left off on the next read once more
+// data has been added.
+class ProgressiveImageDecoder::EncodedDataStream : public SkStream {
+ public:
+  explicit EncodedDataStream(std::shared_ptr<EncodedData> data)
+      : data_(std::move(data)) {}
+
+  ~EncodedDataStream() override = default;
+
+  // |SkStream|
+  size_t read(void* buffer, size_t size) override {
+    const size_t count = data_->Read(position_, buffer, size);
+    position_ += count;
+    return count;
+  }
+
+  // |SkStream|
+  size_t peek(void* buffer, size_t size) const override {
+    return data_->Read(position_, buffer, size);
+  }
+
+  // |SkStream|
+  bool isAtEnd() const override { return position_ >= data_->GetSize(); }
+
+  // |SkStream|
+  bool rewind() override {
+    position_ = 0;
+    return true;
+  }
+
+  // |SkStream|
+  bool hasPosition() const override { return true; }
+
+  // |SkStream|
+  size_t getPosition() const override { return position_; }
+
+ private:
+  std::shared_ptr<EncodedData> data_;
+  size_t position_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EncodedDataStream);
+};
+
+// Whether codecs of |format| read the encoded data from the stream as they
+// decode. The others copy whatever the stream holds when they are created and
+// would never see the rest of the data.
+static bool CanDecodeFromPartialData(SkEncodedImageFormat format) {
+  switch (format) {
+    case SkEncodedImageFormat::kPNG:
+    case SkEncodedImageFormat::kGIF:
+    case SkEncodedImageFormat::kJPEG:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static sk_sp<SkImage> MakeOrientedImage(const SkBitmap& bitmap,
+                                        SkEncodedOrigin origin) {
+  if (origin == kTopLeft_SkEncodedOrigin) {
+    // Immutable bitmaps share their pixels with the image.
+    return bitmap.isImmutable() ? SkImage::MakeFromBitmap(bitmap)
+                                : SkImage::MakeRasterCopy(bitmap.pixmap());
+  }
+
+  SkImageInfo oriented_info = bitmap.info();
+  if (SkPixmapPriv::ShouldSwapWidthHeight(origin)) {
+    oriented_info = SkPixmapPriv::SwapWidthHeight(oriented_info);
+  }
+  SkBitmap oriented_bitmap;
+  if (!oriented_bitmap.tryAllocPixels(oriented_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << oriented_info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+  if (!SkPixmapPriv::Orient(oriented_bitmap.pixmap(), bitmap.pixmap(),
+                            origin)) {
+    return nullptr;
+  }
+  oriented_bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(oriented_bitmap);
+}
+
+ProgressiveImageDecoder::ProgressiveImageDecoder(
+    std::optional<uint32_t> target_width,
+    std::optional<uint32_t> target_height,
+    bool make_partial_images)
+    : target_width_(target_width),
+      target_height_(target_height),
+      make_partial_images_(make_partial_images),
+      data_(std::make_shared<EncodedData>()) {}
+
+ProgressiveImageDecoder::~ProgressiveImageDecoder() = default;
+
+void ProgressiveImageDecoder::AddData(sk_sp<SkData> data) {
+  if (data) {
+    data_->Add(std::move(data));
+  }
+}
+
+void ProgressiveImageDecoder::SetComplete() {
+  data_->SetComplete();
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::Decode() {
+  if (status_ == Status::kComplete || status_ == Status::kError) {
+    return status_;
+  }
+
+  // Read completeness first so that all of the data is known to be present
+  // when it is set.
+  const bool complete = data_->IsComplete();
+  const size_t size = data_->GetSize();
+  if (size == decoded_data_size_ && complete == decoded_data_complete_) {
+    return Status::kNeedsData;
+  }
+  decoded_data_size_ = size;
+  decoded_data_complete_ = complete;
+
+  if (mode_ == Mode::kHeader) {
+    const Status status = DecodeHeader(complete);
+    if (mode_ == Mode::kHeader || status == Status::kError) {
+      return status;
+    }
+  }
+
+  switch (mode_) {
+    case Mode::kIncremental:
+      return DecodeIncrementally(complete);
+    case Mode::kWhole:
+      return complete ? DecodeWhole() : Status::kNeedsData;
+    case Mode::kSampled:
+      return complete ? DecodeSampled() : Status::kNeedsData;
+    case Mode::kHeader:
+      break;
+  }
+  return Status::kNeedsData;
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::DecodeHeader(
+    bool complete) {
+  if (!complete && (wait_for_complete_data_ ||
+                    decoded_data_size_ < SkCodec::MinBufferedBytesNeeded())) {
+    return Status::kNeedsData;
+  }
+
+  SkCodec::Result result = SkCodec::kSuccess;
+  auto codec = SkCodec::MakeFromStream(
+      std::make_unique<EncodedDataStream>(data_), &result);
+  if (!codec) {
+    if (result == SkCodec::kIncompleteInput && !complete) {
+      return Status::kNeedsData;
+    }
+    FML_LOG(ERROR) << "Could not create a codec for the image.";
+    return Fail();
+  }
+
+  if (!complete && !CanDecodeFromPartialData(codec->getEncodedFormat())) {
+    wait_for_complete_data_ = true;
+    return Status::kNeedsData;
+  }
+
+  origin_ = codec->getOrigin();
+  const bool swap_dimensions = SkPixmapPriv::ShouldSwapWidthHeight(origin_);
+  const SkISize codec_dimensions = codec->dimensions();
+
+  // The target dimensions apply to the oriented image, the codec decodes the
+  // image as encoded.
+  source_dimensions_ =
+      swap_dimensions
+          ? SkISize::Make(codec_dimensions.height(), codec_dimensions.width())
+          : codec_dimensions;
+  SkISize target_dimensions =
+      GetResizedDimensions(source_dimensions_, target_width_, target_height_);
+  if (target_dimensions.isEmpty()) {
+    FML_LOG(ERROR) << "Could not decode an image to empty dimensions.";
+    return Fail();
+  }
+  if (swap_dimensions) {
+    target_dimensions =
+        SkISize::Make(target_dimensions.height(), target_dimensions.width());
+  }
+
+  decode_info_ = codec->getInfo().makeColorType(kN32_SkColorType);
+  if (decode_info_.alphaType() == kUnpremul_SkAlphaType) {
+    decode_info_ = decode_info_.makeAlphaType(kPremul_SkAlphaType);
+  }
+  mode_ = Mode::kIncremental;
+
+  if (target_dimensions.width() < codec_dimensions.width() &&
+      target_dimensions.height() < codec_dimensions.height()) {
+    const float scale = std::max(
+        static_cast<float>(target_dimensions.width()) /
+            codec_dimensions.width(),
+        static_cast<float>(target_dimensions.height()) /
+            codec_dimensions.height());
+    const SkISize scaled_dimensions = codec->getScaledDimensions(scale);
+    if (scaled_dimensions != codec_dimensions) {
+      decode_info_ = decode_info_.makeDimensions(scaled_dimensions);
+    } else {
+      // The codec cannot scale while decoding, so sample instead. Every
+      // sampled dimension stays at least as large as the target.
+      sample_size_ =
+          std::min(codec_dimensions.width() / target_dimensions.width(),
+                   codec_dimensions.height() / target_dimensions.height());
+      if (sample_size_ > 1) {
+        mode_ = Mode::kSampled;
+      }
+    }
+  }
+
+  codec_ = std::move(codec);
+  return Status::kNeedsData;
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::DecodeIncrementally(
+    bool complete) {
+  if (bitmap_.isNull() && !AllocateBitmap(decode_info_)) {
+    return Fail();
+  }
+
+  if (!incremental_decode_started_) {
+    const SkCodec::Result result = codec_->startIncrementalDecode(
+        bitmap_.info(), bitmap_.getPixels(), bitmap_.rowBytes());
+    switch (result) {
+      case SkCodec::kSuccess:
+        incremental_decode_started_ = true;
+        break;
+      case SkCodec::kIncompleteInput:
+        if (!complete) {
+          return Status::kNeedsData;
+        }
+        FML_LOG(ERROR) << "The image data ended before its pixels.";
+        return Fail();
+      case SkCodec::kUnimplemented:
+        // The codec can only decode the image in one step (e.g. JPEG).
+        mode_ = Mode::kWhole;
+        return complete ? DecodeWhole() : Status::kNeedsData;
+      default:
+        FML_LOG(ERROR) << "Could not start decoding the image.";
+        return Fail();
+    }
+  }
+
+  int rows_decoded = 0;
+  const SkCodec::Result result = codec_->incrementalDecode(&rows_decoded);
+  switch (result) {
+    case SkCodec::kSuccess:
+      return Finish();
+    case SkCodec::kIncompleteInput:
+      if (complete) {
+        // The data is truncated. Keep whatever was decoded, like
+        // |SkImage::MakeFromEncoded| does.
+        return Finish();
+      }
+      if (!make_partial_images_ ||
+          rows_decoded - partial_image_rows_ <
+              std::max(1, bitmap_.height() / kMaxPartialImages)) {
+        return Status::kNeedsData;
+      }
+      partial_image_rows_ = rows_decoded;
+      // The codec keeps writing to the bitmap, so the image needs a copy.
+      image_ = MakeOrientedImage(bitmap_, origin_);
+      return image_ ? Status::kPartial : Status::kNeedsData;
+    case SkCodec::kErrorInInput:
+      return Finish();
+    default:
+      FML_LOG(ERROR) << "Could not decode the image.";
+      return Fail();
+  }
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::DecodeWhole() {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  if (bitmap_.isNull() && !AllocateBitmap(decode_info_)) {
+    return Fail();
+  }
+
+  const SkCodec::Result result = codec_->getPixels(
+      bitmap_.info(), bitmap_.getPixels(), bitmap_.rowBytes());
+  switch (result) {
+    case SkCodec::kSuccess:
+    case SkCodec::kIncompleteInput:
+    case SkCodec::kErrorInInput:
+      return Finish();
+    default:
+      FML_LOG(ERROR) << "Could not decode the image.";
+      return Fail();
+  }
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::DecodeSampled() {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  auto codec = SkAndroidCodec::MakeFromCodec(std::move(codec_));
+  if (!codec) {
+    FML_LOG(ERROR) << "Could not create a sampling codec for the image.";
+    return Fail();
+  }
+
+  const SkImageInfo info = decode_info_.makeDimensions(
+      codec->getSampledDimensions(sample_size_));
+  if (!AllocateBitmap(info)) {
+    return Fail();
+  }
+
+  SkAndroidCodec::AndroidOptions options;
+  options.fSampleSize = sample_size_;
+  const SkCodec::Result result = codec->getAndroidPixels(
+      bitmap_.info(), bitmap_.getPixels(), bitmap_.rowBytes(), &options);
+  switch (result) {
+    case SkCodec::kSuccess:
+    case SkCodec::kIncompleteInput:
+    case SkCodec::kErrorInInput:
+      return Finish();
+    default:
+      FML_LOG(ERROR) << "Could not decode the image with sampling.";
+      return Fail();
+  }
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::Finish() {
+  codec_.reset();
+  // Marking this as immutable makes the image share the pixels instead of
+  // copying them.
+  bitmap_.setImmutable();
+  image_ = MakeOrientedImage(bitmap_, origin_);
+  bitmap_.reset();
+  if (!image_) {
+    return Fail();
+  }
+  status_ = Status::kComplete;
+  return status_;
+}
+
+ProgressiveImageDecoder::Status ProgressiveImageDecoder::Fail() {
+  codec_.reset();
+  bitmap_.reset();
+  image_ = nullptr;
+  status_ = Status::kError;
+  return status_;
+}
+
+bool ProgressiveImageDecoder::AllocateBitmap(const SkImageInfo& info) {
+  if (!bitmap_.tryAllocPixels(info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << info.computeMinByteSize() << "B";
+    return false;
+  }
+  // Rows that have not been decoded yet show up in partial images.
+  bitmap_.eraseColor(SK_ColorTRANSPARENT);
+  return true;
+}
+
+}  // namespace flutter
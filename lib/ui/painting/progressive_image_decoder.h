@@ -0,0 +1,136 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PROGRESSIVE_IMAGE_DECODER_H_
+#define FLUTTER_LIB_UI_PAINTING_PROGRESSIVE_IMAGE_DECODER_H_
+
+#include <memory>
+#include <optional>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/codec/SkEncodedOrigin.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace flutter {
+
+// Decodes an image whose encoded bytes arrive in chunks, decoding as much of
+// the image as the bytes received so far allow.
+//
+// The image is decoded straight to the smallest size the codec can produce
+// that is still at least as large as the target size: JPEG and WebP decode
+// natively at a reduced scale and the other formats are sampled. Only the
+// final resize to the exact target dimensions is left to the caller.
+//
+// Formats that Skia can decode incrementally (PNG and GIF) are decoded as
+// scanlines arrive, unless they need to be sampled. The others are decoded
+// once all of the data has arrived. Partial images of what was decoded so far
+// are only made when asked for, since each one is a copy of the pixels.
+//
+// |AddData| and |SetComplete| may be called on any thread. All other methods
+// must be called on one thread at a time.
+class ProgressiveImageDecoder {
+ public:
+  enum class Status {
+    // Nothing more could be decoded from the data received so far.
+    kNeedsData,
+    // More of the image was decoded. |GetImage| returns a snapshot of it.
+    // Only returned when partial images were asked for.
+    kPartial,
+    // The image was decoded. |GetImage| returns it.
+    kComplete,
+    // The data is not a supported image.
+    kError,
+  };
+
+  // A partial image is made at most once every this fraction of the rows of
+  // the image, so that all of them together copy a few images' worth of
+  // pixels at most, however small the chunks of data are.
+  static constexpr int kMaxPartialImages = 8;
+
+  ProgressiveImageDecoder(std::optional<uint32_t> target_width,
+                          std::optional<uint32_t> target_height,
+                          bool make_partial_images = false);
+
+  ~ProgressiveImageDecoder();
+
+  void AddData(sk_sp<SkData> data);
+
+  // No more data will be added.
+  void SetComplete();
+
+  Status Decode();
+
+  // The image as of the last call to |Decode|, at the decode dimensions and
+  // respecting the image orientation. Rows that were not decoded yet are
+  // transparent. Null until |Decode| returns |kPartial| or |kComplete|.
+  sk_sp<SkImage> GetImage() const { return image_; }
+
+  // The oriented dimensions of the encoded image. Empty until the header of
+  // the image has been decoded.
+  SkISize GetSourceDimensions() const { return source_dimensions_; }
+
+ private:
+  class EncodedData;
+  class EncodedDataStream;
+
+  enum class Mode {
+    // Reading the header.
+    kHeader,
+    // Decoding scanlines as data arrives, at the native decode scale.
+    kIncremental,
+    // Decoding in one step at the native decode scale once all of the data
+    // has arrived.
+    kWhole,
+    // Decoding in one step with sampling once all of the data has arrived.
+    kSampled,
+  };
+
+  const std::optional<uint32_t> target_width_;
+  const std::optional<uint32_t> target_height_;
+  const bool make_partial_images_;
+  std::shared_ptr<EncodedData> data_;
+  Mode mode_ = Mode::kHeader;
+  Status status_ = Status::kNeedsData;
+  // The size of the data and whether it was complete as of the last decode.
+  size_t decoded_data_size_ = 0;
+  bool decoded_data_complete_ = false;
+  // Set for formats whose codecs copy the data they are created with, which
+  // must not be created before all of the data has arrived.
+  bool wait_for_complete_data_ = false;
+  std::unique_ptr<SkCodec> codec_;
+  SkEncodedOrigin origin_ = kDefault_SkEncodedOrigin;
+  SkISize source_dimensions_ = SkISize::MakeEmpty();
+  SkImageInfo decode_info_;
+  int sample_size_ = 1;
+  SkBitmap bitmap_;
+  bool incremental_decode_started_ = false;
+  // The rows that were decoded as of the last partial image.
+  int partial_image_rows_ = 0;
+  sk_sp<SkImage> image_;
+
+  Status DecodeHeader(bool complete);
+
+  Status DecodeIncrementally(bool complete);
+
+  Status DecodeWhole();
+
+  Status DecodeSampled();
+
+  Status Finish();
+
+  Status Fail();
+
+  bool AllocateBitmap(const SkImageInfo& info);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ProgressiveImageDecoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PROGRESSIVE_IMAGE_DECODER_H_
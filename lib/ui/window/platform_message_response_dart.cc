@@ -11,6 +11,7 @@
 #include "flutter/lib/ui/window/window.h"
 #include "third_party/tonic/dart_state.h"
 #include "third_party/tonic/logging/dart_invoke.h"
+#include "third_party/tonic/typed_data/dart_byte_data.h"
 
 namespace flutter {
 
@@ -19,28 +20,29 @@ namespace {
 // Avoid copying the contents of messages beyond a certain size.
 const int kMessageCopyThreshold = 1000;
 
-void MessageDataFinalizer(void* isolate_callback_data,
-                          Dart_WeakPersistentHandle handle,
-                          void* peer) {
-  std::vector<uint8_t>* data = reinterpret_cast<std::vector<uint8_t>*>(peer);
-  delete data;
-}
-
-Dart_Handle WrapByteData(std::vector<uint8_t> data) {
-  if (data.size() < kMessageCopyThreshold) {
-    return ToByteData(data);
-  } else {
-    std::vector<uint8_t>* heap_data = new std::vector<uint8_t>(std::move(data));
-    return Dart_NewExternalTypedDataWithFinalizer(
-        Dart_TypedData_kByteData, heap_data->data(), heap_data->size(),
-        heap_data, heap_data->size(), MessageDataFinalizer);
-  }
+void MappingFinalizer(void* isolate_callback_data,
+                      Dart_WeakPersistentHandle handle,
+                      void* peer) {
+  delete static_cast<fml::Mapping*>(peer);
 }
 
 Dart_Handle WrapByteData(std::unique_ptr<fml::Mapping> mapping) {
-  std::vector<uint8_t> data(mapping->GetSize());
-  memcpy(data.data(), mapping->GetMapping(), mapping->GetSize());
-  return WrapByteData(std::move(data));
+  const size_t size = mapping->GetSize();
+  // Dart has no notion of read-only typed data, so only mappings that may be
+  // written to are handed to Dart, which releases them when the ByteData is
+  // collected. Read-only ones, such as the file mappings of assets, would
+  // fault on the first write.
+  uint8_t* data = mapping->GetMutableMapping();
+  if (size < kMessageCopyThreshold || data == nullptr) {
+    return tonic::DartByteData::Create(mapping->GetMapping(), size);
+  }
+  Dart_Handle byte_data = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, data, size, mapping.get(), size,
+      MappingFinalizer);
+  if (!Dart_IsError(byte_data)) {
+    mapping.release();
+  }
+  return byte_data;
 }
 
 }  // anonymous namespace
@@ -6,6 +6,7 @@
 
 #include <sstream>
 
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/native_library.h"
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
@@ -30,12 +31,25 @@ const char* DartSnapshot::kIsolateInstructionsSymbol =
 
 static std::unique_ptr<const fml::Mapping> GetFileMapping(
     const std::string& path,
-    bool executable) {
-  if (executable) {
-    return fml::FileMapping::CreateReadExecute(path);
-  } else {
-    return fml::FileMapping::CreateReadOnly(path);
+    bool executable,
+    bool populate,
+    bool prefetch) {
+  using Hint = fml::FileMapping::Hint;
+  auto map = [&path, executable](std::initializer_list<Hint> hints)
+      -> std::unique_ptr<const fml::Mapping> {
+    if (executable) {
+      return fml::FileMapping::CreateReadExecute(path, hints);
+    } else {
+      return fml::FileMapping::CreateReadOnly(path, hints);
+    }
+  };
+  if (populate) {
+    return map({Hint::kPopulate, Hint::kHugePages});
+  }
+  if (prefetch) {
+    return map({Hint::kWillNeed, Hint::kHugePages});
   }
+  return map({});
 }
 
 // The first party embedders don't yet use the stable embedder API and depend on
@@ -54,7 +68,9 @@ static std::shared_ptr<const fml::Mapping> SearchMapping(
     const std::string& file_path,
     const std::vector<std::string>& native_library_path,
     const char* native_library_symbol_name,
-    bool is_executable) {
+    bool is_executable,
+    bool populate,
+    bool prefetch) {
   // Ask the embedder. There is no fallback as we expect the embedders (via
   // their embedding APIs) to just specify the mappings directly.
   if (embedder_mapping_callback) {
@@ -63,7 +79,8 @@ static std::shared_ptr<const fml::Mapping> SearchMapping(
 
   // Attempt to open file at path specified.
   if (file_path.size() > 0) {
-    if (auto file_mapping = GetFileMapping(file_path, is_executable)) {
+    if (auto file_mapping =
+            GetFileMapping(file_path, is_executable, populate, prefetch)) {
       return file_mapping;
     }
   }
@@ -103,7 +120,9 @@ static std::shared_ptr<const fml::Mapping> ResolveVMData(
       settings.vm_snapshot_data_path,     // file_path
       settings.application_library_path,  // native_library_path
       DartSnapshot::kVMDataSymbol,        // native_library_symbol_name
-      false                               // is_executable
+      false,                              // is_executable
+      settings.populate_snapshots,        // populate
+      settings.prefetch_snapshots         // prefetch
   );
 #endif  // DART_SNAPSHOT_STATIC_LINK
 }
@@ -118,7 +137,9 @@ static std::shared_ptr<const fml::Mapping> ResolveVMInstructions(
       settings.vm_snapshot_instr_path,      // file_path
       settings.application_library_path,    // native_library_path
       DartSnapshot::kVMInstructionsSymbol,  // native_library_symbol_name
-      true                                  // is_executable
+      true,                                 // is_executable
+      settings.populate_snapshots,          // populate
+      settings.prefetch_snapshots           // prefetch
   );
 #endif  // DART_SNAPSHOT_STATIC_LINK
 }
@@ -133,7 +154,9 @@ static std::shared_ptr<const fml::Mapping> ResolveIsolateData(
       settings.isolate_snapshot_data_path,  // file_path
       settings.application_library_path,    // native_library_path
       DartSnapshot::kIsolateDataSymbol,     // native_library_symbol_name
-      false                                 // is_executable
+      false,                                // is_executable
+      settings.populate_snapshots,          // populate
+      settings.prefetch_snapshots           // prefetch
   );
 #endif  // DART_SNAPSHOT_STATIC_LINK
 }
@@ -149,7 +172,9 @@ static std::shared_ptr<const fml::Mapping> ResolveIsolateInstructions(
       settings.isolate_snapshot_instr_path,      // file_path
       settings.application_library_path,         // native_library_path
       DartSnapshot::kIsolateInstructionsSymbol,  // native_library_symbol_name
-      true                                       // is_executable
+      true,                                      // is_executable
+      settings.populate_snapshots,               // populate
+      settings.prefetch_snapshots                // prefetch
   );
 #endif  // DART_SNAPSHOT_STATIC_LINK
 }
@@ -157,10 +182,11 @@ static std::shared_ptr<const fml::Mapping> ResolveIsolateInstructions(
 fml::RefPtr<DartSnapshot> DartSnapshot::VMSnapshotFromSettings(
     const Settings& settings) {
   TRACE_EVENT0("flutter", "DartSnapshot::VMSnapshotFromSettings");
-  auto snapshot =
-      fml::MakeRefCounted<DartSnapshot>(ResolveVMData(settings),         //
-                                        ResolveVMInstructions(settings)  //
-      );
+  auto data = ResolveVMData(settings);
+  auto instructions = ResolveVMInstructions(settings);
+  auto snapshot = fml::MakeRefCounted<DartSnapshot>(std::move(data),         //
+                                                    std::move(instructions)  //
+  );
   if (snapshot->IsValid()) {
     return snapshot;
   }
@@ -170,10 +196,11 @@ fml::RefPtr<DartSnapshot> DartSnapshot::VMSnapshotFromSettings(
 fml::RefPtr<DartSnapshot> DartSnapshot::IsolateSnapshotFromSettings(
     const Settings& settings) {
   TRACE_EVENT0("flutter", "DartSnapshot::IsolateSnapshotFromSettings");
-  auto snapshot =
-      fml::MakeRefCounted<DartSnapshot>(ResolveIsolateData(settings),         //
-                                        ResolveIsolateInstructions(settings)  //
-      );
+  auto data = ResolveIsolateData(settings);
+  auto instructions = ResolveIsolateInstructions(settings);
+  auto snapshot = fml::MakeRefCounted<DartSnapshot>(std::move(data),         //
+                                                    std::move(instructions)  //
+  );
   if (snapshot->IsValid()) {
     return snapshot;
   }
@@ -202,4 +229,9 @@ const uint8_t* DartSnapshot::GetInstructionsMapping() const {
   return instructions_ ? instructions_->GetMapping() : nullptr;
 }
 
+void DartSnapshot::PrefetchAsync(fml::ConcurrentTaskRunner& task_runner) const {
+  fml::PrefetchMappingAsync(data_, task_runner);
+  fml::PrefetchMappingAsync(instructions_, task_runner);
+}
+
 }  // namespace flutter
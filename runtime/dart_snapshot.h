@@ -9,6 +9,7 @@
 #include <string>
 
 #include "flutter/common/settings.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 
@@ -139,6 +140,16 @@ class DartSnapshot : public fml::RefCountedThreadSafe<DartSnapshot> {
   ///
   const uint8_t* GetInstructionsMapping() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Reads the pages of the heap and instructions snapshots ahead
+  ///             of their first use on the given workers. Snapshots resolved
+  ///             from symbols have no known size and are not read ahead.
+  ///
+  /// @param[in]  task_runner  The task runner of the workers to read the
+  ///                          pages on.
+  ///
+  void PrefetchAsync(fml::ConcurrentTaskRunner& task_runner) const;
+
  private:
   std::shared_ptr<const fml::Mapping> data_;
   std::shared_ptr<const fml::Mapping> instructions_;
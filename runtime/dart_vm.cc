@@ -282,6 +282,14 @@ DartVM::DartVM(std::shared_ptr<const DartVMData> vm_data,
   FML_DCHECK(isolate_name_server_);
   FML_DCHECK(service_protocol_);
 
+  if (settings_.prefetch_snapshots) {
+    // The workers are joined when the VM shuts down, so the snapshots are not
+    // read past the lifetime of the VM.
+    auto task_runner = concurrent_message_loop_->GetTaskRunner();
+    vm_data_->GetVMSnapshot().PrefetchAsync(*task_runner);
+    vm_data_->GetIsolateSnapshot()->PrefetchAsync(*task_runner);
+  }
+
   {
     TRACE_EVENT0("flutter", "dart::bin::BootstrapDartIo");
     dart::bin::BootstrapDartIo();
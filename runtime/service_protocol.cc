@@ -33,6 +33,12 @@ const std::string_view ServiceProtocol::kSetAssetBundlePathExtensionName =
     "_flutter.setAssetBundlePath";
 const std::string_view ServiceProtocol::kGetDisplayRefreshRateExtensionName =
     "_flutter.getDisplayRefreshRate";
+const std::string_view ServiceProtocol::kSetTraceRecorderEnabledExtensionName =
+    "_flutter.setTraceRecorderEnabled";
+const std::string_view ServiceProtocol::kGetRecordedTraceExtensionName =
+    "_flutter.getRecordedTrace";
+const std::string_view ServiceProtocol::kGetFrameStatisticsExtensionName =
+    "_flutter.getFrameStatistics";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -50,6 +56,9 @@ ServiceProtocol::ServiceProtocol()
           kFlushUIThreadTasksExtensionName,
           kSetAssetBundlePathExtensionName,
           kGetDisplayRefreshRateExtensionName,
+          kSetTraceRecorderEnabledExtensionName,
+          kGetRecordedTraceExtensionName,
+          kGetFrameStatisticsExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
 
@@ -27,6 +27,9 @@ class ServiceProtocol {
   static const std::string_view kFlushUIThreadTasksExtensionName;
   static const std::string_view kSetAssetBundlePathExtensionName;
   static const std::string_view kGetDisplayRefreshRateExtensionName;
+  static const std::string_view kSetTraceRecorderEnabledExtensionName;
+  static const std::string_view kGetRecordedTraceExtensionName;
+  static const std::string_view kGetFrameStatisticsExtensionName;
 
   class Handler {
    public:
@@ -17,28 +17,50 @@ namespace {
 constexpr fml::TimeDelta kNotifyIdleTaskWaitTime =
     fml::TimeDelta::FromMilliseconds(51);
 
+// The length of the idle periods given to the |IdleTaskQueue| while no frames
+// are being produced. This matches the deadline given to Dart in that case.
+constexpr fml::TimeDelta kLongIdlePeriodLength =
+    fml::TimeDelta::FromMilliseconds(100);
+
+fml::RefPtr<Pipeline<flutter::LayerTree>> CreateLayerTreePipeline(
+    const TaskRunners& task_runners,
+    bool adaptive_depth) {
+#if FLUTTER_SHELL_ENABLE_METAL
+  const uint32_t depth = 2;
+#else   // FLUTTER_SHELL_ENABLE_METAL
+  // TODO(dnfield): We should remove this logic and set the pipeline depth
+  // back to 2 in this case. See
+  // https://github.com/flutter/engine/pull/9132 for discussion.
+  const uint32_t depth = task_runners.GetPlatformTaskRunner() ==
+                                 task_runners.GetGPUTaskRunner()
+                             ? 1
+                             : 2;
+#endif  // FLUTTER_SHELL_ENABLE_METAL
+  // A pipeline that must stay at a depth of 1 does not adapt either.
+  if (!adaptive_depth || depth == 1) {
+    return fml::MakeRefCounted<Pipeline<flutter::LayerTree>>(depth);
+  }
+  return fml::MakeRefCounted<Pipeline<flutter::LayerTree>>(
+      depth, PipelineDepthController::kMaxDepth);
+}
+
 }  // namespace
 
 Animator::Animator(Delegate& delegate,
                    TaskRunners task_runners,
-                   std::unique_ptr<VsyncWaiter> waiter)
+                   std::unique_ptr<VsyncWaiter> waiter,
+                   std::shared_ptr<IdleTaskQueue> idle_task_queue,
+                   std::shared_ptr<FrameStatistics> frame_statistics,
+                   bool adaptive_pipeline_depth)
     : delegate_(delegate),
       task_runners_(std::move(task_runners)),
       waiter_(std::move(waiter)),
+      idle_task_queue_(std::move(idle_task_queue)),
+      frame_statistics_(std::move(frame_statistics)),
       last_begin_frame_time_(),
       dart_frame_deadline_(0),
-#if FLUTTER_SHELL_ENABLE_METAL
-      layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(2)),
-#else   // FLUTTER_SHELL_ENABLE_METAL
-      // TODO(dnfield): We should remove this logic and set the pipeline depth
-      // back to 2 in this case. See
-      // https://github.com/flutter/engine/pull/9132 for discussion.
-      layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(
-          task_runners.GetPlatformTaskRunner() ==
-                  task_runners.GetGPUTaskRunner()
-              ? 1
-              : 2)),
-#endif  // FLUTTER_SHELL_ENABLE_METAL
+      layer_tree_pipeline_(
+          CreateLayerTreePipeline(task_runners_, adaptive_pipeline_depth)),
       pending_frame_semaphore_(1),
       frame_number_(1),
       paused_(false),
@@ -57,6 +79,9 @@ float Animator::GetDisplayRefreshRate() const {
 
 void Animator::Stop() {
   paused_ = true;
+  if (idle_task_queue_) {
+    idle_task_queue_->EndIdlePeriod();
+  }
 }
 
 void Animator::Start() {
@@ -110,6 +135,9 @@ void Animator::BeginFrame(fml::TimePoint frame_start_time,
 
   frame_scheduled_ = false;
   notify_idle_task_id_++;
+  if (idle_task_queue_) {
+    idle_task_queue_->EndIdlePeriod();
+  }
   regenerate_layer_tree_ = false;
   pending_frame_semaphore_.Signal();
 
@@ -134,12 +162,28 @@ void Animator::BeginFrame(fml::TimePoint frame_start_time,
 
   last_begin_frame_time_ = frame_start_time;
   dart_frame_deadline_ = FxlToDartOrEarlier(frame_target_time);
+  const fml::TimePoint build_start = fml::TimePoint::Now();
   {
     TRACE_EVENT2("flutter", "Framework Workload", "mode", "basic", "frame",
                  FrameParity());
     delegate_.OnAnimatorBeginFrame(frame_target_time);
   }
 
+  // The continuation is only consumed if the framework rendered a frame.
+  if (producer_continuation_) {
+    delegate_.OnAnimatorFrameDropped();
+  } else if (frame_statistics_) {
+    frame_statistics_->RecordBuiltFrame(fml::TimePoint::Now() - build_start,
+                                        frame_target_time - frame_start_time);
+  }
+
+  // Whatever is left of the frame interval can be used by idle tasks. Any
+  // frame requested by the framework has already been requested, so this
+  // only ends early if a frame is requested during the idle period.
+  if (idle_task_queue_) {
+    idle_task_queue_->BeginIdlePeriod(frame_target_time);
+  }
+
   if (!frame_scheduled_) {
     // Under certain workloads (such as our parent view resizing us, which is
     // communicated to us by repeat viewport metrics events), we won't
@@ -161,8 +205,13 @@ void Animator::BeginFrame(fml::TimePoint frame_start_time,
           if (notify_idle_task_id == self->notify_idle_task_id_ &&
               !self->frame_scheduled_) {
             TRACE_EVENT0("flutter", "BeginFrame idle callback");
-            self->delegate_.OnAnimatorNotifyIdle(Dart_TimelineGetMicros() +
-                                                 100000);
+            self->delegate_.OnAnimatorNotifyIdle(
+                Dart_TimelineGetMicros() +
+                kLongIdlePeriodLength.ToMicroseconds());
+            if (self->idle_task_queue_ && !self->paused_) {
+              self->idle_task_queue_->BeginLongIdlePeriod(
+                  kLongIdlePeriodLength);
+            }
           }
         },
         kNotifyIdleTaskWaitTime);
@@ -210,6 +259,12 @@ void Animator::RequestFrame(bool regenerate_layer_tree) {
     return;
   }
 
+  // A frame will begin at the next vsync, which may be before the end of the
+  // current idle period.
+  if (idle_task_queue_) {
+    idle_task_queue_->EndIdlePeriod();
+  }
+
   // The AwaitVSync is going to call us back at the next VSync. However, we want
   // to be reasonably certain that the UI thread is not in the middle of a
   // particularly expensive callout. We post the AwaitVSync to run right after
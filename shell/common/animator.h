@@ -8,10 +8,12 @@
 #include <deque>
 
 #include "flutter/common/task_runners.h"
+#include "flutter/flow/frame_statistics.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/synchronization/semaphore.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/shell/common/idle_task_queue.h"
 #include "flutter/shell/common/pipeline.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/vsync_waiter.h"
@@ -38,11 +40,20 @@ class Animator final {
         fml::RefPtr<Pipeline<flutter::LayerTree>> pipeline) = 0;
 
     virtual void OnAnimatorDrawLastLayerTree() = 0;
+
+    // A frame began but no scene was rendered for it.
+    virtual void OnAnimatorFrameDropped() = 0;
   };
 
+  // With |adaptive_pipeline_depth|, the layer tree pipeline may get as deep
+  // as |PipelineDepthController::kMaxDepth|. Its depth is then set by the
+  // rasterizer that draws it.
   Animator(Delegate& delegate,
            TaskRunners task_runners,
-           std::unique_ptr<VsyncWaiter> waiter);
+           std::unique_ptr<VsyncWaiter> waiter,
+           std::shared_ptr<IdleTaskQueue> idle_task_queue = nullptr,
+           std::shared_ptr<FrameStatistics> frame_statistics = nullptr,
+           bool adaptive_pipeline_depth = false);
 
   ~Animator();
 
@@ -95,6 +106,10 @@ class Animator final {
   Delegate& delegate_;
   TaskRunners task_runners_;
   std::shared_ptr<VsyncWaiter> waiter_;
+  // Given the slack between frames, if any.
+  std::shared_ptr<IdleTaskQueue> idle_task_queue_;
+  // Records how long each frame took to build, if any.
+  std::shared_ptr<FrameStatistics> frame_statistics_;
 
   fml::TimePoint last_begin_frame_time_;
   int64_t dart_frame_deadline_;
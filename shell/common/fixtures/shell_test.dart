@@ -138,3 +138,24 @@ void canDecompressImageFromAsset() {
 }
 
 List<int> getFixtureImage() native 'GetFixtureImage';
+
+String getLargeAssetName() native 'GetLargeAssetName';
+void notifyAssetLoaded(int length, int firstByte, int writtenByte) native 'NotifyAssetLoaded';
+
+@pragma('vm:entry-point')
+void canLoadAssetThroughPlatformMessage() {
+  window.sendPlatformMessage(
+    'flutter/assets',
+    Uint8List.fromList(utf8.encode(getLargeAssetName())).buffer.asByteData(),
+    (ByteData data) {
+      if (data == null) {
+        notifyAssetLoaded(-1, -1, -1);
+        return;
+      }
+      // Responses are ordinary ByteData, which the framework may write to.
+      final int firstByte = data.getUint8(0);
+      data.setUint8(0, firstByte ^ 0xff);
+      notifyAssetLoaded(data.lengthInBytes, firstByte, data.getUint8(0));
+    },
+  );
+}
@@ -0,0 +1,109 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/idle_task_queue.h"
+
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+IdleTaskQueue::IdleTaskQueue(fml::RefPtr<fml::TaskRunner> task_runner)
+    : task_runner_(std::move(task_runner)) {}
+
+IdleTaskQueue::~IdleTaskQueue() = default;
+
+void IdleTaskQueue::PostIdleTask(IdleTask task) {
+  if (!task) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  tasks_.push_back(std::move(task));
+  if (in_idle_period_) {
+    ScheduleRunLocked();
+  }
+}
+
+void IdleTaskQueue::BeginIdlePeriod(fml::TimePoint deadline) {
+  FML_DCHECK(task_runner_->RunsTasksOnCurrentThread());
+  std::scoped_lock lock(mutex_);
+  in_idle_period_ = true;
+  deadline_ = deadline;
+  long_period_length_ = fml::TimeDelta::Zero();
+  ScheduleRunLocked();
+}
+
+void IdleTaskQueue::BeginLongIdlePeriod(fml::TimeDelta length) {
+  FML_DCHECK(task_runner_->RunsTasksOnCurrentThread());
+  FML_DCHECK(length > fml::TimeDelta::Zero());
+  std::scoped_lock lock(mutex_);
+  in_idle_period_ = true;
+  deadline_ = fml::TimePoint::Now() + length;
+  long_period_length_ = length;
+  ScheduleRunLocked();
+}
+
+void IdleTaskQueue::EndIdlePeriod() {
+  FML_DCHECK(task_runner_->RunsTasksOnCurrentThread());
+  std::scoped_lock lock(mutex_);
+  in_idle_period_ = false;
+}
+
+bool IdleTaskQueue::IsInIdlePeriod() const {
+  std::scoped_lock lock(mutex_);
+  return in_idle_period_;
+}
+
+size_t IdleTaskQueue::GetPendingTaskCount() const {
+  std::scoped_lock lock(mutex_);
+  return tasks_.size();
+}
+
+void IdleTaskQueue::ScheduleRunLocked() {
+  if (run_scheduled_ || tasks_.empty()) {
+    return;
+  }
+  run_scheduled_ = true;
+  task_runner_->PostTaskWithPriority(
+      [weak = weak_from_this()]() {
+        if (auto queue = weak.lock()) {
+          queue->RunNextTask();
+        }
+      },
+      fml::TaskPriority::kIdle);
+}
+
+void IdleTaskQueue::RunNextTask() {
+  IdleTask task;
+  fml::TimePoint deadline;
+  {
+    std::scoped_lock lock(mutex_);
+    run_scheduled_ = false;
+    if (!in_idle_period_ || tasks_.empty()) {
+      return;
+    }
+    const auto now = fml::TimePoint::Now();
+    if (now + kMinimumIdleTime >= deadline_) {
+      if (long_period_length_ == fml::TimeDelta::Zero()) {
+        in_idle_period_ = false;
+        return;
+      }
+      deadline_ = now + long_period_length_;
+    }
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+    deadline = deadline_;
+  }
+
+  {
+    TRACE_EVENT0("flutter", "IdleTaskQueue::RunNextTask");
+    task(deadline);
+  }
+
+  std::scoped_lock lock(mutex_);
+  if (in_idle_period_) {
+    ScheduleRunLocked();
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,113 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_IDLE_TASK_QUEUE_H_
+#define FLUTTER_SHELL_COMMON_IDLE_TASK_QUEUE_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      A queue of low priority work that runs on the UI task runner
+///             only while the `Animator` has slack before the next frame is
+///             due. This is meant for speculative work such as warming caches
+///             or prefetching resources, which should never delay a frame.
+///
+///             Idle periods are begun and ended by the `Animator`:
+///
+///             * After a frame has been produced, the time left until the
+///               frame deadline is an idle period.
+///             * When no frames are being produced, the `Animator` begins a
+///               long idle period, which is renewed until a frame is
+///               requested.
+///
+///             Tasks run one at a time, each in a separate task on the UI task
+///             runner with the `fml::TaskPriority::kIdle` priority, so that
+///             vsync, input and other tasks are never held up behind more than
+///             one idle task. A task is only started if at least
+///             `kMinimumIdleTime` is left before the deadline, which is passed
+///             to the task so that it can split up its work to fit.
+///
+///             Tasks may be posted from any thread. The idle periods must be
+///             managed on the UI task runner.
+///
+class IdleTaskQueue : public std::enable_shared_from_this<IdleTaskQueue> {
+ public:
+  using IdleTask = std::function<void(fml::TimePoint deadline)>;
+
+  static constexpr fml::TimeDelta kMinimumIdleTime =
+      fml::TimeDelta::FromMilliseconds(1);
+
+  explicit IdleTaskQueue(fml::RefPtr<fml::TaskRunner> task_runner);
+
+  ~IdleTaskQueue();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Posts a task to run during an idle period. Tasks run in the
+  ///             order they were posted.
+  ///
+  /// @param[in]  task  The task, which is given the deadline of the idle
+  ///                   period it runs in.
+  ///
+  void PostIdleTask(IdleTask task);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Begins an idle period that ends at the given deadline,
+  ///             replacing any current idle period.
+  ///
+  /// @param[in]  deadline  The time at which the next frame is due.
+  ///
+  void BeginIdlePeriod(fml::TimePoint deadline);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Begins an idle period that is renewed with the given length
+  ///             every time it ends, until `EndIdlePeriod` is called. Used
+  ///             while no frames are being produced.
+  ///
+  /// @param[in]  length  The length of each idle period.
+  ///
+  void BeginLongIdlePeriod(fml::TimeDelta length);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Ends the current idle period, if any. Pending tasks stay
+  ///             queued until the next idle period. A task that is already
+  ///             running is not interrupted.
+  ///
+  void EndIdlePeriod();
+
+  bool IsInIdlePeriod() const;
+
+  size_t GetPendingTaskCount() const;
+
+ private:
+  const fml::RefPtr<fml::TaskRunner> task_runner_;
+  mutable std::mutex mutex_;
+  std::deque<IdleTask> tasks_;
+  bool in_idle_period_ = false;
+  fml::TimePoint deadline_;
+  // The length of the current idle period if it is a long one, or zero.
+  fml::TimeDelta long_period_length_;
+  bool run_scheduled_ = false;
+
+  // Posts a task that runs the next idle task, if there is not one already.
+  // Must be called with |mutex_| held.
+  void ScheduleRunLocked();
+
+  void RunNextTask();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(IdleTaskQueue);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_IDLE_TASK_QUEUE_H_
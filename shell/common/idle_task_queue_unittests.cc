@@ -0,0 +1,120 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/message_loop.h"
+#include "flutter/shell/common/idle_task_queue.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static std::shared_ptr<IdleTaskQueue> CreateQueueForCurrentThread() {
+  fml::MessageLoop::EnsureInitializedForCurrentThread();
+  return std::make_shared<IdleTaskQueue>(
+      fml::MessageLoop::GetCurrent().GetTaskRunner());
+}
+
+// Each idle task is run by a separate task, so flush a few times.
+static void RunExpiredTasks() {
+  for (int i = 0; i < 8; i++) {
+    fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
+  }
+}
+
+TEST(IdleTaskQueueTest, TasksDoNotRunOutsideIdlePeriods) {
+  auto queue = CreateQueueForCurrentThread();
+  bool ran = false;
+  queue->PostIdleTask([&ran](fml::TimePoint) { ran = true; });
+  RunExpiredTasks();
+  ASSERT_FALSE(ran);
+  ASSERT_EQ(queue->GetPendingTaskCount(), 1u);
+}
+
+TEST(IdleTaskQueueTest, TasksRunInOrderWithTheDeadline) {
+  auto queue = CreateQueueForCurrentThread();
+  const auto deadline =
+      fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(10);
+  std::vector<int> order;
+  queue->PostIdleTask([&](fml::TimePoint task_deadline) {
+    ASSERT_EQ(task_deadline, deadline);
+    order.push_back(1);
+  });
+  queue->BeginIdlePeriod(deadline);
+  queue->PostIdleTask([&](fml::TimePoint) { order.push_back(2); });
+  RunExpiredTasks();
+  ASSERT_EQ(order, std::vector<int>({1, 2}));
+  ASSERT_TRUE(queue->IsInIdlePeriod());
+}
+
+TEST(IdleTaskQueueTest, TasksDoNotRunPastTheDeadline) {
+  auto queue = CreateQueueForCurrentThread();
+  bool ran = false;
+  queue->PostIdleTask([&ran](fml::TimePoint) { ran = true; });
+  queue->BeginIdlePeriod(fml::TimePoint::Now() +
+                         IdleTaskQueue::kMinimumIdleTime / 2);
+  RunExpiredTasks();
+  ASSERT_FALSE(ran);
+  ASSERT_FALSE(queue->IsInIdlePeriod());
+}
+
+TEST(IdleTaskQueueTest, EndingTheIdlePeriodDefersRemainingTasks) {
+  auto queue = CreateQueueForCurrentThread();
+  int count = 0;
+  // Like a frame being requested while the first task runs.
+  queue->PostIdleTask([&](fml::TimePoint) {
+    count++;
+    queue->EndIdlePeriod();
+  });
+  queue->PostIdleTask([&](fml::TimePoint) { count++; });
+  queue->BeginIdlePeriod(fml::TimePoint::Now() +
+                         fml::TimeDelta::FromSeconds(10));
+  RunExpiredTasks();
+  ASSERT_EQ(count, 1);
+  ASSERT_EQ(queue->GetPendingTaskCount(), 1u);
+
+  queue->BeginIdlePeriod(fml::TimePoint::Now() +
+                         fml::TimeDelta::FromSeconds(10));
+  RunExpiredTasks();
+  ASSERT_EQ(count, 2);
+}
+
+TEST(IdleTaskQueueTest, LongIdlePeriodsAreRenewed) {
+  auto queue = CreateQueueForCurrentThread();
+  const auto length = IdleTaskQueue::kMinimumIdleTime * 2;
+  std::vector<fml::TimePoint> deadlines;
+  for (int i = 0; i < 2; i++) {
+    queue->PostIdleTask([&](fml::TimePoint deadline) {
+      deadlines.push_back(deadline);
+      // Use up the rest of the idle period.
+      while (fml::TimePoint::Now() < deadline) {
+      }
+    });
+  }
+  queue->BeginLongIdlePeriod(length);
+  RunExpiredTasks();
+  ASSERT_EQ(deadlines.size(), 2u);
+  ASSERT_LT(deadlines[0], deadlines[1]);
+  ASSERT_TRUE(queue->IsInIdlePeriod());
+}
+
+TEST(IdleTaskQueueTest, TasksCanBePostedFromOtherThreads) {
+  auto queue = CreateQueueForCurrentThread();
+  bool ran = false;
+  queue->BeginIdlePeriod(fml::TimePoint::Now() +
+                         fml::TimeDelta::FromSeconds(10));
+  std::thread thread(
+      [&]() { queue->PostIdleTask([&ran](fml::TimePoint) { ran = true; }); });
+  thread.join();
+  RunExpiredTasks();
+  ASSERT_TRUE(ran);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -4,16 +4,16 @@
 
 #include "flutter/shell/common/persistent_cache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
-#include <string_view>
 
-#include "flutter/fml/base32.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/logging.h"
-#include "flutter/fml/make_copyable.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/shell/version/version.h"
 
@@ -24,25 +24,14 @@ std::string PersistentCache::cache_base_path_;
 std::mutex PersistentCache::instance_mutex_;
 std::unique_ptr<PersistentCache> PersistentCache::gPersistentCache;
 
-static std::string SkKeyToFilePath(const SkData& data) {
-  if (data.data() == nullptr || data.size() == 0) {
-    return "";
-  }
-
-  std::string_view view(reinterpret_cast<const char*>(data.data()),
-                        data.size());
-
-  auto encode_result = fml::Base32Encode(view);
-
-  if (!encode_result.first) {
-    return "";
-  }
-
-  return encode_result.second;
+static std::string SkKeyToString(const SkData& data) {
+  return std::string(reinterpret_cast<const char*>(data.data()), data.size());
 }
 
 bool PersistentCache::gIsReadOnly = false;
 
+size_t PersistentCache::gMaxSize = 16 * 1024 * 1024;
+
 std::atomic<bool> PersistentCache::cache_sksl_ = false;
 std::atomic<bool> PersistentCache::strategy_set_ = false;
 
@@ -100,41 +89,105 @@ static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     return std::make_shared<fml::UniqueFD>();
   }
 }
+
+static std::shared_ptr<ShaderCacheStore> MakeCacheStore(
+    const std::string& global_cache_base_path,
+    bool read_only,
+    bool cache_sksl) {
+  auto directory =
+      MakeCacheDirectory(global_cache_base_path, read_only, cache_sksl);
+  return std::make_shared<ShaderCacheStore>(std::move(*directory),
+                                            PersistentCache::gMaxSize,
+                                            read_only);
+}
 }  // namespace
 
+// The SkSL shaders being loaded by the concurrent workers. Each shader is
+// claimed by whichever of the workers or the caller of |LoadSkSLs| gets to it
+// first, so that nobody waits on shaders no worker has started loading.
+struct PersistentCache::SkSLPrefetch {
+  SkSLPrefetch(std::shared_ptr<ShaderCacheStore> p_store,
+               std::vector<std::string> p_keys)
+      : store(std::move(p_store)),
+        keys(std::move(p_keys)),
+        values(keys.size()),
+        latch(keys.size()) {}
+
+  const std::shared_ptr<ShaderCacheStore> store;
+  const std::vector<std::string> keys;
+  std::vector<sk_sp<SkData>> values;
+  std::atomic_size_t next_key = 0;
+  fml::CountDownLatch latch;
+
+  void Run() {
+    for (size_t i = next_key++; i < keys.size(); i = next_key++) {
+      if (auto mapping = store->Load(keys[i])) {
+        values[i] =
+            SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
+      }
+      latch.CountDown();
+    }
+  }
+};
+
 std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
   std::vector<PersistentCache::SkSLCache> result;
   if (!IsValid()) {
     return result;
   }
-  fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
-                                       const std::string& filename) {
-    std::pair<bool, std::string> decode_result = fml::Base32Decode(filename);
-    if (!decode_result.first) {
-      FML_LOG(ERROR) << "Base32 can't decode: " << filename;
-      return true;  // continue to visit other files
-    }
-    const std::string& data_string = decode_result.second;
-    sk_sp<SkData> key =
-        SkData::MakeWithCopy(data_string.data(), data_string.length());
-    sk_sp<SkData> data = LoadFile(directory, filename);
-    if (data != nullptr) {
-      result.push_back({key, data});
-    } else {
-      FML_LOG(ERROR) << "Failed to load: " << filename;
+  std::shared_ptr<SkSLPrefetch> prefetch;
+  {
+    std::scoped_lock lock(sksl_prefetch_mutex_);
+    prefetch = std::move(sksl_prefetch_);
+  }
+  if (!prefetch) {
+    prefetch = std::make_shared<SkSLPrefetch>(sksl_cache_store_,
+                                              sksl_cache_store_->GetKeys());
+  }
+  prefetch->Run();
+  prefetch->latch.Wait();
+  for (size_t i = 0; i < prefetch->keys.size(); i++) {
+    const auto& key = prefetch->keys[i];
+    if (prefetch->values[i] == nullptr) {
+      FML_LOG(ERROR) << "Failed to load an SkSL shader.";
+      continue;
     }
-    return true;
-  };
-  fml::VisitFiles(*sksl_cache_directory_, visitor);
+    result.push_back({SkData::MakeWithCopy(key.data(), key.size()),
+                      std::move(prefetch->values[i])});
+  }
   return result;
 }
 
+void PersistentCache::PrefetchSkSLs(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t task_count) {
+  if (!IsValid() || !task_runner) {
+    return;
+  }
+  std::scoped_lock lock(sksl_prefetch_mutex_);
+  if (sksl_prefetch_) {
+    return;
+  }
+  auto keys = sksl_cache_store_->GetKeys();
+  if (keys.empty()) {
+    return;
+  }
+  TRACE_EVENT1("flutter", "PersistentCache::PrefetchSkSLs", "count",
+               std::to_string(keys.size()).c_str());
+  task_count = std::clamp<size_t>(task_count, 1, keys.size());
+  sksl_prefetch_ =
+      std::make_shared<SkSLPrefetch>(sksl_cache_store_, std::move(keys));
+  for (size_t i = 0; i < task_count; i++) {
+    task_runner->PostTask([prefetch = sksl_prefetch_]() { prefetch->Run(); });
+  }
+}
+
 PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
       cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
-      sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+      cache_store_(MakeCacheStore(cache_base_path_, read_only, false)),
+      sksl_cache_store_(MakeCacheStore(cache_base_path_, read_only, true)) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
@@ -147,57 +200,23 @@ bool PersistentCache::IsValid() const {
   return cache_directory_ && cache_directory_->is_valid();
 }
 
-sk_sp<SkData> PersistentCache::LoadFile(const fml::UniqueFD& dir,
-                                        const std::string& file_name) {
-  auto file = fml::OpenFileReadOnly(dir, file_name.c_str());
-  if (!file.is_valid()) {
-    return nullptr;
-  }
-  auto mapping = std::make_unique<fml::FileMapping>(file);
-  if (mapping->GetSize() == 0) {
-    return nullptr;
-  }
-  return SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
-}
-
 // |GrContextOptions::PersistentCache|
 sk_sp<SkData> PersistentCache::load(const SkData& key) {
   TRACE_EVENT0("flutter", "PersistentCacheLoad");
-  if (!IsValid()) {
+  if (!IsValid() || key.size() == 0) {
     return nullptr;
   }
-  auto file_name = SkKeyToFilePath(key);
-  if (file_name.size() == 0) {
+  auto mapping = cache_store_->Load(SkKeyToString(key));
+  if (mapping == nullptr) {
+    FML_LOG(INFO) << "PersistentCache::load failed.";
     return nullptr;
   }
-  auto result = PersistentCache::LoadFile(*cache_directory_, file_name);
-  if (result != nullptr) {
-    TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
-  } else {
-    FML_LOG(INFO) << "PersistentCache::load failed: " << file_name;
-  }
-  return result;
+  TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
+  return SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
 }
 
 static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
-                                 std::shared_ptr<fml::UniqueFD> cache_directory,
-                                 std::string key,
-                                 std::unique_ptr<fml::Mapping> value) {
-  auto task =
-      fml::MakeCopyable([cache_directory,             //
-                         file_name = std::move(key),  //
-                         mapping = std::move(value)   //
-  ]() mutable {
-        TRACE_EVENT0("flutter", "PersistentCacheStore");
-        if (!fml::WriteAtomically(*cache_directory,   //
-                                  file_name.c_str(),  //
-                                  *mapping)           //
-        ) {
-          FML_DLOG(WARNING)
-              << "Could not write cache contents to persistent store.";
-        }
-      });
-
+                                 fml::UniqueClosure task) {
   if (!worker) {
     FML_LOG(WARNING)
         << "The persistent cache has no available workers. Performing the task "
@@ -221,22 +240,30 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
-  auto file_name = SkKeyToFilePath(key);
-
-  if (file_name.size() == 0) {
+  if (key.size() == 0 || data.size() == 0) {
     return;
   }
 
+  if (cache_sksl_) {
+    // The shaders being prefetched no longer include every shader, so let the
+    // next shell start over instead of loading a stale set of them.
+    std::scoped_lock lock(sksl_prefetch_mutex_);
+    sksl_prefetch_ = nullptr;
+  }
+
   auto mapping = std::make_unique<fml::DataMapping>(
       std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
 
-  if (mapping == nullptr || mapping->GetSize() == 0) {
-    return;
-  }
-
-  PersistentCacheStore(GetWorkerTaskRunner(),
-                       cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
-                       std::move(file_name), std::move(mapping));
+  PersistentCacheStore(
+      GetWorkerTaskRunner(),
+      [store = cache_sksl_ ? sksl_cache_store_ : cache_store_,
+       key = SkKeyToString(key), mapping = std::move(mapping)]() {
+        TRACE_EVENT0("flutter", "PersistentCacheStore");
+        if (!store->Store(key, *mapping)) {
+          FML_DLOG(WARNING)
+              << "Could not write cache contents to persistent store.";
+        }
+      });
 }
 
 void PersistentCache::DumpSkp(const SkData& data) {
@@ -253,8 +280,17 @@ void PersistentCache::DumpSkp(const SkData& data) {
   FML_LOG(INFO) << "Dumping " << file_name;
   auto mapping = std::make_unique<fml::DataMapping>(
       std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
-  PersistentCacheStore(GetWorkerTaskRunner(), cache_directory_,
-                       std::move(file_name), std::move(mapping));
+  PersistentCacheStore(
+      GetWorkerTaskRunner(),
+      [cache_directory = cache_directory_, file_name = std::move(file_name),
+       mapping = std::move(mapping)]() {
+        TRACE_EVENT0("flutter", "PersistentCacheStore");
+        if (!fml::WriteAtomically(*cache_directory, file_name.c_str(),
+                                  *mapping)) {
+          FML_DLOG(WARNING)
+              << "Could not write cache contents to persistent store.";
+        }
+      });
 }
 
 void PersistentCache::AddWorkerTaskRunner(
@@ -8,10 +8,13 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/shell/common/shader_cache_store.h"
 #include "third_party/skia/include/gpu/GrContextOptions.h"
 
 namespace flutter {
@@ -19,7 +22,9 @@ namespace flutter {
 /// A cache of SkData that gets stored to disk.
 ///
 /// This is mainly used for Shaders but is also written to by Dart.  It is
-/// thread-safe for reading and writing from multiple threads.
+/// thread-safe for reading and writing from multiple threads. Program binaries
+/// and SkSL shaders are each kept in a |ShaderCacheStore|, whose size on disk
+/// is capped by |gMaxSize|.
 class PersistentCache : public GrContextOptions::PersistentCache {
  public:
   // Mutable static switch that can be set before GetCacheForProcess. If true,
@@ -29,6 +34,11 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // packages.
   static bool gIsReadOnly;
 
+  // Mutable static switch that can be set before GetCacheForProcess. The
+  // number of bytes that the program binaries and the SkSL shaders may each
+  // take on disk before the least recently used ones are evicted.
+  static size_t gMaxSize;
+
   static PersistentCache* GetCacheForProcess();
   static void ResetCacheForProcess();
 
@@ -57,6 +67,14 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   /// Load all the SkSL shader caches in the right directory.
   std::vector<SkSLCache> LoadSkSLs();
 
+  /// Start loading the SkSL shader caches on `task_runner`, split across at
+  /// most `task_count` tasks, so that the next call to |LoadSkSLs| only has to
+  /// wait for what is left. Does nothing if the shaders are already being
+  /// loaded. The shaders being loaded are dropped if a new SkSL shader is
+  /// stored before they are claimed.
+  void PrefetchSkSLs(std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+                     size_t task_count);
+
   static bool cache_sksl() { return cache_sksl_; }
   static void SetCacheSkSL(bool value);
   static void MarkStrategySet() { strategy_set_ = true; }
@@ -77,18 +95,20 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // strategy_set_ becomes true.
   static std::atomic<bool> strategy_set_;
 
+  struct SkSLPrefetch;
+
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
-  const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  const std::shared_ptr<ShaderCacheStore> cache_store_;
+  const std::shared_ptr<ShaderCacheStore> sksl_cache_store_;
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
+  std::mutex sksl_prefetch_mutex_;
+  std::shared_ptr<SkSLPrefetch> sksl_prefetch_;
 
   bool stored_new_shaders_ = false;
   bool is_dumping_skp_ = false;
 
-  static sk_sp<SkData> LoadFile(const fml::UniqueFD& dir,
-                                const std::string& filen_ame);
-
   bool IsValid() const;
 
   PersistentCache(bool read_only = false);
@@ -11,4 +11,81 @@ size_t GetNextPipelineTraceID() {
   return ++PipelineLastTraceID;
 }
 
+PipelineDepthController::PipelineDepthController() = default;
+
+PipelineDepthController::~PipelineDepthController() = default;
+
+// The smallest depth at which frames like this one are produced as often as
+// the frame budget allows, with some headroom for the frames that take longer.
+static uint32_t GetNeededDepth(fml::TimeDelta build_time,
+                               fml::TimeDelta raster_time,
+                               fml::TimeDelta frame_budget) {
+  const fml::TimeDelta usable_budget =
+      frame_budget * PipelineDepthController::kUsableBudgetPercent / 100;
+  if (build_time + raster_time <= usable_budget) {
+    return 1;
+  }
+  if (std::max(build_time, raster_time) <= usable_budget) {
+    return 2;
+  }
+  return PipelineDepthController::kMaxDepth;
+}
+
+uint32_t PipelineDepthController::RecordFrame(fml::TimeDelta build_time,
+                                              fml::TimeDelta raster_time,
+                                              fml::TimeDelta frame_budget) {
+  if (input_pending_.exchange(false)) {
+    input_frames_left_ = kInputFrames;
+  } else if (input_frames_left_ > 0) {
+    input_frames_left_--;
+  }
+  const uint32_t max_depth = input_frames_left_ > 0 ? 2 : kMaxDepth;
+
+  const uint32_t needed_depth = std::min(
+      GetNeededDepth(build_time, raster_time, frame_budget), max_depth);
+  if (needed_depth >= depth_ || depth_ > max_depth) {
+    depth_ = needed_depth;
+    shrink_frames_ = 0;
+    shrink_depth_ = 1;
+  } else {
+    shrink_depth_ = std::max(shrink_depth_, needed_depth);
+    if (++shrink_frames_ >= kShrinkFrames) {
+      depth_ = shrink_depth_;
+      shrink_frames_ = 0;
+      shrink_depth_ = 1;
+    }
+  }
+
+  TraceDepthToTimeline(build_time, raster_time, frame_budget);
+  return depth_;
+}
+
+void PipelineDepthController::NotifyLatencySensitiveInput() {
+  input_pending_ = true;
+}
+
+void PipelineDepthController::TraceDepthToTimeline(
+    fml::TimeDelta build_time,
+    fml::TimeDelta raster_time,
+    fml::TimeDelta frame_budget) const {
+#if !FLUTTER_RELEASE
+  // The interval between frames the threads can sustain at the current depth,
+  // and the time from the start of the build of a frame to the end of its
+  // rasterization once the pipeline is full. The latter grows by an interval
+  // with every frame of depth.
+  const fml::TimeDelta interval =
+      std::max(depth_ == 1 ? build_time + raster_time
+                           : std::max(build_time, raster_time),
+               frame_budget);
+  const fml::TimeDelta latency =
+      build_time + raster_time + interval * (depth_ - 1);
+  FML_TRACE_COUNTER("flutter", "PipelineDepthController",
+                    reinterpret_cast<int64_t>(this),                //
+                    "Depth", depth_,                                //
+                    "FrameIntervalMs", interval.ToMillisecondsF(),  //
+                    "MaxLatencyMs", latency.ToMillisecondsF()       //
+  );
+#endif  // !FLUTTER_RELEASE
+}
+
 }  // namespace flutter
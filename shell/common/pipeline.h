@@ -8,8 +8,11 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/synchronization/semaphore.h"
+#include "flutter/fml/time/time_delta.h"
 #include "flutter/fml/trace_event.h"
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -88,14 +91,28 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
     FML_DISALLOW_COPY_AND_ASSIGN(ProducerContinuation);
   };
 
-  explicit Pipeline(uint32_t depth)
-      : depth_(depth), empty_(depth), available_(0), inflight_(0) {}
+  explicit Pipeline(uint32_t depth) : Pipeline(depth, depth) {}
+
+  /// A pipeline whose depth can be changed with |SetDepth|, up to
+  /// |max_depth|.
+  Pipeline(uint32_t depth, uint32_t max_depth)
+      : depth_(depth),
+        max_depth_(max_depth),
+        empty_(max_depth),
+        available_(0),
+        inflight_(0) {
+    FML_DCHECK(depth >= 1 && depth <= max_depth);
+  }
 
   ~Pipeline() = default;
 
   bool IsValid() const { return empty_.IsValid() && available_.IsValid(); }
 
   ProducerContinuation Produce() {
+    // Checked first so that the spots above the current depth stay free.
+    if (inflight_.load() >= static_cast<int>(depth_.load())) {
+      return {};
+    }
     if (!empty_.TryWait()) {
       return {};
     }
@@ -125,6 +142,24 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
         GetNextPipelineTraceID()};         // trace id
   }
 
+  /// Changes the number of resources that may be in flight, clamped to the
+  /// maximum depth. Resources in flight beyond a smaller depth are not
+  /// dropped, the producer waits for them to be consumed instead.
+  void SetDepth(uint32_t depth) {
+    depth = std::clamp<uint32_t>(depth, 1, max_depth_);
+    if (depth_.exchange(depth) == depth) {
+      return;
+    }
+    FML_TRACE_COUNTER("flutter", "Pipeline Depth",
+                      reinterpret_cast<int64_t>(this),  //
+                      "depth", depth                    //
+    );
+  }
+
+  uint32_t GetDepth() const { return depth_.load(); }
+
+  uint32_t GetMaxDepth() const { return max_depth_; }
+
   using Consumer = std::function<void(ResourcePtr)>;
 
   /// @note Procedure doesn't copy all closures.
@@ -154,8 +189,10 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
       consumer(std::move(resource));
     }
 
-    empty_.Signal();
+    // Decremented first so that a producer that finds the spot free is not
+    // turned away by |inflight_|.
     --inflight_;
+    empty_.Signal();
 
     TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
     TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
@@ -165,7 +202,8 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
   }
 
  private:
-  const uint32_t depth_;
+  std::atomic<uint32_t> depth_;
+  const uint32_t max_depth_;
   fml::Semaphore empty_;
   fml::Semaphore available_;
   std::atomic<int> inflight_;
@@ -186,7 +224,7 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
     {
       std::scoped_lock lock(queue_mutex_);
       queue_.emplace_front(std::move(resource), trace_id);
-      while (queue_.size() > depth_) {
+      while (queue_.size() > max_depth_) {
         queue_.pop_back();
       }
     }
@@ -198,6 +236,72 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
   FML_DISALLOW_COPY_AND_ASSIGN(Pipeline);
 };
 
+/// Chooses the depth of a |Pipeline| of frames from how long the recent ones
+/// took to build and rasterize.
+///
+/// With a depth of 1, the UI thread waits for the raster thread, which gives
+/// the lowest latency but only keeps up with the frame budget if building and
+/// rasterizing a frame fit in it together. A depth of 2 lets the threads work
+/// on consecutive frames at the same time. A depth of 3 lets the UI thread
+/// build another frame while the raster thread is behind, which absorbs
+/// frames that take longer than the budget to build or rasterize at the cost
+/// of another frame of latency. That frame is given up while the user is
+/// interacting with the app (see |NotifyLatencySensitiveInput|).
+///
+/// The depth grows as soon as a frame needs it and only shrinks once it has
+/// not been needed for |kShrinkFrames| frames.
+///
+/// |RecordFrame| must be called on a single thread, but
+/// |NotifyLatencySensitiveInput| may be called on any thread.
+class PipelineDepthController {
+ public:
+  static constexpr uint32_t kMaxDepth = 3;
+
+  // The percentage of the frame budget that frames are expected to fit in.
+  // Frame times vary from one frame to the next, so a frame that only just
+  // fits in the budget is likely to be followed by one that does not.
+  static constexpr int64_t kUsableBudgetPercent = 80;
+
+  // About a second at 60Hz.
+  static constexpr size_t kShrinkFrames = 60;
+
+  // The number of frames after latency sensitive input that the depth is
+  // kept at 2 or less. About half a second at 60Hz.
+  static constexpr size_t kInputFrames = 30;
+
+  PipelineDepthController();
+
+  ~PipelineDepthController();
+
+  /// Records that a frame took |build_time| on the UI thread and
+  /// |raster_time| on the raster thread, and returns the depth for the next
+  /// frames.
+  uint32_t RecordFrame(fml::TimeDelta build_time,
+                       fml::TimeDelta raster_time,
+                       fml::TimeDelta frame_budget);
+
+  /// Reports input whose response should be shown as soon as possible, like
+  /// a pointer being dragged.
+  void NotifyLatencySensitiveInput();
+
+  uint32_t GetDepth() const { return depth_; }
+
+ private:
+  uint32_t depth_ = 1;
+  // The frames recorded since |depth_| was last needed, and the largest depth
+  // they needed.
+  size_t shrink_frames_ = 0;
+  uint32_t shrink_depth_ = 1;
+  size_t input_frames_left_ = 0;
+  std::atomic<bool> input_pending_ = false;
+
+  void TraceDepthToTimeline(fml::TimeDelta build_time,
+                            fml::TimeDelta raster_time,
+                            fml::TimeDelta frame_budget) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PipelineDepthController);
+};
+
 }  // namespace flutter
 
 #endif  // FLUTTER_SHELL_COMMON_PIPELINE_H_
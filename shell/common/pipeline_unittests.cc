@@ -131,5 +131,125 @@ TEST(PipelineTest, PushingToFrontDropsLastResource) {
   ASSERT_EQ(consume_result_2, PipelineConsumeResult::Done);
 }
 
+TEST(PipelineTest, ProducingRespectsTheCurrentDepth) {
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(1, 3);
+  ASSERT_EQ(pipeline->GetDepth(), 1u);
+  ASSERT_EQ(pipeline->GetMaxDepth(), 3u);
+
+  Continuation continuation_1 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1);
+  ASSERT_FALSE(pipeline->Produce());
+
+  pipeline->SetDepth(2);
+  Continuation continuation_2 = pipeline->Produce();
+  ASSERT_TRUE(continuation_2);
+  ASSERT_FALSE(pipeline->Produce());
+
+  pipeline->SetDepth(3);
+  Continuation continuation_3 = pipeline->Produce();
+  ASSERT_TRUE(continuation_3);
+  ASSERT_FALSE(pipeline->Produce());
+}
+
+TEST(PipelineTest, ShrinkingTheDepthKeepsResourcesInFlight) {
+  const int depth = 3;
+  fml::RefPtr<IntPipeline> pipeline =
+      fml::MakeRefCounted<IntPipeline>(depth, depth);
+
+  for (int i = 1; i <= depth; i++) {
+    pipeline->Produce().Complete(std::make_unique<int>(i));
+  }
+
+  pipeline->SetDepth(1);
+  ASSERT_FALSE(pipeline->Produce());
+
+  for (int i = 1; i <= depth; i++) {
+    PipelineConsumeResult consume_result =
+        pipeline->Consume([i](std::unique_ptr<int> v) { ASSERT_EQ(*v, i); });
+    ASSERT_EQ(consume_result, i < depth ? PipelineConsumeResult::MoreAvailable
+                                        : PipelineConsumeResult::Done);
+    // Until the last resource in flight is consumed.
+    ASSERT_EQ(static_cast<bool>(pipeline->Produce()), i == depth);
+  }
+}
+
+TEST(PipelineTest, DepthIsClampedToTheMaxDepth) {
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(1, 2);
+
+  pipeline->SetDepth(5);
+  ASSERT_EQ(pipeline->GetDepth(), 2u);
+
+  pipeline->SetDepth(0);
+  ASSERT_EQ(pipeline->GetDepth(), 1u);
+}
+
+namespace {
+
+constexpr fml::TimeDelta kFrameBudget = fml::TimeDelta::FromMilliseconds(16);
+constexpr fml::TimeDelta kFastPhase = fml::TimeDelta::FromMilliseconds(4);
+constexpr fml::TimeDelta kSlowPhase = fml::TimeDelta::FromMilliseconds(12);
+constexpr fml::TimeDelta kJankyPhase = fml::TimeDelta::FromMilliseconds(24);
+
+}  // namespace
+
+TEST(PipelineDepthControllerTest, FramesThatFitTogetherNeedNoOverlap) {
+  PipelineDepthController controller;
+  ASSERT_EQ(controller.GetDepth(), 1u);
+
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kFastPhase, kFrameBudget), 1u);
+}
+
+TEST(PipelineDepthControllerTest, FramesThatBarelyFitTogetherStillOverlap) {
+  PipelineDepthController controller;
+
+  // Exactly the budget, with no headroom for a slower frame.
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kSlowPhase, kFrameBudget), 2u);
+}
+
+TEST(PipelineDepthControllerTest, DepthGrowsAsSoonAsAFrameNeedsIt) {
+  PipelineDepthController controller;
+
+  // Building and rasterizing only fit in the budget at the same time.
+  ASSERT_EQ(controller.RecordFrame(kSlowPhase, kSlowPhase, kFrameBudget), 2u);
+
+  // Rasterizing alone is over the budget.
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kJankyPhase, kFrameBudget),
+            PipelineDepthController::kMaxDepth);
+}
+
+TEST(PipelineDepthControllerTest, DepthShrinksOnceItIsNoLongerNeeded) {
+  PipelineDepthController controller;
+  ASSERT_EQ(controller.RecordFrame(kJankyPhase, kFastPhase, kFrameBudget), 3u);
+
+  // The largest depth needed by the frames since it grew wins.
+  ASSERT_EQ(controller.RecordFrame(kSlowPhase, kSlowPhase, kFrameBudget), 3u);
+  for (size_t i = 2; i < PipelineDepthController::kShrinkFrames; i++) {
+    ASSERT_EQ(controller.RecordFrame(kFastPhase, kFastPhase, kFrameBudget),
+              3u);
+  }
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kFastPhase, kFrameBudget), 2u);
+
+  for (size_t i = 1; i < PipelineDepthController::kShrinkFrames; i++) {
+    ASSERT_EQ(controller.RecordFrame(kFastPhase, kFastPhase, kFrameBudget),
+              2u);
+  }
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kFastPhase, kFrameBudget), 1u);
+}
+
+TEST(PipelineDepthControllerTest, InputGivesUpTheExtraFrameOfLatency) {
+  PipelineDepthController controller;
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kJankyPhase, kFrameBudget), 3u);
+
+  controller.NotifyLatencySensitiveInput();
+  // Right away, without waiting for the depth to shrink.
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kJankyPhase, kFrameBudget), 2u);
+  for (size_t i = 1; i < PipelineDepthController::kInputFrames; i++) {
+    ASSERT_EQ(controller.RecordFrame(kFastPhase, kJankyPhase, kFrameBudget),
+              2u);
+  }
+
+  ASSERT_EQ(controller.RecordFrame(kFastPhase, kJankyPhase, kFrameBudget), 3u);
+}
+
 }  // namespace testing
 }  // namespace flutter
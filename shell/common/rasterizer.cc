@@ -4,6 +4,7 @@
 
 #include "flutter/shell/common/rasterizer.h"
 
+#include "flutter/flow/tiled_rasterization.h"
 #include "flutter/shell/common/persistent_cache.h"
 
 #include <utility>
@@ -121,9 +122,21 @@ void Rasterizer::Draw(fml::RefPtr<Pipeline<flutter::LayerTree>> pipeline) {
   Pipeline<flutter::LayerTree>::Consumer consumer =
       [&](std::unique_ptr<LayerTree> layer_tree) {
         raster_status = DoDraw(std::move(layer_tree));
+        if (raster_status == RasterStatus::kFailed) {
+          delegate_.OnFrameDropped();
+        }
       };
 
   PipelineConsumeResult consume_result = pipeline->Consume(consumer);
+  if (raster_status == RasterStatus::kSuccess && pipeline_depth_controller_ &&
+      pipeline->GetMaxDepth() > 1) {
+    const fml::TimeDelta frame_budget = fml::TimeDelta::FromSecondsF(
+        delegate_.GetFrameBudget().count() / 1000.0);
+    // The last laps are those of the frame that was just drawn.
+    pipeline->SetDepth(pipeline_depth_controller_->RecordFrame(
+        compositor_context_->ui_time().LastLap(),
+        compositor_context_->raster_time().LastLap(), frame_budget));
+  }
   // if the raster status is to resubmit the frame, we push the frame to the
   // front of the queue and also change the consume status to more available.
   if (raster_status == RasterStatus::kResubmit) {
@@ -267,6 +280,11 @@ RasterStatus Rasterizer::DoDraw(
   // for Fuchsia to capture SceneUpdateContext::ExecutePaintTasks.
   timing.Set(FrameTiming::kRasterFinish, fml::TimePoint::Now());
   delegate_.OnFrameRasterized(timing);
+  if (frame_statistics_) {
+    frame_statistics_->RecordRasterizedFrame(
+        timing.Get(FrameTiming::kRasterFinish) -
+        timing.Get(FrameTiming::kRasterStart));
+  }
 
   // Pipeline pressure is applied from a couple of places:
   // rasterizer: When there are more items as of the time of Consume.
@@ -324,9 +342,21 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   SkMatrix root_surface_transformation =
       embedder_root_canvas ? SkMatrix{} : surface_->GetRootTransformation();
 
-  auto root_surface_canvas =
+  SkCanvas* root_surface_canvas =
       embedder_root_canvas ? embedder_root_canvas : frame->SkiaCanvas();
 
+  // Frames rendered into CPU memory may be recorded and then rasterized in
+  // tiles on several threads.
+  const bool rasterize_tiled = tiled_rasterization_task_runner_ &&
+                               surface_->GetContext() == nullptr &&
+                               external_view_embedder == nullptr &&
+                               frame->SkiaSurface() != nullptr;
+  SkPictureRecorder tiled_frame_recorder;
+  if (rasterize_tiled) {
+    root_surface_canvas = tiled_frame_recorder.beginRecording(SkRect::MakeIWH(
+        frame->SkiaSurface()->width(), frame->SkiaSurface()->height()));
+  }
+
   auto compositor_frame = compositor_context_->AcquireFrame(
       surface_->GetContext(),       // skia GrContext
       root_surface_canvas,          // root surface canvas
@@ -338,14 +368,53 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
+    // The external view embedder composites the frame from canvases that are
+    // not retained across frames.
+    compositor_frame->set_partial_repaint_enabled(
+        frame->retains_previous_frame() && external_view_embedder == nullptr);
     RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
     if (raster_status == RasterStatus::kFailed) {
       return raster_status;
     }
+    if (frame_statistics_) {
+      frame_statistics_->RecordPhase(FrameStatistics::kPreroll,
+                                     compositor_frame->preroll_time());
+      frame_statistics_->RecordPhase(FrameStatistics::kPaint,
+                                     compositor_frame->paint_time());
+    }
+    const fml::TimePoint flush_start = fml::TimePoint::Now();
+    if (rasterize_tiled) {
+      sk_sp<SkPicture> frame_picture =
+          tiled_frame_recorder.finishRecordingAsPicture();
+      if (!RasterizePictureTiled(frame_picture, frame->SkiaSurface().get(),
+                                 compositor_frame->damage().getBounds(),
+                                 tiled_rasterization_task_runner_,
+                                 tiled_rasterization_helper_count_)) {
+        frame->SkiaCanvas()->drawPicture(frame_picture);
+      }
+    }
+    frame->set_damage(compositor_frame->damage());
+    // Flushing here rather than when the frame is submitted tells the time
+    // spent issuing the frame's draws apart from the time spent presenting
+    // it. The flush made by the surface on submission is then a no-op.
+    const bool profile_flush = frame_statistics_ && profile_flushes_;
+    if (profile_flush && frame->SkiaCanvas() != nullptr) {
+      frame->SkiaCanvas()->flush();
+    }
+    const fml::TimePoint present_start =
+        profile_flush ? fml::TimePoint::Now() : flush_start;
     frame->Submit();
     if (external_view_embedder != nullptr) {
       external_view_embedder->SubmitFrame(surface_->GetContext());
     }
+    if (profile_flush) {
+      frame_statistics_->RecordPhase(FrameStatistics::kFlush,
+                                     present_start - flush_start);
+    }
+    if (frame_statistics_) {
+      frame_statistics_->RecordPhase(FrameStatistics::kPresent,
+                                     fml::TimePoint::Now() - present_start);
+    }
 
     FireNextFrameCallbackIfPresent();
 
@@ -561,6 +630,25 @@ std::optional<size_t> Rasterizer::GetResourceCacheMaxBytes() const {
   return std::nullopt;
 }
 
+void Rasterizer::SetTiledRasterizationTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t helper_count) {
+  tiled_rasterization_task_runner_ = std::move(task_runner);
+  tiled_rasterization_helper_count_ = helper_count;
+}
+
+void Rasterizer::SetFrameStatistics(
+    std::shared_ptr<FrameStatistics> frame_statistics,
+    bool profile_flushes) {
+  frame_statistics_ = std::move(frame_statistics);
+  profile_flushes_ = profile_flushes;
+}
+
+void Rasterizer::SetPipelineDepthController(
+    std::shared_ptr<PipelineDepthController> controller) {
+  pipeline_depth_controller_ = std::move(controller);
+}
+
 Rasterizer::Screenshot::Screenshot() {}
 
 Rasterizer::Screenshot::Screenshot(sk_sp<SkData> p_data, SkISize p_size)
@@ -11,8 +11,10 @@
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/frame_statistics.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/gpu_thread_merger.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/synchronization/waitable_event.h"
@@ -67,6 +69,10 @@ class Rasterizer final : public SnapshotDelegate {
 
     /// Time limit for a smooth frame. See `Engine::GetDisplayRefreshRate`.
     virtual fml::Milliseconds GetFrameBudget() = 0;
+
+    /// Notifies the delegate that a layer tree taken from the pipeline could
+    /// not be drawn, so its frame was never presented.
+    virtual void OnFrameDropped() = 0;
   };
 
   // TODO(dnfield): remove once embedders have caught up.
@@ -75,6 +81,7 @@ class Rasterizer final : public SnapshotDelegate {
     fml::Milliseconds GetFrameBudget() override {
       return fml::kDefaultFrameBudget;
     }
+    void OnFrameDropped() override {}
   };
 
   //----------------------------------------------------------------------------
@@ -405,6 +412,54 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   std::optional<size_t> GetResourceCacheMaxBytes() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Makes the rasterizer split the frames it renders into CPU
+  ///             backed surfaces into tiles, which are rasterized in parallel
+  ///             by the raster thread and by concurrent workers. Each frame is
+  ///             recorded into a picture first, which is then played back into
+  ///             every tile. Surfaces with a `GrContext` and frames composited
+  ///             by an external view embedder are not affected.
+  ///
+  /// @see        `RasterizePictureTiled`
+  ///
+  /// @param[in]  task_runner   The task runner of the concurrent workers, or
+  ///                           `nullptr` to stop rasterizing frames in tiles.
+  /// @param[in]  helper_count  The maximum number of tasks posted to
+  ///                           `task_runner` for each frame, usually its
+  ///                           number of workers.
+  ///
+  void SetTiledRasterizationTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+      size_t helper_count);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets the statistics that the time spent rasterizing each frame
+  ///             is recorded into, broken down into the preroll, paint, flush
+  ///             and present phases.
+  ///
+  /// @param[in]  frame_statistics  The statistics to record into, or `nullptr`
+  ///                               to stop recording.
+  /// @param[in]  profile_flushes   Whether to flush the canvas of each frame
+  ///                               before submitting it, to time the flush
+  ///                               phase. Otherwise, the flush made on
+  ///                               submission is part of the present phase.
+  ///
+  void SetFrameStatistics(std::shared_ptr<FrameStatistics> frame_statistics,
+                          bool profile_flushes = false);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets the controller that picks the depth of the pipelines
+  ///             consumed by `Draw` from the build and raster times of their
+  ///             frames, as measured by the stopwatches of the compositor
+  ///             context. Pipelines that cannot get deeper than 1 are left
+  ///             alone.
+  ///
+  /// @param[in]  controller  The controller, or `nullptr` to stop changing the
+  ///                         depth of pipelines.
+  ///
+  void SetPipelineDepthController(
+      std::shared_ptr<PipelineDepthController> controller);
+
  private:
   Delegate& delegate_;
   TaskRunners task_runners_;
@@ -421,6 +476,11 @@ class Rasterizer final : public SnapshotDelegate {
   std::optional<size_t> max_cache_bytes_;
   fml::WeakPtrFactory<Rasterizer> weak_factory_;
   fml::RefPtr<fml::GpuThreadMerger> gpu_thread_merger_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> tiled_rasterization_task_runner_;
+  size_t tiled_rasterization_helper_count_ = 0;
+  std::shared_ptr<FrameStatistics> frame_statistics_;
+  bool profile_flushes_ = false;
+  std::shared_ptr<PipelineDepthController> pipeline_depth_controller_;
 
   // |SnapshotDelegate|
   sk_sp<SkImage> MakeRasterSnapshot(sk_sp<SkPicture> picture,
@@ -7,6 +7,7 @@
 #include <sstream>
 
 #include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/assets/packed_asset_bundle.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/runtime/dart_vm.h"
@@ -18,14 +19,21 @@ RunConfiguration RunConfiguration::InferFromSettings(
     fml::RefPtr<fml::TaskRunner> io_worker) {
   auto asset_manager = std::make_shared<AssetManager>();
 
+  auto assets_directory = fml::OpenDirectory(settings.assets_path.c_str(),
+                                             false, fml::FilePermission::kRead);
+  // Assets packed into a single archive are preferred, with the directories
+  // as a fallback for any asset that was not packed.
+  if (auto packed_bundle = PackedAssetBundle::Open(assets_directory)) {
+    asset_manager->PushBack(std::move(packed_bundle));
+  }
+
   if (fml::UniqueFD::traits_type::IsValid(settings.assets_dir)) {
     asset_manager->PushBack(std::make_unique<DirectoryAssetBundle>(
         fml::Duplicate(settings.assets_dir)));
   }
 
   asset_manager->PushBack(
-      std::make_unique<DirectoryAssetBundle>(fml::OpenDirectory(
-          settings.assets_path.c_str(), false, fml::FilePermission::kRead)));
+      std::make_unique<DirectoryAssetBundle>(std::move(assets_directory)));
 
   return {IsolateConfiguration::InferFromSettings(settings, asset_manager,
                                                   io_worker),
@@ -0,0 +1,76 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/run_configuration.h"
+
+#include <memory>
+#include <string>
+
+#include "flutter/assets/packed_asset_bundle.h"
+#include "flutter/assets/packed_asset_bundle_writer.h"
+#include "flutter/fml/file.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+bool WriteString(const fml::UniqueFD& directory,
+                 const char* name,
+                 const std::string& contents) {
+  return fml::WriteAtomically(directory, name, fml::DataMapping(contents));
+}
+
+std::string LoadString(const AssetManager& asset_manager,
+                       const std::string& name) {
+  auto mapping = asset_manager.GetAsMapping(name);
+  if (!mapping) {
+    return "";
+  }
+  return std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                     mapping->GetSize());
+}
+
+}  // namespace
+
+TEST(RunConfigurationTest, PrefersPackedAssetsOverBothDirectories) {
+  fml::ScopedTemporaryDirectory assets_dir;
+  fml::ScopedTemporaryDirectory assets_path;
+
+  PackedAssetBundleWriter writer;
+  ASSERT_TRUE(writer.AddAsset(
+      "shared.txt", std::make_unique<fml::DataMapping>("packed"), false));
+  auto archive = writer.Build();
+  ASSERT_TRUE(archive);
+  ASSERT_TRUE(fml::WriteAtomically(assets_path.fd(),
+                                   PackedAssetBundle::kFileName, *archive));
+  ASSERT_TRUE(WriteString(assets_path.fd(), "shared.txt", "assets_path"));
+  ASSERT_TRUE(WriteString(assets_path.fd(), "path.txt", "assets_path"));
+  ASSERT_TRUE(WriteString(assets_dir.fd(), "shared.txt", "assets_dir"));
+  ASSERT_TRUE(WriteString(assets_dir.fd(), "dir.txt", "assets_dir"));
+
+  {
+    Settings settings;
+    settings.assets_dir = assets_dir.fd().get();
+    settings.assets_path = assets_path.path();
+    auto configuration = RunConfiguration::InferFromSettings(settings);
+    auto asset_manager = configuration.GetAssetManager();
+    ASSERT_TRUE(asset_manager);
+
+    ASSERT_EQ(LoadString(*asset_manager, "shared.txt"), "packed");
+    // Assets that were not packed fall back to either directory.
+    ASSERT_EQ(LoadString(*asset_manager, "dir.txt"), "assets_dir");
+    ASSERT_EQ(LoadString(*asset_manager, "path.txt"), "assets_path");
+  }
+
+  ASSERT_TRUE(fml::UnlinkFile(assets_path.fd(), PackedAssetBundle::kFileName));
+  ASSERT_TRUE(fml::UnlinkFile(assets_path.fd(), "shared.txt"));
+  ASSERT_TRUE(fml::UnlinkFile(assets_path.fd(), "path.txt"));
+  ASSERT_TRUE(fml::UnlinkFile(assets_dir.fd(), "shared.txt"));
+  ASSERT_TRUE(fml::UnlinkFile(assets_dir.fd(), "dir.txt"));
+}
+
+}  // namespace testing
+}  // namespace flutter
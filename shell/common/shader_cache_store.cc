@@ -0,0 +1,487 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shader_cache_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "flutter/fml/base32.h"
+#include "flutter/fml/compression.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+constexpr char ShaderCacheStore::kFileName[];
+constexpr char ShaderCacheStore::kLockFileName[];
+
+namespace {
+
+// The file starts with a |FileHeader|, followed by one record per stored
+// entry. Each record is a |RecordHeader|, the key, and the value, which is
+// compressed with LZ4 if its stored size is smaller than its size.
+constexpr uint8_t kMagic[8] = {'F', 'L', 'T', 'S', 'H', 'D', 'R', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  uint8_t magic[8];
+  uint32_t version;
+  // Incremented every time the file is rewritten.
+  uint32_t generation;
+};
+
+struct RecordHeader {
+  uint32_t key_size;
+  uint32_t stored_size;
+  uint32_t size;
+  // The FNV-1a hash of the sizes, the key and the stored value.
+  uint32_t checksum;
+};
+
+uint32_t ComputeChecksum(const RecordHeader& header, const uint8_t* contents) {
+  uint32_t hash = 2166136261u;
+  auto hash_bytes = [&hash](const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  };
+  hash_bytes(&header.key_size, sizeof(header.key_size));
+  hash_bytes(&header.stored_size, sizeof(header.stored_size));
+  hash_bytes(&header.size, sizeof(header.size));
+  hash_bytes(contents, header.key_size + header.stored_size);
+  return hash;
+}
+
+}  // namespace
+
+size_t ShaderCacheStore::Entry::GetRecordSize() const {
+  return sizeof(RecordHeader) + key_size + stored_size;
+}
+
+ShaderCacheStore::ShaderCacheStore(fml::UniqueFD directory,
+                                   size_t max_size,
+                                   bool read_only)
+    : directory_(std::move(directory)),
+      max_size_(max_size),
+      read_only_(read_only) {
+  TRACE_EVENT0("flutter", "ShaderCacheStore::Open");
+  std::scoped_lock lock(mutex_);
+  is_valid_ = Open();
+}
+
+ShaderCacheStore::~ShaderCacheStore() = default;
+
+bool ShaderCacheStore::Open() {
+  if (!directory_.is_valid()) {
+    return false;
+  }
+
+  IndexLegacyFiles();
+
+  if (read_only_) {
+    // A read-only store without a file only holds the legacy entries.
+    return !fml::FileExists(directory_, kFileName) || SyncWithFile();
+  }
+
+  lock_file_ = fml::OpenFile(directory_, kLockFileName, true,
+                             fml::FilePermission::kReadWrite);
+  fml::ScopedFileLock file_lock(lock_file_);
+  if (!file_lock.is_locked() || !SyncWithFile()) {
+    return false;
+  }
+  EvictIfNeeded();
+  return true;
+}
+
+bool ShaderCacheStore::SyncWithFile() {
+  file_ = fml::OpenFile(directory_, kFileName, !read_only_,
+                        read_only_ ? fml::FilePermission::kRead
+                                   : fml::FilePermission::kReadWrite);
+  mapping_ = nullptr;
+  if (!file_.is_valid()) {
+    return false;
+  }
+
+  auto mapping = std::make_shared<fml::FileMapping>(file_);
+  const uint8_t* contents = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+
+  FileHeader header;
+  if (size < sizeof(header)) {
+    return read_only_ || Reset(size);
+  }
+  std::memcpy(&header, contents, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion) {
+    FML_LOG(INFO) << "Discarding a shader cache of an unknown version.";
+    return read_only_ || Reset(size);
+  }
+
+  size_t offset = file_size_;
+  if (header.generation == generation_ && offset >= sizeof(header) &&
+      offset <= size) {
+    // Only the records appended by other processes are new. If the first of
+    // them is not where it should be, the file was replaced by one that only
+    // looks the same.
+    const size_t end = IndexRecords(contents, size, offset);
+    if (end == offset && end < size) {
+      offset = 0;
+    } else {
+      offset = end;
+    }
+  } else {
+    offset = 0;
+  }
+  if (offset == 0) {
+    entries_.clear();
+    entries_size_ = 0;
+    generation_ = header.generation;
+    offset = IndexRecords(contents, size, sizeof(header));
+  }
+  file_size_ = offset;
+  mapping_ = std::move(mapping);
+
+  if (offset < size) {
+    // The last append was interrupted before it could complete.
+    FML_LOG(WARNING) << "Discarding " << size - offset
+                     << " bytes at the end of the shader cache.";
+    if (!read_only_ && !ReplaceFile(fml::NonOwnedMapping(contents, offset))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ShaderCacheStore::IndexRecords(const uint8_t* contents,
+                                      size_t size,
+                                      size_t offset) {
+  while (size - offset >= sizeof(RecordHeader)) {
+    RecordHeader record;
+    std::memcpy(&record, contents + offset, sizeof(record));
+    const uint8_t* record_contents = contents + offset + sizeof(record);
+    const size_t remaining = size - offset - sizeof(record);
+    if (record.key_size == 0 || record.stored_size > record.size ||
+        record.key_size > remaining ||
+        record.stored_size > remaining - record.key_size ||
+        ComputeChecksum(record, record_contents) != record.checksum) {
+      break;
+    }
+    Entry entry;
+    entry.offset = offset;
+    entry.key_size = record.key_size;
+    entry.stored_size = record.stored_size;
+    entry.size = record.size;
+    InsertEntry(std::string(reinterpret_cast<const char*>(record_contents),
+                            record.key_size),
+                entry);
+    offset += entry.GetRecordSize();
+  }
+  return offset;
+}
+
+void ShaderCacheStore::IndexLegacyFiles() {
+  fml::VisitFiles(directory_, [this](const fml::UniqueFD& directory,
+                                     const std::string& file_name) {
+    // The other files of the cache, such as the store itself, are not valid
+    // base32.
+    auto key = fml::Base32Decode(file_name);
+    if (key.first && !key.second.empty() &&
+        !fml::IsDirectory(directory, file_name.c_str())) {
+      legacy_keys_.insert(std::move(key.second));
+    }
+    return true;
+  });
+}
+
+std::unique_ptr<fml::Mapping> ShaderCacheStore::LoadLegacyEntry(
+    const std::string& key) const {
+  auto file_name = fml::Base32Encode(key);
+  if (!file_name.first) {
+    return nullptr;
+  }
+  auto file = fml::OpenFileReadOnly(directory_, file_name.second.c_str());
+  if (!file.is_valid()) {
+    return nullptr;
+  }
+  auto mapping = std::make_unique<fml::FileMapping>(file);
+  if (mapping->GetSize() == 0) {
+    return nullptr;
+  }
+  return mapping;
+}
+
+bool ShaderCacheStore::Reset(size_t size) {
+  mapping_ = nullptr;
+  entries_.clear();
+  entries_size_ = 0;
+  file_size_ = 0;
+
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  // Other processes must index the file again.
+  header.generation = generation_ + 1;
+  const fml::NonOwnedMapping contents(reinterpret_cast<const uint8_t*>(&header),
+                                      sizeof(header));
+  // A new file is empty, so there is nothing to discard.
+  if (!(size == 0 ? fml::AppendToFile(file_, contents)
+                  : ReplaceFile(contents))) {
+    return false;
+  }
+  generation_ = header.generation;
+  file_size_ = sizeof(header);
+  return true;
+}
+
+bool ShaderCacheStore::ReplaceFile(const fml::Mapping& contents) {
+  if (!fml::WriteAtomically(directory_, kFileName, contents)) {
+    return false;
+  }
+  // The old file was replaced, so appending to it would lose the entries.
+  file_ = fml::OpenFile(directory_, kFileName, false,
+                        fml::FilePermission::kReadWrite);
+  mapping_ = nullptr;
+  return file_.is_valid();
+}
+
+bool ShaderCacheStore::IsValid() const {
+  std::scoped_lock lock(mutex_);
+  return is_valid_;
+}
+
+std::vector<std::string> ShaderCacheStore::GetKeys() const {
+  std::scoped_lock lock(mutex_);
+  std::vector<std::pair<uint64_t, const std::string*>> keys;
+  keys.reserve(entries_.size());
+  for (const auto& [key, entry] : entries_) {
+    keys.emplace_back(entry.last_use, &key);
+  }
+  std::sort(keys.begin(), keys.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  std::vector<std::string> result;
+  result.reserve(legacy_keys_.size() + keys.size());
+  for (const auto& key : legacy_keys_) {
+    if (entries_.count(key) == 0) {
+      result.push_back(key);
+    }
+  }
+  for (const auto& key : keys) {
+    result.push_back(*key.second);
+  }
+  return result;
+}
+
+size_t ShaderCacheStore::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+size_t ShaderCacheStore::GetFileSize() const {
+  std::scoped_lock lock(mutex_);
+  return file_size_;
+}
+
+std::shared_ptr<const fml::FileMapping> ShaderCacheStore::GetFileMapping() {
+  if (!mapping_ || mapping_->GetSize() < file_size_) {
+    mapping_ = std::make_shared<fml::FileMapping>(file_);
+  }
+  if (mapping_->GetSize() < file_size_) {
+    return nullptr;
+  }
+  return mapping_;
+}
+
+std::unique_ptr<fml::Mapping> ShaderCacheStore::Load(const std::string& key) {
+  Entry entry;
+  std::shared_ptr<const fml::FileMapping> mapping;
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = entries_.find(key);
+    if (found != entries_.end()) {
+      found->second.last_use = ++use_clock_;
+      entry = found->second;
+      mapping = GetFileMapping();
+      if (!mapping) {
+        return nullptr;
+      }
+    } else if (legacy_keys_.count(key) == 0) {
+      return nullptr;
+    }
+  }
+
+  if (!mapping) {
+    return LoadLegacyEntry(key);
+  }
+
+  // Records are never modified once written, and the file is never shrunk,
+  // only replaced, so the mapping stays valid even if the file is compacted
+  // or repaired in the meantime. So the value can be decompressed without
+  // holding the lock.
+  const uint8_t* stored = mapping->GetMapping() + entry.offset +
+                          sizeof(RecordHeader) + entry.key_size;
+  std::vector<uint8_t> value(entry.size);
+  if (entry.stored_size == entry.size) {
+    std::memcpy(value.data(), stored, entry.size);
+  } else if (!fml::DecompressLZ4(stored, entry.stored_size, value.data(),
+                                 value.size())) {
+    FML_LOG(ERROR) << "Could not decompress a shader cache entry.";
+    return nullptr;
+  }
+  return std::make_unique<fml::DataMapping>(std::move(value));
+}
+
+bool ShaderCacheStore::Store(const std::string& key,
+                             const fml::Mapping& value) {
+  if (read_only_ || key.empty() || value.GetMapping() == nullptr ||
+      value.GetSize() == 0 ||
+      key.size() > std::numeric_limits<uint32_t>::max() ||
+      value.GetSize() > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+
+  auto compressed = fml::CompressLZ4(value.GetMapping(), value.GetSize());
+  const bool is_compressed = compressed.size() < value.GetSize();
+  const uint8_t* stored =
+      is_compressed ? compressed.data() : value.GetMapping();
+
+  RecordHeader header;
+  header.key_size = key.size();
+  header.stored_size = is_compressed ? compressed.size() : value.GetSize();
+  header.size = value.GetSize();
+  std::vector<uint8_t> record(sizeof(header) + header.key_size +
+                              header.stored_size);
+  if (record.size() > max_size_) {
+    return false;
+  }
+  uint8_t* record_contents = record.data() + sizeof(header);
+  std::memcpy(record_contents, key.data(), header.key_size);
+  std::memcpy(record_contents + header.key_size, stored, header.stored_size);
+  header.checksum = ComputeChecksum(header, record_contents);
+  std::memcpy(record.data(), &header, sizeof(header));
+
+  std::scoped_lock lock(mutex_);
+  if (!is_valid_ || is_full_) {
+    return false;
+  }
+  fml::ScopedFileLock file_lock(lock_file_);
+  if (!file_lock.is_locked() || !SyncWithFile()) {
+    FML_LOG(ERROR) << "Could not read the shader cache before appending to it.";
+    return false;
+  }
+  if (!fml::AppendToFile(file_,
+                         fml::NonOwnedMapping(record.data(), record.size()))) {
+    FML_LOG(ERROR) << "Could not append to the shader cache.";
+    // Whatever part of the record was written is discarded by the next sync
+    // with the file.
+    return false;
+  }
+  Entry entry;
+  entry.offset = file_size_;
+  entry.key_size = header.key_size;
+  entry.stored_size = header.stored_size;
+  entry.size = header.size;
+  file_size_ += record.size();
+  InsertEntry(key, entry);
+  EvictIfNeeded();
+  return true;
+}
+
+void ShaderCacheStore::InsertEntry(const std::string& key, Entry entry) {
+  entry.last_use = ++use_clock_;
+  auto found = entries_.find(key);
+  if (found != entries_.end()) {
+    entries_size_ -= found->second.GetRecordSize();
+    found->second = entry;
+  } else {
+    entries_.emplace(key, entry);
+  }
+  entries_size_ += entry.GetRecordSize();
+}
+
+void ShaderCacheStore::EvictIfNeeded() {
+  if (entries_size_ > max_size_) {
+    std::vector<std::pair<uint64_t, std::string>> keys;
+    keys.reserve(entries_.size());
+    for (const auto& [key, entry] : entries_) {
+      keys.emplace_back(entry.last_use, key);
+    }
+    std::sort(keys.begin(), keys.end());
+    // Evict down to three quarters of the maximum size, so that the next few
+    // stores do not compact the file again.
+    const size_t target_size = max_size_ / 4 * 3;
+    for (const auto& key : keys) {
+      if (entries_size_ <= target_size) {
+        break;
+      }
+      auto found = entries_.find(key.second);
+      entries_size_ -= found->second.GetRecordSize();
+      entries_.erase(found);
+    }
+  }
+
+  // Evicted and replaced entries are still in the file.
+  if (file_size_ > sizeof(FileHeader) + max_size_ && !Compact()) {
+    // Stop growing the file if it cannot be rewritten, as on platforms that
+    // do not allow replacing open files.
+    FML_LOG(ERROR) << "Could not compact the shader cache. No more shaders "
+                      "will be stored.";
+    is_full_ = true;
+  }
+}
+
+bool ShaderCacheStore::Compact() {
+  TRACE_EVENT0("flutter", "ShaderCacheStore::Compact");
+  auto mapping = GetFileMapping();
+  if (!mapping) {
+    return false;
+  }
+
+  // Write the entries from the least to the most recently used, so that their
+  // order is kept when the file is opened again.
+  std::vector<Entry*> entries;
+  entries.reserve(entries_.size());
+  for (auto& [key, entry] : entries_) {
+    entries.push_back(&entry);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry* a, const Entry* b) {
+              return a->last_use < b->last_use;
+            });
+
+  std::vector<uint8_t> compacted(sizeof(FileHeader) + entries_size_);
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.generation = generation_ + 1;
+  std::memcpy(compacted.data(), &header, sizeof(header));
+  std::vector<uint64_t> offsets;
+  offsets.reserve(entries.size());
+  size_t offset = sizeof(header);
+  for (const auto* entry : entries) {
+    std::memcpy(compacted.data() + offset,
+                mapping->GetMapping() + entry->offset, entry->GetRecordSize());
+    offsets.push_back(offset);
+    offset += entry->GetRecordSize();
+  }
+
+  if (!ReplaceFile(fml::NonOwnedMapping(compacted.data(), compacted.size()))) {
+    if (!file_.is_valid()) {
+      is_valid_ = false;
+    }
+    return false;
+  }
+  for (size_t i = 0; i < entries.size(); i++) {
+    entries[i]->offset = offsets[i];
+  }
+  file_size_ = compacted.size();
+  generation_ = header.generation;
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,139 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_SHADER_CACHE_STORE_H_
+#define FLUTTER_SHELL_COMMON_SHADER_CACHE_STORE_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+
+namespace flutter {
+
+/// A key value store of shaders and program binaries backed by a single file.
+///
+/// Entries are appended to the file, compressed when that makes them smaller,
+/// and indexed in memory by their key. Once the entries exceed the maximum
+/// size of the store, the least recently used ones are evicted and the file is
+/// compacted by rewriting it with `fml::WriteAtomically`. Every entry carries
+/// a checksum, so that an append interrupted by a crash is detected and
+/// discarded the next time the store is opened. The file is never shrunk in
+/// place, as readers in this or other processes may have it mapped, so such
+/// appends are discarded by rewriting it as well.
+///
+/// Processes sharing the store take a lock on a separate file while they
+/// append to or compact it, and first pick up whatever the other processes
+/// appended or compacted since.
+///
+/// Caches written before the store existed held one file per entry, named
+/// after the base32 encoding of its key. Such files are still read, after the
+/// entries of the store, so that caches shipped with a device keep working.
+///
+/// This class is thread safe.
+class ShaderCacheStore {
+ public:
+  static constexpr char kFileName[] = "shaders.bin";
+  static constexpr char kLockFileName[] = "shaders.lock";
+
+  ShaderCacheStore(fml::UniqueFD directory, size_t max_size, bool read_only);
+
+  ~ShaderCacheStore();
+
+  bool IsValid() const;
+
+  /// Returns the keys of every entry, least recently used first. Loading the
+  /// entries in this order keeps their order of use.
+  std::vector<std::string> GetKeys() const;
+
+  /// Returns a copy of the value stored for `key`, or nullptr if there is
+  /// none.
+  std::unique_ptr<fml::Mapping> Load(const std::string& key);
+
+  /// Stores `value` for `key`, replacing any previous value. Returns false if
+  /// the store is read-only or the value could not be written.
+  bool Store(const std::string& key, const fml::Mapping& value);
+
+  /// The number of entries in the file backing the store, not counting the
+  /// entries read from one file each.
+  size_t GetEntryCount() const;
+
+  /// The size of the file backing the store, in bytes.
+  size_t GetFileSize() const;
+
+ private:
+  struct Entry {
+    // The offset of the record holding the entry in the file.
+    uint64_t offset = 0;
+    uint32_t key_size = 0;
+    uint32_t stored_size = 0;
+    uint32_t size = 0;
+    uint64_t last_use = 0;
+
+    size_t GetRecordSize() const;
+  };
+
+  const fml::UniqueFD directory_;
+  const size_t max_size_;
+  const bool read_only_;
+  mutable std::mutex mutex_;
+  fml::UniqueFD lock_file_;
+  fml::UniqueFD file_;
+  std::shared_ptr<const fml::FileMapping> mapping_;
+  std::unordered_map<std::string, Entry> entries_;
+  // The keys of the entries stored in a file of their own.
+  std::unordered_set<std::string> legacy_keys_;
+  // The size of the records of every entry in the index, in bytes.
+  size_t entries_size_ = 0;
+  size_t file_size_ = 0;
+  // Incremented every time the file is rewritten, by any process.
+  uint32_t generation_ = 0;
+  uint64_t use_clock_ = 0;
+  bool is_valid_ = false;
+  bool is_full_ = false;
+
+  bool Open();
+
+  // Reopens the file and indexes the records other processes appended since
+  // it was last read, or all of them if it was rewritten in the meantime.
+  bool SyncWithFile();
+
+  // Indexes the records in |contents| from |offset| on. Returns the offset
+  // past the last complete record.
+  size_t IndexRecords(const uint8_t* contents, size_t size, size_t offset);
+
+  void IndexLegacyFiles();
+
+  std::unique_ptr<fml::Mapping> LoadLegacyEntry(const std::string& key) const;
+
+  // Replaces the file with an empty store. |size| is the size of the file.
+  bool Reset(size_t size);
+
+  // Replaces the file with one that holds |contents|, leaving the old one to
+  // whoever still maps it.
+  bool ReplaceFile(const fml::Mapping& contents);
+
+  // Returns a mapping of the whole file, remapping it if entries were
+  // appended since it was last mapped.
+  std::shared_ptr<const fml::FileMapping> GetFileMapping();
+
+  void InsertEntry(const std::string& key, Entry entry);
+
+  void EvictIfNeeded();
+
+  bool Compact();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ShaderCacheStore);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_SHADER_CACHE_STORE_H_
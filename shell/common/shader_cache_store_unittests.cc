@@ -0,0 +1,266 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shader_cache_store.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/base32.h"
+#include "flutter/fml/file.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr size_t kMaxSize = 64 * 1024;
+
+std::unique_ptr<ShaderCacheStore> OpenStore(
+    fml::ScopedTemporaryDirectory& directory,
+    size_t max_size = kMaxSize,
+    bool read_only = false) {
+  return std::make_unique<ShaderCacheStore>(
+      fml::OpenDirectory(directory.path().c_str(), false,
+                         fml::FilePermission::kReadWrite),
+      max_size, read_only);
+}
+
+std::string LoadString(ShaderCacheStore& store, const std::string& key) {
+  auto mapping = store.Load(key);
+  if (!mapping) {
+    return "";
+  }
+  return std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                     mapping->GetSize());
+}
+
+std::string RandomString(size_t size, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::string result(size, '\0');
+  for (auto& c : result) {
+    c = static_cast<char>(random() & 0xff);
+  }
+  return result;
+}
+
+size_t GetFileSize(fml::ScopedTemporaryDirectory& directory) {
+  fml::FileMapping mapping(
+      fml::OpenFileReadOnly(directory.fd(), ShaderCacheStore::kFileName));
+  return mapping.GetSize();
+}
+
+}  // namespace
+
+class ShaderCacheStoreTest : public ::testing::Test {
+ public:
+  ShaderCacheStoreTest() = default;
+
+  ~ShaderCacheStoreTest() override {
+    fml::UnlinkFile(directory_.fd(), ShaderCacheStore::kFileName);
+    fml::UnlinkFile(directory_.fd(), ShaderCacheStore::kLockFileName);
+  }
+
+ protected:
+  fml::ScopedTemporaryDirectory directory_;
+
+ private:
+  FML_DISALLOW_COPY_AND_ASSIGN(ShaderCacheStoreTest);
+};
+
+TEST_F(ShaderCacheStoreTest, StoresEntriesAcrossRestarts) {
+  const std::string compressible(10000, 's');
+  const std::string incompressible = RandomString(10000, 1);
+  {
+    auto store = OpenStore(directory_);
+    ASSERT_TRUE(store->IsValid());
+    ASSERT_EQ(store->GetEntryCount(), 0u);
+    ASSERT_TRUE(store->Store("a", fml::DataMapping(compressible)));
+    ASSERT_TRUE(store->Store("b", fml::DataMapping(incompressible)));
+    ASSERT_EQ(LoadString(*store, "a"), compressible);
+    ASSERT_EQ(LoadString(*store, "b"), incompressible);
+    ASSERT_FALSE(store->Load("c"));
+    // Only the compressible value was compressed.
+    ASSERT_LT(store->GetFileSize(), 11000u);
+  }
+
+  auto store = OpenStore(directory_);
+  ASSERT_EQ(store->GetEntryCount(), 2u);
+  ASSERT_EQ(LoadString(*store, "a"), compressible);
+  ASSERT_EQ(LoadString(*store, "b"), incompressible);
+}
+
+TEST_F(ShaderCacheStoreTest, ReplacesEntries) {
+  {
+    auto store = OpenStore(directory_);
+    ASSERT_TRUE(store->Store("a", fml::DataMapping(std::string("first"))));
+    ASSERT_TRUE(store->Store("a", fml::DataMapping(std::string("second"))));
+    ASSERT_EQ(store->GetEntryCount(), 1u);
+    ASSERT_EQ(LoadString(*store, "a"), "second");
+  }
+  auto store = OpenStore(directory_);
+  ASSERT_EQ(store->GetEntryCount(), 1u);
+  ASSERT_EQ(LoadString(*store, "a"), "second");
+}
+
+TEST_F(ShaderCacheStoreTest, ListsLeastRecentlyUsedKeysFirst) {
+  auto store = OpenStore(directory_);
+  for (const auto* key : {"a", "b", "c"}) {
+    ASSERT_TRUE(store->Store(key, fml::DataMapping(std::string("value"))));
+  }
+  ASSERT_TRUE(store->Load("a"));
+  ASSERT_EQ(store->GetKeys(), (std::vector<std::string>{"b", "c", "a"}));
+}
+
+TEST_F(ShaderCacheStoreTest, EvictsLeastRecentlyUsedEntries) {
+  {
+    auto store = OpenStore(directory_);
+    for (uint32_t i = 0; i < 100; i++) {
+      ASSERT_TRUE(store->Store(std::to_string(i),
+                               fml::DataMapping(RandomString(1000, i))));
+      // Keep using the first entry.
+      ASSERT_TRUE(store->Load("0"));
+      ASSERT_LE(store->GetFileSize(), kMaxSize + 1100);
+    }
+    ASSERT_LT(store->GetEntryCount(), 100u);
+    ASSERT_TRUE(store->Load("0"));
+    ASSERT_TRUE(store->Load("99"));
+    ASSERT_FALSE(store->Load("1"));
+    ASSERT_EQ(store->GetFileSize(), GetFileSize(directory_));
+  }
+
+  // The file was compacted without the evicted entries.
+  auto store = OpenStore(directory_);
+  ASSERT_LT(store->GetEntryCount(), 100u);
+  ASSERT_EQ(LoadString(*store, "0"), RandomString(1000, 0));
+  ASSERT_EQ(LoadString(*store, "99"), RandomString(1000, 99));
+  ASSERT_FALSE(store->Load("1"));
+}
+
+TEST_F(ShaderCacheStoreTest, DiscardsTornRecords) {
+  size_t intact_size = 0;
+  {
+    auto store = OpenStore(directory_);
+    ASSERT_TRUE(store->Store("a", fml::DataMapping(std::string("intact"))));
+    intact_size = store->GetFileSize();
+    ASSERT_TRUE(store->Store("b", fml::DataMapping(RandomString(100, 2))));
+  }
+  // Simulate a crash in the middle of appending the second record.
+  {
+    auto file = fml::OpenFile(directory_.fd(), ShaderCacheStore::kFileName,
+                              false, fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(fml::TruncateFile(file, GetFileSize(directory_) - 10));
+  }
+
+  auto store = OpenStore(directory_);
+  ASSERT_TRUE(store->IsValid());
+  ASSERT_EQ(store->GetEntryCount(), 1u);
+  ASSERT_EQ(LoadString(*store, "a"), "intact");
+  ASSERT_EQ(GetFileSize(directory_), intact_size);
+  ASSERT_TRUE(store->Store("b", fml::DataMapping(std::string("again"))));
+  ASSERT_EQ(LoadString(*store, "b"), "again");
+}
+
+TEST_F(ShaderCacheStoreTest, DoesNotShrinkTheFileUnderItsReaders) {
+  auto store = OpenStore(directory_);
+  ASSERT_TRUE(store->Store("a", fml::DataMapping(std::string("intact"))));
+  // A torn record spanning several pages, which another reader maps.
+  const std::string torn = RandomString(64 * 1024, 3);
+  {
+    auto file = fml::OpenFile(directory_.fd(), ShaderCacheStore::kFileName,
+                              false, fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(fml::AppendToFile(file, fml::DataMapping(torn)));
+  }
+  fml::FileMapping reader(
+      fml::OpenFileReadOnly(directory_.fd(), ShaderCacheStore::kFileName));
+  ASSERT_GT(reader.GetSize(), torn.size());
+
+  ASSERT_TRUE(store->Store("b", fml::DataMapping(std::string("again"))));
+  ASSERT_EQ(GetFileSize(directory_), store->GetFileSize());
+  ASSERT_EQ(LoadString(*store, "a"), "intact");
+  ASSERT_EQ(LoadString(*store, "b"), "again");
+  // The reader would fault on the pages past the end of a shrunk file.
+  ASSERT_EQ(reader.GetMapping()[reader.GetSize() - 1],
+            static_cast<uint8_t>(torn.back()));
+}
+
+TEST_F(ShaderCacheStoreTest, DiscardsFilesOfOtherVersions) {
+  ASSERT_TRUE(fml::WriteAtomically(
+      directory_.fd(), ShaderCacheStore::kFileName,
+      fml::DataMapping(std::string("not a shader cache"))));
+  auto store = OpenStore(directory_);
+  ASSERT_TRUE(store->IsValid());
+  ASSERT_EQ(store->GetEntryCount(), 0u);
+  ASSERT_TRUE(store->Store("a", fml::DataMapping(std::string("value"))));
+  ASSERT_EQ(LoadString(*store, "a"), "value");
+}
+
+TEST_F(ShaderCacheStoreTest, ReadOnlyStoresDoNotWrite) {
+  {
+    auto store = OpenStore(directory_, kMaxSize, true);
+    ASSERT_TRUE(store->IsValid());
+    ASSERT_FALSE(store->Store("a", fml::DataMapping(std::string("value"))));
+    ASSERT_FALSE(fml::FileExists(directory_.fd(), ShaderCacheStore::kFileName));
+  }
+  {
+    auto store = OpenStore(directory_);
+    ASSERT_TRUE(store->Store("a", fml::DataMapping(std::string("value"))));
+  }
+  auto store = OpenStore(directory_, kMaxSize, true);
+  ASSERT_EQ(LoadString(*store, "a"), "value");
+  ASSERT_FALSE(store->Store("b", fml::DataMapping(std::string("value"))));
+}
+
+TEST_F(ShaderCacheStoreTest, SharesTheFileWithOtherStores) {
+  auto first = OpenStore(directory_);
+  auto second = OpenStore(directory_);
+  ASSERT_TRUE(first->Store("a", fml::DataMapping(std::string("first"))));
+  ASSERT_TRUE(second->Store("b", fml::DataMapping(std::string("second"))));
+  // Each store picks up the entries of the others before appending.
+  ASSERT_EQ(second->GetEntryCount(), 2u);
+  ASSERT_EQ(LoadString(*second, "a"), "first");
+  ASSERT_TRUE(first->Store("c", fml::DataMapping(std::string("third"))));
+  ASSERT_EQ(LoadString(*first, "b"), "second");
+
+  auto store = OpenStore(directory_);
+  ASSERT_EQ(store->GetEntryCount(), 3u);
+}
+
+TEST_F(ShaderCacheStoreTest, KeepsEntriesStoredAfterOtherStoresCompacted) {
+  auto first = OpenStore(directory_);
+  auto second = OpenStore(directory_);
+  // The second store replaces the file to evict entries.
+  for (uint32_t i = 0; i < 100; i++) {
+    ASSERT_TRUE(second->Store(std::to_string(i),
+                              fml::DataMapping(RandomString(1000, i))));
+  }
+  ASSERT_LT(second->GetEntryCount(), 100u);
+  ASSERT_TRUE(first->Store("a", fml::DataMapping(std::string("value"))));
+  ASSERT_EQ(LoadString(*first, "99"), RandomString(1000, 99));
+
+  auto store = OpenStore(directory_);
+  ASSERT_EQ(LoadString(*store, "a"), "value");
+  ASSERT_EQ(LoadString(*store, "99"), RandomString(1000, 99));
+}
+
+TEST_F(ShaderCacheStoreTest, ReadsEntriesStoredInFilesOfTheirOwn) {
+  const std::string key = "legacy key";
+  const std::string file_name = fml::Base32Encode(key).second;
+  ASSERT_TRUE(
+      fml::WriteAtomically(directory_.fd(), file_name.c_str(),
+                           fml::DataMapping(std::string("legacy value"))));
+  {
+    auto store = OpenStore(directory_, kMaxSize, true);
+    ASSERT_TRUE(store->IsValid());
+    ASSERT_EQ(store->GetKeys(), std::vector<std::string>{key});
+    ASSERT_EQ(LoadString(*store, key), "legacy value");
+    ASSERT_FALSE(store->Load("other key"));
+  }
+  ASSERT_TRUE(fml::UnlinkFile(directory_.fd(), file_name.c_str()));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -18,7 +18,9 @@
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
+#include "flutter/fml/trace_recorder.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/lib/ui/painting/decode_ahead_budget.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/runtime/start_up.h"
 #include "flutter/shell/common/engine.h"
@@ -68,6 +70,29 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupGPUSubsystem");
         std::unique_ptr<Rasterizer> rasterizer(on_create_rasterizer(*shell));
+        if (shell->GetSettings().enable_async_raster_cache_population) {
+          rasterizer->compositor_context()
+              ->raster_cache()
+              .SetConcurrentTaskRunner(
+                  shell->GetDartVM()->GetConcurrentWorkerTaskRunner());
+        }
+        if (shell->GetSettings().enable_tiled_software_rasterization) {
+          auto concurrent_loop = shell->GetDartVM()->GetConcurrentMessageLoop();
+          rasterizer->SetTiledRasterizationTaskRunner(
+              concurrent_loop->GetTaskRunner(),
+              concurrent_loop->GetWorkerCount());
+        }
+        if (shell->GetSettings().enable_parallel_preroll) {
+          auto concurrent_loop = shell->GetDartVM()->GetConcurrentMessageLoop();
+          rasterizer->compositor_context()->SetPrerollTaskRunner(
+              concurrent_loop->GetTaskRunner(),
+              concurrent_loop->GetWorkerCount());
+        }
+        rasterizer->SetFrameStatistics(
+            shell->GetFrameStatistics(),
+            shell->GetSettings().profile_frame_flushes);
+        rasterizer->SetPipelineDepthController(
+            shell->pipeline_depth_controller_);
         snapshot_delegate_promise.set_value(rasterizer->GetSnapshotDelegate());
         rasterizer_promise.set_value(std::move(rasterizer));
       });
@@ -110,12 +135,25 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
        &unref_queue_promise,                                              //
        platform_view = platform_view->GetWeakPtr(),                       //
        io_task_runner,                                                    //
+       vm = shell->GetDartVM(),                                           //
        is_backgrounded_sync_switch = shell->GetIsGpuDisabledSyncSwitch()  //
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupIOSubsystem");
+        auto resource_context =
+            platform_view.getUnsafe()->CreateResourceContext();
+        // Only the GL surface precompiles the SkSL shaders. If that is the
+        // backend in use, start loading them while the rest of the engine is
+        // launched, so that creating the on-screen surface waits less for
+        // them.
+        if (resource_context &&
+            resource_context->backend() == GrBackendApi::kOpenGL) {
+          PersistentCache::GetCacheForProcess()->PrefetchSkSLs(
+              vm->GetConcurrentWorkerTaskRunner(),
+              vm->GetConcurrentMessageLoop()->GetWorkerCount());
+        }
         auto io_manager = std::make_unique<ShellIOManager>(
-            platform_view.getUnsafe()->CreateResourceContext(),
-            is_backgrounded_sync_switch, io_task_runner);
+            std::move(resource_context), is_backgrounded_sync_switch,
+            io_task_runner);
         weak_io_manager_promise.set_value(io_manager->GetWeakPtr());
         unref_queue_promise.set_value(io_manager->GetSkiaUnrefQueue());
         io_manager_promise.set_value(std::move(io_manager));
@@ -145,8 +183,10 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
 
         // The animator is owned by the UI thread but it gets its vsync pulses
         // from the platform.
-        auto animator = std::make_unique<Animator>(*shell, task_runners,
-                                                   std::move(vsync_waiter));
+        auto animator = std::make_unique<Animator>(
+            *shell, task_runners, std::move(vsync_waiter),
+            shell->GetIdleTaskQueue(), shell->GetFrameStatistics(),
+            shell->GetSettings().enable_adaptive_pipeline_depth);
 
         engine_promise.set_value(std::make_unique<Engine>(
             *shell,                         //
@@ -196,6 +236,10 @@ static void PerformInitializationTasks(const Settings& settings) {
 
   static std::once_flag gShellSettingsInitialization = {};
   std::call_once(gShellSettingsInitialization, [&settings] {
+    if (settings.trace_recorder) {
+      fml::tracing::TraceRecorder::GetInstance().Start();
+    }
+
     RecordStartupTimestamp();
 
     tonic::SetLogHandler(
@@ -313,12 +357,25 @@ Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
       settings_(std::move(settings)),
       vm_(std::move(vm)),
       is_gpu_disabled_sync_switch_(new fml::SyncSwitch()),
+      idle_task_queue_(std::make_shared<IdleTaskQueue>(
+          task_runners_.GetUITaskRunner())),
+      frame_statistics_(std::make_shared<FrameStatistics>()),
+      pipeline_depth_controller_(
+          settings_.enable_adaptive_pipeline_depth
+              ? std::make_shared<PipelineDepthController>()
+              : nullptr),
       weak_factory_(this),
       weak_factory_gpu_(nullptr) {
   FML_CHECK(vm_) << "Must have access to VM to create a shell.";
   FML_DCHECK(task_runners_.IsValid());
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
+  // The budget is shared by the animated images of all shells.
+  if (settings_.animated_image_decode_ahead_bytes > 0) {
+    DecodeAheadBudget::GetInstance().SetMaxBytes(
+        settings_.animated_image_decode_ahead_bytes);
+  }
+
   // Generate a WeakPtrFactory for use with the GPU thread. This does not need
   // to wait on a latch because it can only ever be used from the GPU thread
   // from this class, so we have ordering guarantees.
@@ -357,6 +414,22 @@ Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
           task_runners_.GetUITaskRunner(),
           std::bind(&Shell::OnServiceProtocolGetDisplayRefreshRate, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  // The trace recorder is not tied to any thread. Exporting may take a while,
+  // so keep it off the UI and GPU threads.
+  service_protocol_handlers_
+      [ServiceProtocol::kSetTraceRecorderEnabledExtensionName] = {
+          task_runners_.GetIOTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolSetTraceRecorderEnabled, this,
+                    std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_[ServiceProtocol::kGetRecordedTraceExtensionName] =
+      {task_runners_.GetIOTaskRunner(),
+       std::bind(&Shell::OnServiceProtocolGetRecordedTrace, this,
+                 std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetFrameStatisticsExtensionName] = {
+          task_runners_.GetIOTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetFrameStatistics, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -428,6 +501,8 @@ void Shell::NotifyLowMemoryWarning() const {
       });
   // The IO Manager uses resource cache limits of 0, so it is not necessary
   // to purge them.
+
+  DecodeAheadBudget::GetInstance().Purge();
 }
 
 void Shell::RunEngine(RunConfiguration run_configuration) {
@@ -781,13 +856,17 @@ void Shell::OnPlatformViewDispatchPointerDataPacket(
   TRACE_FLOW_BEGIN("flutter", "PointerEvent", next_pointer_flow_id_);
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
-  task_runners_.GetUITaskRunner()->PostTask(
-      fml::MakeCopyable([engine = weak_engine_, packet = std::move(packet),
-                         flow_id = next_pointer_flow_id_]() mutable {
+  if (pipeline_depth_controller_) {
+    pipeline_depth_controller_->NotifyLatencySensitiveInput();
+  }
+  task_runners_.GetUITaskRunner()->PostTaskWithPriority(
+      [engine = weak_engine_, packet = std::move(packet),
+       flow_id = next_pointer_flow_id_]() mutable {
         if (engine) {
           engine->DispatchPointerDataPacket(std::move(packet), flow_id);
         }
-      }));
+      },
+      fml::TaskPriority::kInput);
   next_pointer_flow_id_++;
 }
 
@@ -959,6 +1038,16 @@ void Shell::OnAnimatorDrawLastLayerTree() {
       });
 }
 
+// |Animator::Delegate|
+void Shell::OnAnimatorFrameDropped() {
+  FML_DCHECK(is_setup_);
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  if (settings_.frame_dropped_callback) {
+    settings_.frame_dropped_callback();
+  }
+}
+
 // |Engine::Delegate|
 void Shell::OnEngineUpdateSemantics(SemanticsNodeUpdates update,
                                     CustomAccessibilityActionUpdates actions) {
@@ -1142,6 +1231,16 @@ fml::Milliseconds Shell::GetFrameBudget() {
   }
 }
 
+// |Rasterizer::Delegate|
+void Shell::OnFrameDropped() {
+  FML_DCHECK(is_setup_);
+  FML_DCHECK(task_runners_.GetGPUTaskRunner()->RunsTasksOnCurrentThread());
+
+  if (settings_.frame_dropped_callback) {
+    settings_.frame_dropped_callback();
+  }
+}
+
 // |ServiceProtocol::Handler|
 fml::RefPtr<fml::TaskRunner> Shell::GetServiceProtocolHandlerTaskRunner(
     std::string_view method) const {
@@ -1337,6 +1436,90 @@ bool Shell::OnServiceProtocolGetDisplayRefreshRate(
   return true;
 }
 
+// Service protocol handler
+bool Shell::OnServiceProtocolSetTraceRecorderEnabled(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+
+  if (params.count("enabled") == 0) {
+    ServiceProtocolParameterError(response, "'enabled' parameter is missing.");
+    return false;
+  }
+
+  auto& recorder = fml::tracing::TraceRecorder::GetInstance();
+  if (params.count("clear") != 0 && params.at("clear") == "true") {
+    recorder.Clear();
+  }
+  if (params.at("enabled") == "true") {
+    recorder.Start();
+  } else {
+    recorder.Stop();
+  }
+
+  response.SetObject();
+  response.AddMember("type", "Success", response.GetAllocator());
+  return true;
+}
+
+// Service protocol handler
+bool Shell::OnServiceProtocolGetRecordedTrace(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  const auto trace =
+      fml::tracing::TraceRecorder::GetInstance().ExportChromeJSON();
+  response.SetObject();
+  auto& allocator = response.GetAllocator();
+  response.AddMember("type", "RecordedTrace", allocator);
+  rapidjson::Value trace_value;
+  trace_value.SetString(trace.c_str(), trace.size(), allocator);
+  response.AddMember("trace", trace_value, allocator);
+  return true;
+}
+
+// Service protocol handler
+bool Shell::OnServiceProtocolGetFrameStatistics(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  const auto summary = frame_statistics_->GetSummary();
+  if (params.count("reset") != 0 && params.at("reset") == "true") {
+    frame_statistics_->Reset();
+  }
+
+  response.SetObject();
+  auto& allocator = response.GetAllocator();
+  response.AddMember("type", "FrameStatistics", allocator);
+  response.AddMember("builtFrames", summary.built_frames, allocator);
+  response.AddMember("rasterizedFrames", summary.rasterized_frames, allocator);
+  response.AddMember("missedBuildFrames", summary.missed_build_frames,
+                     allocator);
+  response.AddMember("missedRasterFrames", summary.missed_raster_frames,
+                     allocator);
+  rapidjson::Value phases(rapidjson::kObjectType);
+  for (size_t i = 0; i < FrameStatistics::kPhaseCount; i++) {
+    const auto& summary_phase = summary.phases[i];
+    rapidjson::Value phase(rapidjson::kObjectType);
+    phase.AddMember("count", summary_phase.count, allocator);
+    phase.AddMember("meanMicros", summary_phase.mean.ToMicroseconds(),
+                    allocator);
+    phase.AddMember("p50Micros", summary_phase.p50.ToMicroseconds(),
+                    allocator);
+    phase.AddMember("p90Micros", summary_phase.p90.ToMicroseconds(),
+                    allocator);
+    phase.AddMember("p99Micros", summary_phase.p99.ToMicroseconds(),
+                    allocator);
+    phase.AddMember("maxMicros", summary_phase.max.ToMicroseconds(),
+                    allocator);
+    phases.AddMember(rapidjson::StringRef(FrameStatistics::GetPhaseName(
+                         static_cast<FrameStatistics::Phase>(i))),
+                     phase, allocator);
+  }
+  response.AddMember("phases", phases, allocator);
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
@@ -1455,4 +1638,12 @@ std::shared_ptr<fml::SyncSwitch> Shell::GetIsGpuDisabledSyncSwitch() const {
   return is_gpu_disabled_sync_switch_;
 }
 
+std::shared_ptr<IdleTaskQueue> Shell::GetIdleTaskQueue() const {
+  return idle_task_queue_;
+}
+
+std::shared_ptr<FrameStatistics> Shell::GetFrameStatistics() const {
+  return frame_statistics_;
+}
+
 }  // namespace flutter
@@ -11,6 +11,7 @@
 
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
+#include "flutter/flow/frame_statistics.h"
 #include "flutter/flow/texture.h"
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
@@ -28,6 +29,7 @@
 #include "flutter/runtime/service_protocol.h"
 #include "flutter/shell/common/animator.h"
 #include "flutter/shell/common/engine.h"
+#include "flutter/shell/common/idle_task_queue.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/shell_io_manager.h"
@@ -352,6 +354,25 @@ class Shell final : public PlatformView::Delegate,
   /// @brief     Accessor for the disable GPU SyncSwitch
   std::shared_ptr<fml::SyncSwitch> GetIsGpuDisabledSyncSwitch() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Accessor for the queue of tasks that run on the UI task runner
+  ///             in the slack between frames. Work such as warming caches or
+  ///             prefetching resources may be posted to it from any thread.
+  ///
+  /// @return     The idle task queue.
+  ///
+  std::shared_ptr<IdleTaskQueue> GetIdleTaskQueue() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Accessor for the statistics of the frames produced by this
+  ///             shell. These aggregate the build and raster times of every
+  ///             frame since the shell was created or the statistics were last
+  ///             reset, whether or not the performance overlay is shown.
+  ///
+  /// @return     The frame statistics.
+  ///
+  std::shared_ptr<FrameStatistics> GetFrameStatistics() const;
+
   //----------------------------------------------------------------------------
   /// @brief      Get a pointer to the Dart VM used by this running shell
   ///             instance.
@@ -373,6 +394,10 @@ class Shell final : public PlatformView::Delegate,
   std::unique_ptr<Rasterizer> rasterizer_;       // on GPU task runner
   std::unique_ptr<ShellIOManager> io_manager_;   // on IO task runner
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
+  std::shared_ptr<IdleTaskQueue> idle_task_queue_;
+  std::shared_ptr<FrameStatistics> frame_statistics_;
+  // Only with |Settings::enable_adaptive_pipeline_depth|.
+  std::shared_ptr<PipelineDepthController> pipeline_depth_controller_;
 
   fml::WeakPtr<Engine> weak_engine_;          // to be shared across threads
   fml::WeakPtr<Rasterizer> weak_rasterizer_;  // to be shared across threads
@@ -490,6 +515,9 @@ class Shell final : public PlatformView::Delegate,
   // |Animator::Delegate|
   void OnAnimatorDrawLastLayerTree() override;
 
+  // |Animator::Delegate|
+  void OnAnimatorFrameDropped() override;
+
   // |Engine::Delegate|
   void OnEngineUpdateSemantics(
       SemanticsNodeUpdates update,
@@ -517,6 +545,9 @@ class Shell final : public PlatformView::Delegate,
   // |Rasterizer::Delegate|
   fml::Milliseconds GetFrameBudget() override;
 
+  // |Rasterizer::Delegate|
+  void OnFrameDropped() override;
+
   // |ServiceProtocol::Handler|
   fml::RefPtr<fml::TaskRunner> GetServiceProtocolHandlerTaskRunner(
       std::string_view method) const override;
@@ -561,6 +592,21 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document& response);
 
+  // Service protocol handler
+  bool OnServiceProtocolSetTraceRecorderEnabled(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
+  // Service protocol handler
+  bool OnServiceProtocolGetRecordedTrace(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
+  // Service protocol handler
+  bool OnServiceProtocolGetFrameStatistics(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
   fml::WeakPtrFactory<Shell> weak_factory_;
 
   // For accessing the Shell via the GPU thread, necessary for various
@@ -11,9 +11,41 @@
 
 namespace flutter {
 
-static void StartupAndShutdownShell(benchmark::State& state,
-                                    bool measure_startup,
-                                    bool measure_shutdown) {
+// How the AOT snapshots are mapped. See |Settings::populate_snapshots| and
+// |Settings::prefetch_snapshots|.
+enum class SnapshotLoading {
+  kOnDemand,
+  kPopulate,
+  kPrefetch,
+};
+
+static std::unique_ptr<fml::FileMapping> MapSnapshot(
+    const fml::UniqueFD& assets_dir,
+    const char* name,
+    bool executable,
+    SnapshotLoading loading) {
+  using Hint = fml::FileMapping::Hint;
+  auto map = [&](std::initializer_list<Hint> hints) {
+    return executable
+               ? fml::FileMapping::CreateReadExecute(assets_dir, name, hints)
+               : fml::FileMapping::CreateReadOnly(assets_dir, name, hints);
+  };
+  switch (loading) {
+    case SnapshotLoading::kOnDemand:
+      return map({});
+    case SnapshotLoading::kPopulate:
+      return map({Hint::kPopulate, Hint::kHugePages});
+    case SnapshotLoading::kPrefetch:
+      return map({Hint::kWillNeed, Hint::kHugePages});
+  }
+  return nullptr;
+}
+
+static void StartupAndShutdownShell(
+    benchmark::State& state,
+    bool measure_startup,
+    bool measure_shutdown,
+    SnapshotLoading loading = SnapshotLoading::kOnDemand) {
   auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
                                        fml::FilePermission::kRead);
   std::unique_ptr<Shell> shell;
@@ -23,25 +55,29 @@ static void StartupAndShutdownShell(benchmark::State& state,
     Settings settings = {};
     settings.task_observer_add = [](intptr_t, fml::closure) {};
     settings.task_observer_remove = [](intptr_t) {};
+    settings.populate_snapshots = loading == SnapshotLoading::kPopulate;
+    settings.prefetch_snapshots = loading == SnapshotLoading::kPrefetch;
+    // The VM, and the snapshots it mapped, would otherwise outlive the first
+    // iteration, so the later ones would not load the snapshots at all.
+    settings.leak_vm = false;
 
     if (DartVM::IsRunningPrecompiledCode()) {
       settings.vm_snapshot_data = [&]() {
-        return fml::FileMapping::CreateReadOnly(assets_dir, "vm_snapshot_data");
+        return MapSnapshot(assets_dir, "vm_snapshot_data", false, loading);
       };
 
       settings.isolate_snapshot_data = [&]() {
-        return fml::FileMapping::CreateReadOnly(assets_dir,
-                                                "isolate_snapshot_data");
+        return MapSnapshot(assets_dir, "isolate_snapshot_data", false,
+                           loading);
       };
 
       settings.vm_snapshot_instr = [&]() {
-        return fml::FileMapping::CreateReadExecute(assets_dir,
-                                                   "vm_snapshot_instr");
+        return MapSnapshot(assets_dir, "vm_snapshot_instr", true, loading);
       };
 
       settings.isolate_snapshot_instr = [&]() {
-        return fml::FileMapping::CreateReadExecute(assets_dir,
-                                                   "isolate_snapshot_instr");
+        return MapSnapshot(assets_dir, "isolate_snapshot_instr", true,
+                           loading);
       };
 
     } else {
@@ -93,13 +129,19 @@ static void StartupAndShutdownShell(benchmark::State& state,
   FML_CHECK(!shell);
 }
 
+// The argument is the |SnapshotLoading| used. It only makes a difference when
+// running precompiled code.
 static void BM_ShellInitialization(benchmark::State& state) {
+  const auto loading = static_cast<SnapshotLoading>(state.range(0));
   while (state.KeepRunning()) {
-    StartupAndShutdownShell(state, true, false);
+    StartupAndShutdownShell(state, true, false, loading);
   }
 }
 
-BENCHMARK(BM_ShellInitialization);
+BENCHMARK(BM_ShellInitialization)
+    ->Arg(static_cast<int>(SnapshotLoading::kOnDemand))
+    ->Arg(static_cast<int>(SnapshotLoading::kPopulate))
+    ->Arg(static_cast<int>(SnapshotLoading::kPrefetch));
 
 static void BM_ShellShutdown(benchmark::State& state) {
   while (state.KeepRunning()) {
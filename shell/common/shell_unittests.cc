@@ -1129,5 +1129,47 @@ TEST_F(ShellTest, CanDecompressImageFromAsset) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, CanLoadAssetThroughPlatformMessage) {
+  // Any fixture larger than the threshold above which responses may be
+  // handed to Dart without a copy will do.
+  const std::string asset_name = DartVM::IsRunningPrecompiledCode()
+                                     ? "app_elf_snapshot.so"
+                                     : "kernel_blob.bin";
+  auto fixture = OpenFixtureAsMapping(asset_name);
+  ASSERT_TRUE(fixture);
+  ASSERT_GT(fixture->GetSize(), 1000u);
+
+  AddNativeCallback("GetLargeAssetName", CREATE_NATIVE_ENTRY([&](auto args) {
+                      Dart_SetReturnValue(args, tonic::ToDart(asset_name));
+                    }));
+
+  fml::AutoResetWaitableEvent latch;
+  AddNativeCallback("NotifyAssetLoaded", CREATE_NATIVE_ENTRY([&](auto args) {
+                      auto length = tonic::DartConverter<int64_t>::FromDart(
+                          Dart_GetNativeArgument(args, 0));
+                      auto first_byte = tonic::DartConverter<int64_t>::FromDart(
+                          Dart_GetNativeArgument(args, 1));
+                      auto written_byte =
+                          tonic::DartConverter<int64_t>::FromDart(
+                              Dart_GetNativeArgument(args, 2));
+                      ASSERT_EQ(length,
+                                static_cast<int64_t>(fixture->GetSize()));
+                      ASSERT_EQ(first_byte, fixture->GetMapping()[0]);
+                      // The asset itself is left alone.
+                      ASSERT_EQ(written_byte, first_byte ^ 0xff);
+                      ASSERT_EQ(fixture->GetMapping()[0], first_byte);
+                      latch.Signal();
+                    }));
+
+  auto settings = CreateSettingsForFixture();
+  auto configuration = RunConfiguration::InferFromSettings(settings);
+  configuration.SetEntrypoint("canLoadAssetThroughPlatformMessage");
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  ASSERT_NE(shell.get(), nullptr);
+  RunEngine(shell.get(), std::move(configuration));
+  latch.Wait();
+  DestroyShell(std::move(shell));
+}
+
 }  // namespace testing
 }  // namespace flutter
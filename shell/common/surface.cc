@@ -11,10 +11,12 @@ namespace flutter {
 
 SurfaceFrame::SurfaceFrame(sk_sp<SkSurface> surface,
                            bool supports_readback,
-                           const SubmitCallback& submit_callback)
+                           const SubmitCallback& submit_callback,
+                           bool retains_previous_frame)
     : submitted_(false),
       surface_(surface),
       supports_readback_(supports_readback),
+      retains_previous_frame_(retains_previous_frame),
       submit_callback_(submit_callback) {
   FML_DCHECK(submit_callback_);
 }
@@ -6,11 +6,13 @@
 #define FLUTTER_SHELL_COMMON_SURFACE_H_
 
 #include <memory>
+#include <optional>
 
 #include "flutter/flow/compositor_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkRegion.h"
 
 namespace flutter {
 
@@ -23,7 +25,8 @@ class SurfaceFrame {
 
   SurfaceFrame(sk_sp<SkSurface> surface,
                bool supports_readback,
-               const SubmitCallback& submit_callback);
+               const SubmitCallback& submit_callback,
+               bool retains_previous_frame = false);
 
   ~SurfaceFrame();
 
@@ -35,10 +38,24 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  /// Whether the surface still holds the pixels of the last frame submitted
+  /// to it, in which case only the parts of this frame that changed need to
+  /// be painted.
+  bool retains_previous_frame() const { return retains_previous_frame_; }
+
+  /// The region of the surface (in physical pixels) painted for this frame,
+  /// if known. The submit callback may use it to only present the parts of
+  /// the surface that changed.
+  const std::optional<SkRegion>& damage() const { return damage_; }
+
+  void set_damage(const SkRegion& damage) { damage_ = damage; }
+
  private:
   bool submitted_;
   sk_sp<SkSurface> surface_;
   bool supports_readback_;
+  bool retains_previous_frame_;
+  std::optional<SkRegion> damage_;
   SubmitCallback submit_callback_;
 
   bool PerformSubmit();
@@ -275,9 +275,36 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.trace_systrace =
       command_line.HasOption(FlagForSwitch(Switch::TraceSystrace));
 
+  settings.trace_recorder =
+      command_line.HasOption(FlagForSwitch(Switch::TraceRecorder));
+
   settings.skia_deterministic_rendering_on_cpu =
       command_line.HasOption(FlagForSwitch(Switch::SkiaDeterministicRendering));
 
+  settings.enable_async_raster_cache_population = command_line.HasOption(
+      FlagForSwitch(Switch::EnableAsyncRasterCachePopulation));
+
+  settings.enable_tiled_software_rasterization = command_line.HasOption(
+      FlagForSwitch(Switch::EnableTiledSoftwareRasterization));
+
+  settings.enable_parallel_preroll =
+      command_line.HasOption(FlagForSwitch(Switch::EnableParallelPreroll));
+
+  settings.enable_adaptive_pipeline_depth = command_line.HasOption(
+      FlagForSwitch(Switch::EnableAdaptivePipelineDepth));
+
+  settings.profile_frame_flushes =
+      command_line.HasOption(FlagForSwitch(Switch::ProfileFrameFlushes));
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::AnimatedImageDecodeAheadBytes))) {
+    if (!GetSwitchValue(command_line, Switch::AnimatedImageDecodeAheadBytes,
+                        &settings.animated_image_decode_ahead_bytes)) {
+      FML_LOG(INFO) << "Animated image decode ahead bytes specified was "
+                       "malformed. Frames will not be decoded ahead.";
+    }
+  }
+
   settings.verbose_logging =
       command_line.HasOption(FlagForSwitch(Switch::VerboseLogging));
 
@@ -323,6 +350,11 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
         {snapshot_asset_path, isolate_snapshot_instr_filename});
   }
 
+  settings.populate_snapshots =
+      command_line.HasOption(FlagForSwitch(Switch::PopulateSnapshots));
+  settings.prefetch_snapshots =
+      command_line.HasOption(FlagForSwitch(Switch::PrefetchSnapshots));
+
   command_line.GetOptionValue(FlagForSwitch(Switch::CacheDirPath),
                               &settings.temp_directory_path);
 
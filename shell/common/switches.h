@@ -49,6 +49,15 @@ DEF_SWITCH(IsolateSnapshotInstructions,
            "isolate-snapshot-instr",
            "The isolate instructions snapshot that will be memory mapped as "
            "read and executable. SnapshotAssetPath must be present.")
+DEF_SWITCH(PopulateSnapshots,
+           "populate-snapshots",
+           "Read the snapshots specified by SnapshotAssetPath in full when "
+           "they are memory mapped, instead of faulting their pages in one at "
+           "a time as they are accessed.")
+DEF_SWITCH(PrefetchSnapshots,
+           "prefetch-snapshots",
+           "Read the snapshots ahead on a background thread, so that their "
+           "pages are resident by the time they are accessed.")
 DEF_SWITCH(CacheDirPath,
            "cache-dir-path",
            "Path to the cache directory. "
@@ -103,6 +112,37 @@ DEF_SWITCH(SkiaDeterministicRendering,
            "Skips the call to SkGraphics::Init(), thus avoiding swapping out"
            "some Skia function pointers based on available CPU features. This"
            "is used to obtain 100% deterministic behavior in Skia rendering.")
+DEF_SWITCH(EnableAsyncRasterCachePopulation,
+           "enable-async-raster-cache-population",
+           "Rasterize pictures into the raster cache on worker threads instead "
+           "of the raster thread. Pictures are drawn directly until their "
+           "cached images are ready.")
+DEF_SWITCH(EnableTiledSoftwareRasterization,
+           "enable-tiled-software-rasterization",
+           "Split frames rendered with the software backend into tiles and "
+           "rasterize them in parallel on worker threads.")
+DEF_SWITCH(EnableParallelPreroll,
+           "enable-parallel-preroll",
+           "Preroll the children of layers with many children in parallel on "
+           "worker threads. Frames with platform views are always prerolled "
+           "on the raster thread alone.")
+DEF_SWITCH(EnableAdaptivePipelineDepth,
+           "enable-adaptive-pipeline-depth",
+           "Pick the number of frames that may be in flight between the UI and "
+           "raster threads from how long recent frames took to build and "
+           "rasterize, between 1 and 3. Pointer input keeps it at 2 or less "
+           "for a short while.")
+DEF_SWITCH(ProfileFrameFlushes,
+           "profile-frame-flushes",
+           "Flush the canvas of each frame before presenting it, so that the "
+           "frame statistics report the time spent flushing and presenting "
+           "frames separately.")
+DEF_SWITCH(AnimatedImageDecodeAheadBytes,
+           "animated-image-decode-ahead-bytes",
+           "The number of bytes of frames that animated images may decode on "
+           "the IO thread before they are shown, shared by all animated "
+           "images. Defaults to zero, which only decodes frames when they are "
+           "requested.")
 DEF_SWITCH(FlutterAssetsDir,
            "flutter-assets-dir",
            "Path to the Flutter assets directory.")
@@ -146,6 +186,12 @@ DEF_SWITCH(
     "Trace to the system tracer (instead of the timeline) on platforms where "
     "such a tracer is available. Currently only supported on Android and "
     "Fuchsia.")
+DEF_SWITCH(TraceRecorder,
+           "trace-recorder",
+           "Record trace events into in-memory ring buffers from startup. The "
+           "recorded events can be exported as Chrome trace event JSON with "
+           "the _flutter.getRecordedTrace service protocol method. This does "
+           "not depend on the Dart timeline.")
 DEF_SWITCH(UseTestFonts,
            "use-test-fonts",
            "Running tests that layout and measure text will not yield "
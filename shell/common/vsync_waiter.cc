@@ -100,7 +100,8 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
 
     TRACE_FLOW_BEGIN("flutter", kVsyncFlowName, flow_identifier);
 
-    task_runners_.GetUITaskRunner()->PostTaskForTime(
+    // The frame runs ahead of other work that is due on the UI thread.
+    task_runners_.GetUITaskRunner()->PostTaskForTimeWithPriority(
         [callback, flow_identifier, frame_start_time, frame_target_time]() {
           FML_TRACE_EVENT("flutter", "VsyncProcessCallback", "StartTime",
                           frame_start_time, "TargetTime", frame_target_time);
@@ -110,7 +111,7 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
           callback(frame_start_time, frame_target_time);
           TRACE_FLOW_END("flutter", kVsyncFlowName, flow_identifier);
         },
-        frame_start_time);
+        frame_start_time, fml::TaskPriority::kVsync);
   }
 
   if (secondary_callback) {
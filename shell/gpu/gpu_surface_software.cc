@@ -56,6 +56,12 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  const bool retains_previous_frame =
+      backing_store == last_presented_backing_store_;
+  // Until this frame is presented, the contents of the backing store are
+  // unknown.
+  last_presented_backing_store_ = nullptr;
+
   SurfaceFrame::SubmitCallback on_submit =
       [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) -> bool {
@@ -66,10 +72,20 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    const std::optional<SkRegion>& damage = surface_frame.damage();
+    const bool presented =
+        damage ? self->delegate_->PresentBackingStoreRegion(
+                     surface_frame.SkiaSurface(), *damage)
+               : self->delegate_->PresentBackingStore(
+                     surface_frame.SkiaSurface());
+    if (presented) {
+      self->last_presented_backing_store_ = surface_frame.SkiaSurface();
+    }
+    return presented;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit,
+                                        retains_previous_frame);
 }
 
 // |Surface|
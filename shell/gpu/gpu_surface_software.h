@@ -41,6 +41,10 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  // The backing store of the last frame that was presented successfully. If
+  // the delegate hands it out again, it still holds the pixels of that frame
+  // and only the damaged parts of the next frame have to be painted.
+  sk_sp<SkSurface> last_presented_backing_store_;
   fml::WeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
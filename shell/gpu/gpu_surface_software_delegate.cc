@@ -12,4 +12,10 @@ ExternalViewEmbedder* GPUSurfaceSoftwareDelegate::GetExternalViewEmbedder() {
   return nullptr;
 }
 
+bool GPUSurfaceSoftwareDelegate::PresentBackingStoreRegion(
+    sk_sp<SkSurface> backing_store,
+    const SkRegion& damage) {
+  return PresentBackingStore(std::move(backing_store));
+}
+
 }  // namespace flutter
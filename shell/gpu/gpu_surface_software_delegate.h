@@ -8,6 +8,7 @@
 #include "flutter/flow/embedded_views.h"
 #include "flutter/fml/macros.h"
 #include "flutter/shell/gpu/gpu_surface_delegate.h"
+#include "third_party/skia/include/core/SkRegion.h"
 #include "third_party/skia/include/core/SkSurface.h"
 
 namespace flutter {
@@ -52,6 +53,24 @@ class GPUSurfaceSoftwareDelegate : public GPUSurfaceDelegate {
   ///             the screen.
   ///
   virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store) = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Called instead of |PresentBackingStore| when the rasterizer
+  ///             knows which parts of the backing store changed since it was
+  ///             last presented. Platforms that can update parts of the
+  ///             "screen" may override this to copy less. The default
+  ///             implementation presents the whole backing store.
+  ///
+  /// @param[in]  backing_store  The software backing store to present.
+  /// @param[in]  damage         The region of the backing store (in physical
+  ///                            pixels) that changed since it was last
+  ///                            presented. May be empty.
+  ///
+  /// @return     Returns if the platform could present the backing store onto
+  ///             the screen.
+  ///
+  virtual bool PresentBackingStoreRegion(sk_sp<SkSurface> backing_store,
+                                         const SkRegion& damage);
 };
 
 }  // namespace flutter
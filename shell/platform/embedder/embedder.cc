@@ -5,6 +5,8 @@
 #define FML_USED_ON_EMBEDDER
 #define RAPIDJSON_HAS_STDSTRING 1
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include "flutter/fml/build_config.h"
@@ -35,11 +37,13 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
+#include "flutter/fml/trace_recorder.h"
 #include "flutter/shell/common/persistent_cache.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/platform/embedder/embedder.h"
 #include "flutter/shell/platform/embedder/embedder_engine.h"
+#include "flutter/shell/platform/embedder/embedder_headless_renderer.h"
 #include "flutter/shell/platform/embedder/embedder_platform_message_response.h"
 #include "flutter/shell/platform/embedder/embedder_render_target.h"
 #include "flutter/shell/platform/embedder/embedder_safe_access.h"
@@ -255,9 +259,35 @@ InferSoftwarePlatformViewCreationCallback(
     return ptr(user_data, allocation, row_bytes, height);
   };
 
+  std::function<bool(const void* allocation, size_t row_bytes, size_t height,
+                     const SkRegion& damage)>
+      software_present_backing_store_with_damage = nullptr;
+  const FlutterSoftwareRendererConfig* software_config = &config->software;
+  if (SAFE_ACCESS(software_config, surface_present_with_damage_callback,
+                  nullptr) != nullptr) {
+    software_present_backing_store_with_damage =
+        [ptr = config->software.surface_present_with_damage_callback,
+         user_data](const void* allocation, size_t row_bytes, size_t height,
+                    const SkRegion& damage) -> bool {
+      std::vector<FlutterRect> damage_rects;
+      for (SkRegion::Iterator it(damage); !it.done(); it.next()) {
+        const SkIRect& rect = it.rect();
+        damage_rects.push_back({
+            static_cast<double>(rect.left()),   // left
+            static_cast<double>(rect.top()),    // top
+            static_cast<double>(rect.right()),  // right
+            static_cast<double>(rect.bottom())  // bottom
+        });
+      }
+      return ptr(user_data, allocation, row_bytes, height, damage_rects.data(),
+                 damage_rects.size());
+    };
+  }
+
   flutter::EmbedderSurfaceSoftware::SoftwareDispatchTable
       software_dispatch_table = {
-          software_present_backing_store,  // required
+          software_present_backing_store,              // required
+          software_present_backing_store_with_damage,  // optional
       };
 
   return fml::MakeCopyable(
@@ -301,6 +331,32 @@ InferPlatformViewCreationCallback(
   return nullptr;
 }
 
+static flutter::Shell::CreateCallback<flutter::PlatformView>
+InferHeadlessPlatformViewCreationCallback(
+    std::shared_ptr<flutter::EmbedderHeadlessRenderer> headless_renderer,
+    flutter::PlatformViewEmbedder::PlatformDispatchTable
+        platform_dispatch_table) {
+  flutter::EmbedderSurfaceSoftware::SoftwareDispatchTable
+      software_dispatch_table = {
+          [headless_renderer](const void* allocation, size_t row_bytes,
+                              size_t height) -> bool {
+            return headless_renderer->Present(allocation, row_bytes, height);
+          },        // required
+          nullptr,  // optional
+      };
+
+  return [software_dispatch_table,
+          platform_dispatch_table](flutter::Shell& shell) {
+    return std::make_unique<flutter::PlatformViewEmbedder>(
+        shell,                    // delegate
+        shell.GetTaskRunners(),   // task runners
+        software_dispatch_table,  // software dispatch table
+        platform_dispatch_table,  // platform dispatch table
+        nullptr                   // external view embedder
+    );
+  };
+}
+
 static sk_sp<SkSurface> MakeSkSurfaceFromBackingStore(
     GrContext* context,
     const FlutterBackingStoreConfig& config,
@@ -589,12 +645,15 @@ FlutterEngineResult FlutterEngineRun(size_t version,
   return FlutterEngineRunInitialized(*engine_out);
 }
 
-FlutterEngineResult FlutterEngineInitialize(size_t version,
-                                            const FlutterRendererConfig* config,
-                                            const FlutterProjectArgs* args,
-                                            void* user_data,
-                                            FLUTTER_API_SYMBOL(FlutterEngine) *
-                                                engine_out) {
+// Initializes an engine that renders with |config|, or with
+// |headless_renderer| instead if it is not null.
+static FlutterEngineResult InitializeEngine(
+    size_t version,
+    const FlutterRendererConfig* config,
+    std::shared_ptr<flutter::EmbedderHeadlessRenderer> headless_renderer,
+    const FlutterProjectArgs* args,
+    void* user_data,
+    FLUTTER_API_SYMBOL(FlutterEngine) * engine_out) {
   // Step 0: Figure out arguments for shell creation.
   if (version != FLUTTER_ENGINE_VERSION) {
     return LOG_EMBEDDER_ERROR(
@@ -629,7 +688,7 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
                         "should be set null.";
   }
 
-  if (!IsRendererValid(config)) {
+  if (!headless_renderer && !IsRendererValid(config)) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments,
                               "The renderer configuration was invalid.");
   }
@@ -665,6 +724,15 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   settings.assets_path = args->assets_path;
   settings.leak_vm = !SAFE_ACCESS(args, shutdown_dart_vm_when_done, false);
   settings.old_gen_heap_size = SAFE_ACCESS(args, dart_old_gen_heap_size, -1);
+  if (headless_renderer) {
+    // Headless frames are not paced by a display, so there is no latency to
+    // trade for throughput. A fixed depth also lets the headless renderer keep
+    // the pipeline full.
+    settings.enable_adaptive_pipeline_depth = false;
+    settings.frame_dropped_callback = [headless_renderer]() {
+      headless_renderer->DropFrame();
+    };
+  }
 
   if (!flutter::DartVM::IsRunningPrecompiledCode()) {
     // Verify the assets path contains Dart 2 kernel assets.
@@ -798,7 +866,11 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   }
 
   flutter::VsyncWaiterEmbedder::VsyncCallback vsync_callback = nullptr;
-  if (SAFE_ACCESS(args, vsync_callback, nullptr) != nullptr) {
+  if (headless_renderer) {
+    vsync_callback = [headless_renderer](intptr_t baton) {
+      headless_renderer->AwaitVsync(baton);
+    };
+  } else if (SAFE_ACCESS(args, vsync_callback, nullptr) != nullptr) {
     vsync_callback = [ptr = args->vsync_callback, user_data](intptr_t baton) {
       return ptr(user_data, baton);
     };
@@ -819,9 +891,13 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
           vsync_callback,                            //
       };
 
-  auto on_create_platform_view = InferPlatformViewCreationCallback(
-      config, user_data, platform_dispatch_table,
-      std::move(external_view_embedder_result.first));
+  auto on_create_platform_view =
+      headless_renderer
+          ? InferHeadlessPlatformViewCreationCallback(headless_renderer,
+                                                      platform_dispatch_table)
+          : InferPlatformViewCreationCallback(
+                config, user_data, platform_dispatch_table,
+                std::move(external_view_embedder_result.first));
 
   if (!on_create_platform_view) {
     return LOG_EMBEDDER_ERROR(
@@ -839,7 +915,7 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   // platform view jump table.
   flutter::EmbedderExternalTextureGL::ExternalTextureCallback
       external_texture_callback;
-  if (config->type == kOpenGL) {
+  if (config != nullptr && config->type == kOpenGL) {
     const FlutterOpenGLRendererConfig* open_gl_config = &config->open_gl;
     if (SAFE_ACCESS(open_gl_config, gl_external_texture_frame_callback,
                     nullptr) != nullptr) {
@@ -894,9 +970,12 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
     }
   }
 
+  using flutter::EmbedderThreadHost;
   auto thread_host =
-      flutter::EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
-          SAFE_ACCESS(args, custom_task_runners, nullptr));
+      headless_renderer
+          ? EmbedderThreadHost::CreateSharedThreadHost()
+          : EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
+                SAFE_ACCESS(args, custom_task_runners, nullptr));
 
   if (!thread_host || !thread_host->IsValid()) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments,
@@ -935,7 +1014,8 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
       std::move(run_configuration),  //
       on_create_platform_view,       //
       on_create_rasterizer,          //
-      external_texture_callback      //
+      external_texture_callback,     //
+      std::move(headless_renderer)   //
   );
 
   // Release the ownership of the embedder engine to the caller.
@@ -944,6 +1024,119 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineInitialize(size_t version,
+                                            const FlutterRendererConfig* config,
+                                            const FlutterProjectArgs* args,
+                                            void* user_data,
+                                            FLUTTER_API_SYMBOL(FlutterEngine) *
+                                                engine_out) {
+  return InitializeEngine(version, config, nullptr, args, user_data,
+                          engine_out);
+}
+
+FlutterEngineResult FlutterEngineRunHeadless(
+    size_t version,
+    const FlutterHeadlessRendererConfig* config,
+    const FlutterProjectArgs* args,
+    void* user_data,
+    FLUTTER_API_SYMBOL(FlutterEngine) * engine_out) {
+  if (config == nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments, "The headless renderer configuration was missing.");
+  }
+
+  const FlutterWindowMetricsEvent metrics = {
+      sizeof(FlutterWindowMetricsEvent),      // struct_size
+      SAFE_ACCESS(config, width, 0u),         // width
+      SAFE_ACCESS(config, height, 0u),        // height
+      SAFE_ACCESS(config, pixel_ratio, 1.0),  // pixel_ratio
+  };
+
+  if (metrics.width == 0 || metrics.height == 0 || metrics.pixel_ratio <= 0.0) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "The headless renderer configuration was invalid. The size must not "
+        "be empty and the pixel ratio must be greater than zero.");
+  }
+
+  if (args != nullptr &&
+      (SAFE_ACCESS(args, vsync_callback, nullptr) != nullptr ||
+       SAFE_ACCESS(args, compositor, nullptr) != nullptr ||
+       SAFE_ACCESS(args, custom_task_runners, nullptr) != nullptr)) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "Headless engines may not specify a vsync callback, a compositor or "
+        "custom task runners.");
+  }
+
+  auto headless_renderer = std::make_shared<flutter::EmbedderHeadlessRenderer>(
+      SkISize::Make(metrics.width, metrics.height));
+
+  auto result = InitializeEngine(version, nullptr, std::move(headless_renderer),
+                                 args, user_data, engine_out);
+  if (result != kSuccess) {
+    return result;
+  }
+
+  result = FlutterEngineRunInitialized(*engine_out);
+  if (result != kSuccess) {
+    return result;
+  }
+
+  return FlutterEngineSendWindowMetricsEvent(*engine_out, &metrics);
+}
+
+FlutterEngineResult FlutterEngineRenderHeadlessFrames(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    const FlutterHeadlessFrames* frames) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  auto headless_renderer = engine->GetHeadlessRenderer();
+  if (!headless_renderer) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Engine was not run with "
+                              "FlutterEngineRunHeadless.");
+  }
+
+  if (frames == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Frames were null.");
+  }
+
+  const size_t frame_count = SAFE_ACCESS(frames, frame_count, 0u);
+  void* const* buffers = SAFE_ACCESS(frames, buffers, nullptr);
+  if (frame_count != 0 && buffers == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Frame buffers were null.");
+  }
+
+  std::vector<void*> frame_buffers(buffers, buffers + frame_count);
+  if (std::find(frame_buffers.begin(), frame_buffers.end(), nullptr) !=
+      frame_buffers.end()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "A frame buffer was null.");
+  }
+
+  const size_t row_bytes = SAFE_ACCESS(frames, row_bytes, 0u);
+  if (row_bytes < 4u * headless_renderer->GetSize().width()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Frame buffer rows were too short.");
+  }
+
+  switch (engine->RenderHeadlessFrames(std::move(frame_buffers), row_bytes)) {
+    case flutter::EmbedderHeadlessRenderer::RenderStatus::kSuccess:
+      return kSuccess;
+    case flutter::EmbedderHeadlessRenderer::RenderStatus::kBusy:
+      return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                                "Frames were already being rendered.");
+    case flutter::EmbedderHeadlessRenderer::RenderStatus::kFailed:
+      break;
+  }
+  return LOG_EMBEDDER_ERROR(kInternalInconsistency,
+                            "Frames were dropped or the engine was shut down "
+                            "before every frame was rendered.");
+}
+
 FlutterEngineResult FlutterEngineRunInitialized(
     FLUTTER_API_SYMBOL(FlutterEngine) engine) {
   if (!engine) {
@@ -1465,6 +1658,92 @@ void FlutterEngineTraceEventInstant(const char* name) {
   fml::tracing::TraceEventInstant0("flutter", name);
 }
 
+void FlutterEngineTraceRecorderSetEnabled(bool enabled) {
+  auto& recorder = fml::tracing::TraceRecorder::GetInstance();
+  if (enabled) {
+    recorder.Clear();
+    recorder.Start();
+  } else {
+    recorder.Stop();
+  }
+}
+
+FlutterEngineResult FlutterEngineTraceRecorderExport(
+    FlutterDataCallback callback,
+    void* user_data) {
+  if (callback == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Trace export callback was null.");
+  }
+
+  const auto json =
+      fml::tracing::TraceRecorder::GetInstance().ExportChromeJSON();
+  callback(reinterpret_cast<const uint8_t*>(json.data()), json.size(),
+           user_data);
+  return kSuccess;
+}
+
+static FlutterFramePhaseStatistics ToFlutterFramePhaseStatistics(
+    const flutter::FrameStatistics::PhaseSummary& phase) {
+  FlutterFramePhaseStatistics statistics = {};
+  statistics.count = phase.count;
+  statistics.mean_micros = phase.mean.ToMicroseconds();
+  statistics.p50_micros = phase.p50.ToMicroseconds();
+  statistics.p90_micros = phase.p90.ToMicroseconds();
+  statistics.p99_micros = phase.p99.ToMicroseconds();
+  statistics.max_micros = phase.max.ToMicroseconds();
+  return statistics;
+}
+
+FlutterEngineResult FlutterEngineGetFrameStatistics(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterFrameStatistics* statistics) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (statistics == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Frame statistics were null.");
+  }
+
+  const auto summary = engine->GetShell().GetFrameStatistics()->GetSummary();
+  using Phase = flutter::FrameStatistics::Phase;
+
+  FlutterFrameStatistics result = {};
+  result.struct_size = statistics->struct_size;
+  result.built_frame_count = summary.built_frames;
+  result.rasterized_frame_count = summary.rasterized_frames;
+  result.missed_build_frame_count = summary.missed_build_frames;
+  result.missed_raster_frame_count = summary.missed_raster_frames;
+  result.build = ToFlutterFramePhaseStatistics(summary.phases[Phase::kBuild]);
+  result.raster = ToFlutterFramePhaseStatistics(summary.phases[Phase::kRaster]);
+  result.preroll =
+      ToFlutterFramePhaseStatistics(summary.phases[Phase::kPreroll]);
+  result.paint = ToFlutterFramePhaseStatistics(summary.phases[Phase::kPaint]);
+  result.flush = ToFlutterFramePhaseStatistics(summary.phases[Phase::kFlush]);
+  result.present =
+      ToFlutterFramePhaseStatistics(summary.phases[Phase::kPresent]);
+
+  // Embedders built against older versions of this header may pass a smaller
+  // struct. Only fill in the members they know about.
+  std::memcpy(statistics, &result,
+              std::min(statistics->struct_size, sizeof(result)));
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineResetFrameStatistics(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  engine->GetShell().GetFrameStatistics()->Reset();
+  return kSuccess;
+}
+
 FlutterEngineResult FlutterEnginePostRenderThreadTask(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     VoidCallback callback,
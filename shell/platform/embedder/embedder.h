@@ -258,6 +258,13 @@ typedef struct {
   VoidCallback destruction_callback;
 } FlutterOpenGLFramebuffer;
 
+typedef struct {
+  double left;
+  double top;
+  double right;
+  double bottom;
+} FlutterRect;
+
 typedef bool (*BoolCallback)(void* /* user data */);
 typedef FlutterTransformation (*TransformationCallback)(void* /* user data */);
 typedef uint32_t (*UIntCallback)(void* /* user data */);
@@ -265,6 +272,13 @@ typedef bool (*SoftwareSurfacePresentCallback)(void* /* user data */,
                                                const void* /* allocation */,
                                                size_t /* row bytes */,
                                                size_t /* height */);
+typedef bool (*SoftwareSurfacePresentWithDamageCallback)(
+    void* /* user data */,
+    const void* /* allocation */,
+    size_t /* row bytes */,
+    size_t /* height */,
+    const FlutterRect* /* damage rects */,
+    size_t /* damage rect count */);
 typedef void* (*ProcResolver)(void* /* user data */, const char* /* name */);
 typedef bool (*TextureFrameCallback)(void* /* user data */,
                                      int64_t /* texture identifier */,
@@ -319,6 +333,13 @@ typedef struct {
   /// format. The buffer is owned by the Flutter engine and must be copied in
   /// this callback if needed.
   SoftwareSurfacePresentCallback surface_present_callback;
+  /// An optional callback used instead of `surface_present_callback`. In
+  /// addition to the buffer, it receives the rectangles (in physical pixels)
+  /// of the buffer that changed since the last buffer presented to the
+  /// embedder. The engine only repaints those parts of the buffer, so
+  /// embedders that copy the buffer may copy just the damaged rectangles. The
+  /// rectangles do not overlap and there may be none if nothing changed.
+  SoftwareSurfacePresentWithDamageCallback surface_present_with_damage_callback;
 } FlutterSoftwareRendererConfig;
 
 typedef struct {
@@ -457,13 +478,6 @@ typedef void (*FlutterDataCallback)(const uint8_t* /* data */,
                                     size_t /* size */,
                                     void* /* user data */);
 
-typedef struct {
-  double left;
-  double top;
-  double right;
-  double bottom;
-} FlutterRect;
-
 typedef struct {
   double x;
   double y;
@@ -959,6 +973,46 @@ typedef enum {
 typedef void (*FlutterNativeThreadCallback)(FlutterNativeThreadType type,
                                             void* user_data);
 
+/// The distribution of the time spent in one phase of the frames produced by
+/// an engine. Percentiles are accurate to within 1%.
+typedef struct {
+  /// The number of frames the phase was timed for.
+  uint64_t count;
+  uint64_t mean_micros;
+  uint64_t p50_micros;
+  uint64_t p90_micros;
+  uint64_t p99_micros;
+  uint64_t max_micros;
+} FlutterFramePhaseStatistics;
+
+/// Statistics of the frames produced by an engine since it was started or its
+/// statistics were last reset. Filled in by `FlutterEngineGetFrameStatistics`.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterFrameStatistics).
+  size_t struct_size;
+  /// The number of frames built by the UI thread.
+  uint64_t built_frame_count;
+  /// The number of frames rasterized by the render thread.
+  uint64_t rasterized_frame_count;
+  /// The number of frames that took longer than the frame interval to build.
+  uint64_t missed_build_frame_count;
+  /// The number of frames that took longer than the frame interval to
+  /// rasterize.
+  uint64_t missed_raster_frame_count;
+  /// The time the UI thread spent building each frame.
+  FlutterFramePhaseStatistics build;
+  /// The time the render thread spent rasterizing each frame. This includes
+  /// the preroll, paint, flush and present phases below.
+  FlutterFramePhaseStatistics raster;
+  FlutterFramePhaseStatistics preroll;
+  FlutterFramePhaseStatistics paint;
+  /// Only recorded when the engine is run with the
+  /// `--profile-frame-flushes` switch. Otherwise, the flushes are part of the
+  /// present phase.
+  FlutterFramePhaseStatistics flush;
+  FlutterFramePhaseStatistics present;
+} FlutterFrameStatistics;
+
 typedef struct {
   /// The size of this struct. Must be sizeof(FlutterProjectArgs).
   size_t struct_size;
@@ -1148,6 +1202,31 @@ typedef struct {
   int64_t dart_old_gen_heap_size;
 } FlutterProjectArgs;
 
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterHeadlessRendererConfig).
+  size_t struct_size;
+  /// Physical width of the frames.
+  size_t width;
+  /// Physical height of the frames.
+  size_t height;
+  /// Scale factor for the frames.
+  double pixel_ratio;
+} FlutterHeadlessRendererConfig;
+
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterHeadlessFrames).
+  size_t struct_size;
+  /// The number of frames to render.
+  size_t frame_count;
+  /// The `frame_count` buffers the frames are written to, in order. Each one
+  /// must hold `row_bytes` times the height of the frames. The pixel format is
+  /// the native 32-bit RGBA format, as with `FlutterSoftwareRendererConfig`.
+  void* const* buffers;
+  /// The number of bytes from the start of a row of pixels in a buffer to the
+  /// start of the next one. Must be at least 4 times the width of the frames.
+  size_t row_bytes;
+} FlutterHeadlessFrames;
+
 //------------------------------------------------------------------------------
 /// @brief      Initialize and run a Flutter engine instance and return a handle
 ///             to it. This is a convenience method for the pair of calls to
@@ -1257,6 +1336,65 @@ FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineRunInitialized(
     FLUTTER_API_SYMBOL(FlutterEngine) engine);
 
+//------------------------------------------------------------------------------
+/// @brief      Run a Flutter engine instance that renders offscreen, with the
+///             software renderer, only when asked to by
+///             `FlutterEngineRenderHeadlessFrames`. The window metrics of the
+///             engine are set from the renderer configuration. Like with
+///             `FlutterEngineRun`, the calling thread is the platform thread
+///             of the engine.
+///
+///             Headless engines are not gated by vsync, and their threads are
+///             managed by the engine. So the project arguments may not specify
+///             a `vsync_callback`, a `compositor` or `custom_task_runners`.
+///             All the headless engines in the process share a few sets of
+///             threads, the way all engines share the Dart VM, so that many of
+///             them can be run at once.
+///
+/// @param[in]  version    The Flutter embedder API version. Must be
+///                        FLUTTER_ENGINE_VERSION.
+/// @param[in]  config     The size and pixel ratio of the frames.
+/// @param[in]  args       The Flutter project arguments.
+/// @param      user_data  A user data baton passed back to embedders in
+///                        callbacks.
+/// @param[out] engine_out The engine handle on successful engine creation.
+///
+/// @return     The result of the call to run the Flutter engine.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineRunHeadless(
+    size_t version,
+    const FlutterHeadlessRendererConfig* config,
+    const FlutterProjectArgs* args,
+    void* user_data,
+    FLUTTER_API_SYMBOL(FlutterEngine) * engine_out);
+
+//------------------------------------------------------------------------------
+/// @brief      Render frames of an engine run with `FlutterEngineRunHeadless`
+///             as fast as possible, and return once they are all written to
+///             the given buffers. A frame is begun for every buffer, whether
+///             or not Dart code asked for one, and Dart code must render a
+///             scene for each one (the Flutter framework does). Frames are
+///             timestamped with the time they begin at. Between calls, the
+///             frames Dart code asks for are deferred to the next call.
+///
+///             May be called on any thread, but only once at a time for a
+///             given engine.
+///
+/// @param[in]  engine  An engine run with `FlutterEngineRunHeadless`.
+/// @param[in]  frames  The number of frames and the buffers to write them to.
+///
+/// @return     The result of the call. `kInternalInconsistency` if a frame
+///             was not rendered, because Dart code did not render a scene for
+///             it or its scene could not be drawn, or if the engine was shut
+///             down before every frame was written. The contents of the
+///             buffers are then undefined.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineRenderHeadlessFrames(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterHeadlessFrames* frames);
+
 FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineSendWindowMetricsEvent(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
@@ -1559,6 +1697,69 @@ void FlutterEngineTraceEventDurationEnd(const char* name);
 FLUTTER_EXPORT
 void FlutterEngineTraceEventInstant(const char* name);
 
+//------------------------------------------------------------------------------
+/// @brief      A profiling utility. Starts or stops recording trace events
+///             into in-memory ring buffers. Unlike the timeline, this does not
+///             depend on the Dart VM, so it can be used before an engine is
+///             running or when the VM service is unavailable. While it is
+///             stopped, recording costs next to nothing. Can be called on any
+///             thread.
+///
+/// @param[in]  enabled  Whether trace events should be recorded.
+///
+FLUTTER_EXPORT
+void FlutterEngineTraceRecorderSetEnabled(bool enabled);
+
+//------------------------------------------------------------------------------
+/// @brief      A profiling utility. Exports the trace events recorded since
+///             recording was last enabled (via
+///             `FlutterEngineTraceRecorderSetEnabled`) as Chrome trace event
+///             JSON, which can be loaded in `chrome://tracing` and Perfetto.
+///             Each thread keeps only its most recent events. Can be called on
+///             any thread, including while events are being recorded.
+///
+/// @param[in]  callback   The callback invoked synchronously with the UTF-8
+///                        encoded JSON. The data is only valid for the
+///                        duration of the callback.
+/// @param[in]  user_data  The user data passed to the callback.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineTraceRecorderExport(
+    FlutterDataCallback callback,
+    void* user_data);
+
+//------------------------------------------------------------------------------
+/// @brief      A profiling utility. Gets the statistics of the frames produced
+///             by a running engine, aggregated since the engine was started or
+///             `FlutterEngineResetFrameStatistics` was last called. The
+///             statistics are collected whether or not the performance overlay
+///             is shown. Can be called on any thread.
+///
+/// @param[in]  engine      A running engine instance.
+/// @param[out] statistics  The statistics. Its `struct_size` must be set by the
+///                         caller.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetFrameStatistics(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterFrameStatistics* statistics);
+
+//------------------------------------------------------------------------------
+/// @brief      A profiling utility. Discards the frame statistics collected so
+///             far by a running engine. Can be called on any thread.
+///
+/// @param[in]  engine  A running engine instance.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineResetFrameStatistics(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine);
+
 //------------------------------------------------------------------------------
 /// @brief      Posts a task onto the Flutter render thread. Typically, this may
 ///             be called from any thread as long as a `FlutterEngineShutdown`
@@ -29,16 +29,20 @@ EmbedderEngine::EmbedderEngine(
     Shell::CreateCallback<PlatformView> on_create_platform_view,
     Shell::CreateCallback<Rasterizer> on_create_rasterizer,
     EmbedderExternalTextureGL::ExternalTextureCallback
-        external_texture_callback)
+        external_texture_callback,
+    std::shared_ptr<EmbedderHeadlessRenderer> headless_renderer)
     : thread_host_(std::move(thread_host)),
       task_runners_(task_runners),
       run_configuration_(std::move(run_configuration)),
+      headless_renderer_(std::move(headless_renderer)),
       shell_args_(std::make_unique<ShellArgs>(std::move(settings),
                                               on_create_platform_view,
                                               on_create_rasterizer)),
       external_texture_callback_(external_texture_callback) {}
 
-EmbedderEngine::~EmbedderEngine() = default;
+EmbedderEngine::~EmbedderEngine() {
+  CollectShell();
+}
 
 bool EmbedderEngine::LaunchShell() {
   if (!shell_args_) {
@@ -63,6 +67,10 @@ bool EmbedderEngine::LaunchShell() {
 
 bool EmbedderEngine::CollectShell() {
   shell_.reset();
+  // Frames that were being rendered are never presented now.
+  if (headless_renderer_) {
+    headless_renderer_->Shutdown();
+  }
   return IsValid();
 }
 
@@ -227,6 +235,30 @@ bool EmbedderEngine::ReloadSystemFonts() {
   return shell_->ReloadSystemFonts();
 }
 
+std::shared_ptr<EmbedderHeadlessRenderer>
+EmbedderEngine::GetHeadlessRenderer() const {
+  return headless_renderer_;
+}
+
+EmbedderHeadlessRenderer::RenderStatus EmbedderEngine::RenderHeadlessFrames(
+    std::vector<void*> buffers,
+    size_t row_bytes) {
+  if (!IsValid() || !headless_renderer_) {
+    return EmbedderHeadlessRenderer::RenderStatus::kFailed;
+  }
+
+  auto request_frame = [engine = shell_->GetEngine()]() {
+    if (engine) {
+      engine->ScheduleFrame();
+    }
+  };
+  // The engine may be shut down while this waits for the frames.
+  auto headless_renderer = headless_renderer_;
+  return headless_renderer->RenderFrames(
+      std::move(buffers), row_bytes,
+      shell_->GetTaskRunners().GetUITaskRunner(), request_frame);
+}
+
 bool EmbedderEngine::PostRenderThreadTask(const fml::closure& task) {
   if (!IsValid()) {
     return false;
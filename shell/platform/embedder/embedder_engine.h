@@ -14,6 +14,7 @@
 #include "flutter/shell/platform/embedder/embedder.h"
 #include "flutter/shell/platform/embedder/embedder_engine.h"
 #include "flutter/shell/platform/embedder/embedder_external_texture_gl.h"
+#include "flutter/shell/platform/embedder/embedder_headless_renderer.h"
 #include "flutter/shell/platform/embedder/embedder_thread_host.h"
 
 namespace flutter {
@@ -31,7 +32,9 @@ class EmbedderEngine {
                  Shell::CreateCallback<PlatformView> on_create_platform_view,
                  Shell::CreateCallback<Rasterizer> on_create_rasterizer,
                  EmbedderExternalTextureGL::ExternalTextureCallback
-                     external_texture_callback);
+                     external_texture_callback,
+                 std::shared_ptr<EmbedderHeadlessRenderer> headless_renderer =
+                     nullptr);
 
   ~EmbedderEngine();
 
@@ -76,6 +79,15 @@ class EmbedderEngine {
 
   bool ReloadSystemFonts();
 
+  // Null unless the engine was run with `FlutterEngineRunHeadless`.
+  std::shared_ptr<EmbedderHeadlessRenderer> GetHeadlessRenderer() const;
+
+  // See |EmbedderHeadlessRenderer::RenderFrames|. Fails if the engine is not
+  // running.
+  EmbedderHeadlessRenderer::RenderStatus RenderHeadlessFrames(
+      std::vector<void*> buffers,
+      size_t row_bytes);
+
   bool PostRenderThreadTask(const fml::closure& task);
 
   bool RunTask(const FlutterTask* task);
@@ -89,6 +101,8 @@ class EmbedderEngine {
   const std::unique_ptr<EmbedderThreadHost> thread_host_;
   TaskRunners task_runners_;
   RunConfiguration run_configuration_;
+  // Outlives the shell that presents frames to it.
+  const std::shared_ptr<EmbedderHeadlessRenderer> headless_renderer_;
   std::unique_ptr<ShellArgs> shell_args_;
   std::unique_ptr<Shell> shell_;
   const EmbedderExternalTextureGL::ExternalTextureCallback
@@ -0,0 +1,205 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/shell/platform/embedder/embedder_headless_renderer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "flutter/fml/message_loop.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
+
+namespace flutter {
+
+// There is no display refreshing at a given rate. This only sets the idle time
+// given to Dart code after each frame.
+static constexpr fml::TimeDelta kFrameInterval =
+    fml::TimeDelta::FromMicroseconds(16667);
+
+EmbedderHeadlessRenderer::EmbedderHeadlessRenderer(SkISize size)
+    : size_(size) {}
+
+EmbedderHeadlessRenderer::~EmbedderHeadlessRenderer() {
+  // The engine is gone by now. This only collects the baton.
+  if (pending_baton_ != 0) {
+    const auto now = fml::TimePoint::Now();
+    VsyncWaiterEmbedder::OnEmbedderVsync(pending_baton_, now, now);
+  }
+}
+
+SkISize EmbedderHeadlessRenderer::GetSize() const {
+  return size_;
+}
+
+void EmbedderHeadlessRenderer::AwaitVsync(intptr_t baton) {
+  {
+    std::scoped_lock lock(mutex_);
+    FML_DCHECK(pending_baton_ == 0);
+    pending_baton_ = baton;
+  }
+  BeginNextFrame();
+}
+
+void EmbedderHeadlessRenderer::BeginNextFrame() {
+  intptr_t baton = 0;
+  fml::RefPtr<fml::TaskRunner> ui_task_runner;
+  fml::closure request_frame;
+  {
+    std::scoped_lock lock(mutex_);
+    if (pending_baton_ == 0 || failed_ || begun_frames_ >= buffers_.size() ||
+        frames_in_flight_ >= kMaxFramesInFlight) {
+      return;
+    }
+    baton = std::exchange(pending_baton_, 0);
+    frames_in_flight_++;
+    if (++begun_frames_ < buffers_.size()) {
+      ui_task_runner = ui_task_runner_;
+      request_frame = request_frame_;
+    }
+  }
+
+  const auto frame_start_time = fml::TimePoint::Now();
+  VsyncWaiterEmbedder::OnEmbedderVsync(baton, frame_start_time,
+                                       frame_start_time + kFrameInterval);
+
+  // The frame begins ahead of this task, after which the engine waits for the
+  // vsync of the next one.
+  if (request_frame) {
+    ui_task_runner->PostTask(request_frame);
+  }
+}
+
+bool EmbedderHeadlessRenderer::Present(const void* allocation,
+                                       size_t row_bytes,
+                                       size_t height) {
+  {
+    std::scoped_lock lock(mutex_);
+    // Frames presented once no frames are wanted are not written.
+    if (!failed_ && presented_frames_ < buffers_.size()) {
+      TRACE_EVENT0("flutter", "EmbedderHeadlessRenderer::Present");
+      auto* dst = static_cast<uint8_t*>(buffers_[presented_frames_]);
+      auto* src = static_cast<const uint8_t*>(allocation);
+      const size_t rows =
+          std::min(height, static_cast<size_t>(size_.height()));
+      if (row_bytes == row_bytes_) {
+        std::memcpy(dst, src, rows * row_bytes);
+      } else {
+        const size_t row_size = std::min(row_bytes, row_bytes_);
+        for (size_t row = 0; row < rows; row++) {
+          std::memcpy(dst + row * row_bytes_, src + row * row_bytes,
+                      row_size);
+        }
+      }
+      presented_frames_++;
+    }
+  }
+
+  FinishFrameAfterCurrentTask();
+  return true;
+}
+
+void EmbedderHeadlessRenderer::DropFrame() {
+  {
+    std::scoped_lock lock(mutex_);
+    FailFramesLocked();
+    frames_changed_.notify_all();
+  }
+
+  FinishFrameAfterCurrentTask();
+}
+
+void EmbedderHeadlessRenderer::FinishFrameAfterCurrentTask() {
+  // Until the task that presents or drops a frame is done with it, the frame
+  // still takes up room in the layer tree pipeline. A frame that begins
+  // before then would find the pipeline full and never be rasterized.
+  auto finish_frame = [renderer = shared_from_this()]() {
+    {
+      std::scoped_lock lock(renderer->mutex_);
+      if (renderer->frames_in_flight_ > 0) {
+        renderer->frames_in_flight_--;
+      }
+      renderer->frames_changed_.notify_all();
+    }
+    renderer->BeginNextFrame();
+  };
+
+  if (!fml::MessageLoop::IsInitializedForCurrentThread()) {
+    finish_frame();
+    return;
+  }
+  fml::MessageLoop::GetCurrent().GetTaskRunner()->PostTask(finish_frame);
+}
+
+void EmbedderHeadlessRenderer::Shutdown() {
+  std::scoped_lock lock(mutex_);
+  shut_down_ = true;
+  FailFramesLocked();
+  frames_changed_.notify_all();
+}
+
+void EmbedderHeadlessRenderer::FailFramesLocked() {
+  if (buffers_.empty() || presented_frames_ == buffers_.size()) {
+    return;
+  }
+  failed_ = true;
+}
+
+bool EmbedderHeadlessRenderer::AreFramesDoneLocked() const {
+  // No frames are presented or dropped once the engine has shut down.
+  if (shut_down_) {
+    return true;
+  }
+  return (failed_ || presented_frames_ == buffers_.size()) &&
+         frames_in_flight_ == 0;
+}
+
+EmbedderHeadlessRenderer::RenderStatus EmbedderHeadlessRenderer::RenderFrames(
+    std::vector<void*> buffers,
+    size_t row_bytes,
+    fml::RefPtr<fml::TaskRunner> ui_task_runner,
+    fml::closure request_frame) {
+  {
+    std::scoped_lock lock(mutex_);
+    if (shut_down_) {
+      return RenderStatus::kFailed;
+    }
+    if (!buffers_.empty()) {
+      return RenderStatus::kBusy;
+    }
+    if (buffers.empty()) {
+      return RenderStatus::kSuccess;
+    }
+    buffers_ = std::move(buffers);
+    row_bytes_ = row_bytes;
+    ui_task_runner_ = ui_task_runner;
+    request_frame_ = request_frame;
+  }
+
+  // The engine may already be waiting for the vsync of a frame that would
+  // only redraw the last layer tree.
+  ui_task_runner->PostTask([renderer = shared_from_this(),
+                            request_frame = std::move(request_frame)]() {
+    request_frame();
+    renderer->BeginNextFrame();
+  });
+
+  // Frames that are presented once the frames failed are not written.
+  std::unique_lock lock(mutex_);
+  frames_changed_.wait(lock, [this]() { return AreFramesDoneLocked(); });
+  const RenderStatus status =
+      failed_ ? RenderStatus::kFailed : RenderStatus::kSuccess;
+  buffers_.clear();
+  ui_task_runner_ = nullptr;
+  request_frame_ = nullptr;
+  begun_frames_ = 0;
+  presented_frames_ = 0;
+  failed_ = false;
+  return status;
+}
+
+}  // namespace flutter
@@ -0,0 +1,116 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_HEADLESS_RENDERER_H_
+#define FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_HEADLESS_RENDERER_H_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/closure.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace flutter {
+
+// Renders the frames of an engine run with `FlutterEngineRunHeadless` into
+// the buffers given to |RenderFrames|.
+//
+// The engine is not gated by vsync: while frames are wanted, the frames it
+// waits for begin right away, as long as fewer than |kMaxFramesInFlight|
+// frames are being built or rasterized. While no frames are wanted, they do
+// not begin at all.
+class EmbedderHeadlessRenderer
+    : public std::enable_shared_from_this<EmbedderHeadlessRenderer> {
+ public:
+  // As many as the layer tree pipeline holds, so that a frame is built while
+  // the one before it is rasterized.
+  static constexpr size_t kMaxFramesInFlight = 2;
+
+  enum class RenderStatus {
+    kSuccess,
+    // Frames were already being rendered.
+    kBusy,
+    // A frame was dropped or the engine shut down before every frame was
+    // written.
+    kFailed,
+  };
+
+  explicit EmbedderHeadlessRenderer(SkISize size);
+
+  ~EmbedderHeadlessRenderer();
+
+  SkISize GetSize() const;
+
+  // |VsyncWaiterEmbedder::VsyncCallback|. Called on the UI thread.
+  void AwaitVsync(intptr_t baton);
+
+  // |EmbedderSurfaceSoftware::SoftwareDispatchTable|. Called on the render
+  // thread.
+  bool Present(const void* allocation, size_t row_bytes, size_t height);
+
+  // |Settings::frame_dropped_callback|. Fails the frames being rendered, as
+  // the dropped one is never presented. Can be called on any thread.
+  void DropFrame();
+
+  // Fails the frames being rendered and any rendered after this. Called once
+  // the engine can no longer present frames.
+  void Shutdown();
+
+  // Renders a frame into each of |buffers| and waits for them to be written,
+  // unless a frame is dropped or the engine shuts down first. If a frame is
+  // dropped, this still waits for the frames in flight to be presented or
+  // dropped, so that none of them is taken for a frame of the next call.
+  // |request_frame|
+  // is called on |ui_task_runner| to ask the engine for a frame that
+  // regenerates the layer tree.
+  RenderStatus RenderFrames(std::vector<void*> buffers,
+                            size_t row_bytes,
+                            fml::RefPtr<fml::TaskRunner> ui_task_runner,
+                            fml::closure request_frame);
+
+ private:
+  const SkISize size_;
+
+  std::mutex mutex_;
+  // The baton of the vsync the engine is waiting for, if any.
+  intptr_t pending_baton_ = 0;
+  // The frames being rendered, if any.
+  std::vector<void*> buffers_;
+  size_t row_bytes_ = 0;
+  fml::RefPtr<fml::TaskRunner> ui_task_runner_;
+  fml::closure request_frame_;
+  size_t begun_frames_ = 0;
+  size_t presented_frames_ = 0;
+  // The frames that have begun but whose presenting or dropping task is not
+  // done yet.
+  size_t frames_in_flight_ = 0;
+  bool failed_ = false;
+  bool shut_down_ = false;
+  // Notified whenever the frames are presented, dropped or fail.
+  std::condition_variable frames_changed_;
+
+  // Fails the frames being rendered, if they have not all been presented.
+  void FailFramesLocked();
+
+  // Whether |RenderFrames| can return.
+  bool AreFramesDoneLocked() const;
+
+  // Takes the frame presented or dropped by the current task out of flight
+  // once that task is done, and begins the next frame if it is wanted.
+  void FinishFrameAfterCurrentTask();
+
+  // Begins the next frame if the engine is waiting for a vsync and the frame
+  // is wanted. Can be called on any thread.
+  void BeginNextFrame();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EmbedderHeadlessRenderer);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_HEADLESS_RENDERER_H_
@@ -78,32 +78,63 @@ sk_sp<SkSurface> EmbedderSurfaceSoftware::AcquireBackingStore(
 // |GPUSurfaceSoftwareDelegate|
 bool EmbedderSurfaceSoftware::PresentBackingStore(
     sk_sp<SkSurface> backing_store) {
+  SkPixmap pixmap;
+  if (!PeekBackingStorePixels(backing_store, &pixmap)) {
+    return false;
+  }
+
+  return software_dispatch_table_.software_present_backing_store(
+      pixmap.addr(),      //
+      pixmap.rowBytes(),  //
+      pixmap.height()     //
+  );
+}
+
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::PresentBackingStoreRegion(
+    sk_sp<SkSurface> backing_store,
+    const SkRegion& damage) {
+  if (!software_dispatch_table_.software_present_backing_store_with_damage) {
+    return PresentBackingStore(std::move(backing_store));
+  }
+
+  SkPixmap pixmap;
+  if (!PeekBackingStorePixels(backing_store, &pixmap)) {
+    return false;
+  }
+
+  return software_dispatch_table_.software_present_backing_store_with_damage(
+      pixmap.addr(),      //
+      pixmap.rowBytes(),  //
+      pixmap.height(),    //
+      damage              //
+  );
+}
+
+bool EmbedderSurfaceSoftware::PeekBackingStorePixels(
+    sk_sp<SkSurface> backing_store,
+    SkPixmap* pixmap) const {
   if (!IsValid()) {
     FML_LOG(ERROR) << "Tried to present an invalid software surface.";
     return false;
   }
 
-  SkPixmap pixmap;
-  if (!backing_store->peekPixels(&pixmap)) {
+  if (!backing_store->peekPixels(pixmap)) {
     FML_LOG(ERROR) << "Could not peek the pixels of the backing store.";
     return false;
   }
 
   // Some basic sanity checking.
-  uint64_t expected_pixmap_data_size = pixmap.width() * pixmap.height() * 4;
+  uint64_t expected_pixmap_data_size = pixmap->width() * pixmap->height() * 4;
 
-  const size_t pixmap_size = pixmap.computeByteSize();
+  const size_t pixmap_size = pixmap->computeByteSize();
 
   if (expected_pixmap_data_size != pixmap_size) {
     FML_LOG(ERROR) << "Software backing store had unexpected size.";
     return false;
   }
 
-  return software_dispatch_table_.software_present_backing_store(
-      pixmap.addr(),      //
-      pixmap.rowBytes(),  //
-      pixmap.height()     //
-  );
+  return true;
 }
 
 // |GPUSurfaceSoftwareDelegate|
@@ -4,6 +4,8 @@
 
 #include "flutter/shell/platform/embedder/embedder_task_runner.h"
 
+#include <tuple>
+
 #include "flutter/fml/message_loop_impl.h"
 #include "flutter/fml/message_loop_task_queues.h"
 
@@ -26,12 +28,20 @@ size_t EmbedderTaskRunner::GetEmbedderIdentifier() const {
   return embedder_identifier_;
 }
 
-void EmbedderTaskRunner::PostTask(const fml::closure& task) {
-  PostTaskForTime(task, fml::TimePoint::Now());
+void EmbedderTaskRunner::PostTask(fml::UniqueClosure task) {
+  PostTaskForTime(std::move(task), fml::TimePoint::Now());
 }
 
-void EmbedderTaskRunner::PostTaskForTime(const fml::closure& task,
+void EmbedderTaskRunner::PostTaskForTime(fml::UniqueClosure task,
                                          fml::TimePoint target_time) {
+  PostTaskForTimeWithPriority(std::move(task), target_time,
+                              fml::TaskPriority::kNormal);
+}
+
+void EmbedderTaskRunner::PostTaskForTimeWithPriority(
+    fml::UniqueClosure task,
+    fml::TimePoint target_time,
+    fml::TaskPriority priority) {
   if (!task) {
     return;
   }
@@ -42,15 +52,18 @@ void EmbedderTaskRunner::PostTaskForTime(const fml::closure& task,
     // Release the lock before the jump via the dispatch table.
     std::scoped_lock lock(tasks_mutex_);
     baton = ++last_baton_;
-    pending_tasks_[baton] = task;
+    pending_tasks_[baton] = {std::move(task), target_time, priority};
+    if (priority != fml::TaskPriority::kNormal) {
+      pending_prioritized_tasks_++;
+    }
   }
 
   dispatch_table_.post_task_callback(this, baton, target_time);
 }
 
-void EmbedderTaskRunner::PostDelayedTask(const fml::closure& task,
+void EmbedderTaskRunner::PostDelayedTask(fml::UniqueClosure task,
                                          fml::TimeDelta delay) {
-  PostTaskForTime(task, fml::TimePoint::Now() + delay);
+  PostTaskForTime(std::move(task), fml::TimePoint::Now() + delay);
 }
 
 bool EmbedderTaskRunner::RunsTasksOnCurrentThread() {
@@ -58,7 +71,7 @@ bool EmbedderTaskRunner::RunsTasksOnCurrentThread() {
 }
 
 bool EmbedderTaskRunner::PostTask(uint64_t baton) {
-  fml::closure task;
+  fml::UniqueClosure task;
 
   {
     std::scoped_lock lock(tasks_mutex_);
@@ -67,7 +80,15 @@ bool EmbedderTaskRunner::PostTask(uint64_t baton) {
       FML_LOG(ERROR) << "Embedder attempted to post an unknown task.";
       return false;
     }
-    task = found->second;
+    auto next = FindTaskToRun(found);
+    task = std::move(next->second.closure);
+    if (next->second.priority != fml::TaskPriority::kNormal) {
+      pending_prioritized_tasks_--;
+    }
+    if (next != found) {
+      // The embedder will run the baton of |next| soon, as it is due.
+      next->second = std::move(found->second);
+    }
     pending_tasks_.erase(found);
 
     // Let go of the tasks mutex befor executing the task.
@@ -78,6 +99,51 @@ bool EmbedderTaskRunner::PostTask(uint64_t baton) {
   return true;
 }
 
+EmbedderTaskRunner::PendingTasks::iterator EmbedderTaskRunner::FindTaskToRun(
+    PendingTasks::iterator found) {
+  if (pending_prioritized_tasks_ == 0) {
+    return found;
+  }
+
+  // Pick the due task the message loops of the engine would run next: the
+  // one with the highest priority, unless some have waited for longer than
+  // their priority tolerates (see |fml::GetStarvationLimit|).
+  const auto now = fml::TimePoint::Now();
+  auto next = pending_tasks_.end();
+  bool next_is_starved = false;
+  fml::TimePoint next_deadline;
+  for (auto it = pending_tasks_.begin(); it != pending_tasks_.end(); ++it) {
+    const Task& candidate = it->second;
+    if (candidate.target_time > now) {
+      continue;
+    }
+    const auto deadline =
+        candidate.target_time + fml::GetStarvationLimit(candidate.priority);
+    const bool starved = deadline < now;
+    bool is_next;
+    if (next == pending_tasks_.end()) {
+      is_next = true;
+    } else if (starved != next_is_starved) {
+      is_next = starved;
+    } else if (starved) {
+      is_next = std::tie(deadline, it->first) <
+                std::tie(next_deadline, next->first);
+    } else {
+      is_next = std::tie(candidate.priority, candidate.target_time, it->first) <
+                std::tie(next->second.priority, next->second.target_time,
+                         next->first);
+    }
+    if (is_next) {
+      next = it;
+      next_is_starved = starved;
+      next_deadline = deadline;
+    }
+  }
+
+  // The embedder may run a task ahead of its target time.
+  return next == pending_tasks_.end() ? found : next;
+}
+
 // |fml::TaskRunner|
 fml::TaskQueueId EmbedderTaskRunner::GetTaskQueueId() {
   return placeholder_id_;
@@ -69,25 +69,52 @@ class EmbedderTaskRunner final : public fml::TaskRunner {
   ///
   size_t GetEmbedderIdentifier() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Runs a task whose target time has expired. The embedder only
+  ///             knows the target times of the tasks, so this runs the due
+  ///             task with the highest priority (see `fml::TaskPriority`)
+  ///             instead and hands the task of the `baton` over to the baton
+  ///             of that task, which is due as well.
+  ///
+  /// @param[in]  baton  The baton of a task previously handed to the
+  ///                    embedder via the `post_task_callback`.
+  ///
+  /// @return     If a task was run.
+  ///
   bool PostTask(uint64_t baton);
 
  private:
+  struct Task {
+    fml::UniqueClosure closure;
+    fml::TimePoint target_time;
+    fml::TaskPriority priority;
+  };
+  using PendingTasks = std::unordered_map<uint64_t, Task>;
+
   const size_t embedder_identifier_;
   DispatchTable dispatch_table_;
   std::mutex tasks_mutex_;
   uint64_t last_baton_;
-  std::unordered_map<uint64_t, fml::closure> pending_tasks_;
+  PendingTasks pending_tasks_;
+  // The number of pending tasks that do not have the normal priority. While
+  // there are none, tasks run in the order the embedder runs their batons.
+  size_t pending_prioritized_tasks_ = 0;
   fml::TaskQueueId placeholder_id_;
 
   // |fml::TaskRunner|
-  void PostTask(const fml::closure& task) override;
+  void PostTask(fml::UniqueClosure task) override;
 
   // |fml::TaskRunner|
-  void PostTaskForTime(const fml::closure& task,
+  void PostTaskForTime(fml::UniqueClosure task,
                        fml::TimePoint target_time) override;
 
   // |fml::TaskRunner|
-  void PostDelayedTask(const fml::closure& task, fml::TimeDelta delay) override;
+  void PostDelayedTask(fml::UniqueClosure task, fml::TimeDelta delay) override;
+
+  // |fml::TaskRunner|
+  void PostTaskForTimeWithPriority(fml::UniqueClosure task,
+                                   fml::TimePoint target_time,
+                                   fml::TaskPriority priority) override;
 
   // |fml::TaskRunner|
   bool RunsTasksOnCurrentThread() override;
@@ -95,6 +122,10 @@ class EmbedderTaskRunner final : public fml::TaskRunner {
   // |fml::TaskRunner|
   fml::TaskQueueId GetTaskQueueId() override;
 
+  // Returns the pending task to run in place of the task |found|, whose baton
+  // the embedder ran.
+  PendingTasks::iterator FindTaskToRun(PendingTasks::iterator found);
+
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderTaskRunner);
 };
 
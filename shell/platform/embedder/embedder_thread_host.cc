@@ -7,6 +7,10 @@
 #include "flutter/shell/platform/embedder/embedder_thread_host.h"
 
 #include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "flutter/fml/message_loop.h"
 #include "flutter/shell/platform/embedder/embedder_safe_access.h"
@@ -242,6 +246,65 @@ EmbedderThreadHost::CreateEngineManagedThreadHost() {
   return nullptr;
 }
 
+// The threads shared by the hosts created by |CreateSharedThreadHost|. There
+// is a UI, GPU and IO thread for every two cores, which is enough to keep the
+// cores busy building and rasterizing frames. Each host gets the threads that
+// are shared by the fewest other hosts, and the threads stop once no host uses
+// them anymore.
+static std::mutex gSharedThreadHostsMutex;
+static std::vector<std::weak_ptr<ThreadHost>> gSharedThreadHosts;
+
+static std::shared_ptr<ThreadHost> AcquireSharedThreadHost() {
+  std::scoped_lock lock(gSharedThreadHostsMutex);
+  if (gSharedThreadHosts.empty()) {
+    gSharedThreadHosts.resize(
+        std::max(1u, std::thread::hardware_concurrency() / 2));
+  }
+
+  auto least_shared =
+      std::min_element(gSharedThreadHosts.begin(), gSharedThreadHosts.end(),
+                       [](const auto& a, const auto& b) {
+                         return a.use_count() < b.use_count();
+                       });
+  if (auto host = least_shared->lock()) {
+    return host;
+  }
+
+  const auto index = least_shared - gSharedThreadHosts.begin();
+  auto host = std::make_shared<ThreadHost>(
+      std::string{kFlutterThreadName} + ".shared." + std::to_string(index),
+      ThreadHost::Type::GPU | ThreadHost::Type::IO | ThreadHost::Type::UI);
+  *least_shared = host;
+  return host;
+}
+
+// static
+std::unique_ptr<EmbedderThreadHost>
+EmbedderThreadHost::CreateSharedThreadHost() {
+  auto shared_host = AcquireSharedThreadHost();
+
+  flutter::TaskRunners task_runners(
+      kFlutterThreadName,
+      GetCurrentThreadTaskRunner(),             // platform
+      shared_host->gpu_thread->GetTaskRunner(),  // gpu
+      shared_host->ui_thread->GetTaskRunner(),   // ui
+      shared_host->io_thread->GetTaskRunner()    // io
+  );
+
+  if (!task_runners.IsValid()) {
+    return nullptr;
+  }
+
+  auto embedder_host = std::make_unique<EmbedderThreadHost>(
+      std::move(shared_host), std::move(task_runners));
+
+  if (embedder_host->IsValid()) {
+    return embedder_host;
+  }
+
+  return nullptr;
+}
+
 EmbedderThreadHost::EmbedderThreadHost(
     ThreadHost host,
     flutter::TaskRunners runners,
@@ -252,6 +315,10 @@ EmbedderThreadHost::EmbedderThreadHost(
   }
 }
 
+EmbedderThreadHost::EmbedderThreadHost(std::shared_ptr<ThreadHost> shared_host,
+                                       flutter::TaskRunners runners)
+    : shared_host_(std::move(shared_host)), runners_(std::move(runners)) {}
+
 EmbedderThreadHost::~EmbedderThreadHost() = default;
 
 bool EmbedderThreadHost::IsValid() const {
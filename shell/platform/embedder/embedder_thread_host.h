@@ -23,11 +23,18 @@ class EmbedderThreadHost {
   CreateEmbedderOrEngineManagedThreadHost(
       const FlutterCustomTaskRunners* custom_task_runners);
 
+  // The UI, GPU and IO threads of the hosts created here are shared with
+  // other engines, and the current thread is the platform thread.
+  static std::unique_ptr<EmbedderThreadHost> CreateSharedThreadHost();
+
   EmbedderThreadHost(
       ThreadHost host,
       flutter::TaskRunners runners,
       std::set<fml::RefPtr<EmbedderTaskRunner>> embedder_task_runners);
 
+  EmbedderThreadHost(std::shared_ptr<ThreadHost> shared_host,
+                     flutter::TaskRunners runners);
+
   ~EmbedderThreadHost();
 
   bool IsValid() const;
@@ -38,6 +45,7 @@ class EmbedderThreadHost {
 
  private:
   ThreadHost host_;
+  std::shared_ptr<ThreadHost> shared_host_;
   flutter::TaskRunners runners_;
   std::map<int64_t, fml::RefPtr<EmbedderTaskRunner>> runners_map_;
 
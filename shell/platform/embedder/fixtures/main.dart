@@ -729,3 +729,58 @@ void render_targets_are_recycled() {
   };
   window.scheduleFrame();
 }
+
+@pragma('vm:entry-point')
+void render_headless_frames() {
+  List<Color> colors = <Color>[
+    Color.fromARGB(255, 255, 0, 0),
+    Color.fromARGB(255, 0, 255, 0),
+    Color.fromARGB(255, 0, 0, 255),
+  ];
+  int frame_count = 0;
+  // Headless engines begin frames when the embedder wants them, so this never
+  // schedules one.
+  window.onBeginFrame = (Duration duration) {
+    SceneBuilder builder = SceneBuilder();
+    builder.addPicture(Offset(0.0, 0.0),
+        CreateColoredBox(colors[frame_count % colors.length], window.physicalSize));
+    window.render(builder.build());
+    frame_count++;
+  };
+}
+
+@pragma('vm:entry-point')
+void drop_headless_frames() {
+  // Every frame after the first one ends without a scene.
+  bool rendered = false;
+  window.onBeginFrame = (Duration duration) {
+    if (rendered) {
+      return;
+    }
+    SceneBuilder builder = SceneBuilder();
+    builder.addPicture(Offset(0.0, 0.0),
+        CreateColoredBox(Color.fromARGB(255, 255, 0, 0), window.physicalSize));
+    window.render(builder.build());
+    rendered = true;
+  };
+}
+
+@pragma('vm:entry-point')
+void drop_second_headless_frame() {
+  // The first frame is red, the second one ends without a scene and every
+  // frame after it is green.
+  int frame_count = 0;
+  window.onBeginFrame = (Duration duration) {
+    frame_count++;
+    if (frame_count == 2) {
+      return;
+    }
+    Color color = frame_count == 1
+        ? Color.fromARGB(255, 255, 0, 0)
+        : Color.fromARGB(255, 0, 255, 0);
+    SceneBuilder builder = SceneBuilder();
+    builder.addPicture(
+        Offset(0.0, 0.0), CreateColoredBox(color, window.physicalSize));
+    window.render(builder.build());
+  };
+}
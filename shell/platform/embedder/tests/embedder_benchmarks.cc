@@ -0,0 +1,101 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <thread>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/logging.h"
+#include "flutter/shell/platform/embedder/embedder.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+
+static constexpr size_t kFrameWidth = 800;
+static constexpr size_t kFrameHeight = 600;
+static constexpr size_t kFramesPerIteration = 30;
+
+static FlutterEngine RunHeadlessEngine() {
+  static const char* kCommandLineArgs[] = {
+      "embedder_benchmarks",
+      "--disable-observatory",
+  };
+
+  FlutterProjectArgs args = {};
+  args.struct_size = sizeof(FlutterProjectArgs);
+  args.assets_path = testing::GetFixturesPath();
+  args.command_line_argc = 2;
+  args.command_line_argv = kCommandLineArgs;
+  args.custom_dart_entrypoint = "render_headless_frames";
+
+  FlutterHeadlessRendererConfig config = {};
+  config.struct_size = sizeof(FlutterHeadlessRendererConfig);
+  config.width = kFrameWidth;
+  config.height = kFrameHeight;
+  config.pixel_ratio = 1.0;
+
+  FlutterEngine engine = nullptr;
+  FML_CHECK(FlutterEngineRunHeadless(FLUTTER_ENGINE_VERSION, &config, &args,
+                                     nullptr, &engine) == kSuccess);
+  return engine;
+}
+
+// The argument is the number of engines rendering at once, each one from its
+// own thread.
+static void BM_HeadlessEngineFrames(benchmark::State& state) {
+  if (FlutterEngineRunsAOTCompiledDartCode()) {
+    // Running precompiled code needs the snapshots to be mapped by the test
+    // harness.
+    state.SkipWithError("Only JIT builds are supported.");
+    return;
+  }
+
+  const size_t engine_count = state.range(0);
+  std::vector<FlutterEngine> engines;
+  for (size_t i = 0; i < engine_count; i++) {
+    engines.push_back(RunHeadlessEngine());
+  }
+
+  // Every frame of an engine is written to the same buffer.
+  std::vector<std::vector<uint32_t>> pixels(
+      engine_count, std::vector<uint32_t>(kFrameWidth * kFrameHeight));
+  std::vector<std::vector<void*>> buffers;
+  for (auto& engine_pixels : pixels) {
+    buffers.emplace_back(kFramesPerIteration, engine_pixels.data());
+  }
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < engine_count; i++) {
+      threads.emplace_back([engine = engines[i], &buffers = buffers[i]]() {
+        FlutterHeadlessFrames frames = {};
+        frames.struct_size = sizeof(FlutterHeadlessFrames);
+        frames.frame_count = buffers.size();
+        frames.buffers = buffers.data();
+        frames.row_bytes = kFrameWidth * sizeof(uint32_t);
+        FML_CHECK(FlutterEngineRenderHeadlessFrames(engine, &frames) ==
+                  kSuccess);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.counters["FramesPerSecond"] = benchmark::Counter(
+      state.iterations() * engine_count * kFramesPerIteration,
+      benchmark::Counter::kIsRate);
+
+  for (auto engine : engines) {
+    FML_CHECK(FlutterEngineShutdown(engine) == kSuccess);
+  }
+}
+
+BENCHMARK(BM_HeadlessEngineFrames)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace flutter
@@ -106,6 +106,14 @@ void EmbedderConfigBuilder::SetOpenGLRendererConfig(SkISize surface_size) {
   context_.SetupOpenGLSurface(surface_size);
 }
 
+void EmbedderConfigBuilder::SetHeadlessRendererConfig(SkISize frame_size,
+                                                      double pixel_ratio) {
+  headless_renderer_config_.struct_size = sizeof(FlutterHeadlessRendererConfig);
+  headless_renderer_config_.width = frame_size.width();
+  headless_renderer_config_.height = frame_size.height();
+  headless_renderer_config_.pixel_ratio = pixel_ratio;
+}
+
 void EmbedderConfigBuilder::SetAssetsPath() {
   project_args_.assets_path = context_.GetAssetsPath().c_str();
 }
@@ -251,11 +259,20 @@ UniqueEngine EmbedderConfigBuilder::SetupEngine(bool run) const {
     project_args.command_line_argc = 0;
   }
 
-  auto result =
-      run ? FlutterEngineRun(FLUTTER_ENGINE_VERSION, &renderer_config_,
-                             &project_args, &context_, &engine)
-          : FlutterEngineInitialize(FLUTTER_ENGINE_VERSION, &renderer_config_,
-                                    &project_args, &context_, &engine);
+  FlutterEngineResult result = kInvalidArguments;
+  if (headless_renderer_config_.struct_size != 0) {
+    if (run) {
+      result = FlutterEngineRunHeadless(FLUTTER_ENGINE_VERSION,
+                                        &headless_renderer_config_,
+                                        &project_args, &context_, &engine);
+    }
+  } else {
+    result =
+        run ? FlutterEngineRun(FLUTTER_ENGINE_VERSION, &renderer_config_,
+                               &project_args, &context_, &engine)
+            : FlutterEngineInitialize(FLUTTER_ENGINE_VERSION, &renderer_config_,
+                                      &project_args, &context_, &engine);
+  }
 
   if (result != kSuccess) {
     return {};
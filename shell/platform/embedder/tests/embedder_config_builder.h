@@ -47,6 +47,10 @@ class EmbedderConfigBuilder {
 
   void SetOpenGLRendererConfig(SkISize surface_size);
 
+  // Launches the engine with `FlutterEngineRunHeadless` instead. Headless
+  // engines cannot be initialized without being run.
+  void SetHeadlessRendererConfig(SkISize frame_size, double pixel_ratio = 1.0);
+
   void SetAssetsPath();
 
   void SetSnapshots();
@@ -80,6 +84,7 @@ class EmbedderConfigBuilder {
   FlutterRendererConfig renderer_config_ = {};
   FlutterSoftwareRendererConfig software_renderer_config_ = {};
   FlutterOpenGLRendererConfig opengl_renderer_config_ = {};
+  FlutterHeadlessRendererConfig headless_renderer_config_ = {};
   std::string dart_entrypoint_;
   FlutterCustomTaskRunners custom_task_runners_ = {};
   FlutterCompositor compositor_ = {};
@@ -4,7 +4,9 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
 #include <string>
+#include <thread>
 
 #include "embedder.h"
 #include "embedder_engine.h"
@@ -18,9 +20,11 @@
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/fml/thread.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/shell/platform/embedder/embedder_headless_renderer.h"
 #include "flutter/shell/platform/embedder/tests/embedder_assertions.h"
 #include "flutter/shell/platform/embedder/tests/embedder_config_builder.h"
 #include "flutter/shell/platform/embedder/tests/embedder_test.h"
+#include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
 #include "flutter/testing/assertions_skia.h"
 #include "flutter/testing/testing.h"
 #include "third_party/skia/include/core/SkSurface.h"
@@ -245,6 +249,27 @@ TEST(EmbedderTestNoFixture, CanGetCurrentTimeInNanoseconds) {
   ASSERT_LT((point2 - point1), fml::TimeDelta::FromMilliseconds(1));
 }
 
+TEST(EmbedderTestNoFixture, CanRecordTraceEventsWithoutAnEngine) {
+  FlutterEngineTraceRecorderSetEnabled(true);
+  FlutterEngineTraceEventDurationBegin("EmbedderRecordedEvent");
+  FlutterEngineTraceEventDurationEnd("EmbedderRecordedEvent");
+  FlutterEngineTraceRecorderSetEnabled(false);
+
+  std::string json;
+  auto result = FlutterEngineTraceRecorderExport(
+      [](const uint8_t* data, size_t size, void* user_data) {
+        reinterpret_cast<std::string*>(user_data)->assign(
+            reinterpret_cast<const char*>(data), size);
+      },
+      &json);
+  ASSERT_EQ(result, kSuccess);
+  ASSERT_NE(json.find("\"name\":\"EmbedderRecordedEvent\""),
+            std::string::npos);
+
+  ASSERT_EQ(FlutterEngineTraceRecorderExport(nullptr, nullptr),
+            kInvalidArguments);
+}
+
 TEST_F(EmbedderTest, CanReloadSystemFonts) {
   auto& context = GetEmbedderContext();
   EmbedderConfigBuilder builder(context);
@@ -2058,6 +2083,88 @@ TEST_F(EmbedderTest, CanRenderGradientWithoutCompositor) {
   ASSERT_TRUE(ImageMatchesFixture("gradient.png", renderered_scene));
 }
 
+//------------------------------------------------------------------------------
+/// Renders a frame with |builder| and waits for the render thread to record
+/// its timings.
+///
+static UniqueEngine RenderFrameForStatistics(EmbedderTestContext& context,
+                                             EmbedderConfigBuilder& builder) {
+  builder.SetDartEntrypoint("render_gradient");
+  builder.SetOpenGLRendererConfig(SkISize::Make(800, 600));
+
+  auto renderered_scene = context.GetNextSceneImage();
+
+  auto engine = builder.LaunchEngine();
+  if (!engine.is_valid()) {
+    return engine;
+  }
+
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  FlutterEngineSendWindowMetricsEvent(engine.get(), &event);
+  renderered_scene.wait();
+
+  // The frame is presented before the render thread is done recording its
+  // timings.
+  fml::AutoResetWaitableEvent latch;
+  FlutterEnginePostRenderThreadTask(
+      engine.get(),
+      [](void* latch) {
+        reinterpret_cast<fml::AutoResetWaitableEvent*>(latch)->Signal();
+      },
+      &latch);
+  latch.Wait();
+  return engine;
+}
+
+TEST_F(EmbedderTest, CanGetFrameStatistics) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  auto engine = RenderFrameForStatistics(context, builder);
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterFrameStatistics statistics = {};
+  statistics.struct_size = sizeof(statistics);
+  ASSERT_EQ(FlutterEngineGetFrameStatistics(engine.get(), &statistics),
+            kSuccess);
+  ASSERT_EQ(statistics.struct_size, sizeof(statistics));
+  ASSERT_GE(statistics.built_frame_count, 1u);
+  ASSERT_GE(statistics.rasterized_frame_count, 1u);
+  ASSERT_EQ(statistics.raster.count, statistics.rasterized_frame_count);
+  ASSERT_GE(statistics.paint.count, 1u);
+  ASSERT_GE(statistics.present.count, 1u);
+  // Flushes are part of the present phase unless they are profiled.
+  ASSERT_EQ(statistics.flush.count, 0u);
+  ASSERT_LE(statistics.raster.p50_micros, statistics.raster.max_micros);
+
+  ASSERT_EQ(FlutterEngineResetFrameStatistics(engine.get()), kSuccess);
+  ASSERT_EQ(FlutterEngineGetFrameStatistics(engine.get(), &statistics),
+            kSuccess);
+  ASSERT_EQ(statistics.rasterized_frame_count, 0u);
+  ASSERT_EQ(statistics.raster.max_micros, 0u);
+
+  ASSERT_EQ(FlutterEngineGetFrameStatistics(engine.get(), nullptr),
+            kInvalidArguments);
+}
+
+TEST_F(EmbedderTest, CanProfileFrameFlushes) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.AddCommandLineArgument("--profile-frame-flushes");
+  auto engine = RenderFrameForStatistics(context, builder);
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterFrameStatistics statistics = {};
+  statistics.struct_size = sizeof(statistics);
+  ASSERT_EQ(FlutterEngineGetFrameStatistics(engine.get(), &statistics),
+            kSuccess);
+  ASSERT_GE(statistics.flush.count, 1u);
+  ASSERT_EQ(statistics.flush.count, statistics.present.count);
+}
+
 TEST_F(EmbedderTest, CanRenderGradientWithoutCompositorWithXform) {
   auto& context = GetEmbedderContext();
 
@@ -4201,5 +4308,258 @@ TEST_F(EmbedderTest, CompositorRenderTargetsAreInStableOrder) {
   latch.Wait();
 }
 
+//------------------------------------------------------------------------------
+/// Renders |frame_count| frames of a headless engine into buffers that are
+/// wider than the frames, and returns the pixels of each one.
+///
+static std::vector<std::vector<uint32_t>> RenderHeadlessFrames(
+    FlutterEngine engine,
+    SkISize frame_size,
+    size_t frame_count) {
+  const size_t row_pixels = frame_size.width() + 8;
+  std::vector<std::vector<uint32_t>> pixels(
+      frame_count, std::vector<uint32_t>(row_pixels * frame_size.height()));
+  std::vector<void*> buffers;
+  for (auto& frame_pixels : pixels) {
+    buffers.push_back(frame_pixels.data());
+  }
+
+  FlutterHeadlessFrames frames = {};
+  frames.struct_size = sizeof(FlutterHeadlessFrames);
+  frames.frame_count = buffers.size();
+  frames.buffers = buffers.data();
+  frames.row_bytes = row_pixels * sizeof(uint32_t);
+  if (FlutterEngineRenderHeadlessFrames(engine, &frames) != kSuccess) {
+    return {};
+  }
+  return pixels;
+}
+
+//------------------------------------------------------------------------------
+/// Whether the frame covers its buffer with |color| and leaves the padding at
+/// the end of the rows alone.
+///
+static bool IsFilledWithColor(const std::vector<uint32_t>& pixels,
+                              SkISize frame_size,
+                              SkColor color) {
+  const size_t row_pixels = pixels.size() / frame_size.height();
+  for (size_t i = 0; i < pixels.size(); i++) {
+    const bool in_frame = static_cast<int>(i % row_pixels) < frame_size.width();
+    if (pixels[i] != (in_frame ? SkPreMultiplyColor(color) : 0u)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_F(EmbedderTest, HeadlessEngineRendersTheFramesItIsAskedFor) {
+  const SkISize frame_size = SkISize::Make(40, 30);
+  const SkColor colors[] = {SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE};
+
+  EmbedderConfigBuilder builder(GetEmbedderContext());
+  builder.SetHeadlessRendererConfig(frame_size, 2.0);
+  builder.SetDartEntrypoint("render_headless_frames");
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  // Nothing is rendered between the calls, so the second one picks up the
+  // colors of the fixture where the first one left off.
+  size_t frame_index = 0;
+  for (size_t frame_count : {4u, 2u}) {
+    auto pixels = RenderHeadlessFrames(engine.get(), frame_size, frame_count);
+    ASSERT_EQ(pixels.size(), frame_count);
+    for (const auto& frame_pixels : pixels) {
+      ASSERT_TRUE(IsFilledWithColor(frame_pixels, frame_size,
+                                    colors[frame_index++ % 3]));
+    }
+  }
+}
+
+TEST_F(EmbedderTest, HeadlessEngineRejectsInvalidArguments) {
+  auto& context = GetEmbedderContext();
+
+  {
+    EmbedderConfigBuilder builder(context);
+    builder.SetHeadlessRendererConfig(SkISize::Make(0, 30));
+    ASSERT_FALSE(builder.LaunchEngine().is_valid());
+  }
+
+  {
+    EmbedderConfigBuilder builder(context);
+    builder.SetHeadlessRendererConfig(SkISize::Make(40, 30));
+    builder.SetCompositor();
+    ASSERT_FALSE(builder.LaunchEngine().is_valid());
+  }
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetHeadlessRendererConfig(SkISize::Make(40, 30));
+  builder.SetDartEntrypoint("render_headless_frames");
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  std::vector<uint32_t> pixels(40 * 30);
+  void* buffers[] = {pixels.data()};
+  FlutterHeadlessFrames frames = {};
+  frames.struct_size = sizeof(FlutterHeadlessFrames);
+  frames.frame_count = 1;
+  frames.buffers = buffers;
+  frames.row_bytes = 39 * sizeof(uint32_t);
+  ASSERT_EQ(FlutterEngineRenderHeadlessFrames(engine.get(), &frames),
+            kInvalidArguments);
+
+  EmbedderConfigBuilder software_builder(context);
+  software_builder.SetSoftwareRendererConfig();
+  auto software_engine = software_builder.LaunchEngine();
+  ASSERT_TRUE(software_engine.is_valid());
+  frames.row_bytes = 40 * sizeof(uint32_t);
+  ASSERT_EQ(FlutterEngineRenderHeadlessFrames(software_engine.get(), &frames),
+            kInvalidArguments);
+}
+
+TEST_F(EmbedderTest, HeadlessEngineFailsFramesThatAreNotRendered) {
+  const SkISize frame_size = SkISize::Make(40, 30);
+
+  EmbedderConfigBuilder builder(GetEmbedderContext());
+  builder.SetHeadlessRendererConfig(frame_size);
+  builder.SetDartEntrypoint("drop_headless_frames");
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  std::vector<uint32_t> pixels(frame_size.width() * frame_size.height());
+  std::vector<void*> buffers(3, pixels.data());
+  FlutterHeadlessFrames frames = {};
+  frames.struct_size = sizeof(FlutterHeadlessFrames);
+  frames.frame_count = buffers.size();
+  frames.buffers = buffers.data();
+  frames.row_bytes = frame_size.width() * sizeof(uint32_t);
+  ASSERT_EQ(FlutterEngineRenderHeadlessFrames(engine.get(), &frames),
+            kInternalInconsistency);
+
+  // The failure does not stop the engine from trying again.
+  ASSERT_EQ(FlutterEngineRenderHeadlessFrames(engine.get(), &frames),
+            kInternalInconsistency);
+}
+
+TEST_F(EmbedderTest, HeadlessEngineRendersAgainRightAfterADroppedFrame) {
+  const SkISize frame_size = SkISize::Make(40, 30);
+
+  EmbedderConfigBuilder builder(GetEmbedderContext());
+  builder.SetHeadlessRendererConfig(frame_size);
+  builder.SetDartEntrypoint("drop_second_headless_frame");
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  ASSERT_TRUE(RenderHeadlessFrames(engine.get(), frame_size, 3).empty());
+
+  // The first frame may still have been in flight when the second one was
+  // dropped. It must not be taken for a frame of this call.
+  auto pixels = RenderHeadlessFrames(engine.get(), frame_size, 3);
+  ASSERT_EQ(pixels.size(), 3u);
+  for (const auto& frame_pixels : pixels) {
+    ASSERT_TRUE(IsFilledWithColor(frame_pixels, frame_size, SK_ColorGREEN));
+  }
+}
+
+TEST(EmbedderTestNoFixture,
+     HeadlessRendererBeginsNoFrameWhileOneIsStillBeingPresented) {
+  fml::Thread ui_thread("ui");
+  fml::Thread raster_thread("raster");
+  auto ui_task_runner = ui_thread.GetTaskRunner();
+  auto raster_task_runner = raster_thread.GetTaskRunner();
+  TaskRunners task_runners("headless_renderer", ui_task_runner,
+                           raster_task_runner, ui_task_runner, ui_task_runner);
+
+  auto renderer =
+      std::make_shared<EmbedderHeadlessRenderer>(SkISize::Make(1, 1));
+  auto vsync_waiter = std::make_shared<VsyncWaiterEmbedder>(
+      [renderer](intptr_t baton) { renderer->AwaitVsync(baton); },
+      task_runners);
+
+  // Stands in for the animator and the rasterizer. The first frame is held on
+  // the raster thread after it is presented, as if the pipeline had not yet
+  // let go of it, and the vsync of the third frame arrives meanwhile.
+  fml::AutoResetWaitableEvent first_frame_presented;
+  fml::AutoResetWaitableEvent release_first_frame;
+  std::atomic_bool holding_first_frame = false;
+  bool third_frame_began_early = false;
+  size_t vsync_requests = 0;
+  size_t begun_frames = 0;
+  const uint32_t pixel = SK_ColorRED;
+
+  VsyncWaiter::Callback begin_frame = [&](fml::TimePoint, fml::TimePoint) {
+    if (begun_frames == 2) {
+      third_frame_began_early = holding_first_frame;
+    }
+    const bool is_first_frame = begun_frames++ == 0;
+    raster_task_runner->PostTask([&, is_first_frame]() {
+      renderer->Present(&pixel, sizeof(pixel), 1);
+      if (is_first_frame) {
+        holding_first_frame = true;
+        first_frame_presented.Signal();
+        release_first_frame.Wait();
+        holding_first_frame = false;
+      }
+    });
+  };
+  fml::closure request_frame = [&]() {
+    if (vsync_requests++ == 2) {
+      first_frame_presented.Wait();
+      vsync_waiter->AsyncWaitForVsync(begin_frame);
+      ui_task_runner->PostTask([&]() { release_first_frame.Signal(); });
+      return;
+    }
+    vsync_waiter->AsyncWaitForVsync(begin_frame);
+  };
+
+  std::vector<uint32_t> pixels(3);
+  std::vector<void*> buffers = {&pixels[0], &pixels[1], &pixels[2]};
+  ASSERT_EQ(renderer->RenderFrames(buffers, sizeof(uint32_t), ui_task_runner,
+                                   request_frame),
+            EmbedderHeadlessRenderer::RenderStatus::kSuccess);
+  ASSERT_FALSE(third_frame_began_early);
+  for (uint32_t presented_pixel : pixels) {
+    ASSERT_EQ(presented_pixel, pixel);
+  }
+
+  ui_thread.Join();
+  raster_thread.Join();
+}
+
+TEST_F(EmbedderTest, HeadlessEnginesCanRenderConcurrently) {
+  const SkISize frame_size = SkISize::Make(40, 30);
+  const size_t engine_count = 4;
+  const size_t frame_count = 10;
+
+  EmbedderConfigBuilder builder(GetEmbedderContext());
+  builder.SetHeadlessRendererConfig(frame_size);
+  builder.SetDartEntrypoint("render_headless_frames");
+  std::vector<UniqueEngine> engines;
+  for (size_t i = 0; i < engine_count; i++) {
+    engines.push_back(builder.LaunchEngine());
+    ASSERT_TRUE(engines.back().is_valid());
+  }
+
+  std::vector<std::vector<std::vector<uint32_t>>> pixels(engine_count);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < engine_count; i++) {
+    threads.emplace_back([&, i]() {
+      pixels[i] = RenderHeadlessFrames(engines[i].get(), frame_size,
+                                       frame_count);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const SkColor colors[] = {SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE};
+  for (const auto& engine_pixels : pixels) {
+    ASSERT_EQ(engine_pixels.size(), frame_count);
+    for (size_t i = 0; i < frame_count; i++) {
+      ASSERT_TRUE(
+          IsFilledWithColor(engine_pixels[i], frame_size, colors[i % 3]));
+    }
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -19,23 +19,30 @@ class CompatTaskRunner : public fml::TaskRunner {
     FML_DCHECK(forwarding_target_);
   }
 
-  void PostTask(const fml::closure& task) override {
-    async::PostTask(forwarding_target_, task);
+  void PostTask(fml::UniqueClosure task) override {
+    async::PostTask(forwarding_target_, Forward(std::move(task)));
   }
 
-  void PostTaskForTime(const fml::closure& task,
+  void PostTaskForTime(fml::UniqueClosure task,
                        fml::TimePoint target_time) override {
     async::PostTaskForTime(
-        forwarding_target_, task,
+        forwarding_target_, Forward(std::move(task)),
         zx::time(target_time.ToEpochDelta().ToNanoseconds()));
   }
 
-  void PostDelayedTask(const fml::closure& task,
+  void PostDelayedTask(fml::UniqueClosure task,
                        fml::TimeDelta delay) override {
-    async::PostDelayedTask(forwarding_target_, task,
+    async::PostDelayedTask(forwarding_target_, Forward(std::move(task)),
                            zx::duration(delay.ToNanoseconds()));
   }
 
+  // The dispatcher has no notion of priorities.
+  void PostTaskForTimeWithPriority(fml::UniqueClosure task,
+                                   fml::TimePoint target_time,
+                                   fml::TaskPriority priority) override {
+    PostTaskForTime(std::move(task), target_time);
+  }
+
   bool RunsTasksOnCurrentThread() override {
     return forwarding_target_ == async_get_default_dispatcher();
   }
@@ -43,6 +50,10 @@ class CompatTaskRunner : public fml::TaskRunner {
  private:
   async_dispatcher_t* forwarding_target_;
 
+  static fit::closure Forward(fml::UniqueClosure task) {
+    return [task = std::move(task)]() { task(); };
+  }
+
   FML_DISALLOW_COPY_AND_ASSIGN(CompatTaskRunner);
   FML_FRIEND_MAKE_REF_COUNTED(CompatTaskRunner);
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(CompatTaskRunner);
@@ -118,6 +118,8 @@ def RunCCTests(build_dir, filter):
 
     RunEngineExecutable(build_dir, 'client_wrapper_windows_unittests', filter, shuffle_flags)
 
+  RunEngineExecutable(build_dir, 'assets_unittests', filter, shuffle_flags)
+
   flow_flags = ['--gtest_filter=-PerformanceOverlayLayer.Gold']
   if IsLinux():
     flow_flags = [
@@ -155,6 +157,12 @@ def RunEngineBenchmarks(build_dir, filter):
 
   RunEngineExecutable(build_dir, 'fml_benchmarks', filter)
 
+  RunEngineExecutable(build_dir, 'fml_allocation_benchmarks', filter)
+
+  RunEngineExecutable(build_dir, 'flow_benchmarks', filter)
+
+  RunEngineExecutable(build_dir, 'embedder_benchmarks', filter)
+
   if IsLinux():
     RunEngineExecutable(build_dir, 'txt_benchmarks', filter)
 
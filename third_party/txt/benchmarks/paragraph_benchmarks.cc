@@ -34,6 +34,25 @@
 
 namespace txt {
 
+static const char* kLongText =
+    "This is a very long sentence to test if the text will properly wrap "
+    "around and go to the next line. Sometimes, short sentence. Longer "
+    "sentences are okay too because they are necessary. Very short. "
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+    "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+    "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+    "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+    "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+    "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+    "mollit anim id est laborum. "
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+    "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+    "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+    "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+    "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+    "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+    "mollit anim id est laborum.";
+
 class ParagraphFixture : public benchmark::Fixture {
  public:
   void SetUp(const benchmark::State& state) {
@@ -77,25 +96,34 @@ BENCHMARK_F(ParagraphFixture, ShortLayout)(benchmark::State& state) {
 }
 
 BENCHMARK_F(ParagraphFixture, LongLayout)(benchmark::State& state) {
-  const char* text =
-      "This is a very long sentence to test if the text will properly wrap "
-      "around and go to the next line. Sometimes, short sentence. Longer "
-      "sentences are okay too because they are necessary. Very short. "
-      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
-      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
-      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
-      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
-      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
-      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
-      "mollit anim id est laborum. "
-      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
-      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
-      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
-      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
-      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
-      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
-      "mollit anim id est laborum.";
-  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  auto icu_text = icu::UnicodeString::fromUTF8(kLongText);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+
+// Lays the same paragraph out at a sweep of widths, like a window being
+// resized. With an argument of 0 only the width changes between layouts, so
+// the paragraph keeps its shaped words and only breaks and positions the
+// lines again. With an argument of 1 every layout is a full layout.
+BENCHMARK_DEFINE_F(ParagraphFixture, ResizeSweep)(benchmark::State& state) {
+  auto icu_text = icu::UnicodeString::fromUTF8(kLongText);
   std::u16string u16_text(icu_text.getBuffer(),
                           icu_text.getBuffer() + icu_text.length());
 
@@ -107,6 +135,42 @@ BENCHMARK_F(ParagraphFixture, LongLayout)(benchmark::State& state) {
 
   txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
 
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  const bool full_layout = state.range(0) != 0;
+  const int kMinWidth = 200;
+  const int kMaxWidth = 600;
+  int width = kMinWidth;
+  while (state.KeepRunning()) {
+    if (full_layout) {
+      paragraph->SetDirty();
+    }
+    paragraph->Layout(width);
+    width = width == kMaxWidth ? kMinWidth : width + 1;
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, ResizeSweep)->Arg(0)->Arg(1);
+
+// Lays out paragraphs on several threads at once, like the UI threads of
+// multiple engines do. Each thread has its own font collection, but they all
+// share the minikin caches. After the first iteration, every word is found
+// in the layout cache.
+static void BM_ParagraphLongLayoutMultithreaded(benchmark::State& state) {
+  auto font_collection = GetTestFontCollection();
+  auto icu_text = icu::UnicodeString::fromUTF8(kLongText);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+
   builder.PushStyle(text_style);
   builder.AddText(u16_text);
   builder.Pop();
@@ -115,7 +179,35 @@ BENCHMARK_F(ParagraphFixture, LongLayout)(benchmark::State& state) {
     paragraph->SetDirty();
     paragraph->Layout(300);
   }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParagraphLongLayoutMultithreaded)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Shapes text on several threads at once. Every thread uses a different font
+// size on every iteration, so that every word misses the layout cache.
+static void BM_MinikinShapingMultithreaded(benchmark::State& state) {
+  auto font_collection = GetTestFontCollection();
+  auto icu_text = icu::UnicodeString::fromUTF8(kLongText);
+  std::vector<uint16_t> text(icu_text.getBuffer(),
+                             icu_text.getBuffer() + icu_text.length());
+  auto collection = font_collection->GetMinikinFontCollectionForFamilies(
+      std::vector<std::string>(1, "Roboto"), "en-US");
+  minikin::FontStyle font(4, false);
+  minikin::MinikinPaint paint;
+
+  size_t iteration = 0;
+  while (state.KeepRunning()) {
+    paint.size =
+        10 + 0.001f * (state.thread_index + state.threads * iteration++);
+    minikin::Layout layout;
+    layout.doLayout(text.data(), 0, text.size(), text.size(), false, font,
+                    paint, collection);
+  }
+  state.SetItemsProcessed(state.iterations());
 }
+BENCHMARK(BM_MinikinShapingMultithreaded)->ThreadRange(1, 8)->UseRealTime();
 
 BENCHMARK_F(ParagraphFixture, JustifyLayout)(benchmark::State& state) {
   const char* text =
@@ -141,6 +141,7 @@ uint32_t FontLanguageListCache::getId(const std::string& languages) {
 
 // static
 const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
+  std::scoped_lock _l(gMinikinLock);
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
   LOG_ALWAYS_FATAL_IF(id >= inst->mLanguageLists.size(),
                       "Lookup by unknown language list ID.");
@@ -17,6 +17,7 @@
 #ifndef MINIKIN_FONT_LANGUAGE_LIST_CACHE_H
 #define MINIKIN_FONT_LANGUAGE_LIST_CACHE_H
 
+#include <deque>
 #include <unordered_map>
 
 #include <minikin/FontFamily.h>
@@ -35,7 +36,8 @@ class FontLanguageListCache {
   // FontLanguages. Caller should acquire a lock before calling the method.
   static uint32_t getId(const std::string& languages);
 
-  // Caller should acquire a lock before calling the method.
+  // Thread-safe. The returned list is never moved or destroyed, so it may
+  // still be used after the lock has been released.
   static const FontLanguages& getById(uint32_t id);
 
  private:
@@ -45,7 +47,8 @@ class FontLanguageListCache {
   // Caller should acquire a lock before calling the method.
   static FontLanguageListCache* getInstance();
 
-  std::vector<FontLanguages> mLanguageLists;
+  // A deque, so that registering new lists does not move the existing ones.
+  std::deque<FontLanguages> mLanguageLists;
 
   // A map from string representation of the font language list to the ID.
   std::unordered_map<std::string, uint32_t> mLanguageListLookupTable;
@@ -108,6 +108,8 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
       variations.push_back({variation.axisTag, variation.value});
   }
   hb_font_set_variations(font, variations.data(), variations.size());
+  // Layouts on other threads may use the font once it is in the cache.
+  hb_font_make_immutable(font);
   hb_font_destroy(parent_font);
   hb_face_destroy(face);
   fontCache->put(fontId, font);
@@ -22,6 +22,8 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -33,6 +35,9 @@
 #include <hb-icu.h>
 #include <hb-ot.h>
 
+#include "flutter/fml/macros.h"
+#include "flutter/fml/thread_local.h"
+
 #include <minikin/Emoji.h>
 #include <minikin/Layout.h>
 #include "FontLanguage.h"
@@ -89,6 +94,11 @@ class LayoutCacheKey {
 
   android::hash_t hash() const { return mHash; }
 
+  // The memory held by a key once its text has been copied.
+  size_t getMemoryUsage() const {
+    return sizeof(LayoutCacheKey) + mNchars * sizeof(uint16_t);
+  }
+
   void copyText() {
     uint16_t* charsCopy = new uint16_t[mNchars];
     memcpy(charsCopy, mChars, mNchars * sizeof(uint16_t));
@@ -129,62 +139,174 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+// A cache of the layouts of individual words, shared by all threads.
+//
+// The cache is split into shards, each with its own lock and LRU list, so
+// that threads laying out different words rarely contend with each other.
+// Each shard evicts its least recently used layouts once the memory held by
+// its entries exceeds its share of the byte budget.
+class LayoutCache {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
+  LayoutCache() { setMaxBytes(kDefaultMaxBytes); }
+
+  void clear() {
+    for (Shard& shard : mShards) {
+      shard.clear();
+    }
   }
 
-  void clear() { mCache.clear(); }
+  void setMaxBytes(size_t maxBytes) {
+    for (Shard& shard : mShards) {
+      shard.setMaxBytes(maxBytes / kShardCount);
+    }
+  }
 
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
+  // The returned layout stays valid after it has been evicted for as long as
+  // the caller holds on to it.
+  std::shared_ptr<Layout> get(
+      LayoutCacheKey& key,
+      LayoutContext* ctx,
+      const std::shared_ptr<FontCollection>& collection) {
+    Shard& shard = getShard(key);
+    std::shared_ptr<Layout> layout = shard.get(key);
+    if (layout == nullptr) {
+      // The word is shaped without holding the lock of the shard. Two threads
+      // may occasionally shape the same word, in which case the layout that
+      // was inserted first is kept.
+      layout = std::make_shared<Layout>();
+      key.doLayout(layout.get(), ctx, collection);
+      layout = shard.put(key, std::move(layout));
     }
     return layout;
   }
 
  private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
-  }
+  class Shard
+      : private android::OnEntryRemoved<LayoutCacheKey,
+                                        std::shared_ptr<Layout>> {
+   public:
+    Shard() : mCache(Cache::kUnlimitedCapacity) {
+      mCache.setOnEntryRemovedListener(this);
+    }
+
+    void clear() {
+      std::scoped_lock _l(mMutex);
+      mCache.clear();
+    }
+
+    void setMaxBytes(size_t maxBytes) {
+      std::scoped_lock _l(mMutex);
+      mMaxBytes = maxBytes;
+      trimLocked();
+    }
+
+    std::shared_ptr<Layout> get(const LayoutCacheKey& key) {
+      std::scoped_lock _l(mMutex);
+      return mCache.get(key);
+    }
+
+    std::shared_ptr<Layout> put(LayoutCacheKey& key,
+                                std::shared_ptr<Layout> layout) {
+      std::scoped_lock _l(mMutex);
+      std::shared_ptr<Layout> existing = mCache.get(key);
+      if (existing != nullptr) {
+        return existing;
+      }
+      key.copyText();
+      mBytes += getEntryBytes(key, *layout);
+      mCache.put(key, layout);
+      trimLocked();
+      return layout;
+    }
+
+   private:
+    using Cache = android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>>;
+
+    std::mutex mMutex;
+    size_t mBytes = 0;
+    size_t mMaxBytes = 0;
+    Cache mCache;
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
+    static size_t getEntryBytes(const LayoutCacheKey& key,
+                                const Layout& layout) {
+      return key.getMemoryUsage() + layout.getMemoryUsage();
+    }
 
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+    void trimLocked() {
+      while (mBytes > mMaxBytes && mCache.removeOldest()) {
+      }
+    }
+
+    // callback for OnEntryRemoved
+    void operator()(LayoutCacheKey& key,
+                    std::shared_ptr<Layout>& value) override {
+      mBytes -= getEntryBytes(key, *value);
+      key.freeText();
+      value.reset();
+    }
+  };
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+  static const size_t kShardCount = 16;
+  static const size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+  Shard& getShard(const LayoutCacheKey& key) {
+    // The low bits of the hash are used by the hash set of each shard.
+    return mShards[(static_cast<uint32_t>(key.hash()) >> 16) % kShardCount];
+  }
+
+  Shard mShards[kShardCount];
 };
 
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
+    hb_unicode_funcs_make_immutable(unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
+  // HarfBuzz buffers may not be shared between threads, so every thread that
+  // shapes text gets a buffer of its own.
+  hb_buffer_t* getHbBuffer();
+
   static LayoutEngine& getInstance() {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
   }
 };
 
+namespace {
+
+class ThreadHbBuffer {
+ public:
+  explicit ThreadHbBuffer(hb_unicode_funcs_t* unicodeFunctions)
+      : mBuffer(hb_buffer_create()) {
+    hb_buffer_set_unicode_funcs(mBuffer, unicodeFunctions);
+  }
+
+  ~ThreadHbBuffer() { hb_buffer_destroy(mBuffer); }
+
+  hb_buffer_t* get() const { return mBuffer; }
+
+ private:
+  hb_buffer_t* mBuffer;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ThreadHbBuffer);
+};
+
+FML_THREAD_LOCAL fml::ThreadLocalUniquePtr<ThreadHbBuffer> tHbBuffer;
+
+}  // namespace
+
+hb_buffer_t* LayoutEngine::getHbBuffer() {
+  if (tHbBuffer.get() == nullptr) {
+    tHbBuffer.reset(new ThreadHbBuffer(unicodeFunctions));
+  }
+  return tHbBuffer.get()->get();
+}
+
 bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
   return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
          mStyle == other.mStyle && mSize == other.mSize &&
@@ -316,19 +438,25 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
-    hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
-                      &ctx->paint, 0);
+    // The cached font is shared by all threads, so the paint and scale of
+    // this layout are set on a sub font of its own.
+    hb_font_t* font;
+    hb_font_funcs_t* funcs;
+    {
+      std::scoped_lock _l(gMinikinLock);
+      hb_font_t* parent = getHbFontLocked(face.font);
+      font = hb_font_create_sub_font(parent);
+      hb_font_destroy(parent);
+      funcs = getHbFontFuncs(isColorBitmapFont(font));
+    }
+    hb_font_set_funcs(font, funcs, &ctx->paint, 0);
     ctx->hbFonts.push_back(font);
   }
   return ix;
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -587,9 +715,8 @@ void Layout::doLayout(const uint16_t* buf,
                       bool isRtl,
                       const FontStyle& style,
                       const MinikinPaint& paint,
-                      const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
+                      const std::shared_ptr<FontCollection>& collection,
+                      LayoutPieces* pieces) {
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -597,12 +724,51 @@ void Layout::doLayout(const uint16_t* buf,
   reset();
   mAdvances.resize(count, 0);
 
+  // Hyphen edits change the layouts of the words at the edges of the range,
+  // so they cannot be reused for other ranges.
+  if (paint.hyphenEdit.getHyphen() != 0) {
+    pieces = nullptr;
+  }
+
   doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, start, collection,
-                    this, NULL);
+                    this, NULL, pieces);
 
   ctx.clearHbFonts();
 }
 
+bool Layout::doLayoutFromPieces(const LayoutPieces& pieces,
+                                size_t start,
+                                size_t count,
+                                bool isRtl) {
+  // Find the words covering the range, in logical order.
+  std::vector<std::pair<size_t, const LayoutPieces::Piece*>> words;
+  auto it = pieces.mPieces.find(start);
+  size_t end = start;
+  while (end < start + count) {
+    if (it == pieces.mPieces.end() || it->first != end) {
+      return false;
+    }
+    words.emplace_back(it->first, &it->second);
+    end += it->second.count;
+    ++it;
+  }
+  if (end != start + count) {
+    return false;
+  }
+
+  reset();
+  mAdvances.resize(count, 0);
+  // Append the words in the order doLayoutRunCached does.
+  if (isRtl) {
+    std::reverse(words.begin(), words.end());
+  }
+  for (const auto& word : words) {
+    appendLayout(word.second->layout.get(), word.first - start,
+                 word.second->wordSpacing);
+  }
+  return true;
+}
+
 float Layout::measureText(const uint16_t* buf,
                           size_t start,
                           size_t count,
@@ -612,14 +778,12 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
 
   float advance = doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, 0,
-                                    collection, NULL, advances);
+                                    collection, NULL, advances, NULL);
 
   ctx.clearHbFonts();
   return advance;
@@ -635,7 +799,8 @@ float Layout::doLayoutRunCached(
     size_t dstStart,
     const std::shared_ptr<FontCollection>& collection,
     Layout* layout,
-    float* advances) {
+    float* advances,
+    LayoutPieces* pieces) {
   const uint32_t originalHyphen = ctx->paint.hyphenEdit.getHyphen();
   float advance = 0;
   if (!isRtl) {
@@ -659,7 +824,8 @@ float Layout::doLayoutRunCached(
       advance += doLayoutWord(buf + wordstart, iter - wordstart, wordcount,
                               wordend - wordstart, isRtl, ctx, iter - dstStart,
                               collection, layout,
-                              advances ? advances + (iter - start) : advances);
+                              advances ? advances + (iter - start) : advances,
+                              pieces, iter);
       wordstart = wordend;
     }
   } else {
@@ -684,7 +850,8 @@ float Layout::doLayoutRunCached(
       advance += doLayoutWord(
           buf + wordstart, bufStart - wordstart, iter - bufStart,
           wordend - wordstart, isRtl, ctx, bufStart - dstStart, collection,
-          layout, advances ? advances + (bufStart - start) : advances);
+          layout, advances ? advances + (bufStart - start) : advances, pieces,
+          bufStart);
       wordend = wordstart;
     }
   }
@@ -700,7 +867,9 @@ float Layout::doLayoutWord(const uint16_t* buf,
                            size_t bufStart,
                            const std::shared_ptr<FontCollection>& collection,
                            Layout* layout,
-                           float* advances) {
+                           float* advances,
+                           LayoutPieces* pieces,
+                           size_t pieceStart) {
   LayoutCache& cache = LayoutEngine::getInstance().layoutCache;
   LayoutCacheKey key(collection, ctx->paint, ctx->style, buf, start, count,
                      bufSize, isRtl);
@@ -708,26 +877,27 @@ float Layout::doLayoutWord(const uint16_t* buf,
   float wordSpacing =
       count == 1 && isWordSpace(buf[start]) ? ctx->paint.wordSpacing : 0;
 
-  float advance;
+  std::shared_ptr<Layout> layoutForWord;
   if (ctx->paint.skipCache()) {
-    Layout layoutForWord;
-    key.doLayout(&layoutForWord, ctx, collection);
-    if (layout) {
-      layout->appendLayout(&layoutForWord, bufStart, wordSpacing);
-    }
-    if (advances) {
-      layoutForWord.getAdvances(advances);
-    }
-    advance = layoutForWord.getAdvance();
+    layoutForWord = std::make_shared<Layout>();
+    key.doLayout(layoutForWord.get(), ctx, collection);
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
-    if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
-    }
-    if (advances) {
-      layoutForWord->getAdvances(advances);
-    }
-    advance = layoutForWord->getAdvance();
+    layoutForWord = cache.get(key, ctx, collection);
+  }
+  if (layout) {
+    layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
+  }
+  if (advances) {
+    layoutForWord->getAdvances(advances);
+  }
+  float advance = layoutForWord->getAdvance();
+
+  // Words cut by the edges of the range are laid out without their context,
+  // so only whole words can be reused for other ranges.
+  if (pieces && start == 0 && count == bufSize) {
+    pieces->mPieces.emplace(pieceStart,
+                            LayoutPieces::Piece{count, wordSpacing,
+                                                std::move(layoutForWord)});
   }
 
   if (wordSpacing != 0) {
@@ -748,7 +918,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,9 +1089,16 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = LayoutEngine::getInstance().getHbBuffer();
   std::vector<FontCollection::Run> items;
-  collection->itemize(buf + start, count, ctx->style, &items);
+  const FontLanguages* langList;
+  {
+    // Itemization may match fallback fonts, which are shared by all threads.
+    // Shaping itself happens outside of the lock.
+    std::scoped_lock _l(gMinikinLock);
+    collection->itemize(buf + start, count, ctx->style, &items);
+    langList = &FontLanguageListCache::getById(ctx->style.getLanguageListId());
+  }
 
   std::vector<hb_feature_t> features;
   // Disable default-on non-required ligature features if letter-spacing
@@ -1005,13 +1182,11 @@ void Layout::doLayoutRun(const uint16_t* buf,
       hb_buffer_set_script(buffer, script);
       hb_buffer_set_direction(buffer,
                               isRtl ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
-      const FontLanguages& langList =
-          FontLanguageListCache::getById(ctx->style.getLanguageListId());
-      if (langList.size() != 0) {
-        const FontLanguage* hbLanguage = &langList[0];
-        for (size_t i = 0; i < langList.size(); ++i) {
-          if (langList[i].supportsHbScript(script)) {
-            hbLanguage = &langList[i];
+      if (langList->size() != 0) {
+        const FontLanguage* hbLanguage = &(*langList)[0];
+        for (size_t i = 0; i < langList->size(); ++i) {
+          if ((*langList)[i].supportsHbScript(script)) {
+            hbLanguage = &(*langList)[i];
             break;
           }
         }
@@ -1192,11 +1367,20 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+size_t Layout::getMemoryUsage() const {
+  return sizeof(Layout) + mGlyphs.capacity() * sizeof(LayoutGlyph) +
+         mAdvances.capacity() * sizeof(float) +
+         mFaces.capacity() * sizeof(FakedFont);
+}
+
 void Layout::purgeCaches() {
+  LayoutEngine::getInstance().layoutCache.clear();
   std::scoped_lock _l(gMinikinLock);
-  LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
-  layoutCache.clear();
   purgeHbFontCacheLocked();
 }
 
+void Layout::setCacheMaxBytes(size_t maxBytes) {
+  LayoutEngine::getInstance().layoutCache.setMaxBytes(maxBytes);
+}
+
 }  // namespace minikin
@@ -19,6 +19,7 @@
 
 #include <hb.h>
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -46,6 +47,30 @@ struct LayoutGlyph {
 // Internal state used during layout operation
 struct LayoutContext;
 
+class Layout;
+
+// libtxt extension: The layouts of the whole words of a text, recorded by
+// Layout::doLayout. Any range of the same text that starts and ends at word
+// boundaries can be laid out again from them without shaping, as long as it
+// uses the same style, paint and font collection.
+class LayoutPieces {
+ public:
+  bool empty() const { return mPieces.empty(); }
+  void clear() { mPieces.clear(); }
+
+ private:
+  friend class Layout;
+
+  struct Piece {
+    size_t count;
+    float wordSpacing;
+    std::shared_ptr<Layout> layout;
+  };
+
+  // Keyed by the offset of the word in the text.
+  std::map<size_t, Piece> mPieces;
+};
+
 enum {
   kBidi_LTR = 0,
   kBidi_RTL = 1,
@@ -74,6 +99,8 @@ class Layout {
 
   void dump() const;
 
+  // libtxt extension: When |pieces| is not null, the layouts of the whole
+  // words of the range are added to it.
   void doLayout(const uint16_t* buf,
                 size_t start,
                 size_t count,
@@ -81,7 +108,16 @@ class Layout {
                 bool isRtl,
                 const FontStyle& style,
                 const MinikinPaint& paint,
-                const std::shared_ptr<FontCollection>& collection);
+                const std::shared_ptr<FontCollection>& collection,
+                LayoutPieces* pieces = nullptr);
+
+  // libtxt extension: Produces the same layout as doLayout would, from the
+  // words in |pieces|. Returns false and leaves the layout untouched if the
+  // range is not made of whole words that have been recorded.
+  bool doLayoutFromPieces(const LayoutPieces& pieces,
+                          size_t start,
+                          size_t count,
+                          bool isRtl);
 
   static float measureText(const uint16_t* buf,
                            size_t start,
@@ -117,6 +153,13 @@ class Layout {
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // Sets the number of bytes the layouts of words cached by all threads may
+  // hold before the least recently used ones are evicted.
+  static void setCacheMaxBytes(size_t maxBytes);
+
+  // The approximate number of bytes held by this layout.
+  size_t getMemoryUsage() const;
+
  private:
   friend class LayoutCacheKey;
 
@@ -139,7 +182,8 @@ class Layout {
       size_t dstStart,
       const std::shared_ptr<FontCollection>& collection,
       Layout* layout,
-      float* advances);
+      float* advances,
+      LayoutPieces* pieces);
 
   // Lay out a single word
   static float doLayoutWord(const uint16_t* buf,
@@ -151,7 +195,9 @@ class Layout {
                             size_t bufStart,
                             const std::shared_ptr<FontCollection>& collection,
                             Layout* layout,
-                            float* advances);
+                            float* advances,
+                            LayoutPieces* pieces,
+                            size_t pieceStart);
 
   // Lay out a single bidi run
   void doLayoutRun(const uint16_t* buf,
@@ -28,8 +28,9 @@
 namespace minikin {
 
 // All external Minikin interfaces are designed to be thread-safe.
-// Presently, that's implemented by through a global lock, and having
-// all external interfaces take that lock.
+// Shared font state (font families, language lists and the HarfBuzz font
+// cache) is guarded by a global lock. Shaping and the layout cache do not
+// hold it, so that text can be laid out on several threads at once.
 
 extern std::recursive_mutex gMinikinLock;
 
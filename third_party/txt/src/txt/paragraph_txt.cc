@@ -643,13 +643,16 @@ void ParagraphTxt::ComputePlaceholder(PlaceholderRun* placeholder_run,
 
 // Implementation outline:
 //
+// -Compute line breaks
+// -Compute Bidi runs, unless only the width changed since the last layout
 // -For each line:
-//   -Compute Bidi runs, convert into line_runs (keeps in-line-range runs, adds
-//   special runs)
+//   -Convert Bidi runs into line_runs (keeps in-line-range runs, adds special
+//   runs)
 //   -For each line_run (runs in the line):
 //     -Calculate ellipsis
 //     -Obtain font
-//     -layout.doLayout(...), genereates glyph blobs
+//     -layout.doLayoutFromPieces(...) or layout.doLayout(...), genereates glyph
+//     blobs
 //     -For each glyph blob:
 //       -Convert glyph blobs into pixel metrics/advances
 //     -Store as paint records (for painting) and code unit runs (for metrics
@@ -666,6 +669,12 @@ void ParagraphTxt::Layout(double width) {
 
   width_ = rounded_width;
 
+  // Only the width changed if no full layout was requested, in which case the
+  // text is shaped exactly as before and only needs to be broken into lines
+  // and positioned again.
+  if (needs_layout_) {
+    bidi_runs_valid_ = false;
+  }
   needs_layout_ = false;
 
   records_.clear();
@@ -679,9 +688,14 @@ void ParagraphTxt::Layout(double width) {
   if (!ComputeLineBreaks())
     return;
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
-    return;
+  if (!bidi_runs_valid_) {
+    bidi_runs_.clear();
+    bidi_run_pieces_.clear();
+    if (!ComputeBidiRuns(&bidi_runs_))
+      return;
+    bidi_run_pieces_.resize(bidi_runs_.size());
+    bidi_runs_valid_ = true;
+  }
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
@@ -732,7 +746,12 @@ void ParagraphTxt::Layout(double width) {
 
     // Find the runs comprising this line.
     std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
+    // The shaped words of the bidi run that each line run was taken from.
+    std::vector<minikin::LayoutPieces*> line_run_pieces;
+    for (size_t bidi_run_index = 0; bidi_run_index < bidi_runs_.size();
+         ++bidi_run_index) {
+      const BidiRun& bidi_run = bidi_runs_[bidi_run_index];
+      minikin::LayoutPieces* pieces = &bidi_run_pieces_[bidi_run_index];
       // A "ghost" run is a run that does not impact the layout, breaking,
       // alignment, width, etc but is still "visible" through getRectsForRange.
       // For example, trailing whitespace on centered text can be scrolled
@@ -755,6 +774,7 @@ void ParagraphTxt::Layout(double width) {
       // Include the ghost run before normal run if RTL
       if (bidi_run.direction() == TextDirection::rtl && ghost_run != nullptr) {
         line_runs.push_back(*ghost_run);
+        line_run_pieces.push_back(pieces);
       }
       // Emplace a normal line run.
       if (bidi_run.start() < line_end_index &&
@@ -775,10 +795,12 @@ void ParagraphTxt::Layout(double width) {
               std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
               bidi_run.style());
         }
+        line_run_pieces.push_back(pieces);
       }
       // Include the ghost run after normal run if LTR
       if (bidi_run.direction() == TextDirection::ltr && ghost_run != nullptr) {
         line_runs.push_back(*ghost_run);
+        line_run_pieces.push_back(pieces);
       }
     }
     bool line_runs_all_rtl =
@@ -863,8 +885,22 @@ void ParagraphTxt::Layout(double width) {
         }
       }
 
-      layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
-                      minikin_font, minikin_paint, minikin_font_collection);
+      if (!ellipsized_text.empty()) {
+        layout.doLayout(text_ptr, text_start, text_count, text_size,
+                        run.is_rtl(), minikin_font, minikin_paint,
+                        minikin_font_collection);
+      } else {
+        // Reuse the words shaped by previous layouts if the run is made of
+        // whole words, and record the words of the run otherwise.
+        minikin::LayoutPieces* pieces =
+            line_run_pieces[line_run_it - line_runs.begin()];
+        if (!layout.doLayoutFromPieces(*pieces, text_start, text_count,
+                                       run.is_rtl())) {
+          layout.doLayout(text_ptr, text_start, text_count, text_size,
+                          run.is_rtl(), minikin_font, minikin_paint,
+                          minikin_font_collection, pieces);
+        }
+      }
 
       if (layout.nGlyphs() == 0)
         continue;
@@ -1347,6 +1383,7 @@ void ParagraphTxt::SetParagraphStyle(const ParagraphStyle& style) {
 void ParagraphTxt::SetFontCollection(
     std::shared_ptr<FontCollection> font_collection) {
   font_collection_ = std::move(font_collection);
+  bidi_runs_valid_ = false;
 }
 
 std::shared_ptr<minikin::FontCollection>
@@ -25,6 +25,7 @@
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
 #include "line_metrics.h"
+#include "minikin/Layout.h"
 #include "minikin/LineBreaker.h"
 #include "paint_record.h"
 #include "paragraph.h"
@@ -163,6 +164,8 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
   FRIEND_TEST(ParagraphTest, TextHeightBehaviorRectsParagraph);
+  FRIEND_TEST(ParagraphTest, LayoutOnMultipleThreads);
+  FRIEND_TEST(ParagraphTest, RelayoutAfterWidthChangeMatchesFreshLayout);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -324,6 +327,14 @@ class ParagraphTxt : public Paragraph {
 
   bool needs_layout_ = true;
 
+  // The bidi runs of the text and the shaped words of each run. A Layout()
+  // that only changes the width breaks the lines again but reuses these
+  // instead of shaping the text again. Invalidated by anything that needs a
+  // full layout.
+  std::vector<BidiRun> bidi_runs_;
+  std::vector<minikin::LayoutPieces> bidi_run_pieces_;
+  bool bidi_runs_valid_ = false;
+
   struct WaveCoordinates {
     double x_start;
     double y_start;
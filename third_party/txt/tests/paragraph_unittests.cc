@@ -15,8 +15,10 @@
  */
 
 #include <iostream>
+#include <thread>
 
 #include "flutter/fml/logging.h"
+#include "minikin/Layout.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -5975,4 +5977,131 @@ TEST_F(ParagraphTest, TextHeightBehaviorRectsParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, LayoutOnMultipleThreads) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "مرحبا بالعالم "
+      "😀 Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  // Every engine has its own font collection, but the minikin caches are
+  // shared by all of them.
+  auto layout_paragraph = [&u16_text](double font_size) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+    txt::TextStyle text_style;
+    text_style.font_families = std::vector<std::string>(1, "Roboto");
+    text_style.font_size = font_size;
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    auto paragraph = BuildParagraph(builder);
+    paragraph->Layout(300);
+    return paragraph;
+  };
+
+  const size_t kThreadCount = 8;
+  const size_t kIterations = 20;
+  std::vector<std::unique_ptr<ParagraphTxt>> expected;
+  for (size_t i = 0; i < kThreadCount; i++) {
+    expected.push_back(layout_paragraph(10 + i));
+  }
+  minikin::Layout::purgeCaches();
+
+  std::vector<std::vector<std::unique_ptr<ParagraphTxt>>> results(
+      kThreadCount);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&, i]() {
+      for (size_t j = 0; j < kIterations; j++) {
+        // Alternate between the font sizes so that the threads race to shape
+        // and cache the same words.
+        results[i].push_back(layout_paragraph(10 + (i + j) % kThreadCount));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < kThreadCount; i++) {
+    for (size_t j = 0; j < kIterations; j++) {
+      const ParagraphTxt& result = *results[i][j];
+      const ParagraphTxt& reference = *expected[(i + j) % kThreadCount];
+      ASSERT_EQ(result.glyph_lines_.size(), reference.glyph_lines_.size());
+      for (size_t line = 0; line < result.glyph_lines_.size(); line++) {
+        const auto& positions = result.glyph_lines_[line].positions;
+        const auto& expected_positions =
+            reference.glyph_lines_[line].positions;
+        ASSERT_EQ(positions.size(), expected_positions.size());
+        for (size_t k = 0; k < positions.size(); k++) {
+          EXPECT_EQ(positions[k].x_pos.start,
+                    expected_positions[k].x_pos.start);
+          EXPECT_EQ(positions[k].x_pos.end, expected_positions[k].x_pos.end);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ParagraphTest, RelayoutAfterWidthChangeMatchesFreshLayout) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "مرحبا بالعالم "
+      "😀 Lorem ipsum dolor sit amet, consectetur adipiscing elit.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  auto build_paragraph = [&u16_text]() {
+    txt::ParagraphStyle paragraph_style;
+    paragraph_style.text_align = TextAlign::justify;
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+    txt::TextStyle text_style;
+    text_style.font_families = std::vector<std::string>(1, "Roboto");
+    text_style.font_size = 26;
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text.substr(0, 40));
+    text_style.font_size = 20;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text.substr(40));
+    builder.Pop();
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  // Only the first layout shapes the text, the others reuse its words.
+  auto paragraph = build_paragraph();
+  paragraph->Layout(300);
+  for (double width : {200.0, 550.0, 123.0, 300.0}) {
+    paragraph->Layout(width);
+    auto reference = build_paragraph();
+    reference->Layout(width);
+
+    ASSERT_EQ(paragraph->GetLineCount(), reference->GetLineCount());
+    EXPECT_EQ(paragraph->GetHeight(), reference->GetHeight());
+    EXPECT_EQ(paragraph->GetLongestLine(), reference->GetLongestLine());
+    ASSERT_EQ(paragraph->glyph_lines_.size(), reference->glyph_lines_.size());
+    for (size_t line = 0; line < paragraph->glyph_lines_.size(); line++) {
+      const auto& positions = paragraph->glyph_lines_[line].positions;
+      const auto& expected_positions = reference->glyph_lines_[line].positions;
+      ASSERT_EQ(positions.size(), expected_positions.size());
+      for (size_t k = 0; k < positions.size(); k++) {
+        EXPECT_EQ(positions[k].code_units.start,
+                  expected_positions[k].code_units.start);
+        EXPECT_EQ(positions[k].x_pos.start, expected_positions[k].x_pos.start);
+        EXPECT_EQ(positions[k].x_pos.end, expected_positions[k].x_pos.end);
+      }
+    }
+  }
+}
+
 }  // namespace txt
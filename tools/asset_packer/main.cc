@@ -0,0 +1,106 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "flutter/assets/packed_asset_bundle.h"
+#include "flutter/assets/packed_asset_bundle_writer.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/paths.h"
+
+namespace {
+
+void Usage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << "asset_packer <asset_directory> <output> [--compress]"
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "Packs every file in asset_directory into a single archive. "
+               "When the archive is named "
+            << flutter::PackedAssetBundle::kFileName
+            << " and placed in the asset directory, the engine looks assets "
+               "up in it before falling back to the directory."
+            << std::endl;
+  std::cout << "With --compress, assets that compress well are stored "
+               "compressed with LZ4. Compressed assets are copied into memory "
+               "when they are read instead of being mapped."
+            << std::endl;
+}
+
+bool AddAssets(flutter::PackedAssetBundleWriter& writer,
+               const fml::UniqueFD& directory,
+               const std::string& prefix,
+               bool compress) {
+  return fml::VisitFiles(directory, [&](const fml::UniqueFD& parent,
+                                        const std::string& filename) {
+    const std::string name = prefix + filename;
+    if (fml::IsDirectory(parent, filename.c_str())) {
+      auto child = fml::OpenDirectoryReadOnly(parent, filename.c_str());
+      return AddAssets(writer, child, name + "/", compress);
+    }
+    if (name == flutter::PackedAssetBundle::kFileName) {
+      // Do not pack the archive left over from a previous run.
+      return true;
+    }
+    auto mapping = std::make_unique<fml::FileMapping>(
+        fml::OpenFileReadOnly(parent, filename.c_str()));
+    if (!mapping->IsValid()) {
+      std::cerr << "Failed to read " << name << "; aborting." << std::endl;
+      return false;
+    }
+    return writer.AddAsset(name, std::move(mapping), compress);
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4 ||
+      (argc == 4 && std::strcmp(argv[3], "--compress") != 0)) {
+    Usage();
+    return -1;
+  }
+  const std::string asset_directory_path(argv[1]);
+  const std::string output_file_path(argv[2]);
+  const bool compress = argc == 4;
+
+  auto asset_directory = fml::OpenDirectory(
+      asset_directory_path.c_str(), false, fml::FilePermission::kRead);
+  if (!asset_directory.is_valid()) {
+    std::cerr << "Failed to open asset directory " << asset_directory_path
+              << "; aborting." << std::endl;
+    return -1;
+  }
+
+  flutter::PackedAssetBundleWriter writer;
+  if (!AddAssets(writer, asset_directory, "", compress)) {
+    return -1;
+  }
+  auto archive = writer.Build();
+
+  std::string output_directory_path =
+      fml::paths::GetDirectoryName(output_file_path);
+  if (output_directory_path.empty()) {
+    output_directory_path = ".";
+  }
+  const std::string output_file_name =
+      output_file_path.substr(output_file_path.rfind('/') + 1);
+  auto output_directory =
+      fml::OpenDirectory(output_directory_path.c_str(), false,
+                         fml::FilePermission::kReadWrite);
+  if (!fml::WriteAtomically(output_directory, output_file_name.c_str(),
+                            *archive)) {
+    std::cerr << "Failed to write " << output_file_path << "; aborting."
+              << std::endl;
+    return -1;
+  }
+  std::cout << "Packed " << writer.GetAssetCount() << " assets into "
+            << output_file_path << " (" << archive->GetSize() << " bytes)."
+            << std::endl;
+  return 0;
+}